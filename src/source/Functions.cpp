@@ -34,6 +34,8 @@
 
 #ifdef WIN32
   #include <direct.h>
+  #include <io.h>
+  #include <fcntl.h>
 #else
   #include <unistd.h>
 #endif
@@ -954,6 +956,23 @@ llong FileSize(const std::string &name){
   return(size);
 }
 
+//==============================================================================
+/// Truncates file to the given size. Returns false in case of error.
+//==============================================================================
+bool FileTruncate(const std::string &name,llong size){
+  bool ok=false;
+  #ifdef WIN32
+  const int fd=_open(name.c_str(),_O_RDWR|_O_BINARY);
+  if(fd!=-1){
+    ok=(_chsize_s(fd,size)==0);
+    _close(fd);
+  }
+  #else
+  ok=(truncate(name.c_str(),off_t(size))==0);
+  #endif
+  return(ok);
+}
+
 
 //==============================================================================
 /// Returns current directory.
@@ -1407,6 +1426,14 @@ double* ResizeAlloc(double *data,unsigned ndata,unsigned newsize){
   return(data2);
 }
 //==============================================================================
+ullong* ResizeAlloc(ullong *data,unsigned ndata,unsigned newsize){
+  ullong* data2=new ullong[newsize];
+  ndata=std::min(ndata,newsize);
+  if(ndata)memcpy(data2,data,sizeof(ullong)*ndata);
+  delete[] data;
+  return(data2);
+}
+//==============================================================================
 tdouble2* ResizeAlloc(tdouble2 *data,unsigned ndata,unsigned newsize){
   tdouble2* data2=new tdouble2[newsize];
   ndata=std::min(ndata,newsize);
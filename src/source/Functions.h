@@ -76,6 +76,8 @@
 //:# - Nueva funcion VectorSplitDouble().  (05-06-2019)
 //:# - Nuevas funciones StrIsIntegerNumber() and StrIsRealNumber().  (13-06-2019)
 //:# - Updates FileType() for files larger than 2GB.  (20-06-2019)
+//:# - Nueva funcion FileTruncate().  (18-10-2026)
+//:# - Nueva funcion ResizeAlloc() para ullong.  (18-10-2026)
 //:#############################################################################
 
 /// \file Functions.h \brief Declares basic/general functions for the entire application.
@@ -230,6 +232,7 @@ int FileType(const std::string &name);
 inline bool FileExists(const std::string &name){ return(FileType(name)==2); }
 inline bool DirExists(const std::string &name){ return(FileType(name)==1); }
 llong FileSize(const std::string &name);
+bool FileTruncate(const std::string &name,llong size);
 
 std::string GetCurrentDir();
 int Mkdir(const std::string &dirname);
@@ -275,6 +278,7 @@ tfloat2*  ResizeAlloc(tfloat2  *data,unsigned ndata,unsigned newsize);
 tfloat3*  ResizeAlloc(tfloat3  *data,unsigned ndata,unsigned newsize);
 tfloat4*  ResizeAlloc(tfloat4  *data,unsigned ndata,unsigned newsize);
 double*   ResizeAlloc(double   *data,unsigned ndata,unsigned newsize);
+ullong*   ResizeAlloc(ullong   *data,unsigned ndata,unsigned newsize);
 tdouble2* ResizeAlloc(tdouble2 *data,unsigned ndata,unsigned newsize);
 tdouble3* ResizeAlloc(tdouble3 *data,unsigned ndata,unsigned newsize);
 tdouble4* ResizeAlloc(tdouble4 *data,unsigned ndata,unsigned newsize);
@@ -21,7 +21,15 @@
 #include "JArraysCpu.h"
 #include "Functions.h"
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
 #include <algorithm>
+#ifndef WIN32
+  #include <sys/mman.h>
+#else
+  #include <malloc.h>
+#endif
 
 using namespace std;
 
@@ -36,6 +44,8 @@ JArraysCpuSize::JArraysCpuSize(unsigned elementsize):ElementSize(elementsize){
   for(unsigned c=0;c<MAXPOINTERS;c++)Pointers[c]=NULL;
   Count=0;
   CountMax=CountUsedMax=0;
+  ReserveSize=0;
+  HugePages=HPAGES_None;
   Reset();
 }
 
@@ -52,7 +62,9 @@ JArraysCpuSize::~JArraysCpuSize(){
 //==============================================================================
 void JArraysCpuSize::Reset(){
   FreeMemory();
-  ArraySize=0;
+  ArraySize=ArrayCapacity=0;
+  MemReserved=false;
+  AllocHugePages=HPAGES_None;
 }
 
 //==============================================================================
@@ -64,28 +76,41 @@ void JArraysCpuSize::FreeMemory(){
   CountUsed=Count=0;
 }
 
+//==============================================================================
+/// Devuelve los bytes de memoria virtual reservada para size elementos, 
+/// redondeados a 2 MB con huge pages explicitas.
+/// Returns bytes of reserved virtual memory for size elements, rounded up to
+/// 2 MB with explicit huge pages.
+//==============================================================================
+size_t JArraysCpuSize::ReservedBytes(unsigned size)const{
+  return(JArraysCpu::ReservedBytes(size_t(ElementSize)*size,AllocHugePages));
+}
+
 //==============================================================================
 /// Reserva memoria y devuelve puntero con memoria asignada.
 /// Allocates memory and returns pointers with allocated memory.
 //==============================================================================
-void* JArraysCpuSize::AllocPointer(unsigned size)const{
+void* JArraysCpuSize::AllocPointer(unsigned size){
   void* pointer=NULL;
-  try{
-    switch(ElementSize){
-      case 1:   pointer=new char[size];      break;
-      case 2:   pointer=new word[size];      break;
-      case 4:   pointer=new int[size];       break;
-      case 8:   pointer=new double[size];    break;
-      case 12:  pointer=new int[size*3];     break;
-      case 16:  pointer=new int[size*4];     break;
-      case 24:  pointer=new double[size*3];  break;
-      case 32:  pointer=new double[size*4];  break;
+#ifndef WIN32
+  //-Reserves virtual memory, physical memory is only used when the pages are written.
+  //-Reserva memoria virtual, la memoria fisica solo se usa cuando se escriben las paginas.
+  if(MemReserved){
+    try{
+      pointer=JArraysCpu::AllocReserved(size_t(ElementSize)*size,AllocHugePages);
+    }
+    catch(const std::bad_alloc){
+      RunException("AllocPointer","Cannot reserve the requested virtual memory.");
     }
+    return(pointer);
+  }
+#endif
+  try{
+    pointer=JArraysCpu::AllocLarge(size_t(ElementSize)*size,AllocHugePages);
   }
   catch(const std::bad_alloc){
     RunException("AllocPointer","Cannot allocate the requested memory.");
   }
-  if(!pointer)RunException("AllocPointer","The elementsize value is invalid.");
   return(pointer);
 }
 
@@ -93,18 +118,14 @@ void* JArraysCpuSize::AllocPointer(unsigned size)const{
 /// Libera la memoria asignada del puntero.
 /// Frees memory allocated to pointers.
 //==============================================================================
-void JArraysCpuSize::FreePointer(void* pointer)const{
-  switch(ElementSize){
-    case 1:   delete[] ((char*)pointer);    pointer=NULL;   break;
-    case 2:   delete[] ((word*)pointer);    pointer=NULL;   break;
-    case 4:   delete[] ((int*)pointer);     pointer=NULL;   break;
-    case 8:   delete[] ((double*)pointer);  pointer=NULL;   break;
-    case 12:  delete[] ((int*)pointer);     pointer=NULL;   break;
-    case 16:  delete[] ((int*)pointer);     pointer=NULL;   break;
-    case 24:  delete[] ((double*)pointer);  pointer=NULL;   break;
-    case 32:  delete[] ((double*)pointer);  pointer=NULL;   break;
+void JArraysCpuSize::FreePointer(void* pointer){
+#ifndef WIN32
+  if(MemReserved){
+    JArraysCpu::FreeReserved(pointer,size_t(ElementSize)*ArrayCapacity,AllocHugePages);
+    return;
   }
-  if(pointer)RunException("FreePointer","The elementsize value is invalid.");
+#endif
+  JArraysCpu::FreeLarge(pointer,size_t(ElementSize)*ArrayCapacity,AllocHugePages);
 }
 
 //==============================================================================
@@ -121,7 +142,7 @@ void JArraysCpuSize::SetArrayCount(unsigned count){
   if(count<CountUsed)RunException(met,"Unable to free arrays in use.");
   if(ArraySize){
     if(Count<count){//-Genera nuevos arrays. //-Generates new arrays.
-      for(unsigned c=Count;c<count;c++)Pointers[c]=AllocPointer(ArraySize);
+      for(unsigned c=Count;c<count;c++)Pointers[c]=AllocPointer(ArrayCapacity);
     }
     if(Count>count){//-Libera arrays. //-Frees arrays.
       for(unsigned c=count;c<Count;c++){ FreePointer(Pointers[c]); Pointers[c]=NULL; }
@@ -138,11 +159,24 @@ void JArraysCpuSize::SetArrayCount(unsigned count){
 /// If there is any array in use raises an exception.
 //==============================================================================
 void JArraysCpuSize::SetArraySize(unsigned size){
-  if(CountUsed)RunException("SetArraySize","Unable to change the dimension of the arrays because some are in use.");
   if(ArraySize!=size){
-    ArraySize=size;
+    //-Changes the size without reallocating when enough memory is available (data is kept).
+    //-Cambia el size sin reasignar memoria cuando hay suficiente disponible (se conservan los datos).
+    if(size && size<=ArrayCapacity){
+      ArraySize=size;
+      return;
+    }
+    if(CountUsed)RunException("SetArraySize","Unable to change the dimension of the arrays because some are in use.");
     unsigned count=Count;
     FreeMemory();
+    ArraySize=size;
+    ArrayCapacity=max(size,(size? ReserveSize: 0));
+    AllocHugePages=HugePages;
+#ifndef WIN32
+    MemReserved=(ArrayCapacity>ArraySize);
+#else
+    ArrayCapacity=ArraySize;
+#endif
     if(count)SetArrayCount(count);
   }
 }
@@ -247,13 +281,226 @@ llong JArraysCpu::GetAllocMemoryCpu()const{
   return(m);
 }
 
+//==============================================================================
+/// Devuelve el numero de bytes por elemento de todos los arrays.
+/// Returns number of bytes per element of all arrays.
+//==============================================================================
+unsigned JArraysCpu::GetBytesPerElement()const{ 
+  unsigned s=0;
+  for(unsigned c=0;c<8;c++){
+    const JArraysCpuSize* ar=(!c? Arrays1b: (c==1? Arrays2b: (c==2? Arrays4b: (c==3? Arrays8b: (c==4? Arrays12b: (c==5? Arrays16b: (c==6? Arrays24b: Arrays32b)))))));
+    s+=ar->GetArrayCount()*ar->GetElementSize();
+  }
+  return(s);
+}
+
+//==============================================================================
+/// Establece el numero de elementos a reservar en memoria virtual en las 
+/// siguientes asignaciones de memoria, para poder crecer sin copiar datos.
+/// Sets the number of elements to reserve in virtual memory in the next 
+/// allocations, so the arrays can grow without copying data.
+//==============================================================================
+void JArraysCpu::SetReserveSize(unsigned size){ 
+  Arrays1b->SetReserveSize(size); 
+  Arrays2b->SetReserveSize(size); 
+  Arrays4b->SetReserveSize(size); 
+  Arrays8b->SetReserveSize(size); 
+  Arrays12b->SetReserveSize(size);
+  Arrays16b->SetReserveSize(size);
+  Arrays24b->SetReserveSize(size);
+  Arrays32b->SetReserveSize(size);
+}
+
+//==============================================================================
+/// Establece el modo de huge pages para las siguientes asignaciones de memoria.
+/// Sets the mode of huge pages for the next allocations.
+//==============================================================================
+void JArraysCpu::SetHugePages(TpHugePages hpages){ 
+  Arrays1b->SetHugePages(hpages); 
+  Arrays2b->SetHugePages(hpages); 
+  Arrays4b->SetHugePages(hpages); 
+  Arrays8b->SetHugePages(hpages); 
+  Arrays12b->SetHugePages(hpages);
+  Arrays16b->SetHugePages(hpages);
+  Arrays24b->SetHugePages(hpages);
+  Arrays32b->SetHugePages(hpages);
+}
+
+//==============================================================================
+/// Asigna memoria alineada a 64 bytes (cache line). Con HPAGES_Transparent los
+/// arrays de mas de 2 MB se alinean a 2 MB y se solicitan huge pages 
+/// transparentes. Con HPAGES_Explicit se usan huge pages de 2 MB (MAP_HUGETLB)
+/// y si no hay disponibles se solicitan transparentes.
+/// Genera std::bad_alloc en caso de error.
+///
+/// Allocates memory aligned to 64 bytes (cache line). With HPAGES_Transparent
+/// arrays of more than 2 MB are aligned to 2 MB and transparent huge pages are
+/// requested. With HPAGES_Explicit huge pages of 2 MB (MAP_HUGETLB) are used 
+/// and transparent ones are requested when they are not available.
+/// Throws std::bad_alloc in case of error.
+//==============================================================================
+void* JArraysCpu::AllocLarge(size_t size,TpHugePages hpages){
+  if(!size)size=1;
+  void *pointer=NULL;
+#ifndef WIN32
+  if(hpages==HPAGES_Explicit){
+    const size_t size2=((size+HUGEPAGESIZE-1)/HUGEPAGESIZE)*HUGEPAGESIZE;
+  #ifdef MAP_HUGETLB
+    pointer=mmap(NULL,size2,PROT_READ|PROT_WRITE,MAP_PRIVATE|MAP_ANONYMOUS|MAP_HUGETLB,-1,0);
+    if(pointer!=MAP_FAILED)return(pointer);
+  #endif
+    pointer=mmap(NULL,size2,PROT_READ|PROT_WRITE,MAP_PRIVATE|MAP_ANONYMOUS,-1,0);
+    if(pointer==MAP_FAILED)throw std::bad_alloc();
+  #ifdef MADV_HUGEPAGE
+    madvise(pointer,size2,MADV_HUGEPAGE);
+  #endif
+    return(pointer);
+  }
+  const bool huge=(hpages==HPAGES_Transparent && size>=HUGEPAGESIZE);
+  if(posix_memalign(&pointer,(huge? HUGEPAGESIZE: ALIGNMENT),size))throw std::bad_alloc();
+  #ifdef MADV_HUGEPAGE
+    if(huge)madvise(pointer,(size/HUGEPAGESIZE)*HUGEPAGESIZE,MADV_HUGEPAGE);
+  #endif
+#else
+  pointer=_aligned_malloc(size,ALIGNMENT);
+  if(!pointer)throw std::bad_alloc();
+#endif
+  return(pointer);
+}
+
+//==============================================================================
+/// Devuelve los bytes de memoria virtual reservada para size bytes, 
+/// redondeados a 2 MB con huge pages explicitas.
+/// Returns bytes of reserved virtual memory for size bytes, rounded up to
+/// 2 MB with explicit huge pages.
+//==============================================================================
+size_t JArraysCpu::ReservedBytes(size_t size,TpHugePages hpages){
+  if(!size)size=1;
+  if(hpages==HPAGES_Explicit)size=((size+HUGEPAGESIZE-1)/HUGEPAGESIZE)*HUGEPAGESIZE;
+  return(size);
+}
+
+//==============================================================================
+/// Reserva memoria virtual de size bytes (mmap con MAP_NORESERVE) y la memoria
+/// fisica solo se usa cuando se escriben las paginas. Las huge pages explicitas
+/// se reservan para todo el tamanho y sino se usan las transparentes. En 
+/// Windows usa AllocLarge(). Genera std::bad_alloc en caso de error.
+///
+/// Reserves virtual memory of size bytes (mmap with MAP_NORESERVE) so physical
+/// memory is only used when the pages are written. Explicit huge pages are 
+/// reserved for the whole size, otherwise transparent ones are used. On Windows
+/// it uses AllocLarge(). Throws std::bad_alloc in case of error.
+//==============================================================================
+void* JArraysCpu::AllocReserved(size_t size,TpHugePages hpages){
+#ifndef WIN32
+  const size_t size2=ReservedBytes(size,hpages);
+  void *pointer=NULL;
+  #ifdef MAP_HUGETLB
+  if(hpages==HPAGES_Explicit){
+    pointer=mmap(NULL,size2,PROT_READ|PROT_WRITE,MAP_PRIVATE|MAP_ANONYMOUS|MAP_HUGETLB,-1,0);
+    if(pointer!=MAP_FAILED)return(pointer);
+  }
+  #endif
+  pointer=mmap(NULL,size2,PROT_READ|PROT_WRITE,MAP_PRIVATE|MAP_ANONYMOUS|MAP_NORESERVE,-1,0);
+  if(pointer==MAP_FAILED)throw std::bad_alloc();
+  #ifdef MADV_HUGEPAGE
+  if(hpages!=HPAGES_None)madvise(pointer,size2,MADV_HUGEPAGE);
+  #endif
+  return(pointer);
+#else
+  return(AllocLarge(size,hpages));
+#endif
+}
+
+//==============================================================================
+/// Libera memoria asignada con AllocReserved().
+/// Frees memory allocated with AllocReserved().
+//==============================================================================
+void JArraysCpu::FreeReserved(void *pointer,size_t size,TpHugePages hpages){
+  if(!pointer)return;
+#ifndef WIN32
+  munmap(pointer,ReservedBytes(size,hpages));
+#else
+  FreeLarge(pointer,size,hpages);
+#endif
+}
+
+//==============================================================================
+/// Libera memoria asignada con AllocLarge().
+/// Frees memory allocated with AllocLarge().
+//==============================================================================
+void JArraysCpu::FreeLarge(void *pointer,size_t size,TpHugePages hpages){
+  if(!pointer)return;
+#ifndef WIN32
+  if(hpages==HPAGES_Explicit){
+    if(!size)size=1;
+    munmap(pointer,((size+HUGEPAGESIZE-1)/HUGEPAGESIZE)*HUGEPAGESIZE);
+  }
+  else free(pointer);
+#else
+  _aligned_free(pointer);
+#endif
+}
+
+//==============================================================================
+/// Devuelve la memoria del proceso en huge pages transparentes (AnonHugePages)
+/// y explicitas (HugetlbPages). Devuelve -1 cuando no esta disponible.
+/// Returns memory of the process in transparent (AnonHugePages) and explicit
+/// (HugetlbPages) huge pages. Returns -1 when it is not available.
+//==============================================================================
+void JArraysCpu::GetHugePagesUsage(llong &transparent,llong &hugetlb){
+  transparent=hugetlb=-1;
+#ifndef WIN32
+  char line[256];
+  FILE *pf=fopen("/proc/self/smaps_rollup","r");
+  if(pf){
+    while(fgets(line,sizeof(line),pf)){
+      if(!strncmp(line,"AnonHugePages:",14))transparent=atoll(line+14)*1024;
+    }
+    fclose(pf);
+  }
+  pf=fopen("/proc/self/status","r");
+  if(pf){
+    while(fgets(line,sizeof(line),pf)){
+      if(!strncmp(line,"HugetlbPages:",13))hugetlb=atoll(line+13)*1024;
+    }
+    fclose(pf);
+  }
+#endif
+}
+
+//==============================================================================
+/// Indica si el numero de elementos puede cambiarse sin reasignar memoria.
+/// Returns true when the number of elements can be changed without reallocation.
+//==============================================================================
+bool JArraysCpu::CheckResizeInPlace(unsigned size)const{ 
+  return(Arrays1b->CheckResizeInPlace(size) && Arrays2b->CheckResizeInPlace(size)
+    && Arrays4b->CheckResizeInPlace(size) && Arrays8b->CheckResizeInPlace(size)
+    && Arrays12b->CheckResizeInPlace(size) && Arrays16b->CheckResizeInPlace(size)
+    && Arrays24b->CheckResizeInPlace(size) && Arrays32b->CheckResizeInPlace(size));
+}
+
 //==============================================================================
 /// Cambia el numero de elementos de los arrays.
-/// Si hay algun array en uso lanza una excepcion.
+/// Si hay algun array en uso lanza una excepcion, salvo que haya memoria 
+/// reservada suficiente para cambiar el size sin reasignar memoria.
 /// Changes the number of elements in the arrays.
-/// If there is any array in use raises an exception.
+/// If there is any array in use raises an exception, unless there is enough
+/// reserved memory to change the size without reallocation.
 //==============================================================================
 void JArraysCpu::SetArraySize(unsigned size){ 
+  //-Changes size keeping data when memory was reserved. | Cambia size conservando datos cuando hay memoria reservada.
+  if(size && CheckResizeInPlace(size)){
+    Arrays1b->SetArraySize(size); 
+    Arrays2b->SetArraySize(size); 
+    Arrays4b->SetArraySize(size); 
+    Arrays8b->SetArraySize(size); 
+    Arrays12b->SetArraySize(size);
+    Arrays16b->SetArraySize(size);
+    Arrays24b->SetArraySize(size);
+    Arrays32b->SetArraySize(size);
+    return;
+  }
   //-Frees memory.
   Arrays1b->SetArraySize(0); 
   Arrays2b->SetArraySize(0); 
@@ -21,6 +21,10 @@
 //:# =========
 //:# - Codigo creado a partir de JArraysGpu para usar con memoria CPU. (10-03-2014)
 //:# - Remplaza long long por llong. (01-10-2015)
+//:# - Reserva de memoria virtual para redimensionar arrays sin copiar datos. (18-10-2026)
+//:# - Memoria alineada a 64 bytes y uso opcional de huge pages. (18-10-2026)
+//:# - Funciones AllocReserved() y FreeReserved() para reservar memoria virtual
+//:#   fuera de JArraysCpu. (18-10-2026)
 //:#############################################################################
 
 /// \file JArraysCpu.h \brief Declares the class \ref JArraysCpu.
@@ -42,6 +46,11 @@ class JArraysCpuSize : protected JObject
 protected:
   const unsigned ElementSize;
   unsigned ArraySize;
+  unsigned ArrayCapacity;  ///<Number of elements available in each array (ArrayCapacity>=ArraySize).
+  unsigned ReserveSize;    ///<Number of elements to reserve in virtual memory for future growth (0:disabled).
+  bool MemReserved;        ///<Arrays were allocated as reserved virtual memory (mmap).
+  TpHugePages HugePages;   ///<Mode of huge pages for new allocations.
+  TpHugePages AllocHugePages; ///<Mode of huge pages used by current arrays.
 
   static const unsigned MAXPOINTERS=30;
   void* Pointers[MAXPOINTERS];
@@ -50,8 +59,9 @@ protected:
 
   unsigned CountMax,CountUsedMax;
   
-  void* AllocPointer(unsigned size)const;
-  void FreePointer(void* pointer)const;
+  void* AllocPointer(unsigned size);
+  void FreePointer(void* pointer);
+  size_t ReservedBytes(unsigned size)const;
 
   void FreeMemory();
   unsigned FindPointerUsed(void *pointer)const;
@@ -71,6 +81,11 @@ public:
   void SetArraySize(unsigned size);
   unsigned GetArraySize()const{ return(ArraySize); }
 
+  void SetReserveSize(unsigned size){ ReserveSize=size; }
+  void SetHugePages(TpHugePages hpages){ HugePages=hpages; }
+  bool CheckResizeInPlace(unsigned size)const{ return(!Count || size<=ArrayCapacity); }
+
+  unsigned GetElementSize()const{ return(ElementSize); }
   llong GetAllocMemoryCpu()const{ return((llong)(Count)*ElementSize*ArraySize); };
 
   void* Reserve();
@@ -114,6 +129,20 @@ public:
   void SetArraySize(unsigned size);
   unsigned GetArraySize()const{ return(Arrays1b->GetArraySize()); }
 
+  unsigned GetBytesPerElement()const;
+  void SetReserveSize(unsigned size);
+  bool CheckResizeInPlace(unsigned size)const;
+  void SetHugePages(TpHugePages hpages);
+
+  static const size_t ALIGNMENT=64;               ///<Alignment of large arrays (cache line).
+  static const size_t HUGEPAGESIZE=2*1024*1024;   ///<Size of huge pages.
+  static void* AllocLarge(size_t size,TpHugePages hpages);
+  static void FreeLarge(void *pointer,size_t size,TpHugePages hpages);
+  static size_t ReservedBytes(size_t size,TpHugePages hpages);
+  static void* AllocReserved(size_t size,TpHugePages hpages);
+  static void FreeReserved(void *pointer,size_t size,TpHugePages hpages);
+  static void GetHugePagesUsage(llong &transparent,llong &hugetlb);
+
   byte*        ReserveByte(){       return((byte*)Arrays1b->Reserve());         }
   word*        ReserveWord(){       return((word*)Arrays2b->Reserve());         }
   unsigned*    ReserveUint(){       return((unsigned*)Arrays4b->Reserve());     }
@@ -130,6 +159,11 @@ public:
 #else
   typecode*    ReserveTypeCode(){   return(ReserveWord());                      }
 #endif
+#ifdef IDP_SIZE8
+  typeidp*     ReserveTypeIdp(){    return((typeidp*)Arrays8b->Reserve());      }
+#else
+  typeidp*     ReserveTypeIdp(){    return(ReserveUint());                      }
+#endif
 
   void Free(byte        *pointer){ Arrays1b->Free(pointer);  }
   void Free(word        *pointer){ Arrays2b->Free(pointer);  }
@@ -139,6 +173,7 @@ public:
   void Free(tfloat3     *pointer){ Arrays12b->Free(pointer); }
   void Free(tfloat4     *pointer){ Arrays16b->Free(pointer); }
   void Free(double      *pointer){ Arrays8b->Free(pointer);  }
+  void Free(ullong      *pointer){ Arrays8b->Free(pointer);  }
   void Free(tdouble2    *pointer){ Arrays16b->Free(pointer); }
   void Free(tdouble3    *pointer){ Arrays24b->Free(pointer); }
   void Free(tsymatrix3f *pointer){ Arrays24b->Free(pointer); }
@@ -19,6 +19,7 @@
 /// \file JBinaryData.cpp \brief Implements the class \ref JBinaryData.
 
 #include "JBinaryData.h"
+#include "JDataCompress.h"
 #include "Functions.h"
 
 #include <fstream>
@@ -28,12 +29,20 @@
 #include <iostream>
 #include <sstream>
 #include <algorithm>
+#include <climits>
+#ifndef WIN32
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <fcntl.h>
+  #include <unistd.h>
+#endif
 
 using namespace std;
 
 const std::string JBinaryData::CodeItemDef="\nITEM\n";
 const std::string JBinaryData::CodeValuesDef="\nVALUES";
 const std::string JBinaryData::CodeArrayDef="\nARRAY";
+const std::string JBinaryData::CodeArrayCompDef="\nARRAYZ";
 
 //##############################################################################
 //# JBinaryDataDef
@@ -123,6 +132,63 @@ bool JBinaryDataDef::TypeIsTriple(TpData type){
   return(ret);
 }
 
+//==============================================================================
+/// Devuelve tamanho de cada valor escalar del tipo de datos.
+/// Returns size of each scalar value of the data type.
+//==============================================================================
+size_t JBinaryDataDef::ScalarSizeOfType(TpData type){
+  return(TypeIsTriple(type)? SizeOfType(type)/3: SizeOfType(type));
+}
+
+//==============================================================================
+/// Devuelve tipo de compresion en texto.
+/// Returns compression type text.
+//==============================================================================
+std::string JBinaryDataDef::CompToStr(TpComp comp){
+  string tx="";
+  switch(comp){
+    case JBinaryDataDef::CompNone:     tx="none";     break;
+    case JBinaryDataDef::CompLz:       tx="lz";       break;
+    case JBinaryDataDef::CompShuffle:  tx="shuffle";  break;
+    case JBinaryDataDef::CompDelta:    tx="delta";    break;
+  }
+  return(tx);
+}
+
+//==============================================================================
+/// Devuelve la compresion recomendada para el tipo de datos. Los enteros usan
+/// delta (ids ordenados), los reales y triples reordenacion de bytes.
+/// Returns the recommended compression for the data type. Integers use delta
+/// (sorted ids) and reals and triples use byte shuffle.
+//==============================================================================
+JBinaryDataDef::TpComp JBinaryDataDef::CompByType(TpData type){
+  TpComp ret=CompNone;
+  switch(type){
+    case JBinaryDataDef::DatChar:
+    case JBinaryDataDef::DatUchar:
+      ret=CompLz;
+    break;
+    case JBinaryDataDef::DatShort:
+    case JBinaryDataDef::DatUshort:
+    case JBinaryDataDef::DatInt:
+    case JBinaryDataDef::DatUint:
+    case JBinaryDataDef::DatLlong:
+    case JBinaryDataDef::DatUllong:
+      ret=CompDelta;
+    break;
+    case JBinaryDataDef::DatBool:
+    case JBinaryDataDef::DatFloat:
+    case JBinaryDataDef::DatDouble:
+    case JBinaryDataDef::DatInt3:
+    case JBinaryDataDef::DatUint3:
+    case JBinaryDataDef::DatFloat3:
+    case JBinaryDataDef::DatDouble3:
+      ret=CompShuffle;
+    break;
+  }
+  return(ret);
+}
+
 //##############################################################################
 //# JBinaryDataArray
 //##############################################################################
@@ -137,6 +203,8 @@ JBinaryDataArray::JBinaryDataArray(JBinaryData* parent,const std::string &name,J
   Pointer=NULL;
   ExternalPointer=false;
   Count=Size=0;
+  Comp=JBinaryDataDef::CompNone;
+  CompData=NULL; CompSize=0;
   ClearFileData();
 }
 
@@ -285,6 +353,7 @@ std::string JBinaryDataArray::OutStr(unsigned &count,unsigned size,const byte *p
 /// Frees allocated memory.
 //==============================================================================
 void JBinaryDataArray::FreeMemory(){
+  FreeCompData();
   if(Pointer&&!ExternalPointer)FreePointer(Pointer);
   Pointer=NULL;
   ExternalPointer=false;
@@ -335,9 +404,9 @@ void JBinaryDataArray::ConfigExternalMemory(unsigned size,void* pointer){
 /// Configura acceso a datos en fichero.
 /// Set file data access.
 //==============================================================================
-void JBinaryDataArray::ConfigFileData(llong filepos,unsigned datacount,unsigned datasize){
+void JBinaryDataArray::ConfigFileData(llong filepos,unsigned datacount,unsigned datasize,JBinaryDataDef::TpComp comp){
   FreeMemory();
-  FileDataPos=filepos; FileDataCount=datacount; FileDataSize=datasize;
+  FileDataPos=filepos; FileDataCount=datacount; FileDataSize=datasize; FileDataComp=comp;
 }
 
 //==============================================================================
@@ -346,6 +415,7 @@ void JBinaryDataArray::ConfigFileData(llong filepos,unsigned datacount,unsigned
 //==============================================================================
 void JBinaryDataArray::ClearFileData(){
   FileDataPos=-1; FileDataCount=FileDataSize=0;
+  FileDataComp=JBinaryDataDef::CompNone;
 }
 
 //==============================================================================
@@ -361,8 +431,113 @@ void JBinaryDataArray::ReadFileData(bool resize){
   if(!pf||!pf->is_open())RunException(met,"The file with data is not available.");
   //printf("ReadFileData[%s]> fpos:%llu count:%u size:%u\n",Name.c_str(),FileDataPos,FileDataCount,FileDataSize);
   if(FileDataPos<0)RunException(met,"The access information to data file is not available.");
+  const byte *fmap=(Type!=JBinaryDataDef::DatText? Parent->GetItemRoot()->GetFileMap(FileDataPos,FileDataSize): NULL);
+  if(fmap){//-Reads from file mapped in memory.
+    if(FileDataComp!=JBinaryDataDef::CompNone)DecompData(FileDataCount,fmap,FileDataSize,FileDataComp,resize);
+    else AddData(FileDataCount,fmap,resize);
+    return;
+  }
   pf->seekg(FileDataPos,ios::beg);
-  ReadData(FileDataCount,FileDataSize,pf,resize);
+  ReadData(FileDataCount,FileDataSize,pf,resize,FileDataComp);
+}
+
+//==============================================================================
+/// Devuelve puntero a los datos del array en el fichero proyectado en memoria
+/// con OpenFileStructure(). Devuelve NULL cuando el fichero no esta proyectado
+/// o los datos estan comprimidos. Las paginas se cargan al acceder a ellas y 
+/// el puntero es valido hasta cerrar el fichero. Puede no estar alineado.
+/// Returns pointer to data of the array in the file mapped in memory with
+/// OpenFileStructure(). Returns NULL when the file is not mapped or the data
+/// is compressed. The pages are loaded when accessed and the pointer is valid
+/// until the file is closed. It may be unaligned.
+//==============================================================================
+const void* JBinaryDataArray::GetFileDataPointer()const{
+  if(!DataInFile() || FileDataComp!=JBinaryDataDef::CompNone || Type==JBinaryDataDef::DatText || !FileDataCount)return(NULL);
+  return(Parent->GetItemRoot()->GetFileMap(FileDataPos,FileDataSize));
+}
+
+//==============================================================================
+/// Libera las paginas cargadas de los elementos indicados del array en el 
+/// fichero proyectado en memoria. Se cargan de nuevo si se vuelve a acceder.
+/// Releases the loaded pages of the given elements of the array in the file 
+/// mapped in memory. They are loaded again when they are accessed again.
+//==============================================================================
+void JBinaryDataArray::ReleaseFileDataPointer(unsigned pini,unsigned count)const{
+  if(DataInFile() && FileDataComp==JBinaryDataDef::CompNone && Type!=JBinaryDataDef::DatText && pini<FileDataCount){
+    const llong stype=llong(JBinaryDataDef::SizeOfType(Type));
+    const unsigned n=min(count,FileDataCount-pini);
+    Parent->GetItemRoot()->ReleaseFileMap(FileDataPos+stype*pini,stype*n);
+  }
+}
+
+//==============================================================================
+/// Configura la compresion usada al grabar el array. Los arrays de texto no se
+/// comprimen y delta solo se aplica a enteros.
+/// Sets the compression used to save the array. Arrays of text are not 
+/// compressed and delta is only applied to integers.
+//==============================================================================
+void JBinaryDataArray::SetComp(JBinaryDataDef::TpComp comp){
+  FreeCompData();
+  if(Type==JBinaryDataDef::DatText)comp=JBinaryDataDef::CompNone;
+  if(comp==JBinaryDataDef::CompDelta && JBinaryDataDef::CompByType(Type)!=JBinaryDataDef::CompDelta)comp=JBinaryDataDef::CompShuffle;
+  Comp=comp;
+}
+
+//==============================================================================
+/// Comprime los datos del array en CompData (si no estaba ya preparado) y 
+/// devuelve su tamanho.
+/// Compresses array data in CompData (when it was not already prepared) and
+/// returns its size.
+//==============================================================================
+unsigned JBinaryDataArray::PrepareCompData()const{
+  const char met[]="PrepareCompData";
+  if(!CompData && CompActive()){
+    if(!Pointer)RunException(met,"Pointer of array with data is invalid.");
+    const ullong rawsize=ullong(JBinaryDataDef::SizeOfType(Type))*Count;
+    if(rawsize>UINT_MAX)RunException(met,fun::PrintStr("The size of array '%s' (%llu bytes) exceeds the maximum size of an array (4 GB).",Name.c_str(),rawsize));
+    const unsigned ssize=unsigned(JBinaryDataDef::ScalarSizeOfType(Type));
+    byte *data=NULL;
+    const size_t size=JDataCompress::Compress((const byte*)Pointer,size_t(rawsize),ssize,Comp>=JBinaryDataDef::CompShuffle,Comp==JBinaryDataDef::CompDelta,data);
+    if(!data)RunException(met,fun::PrintStr("Could not allocate memory to compress array '%s'.",Name.c_str()));
+    if(size>UINT_MAX){
+      delete[] data;
+      RunException(met,fun::PrintStr("The compressed size of array '%s' exceeds the maximum size of an array (4 GB).",Name.c_str()));
+    }
+    CompData=data; CompSize=unsigned(size);
+  }
+  return(CompSize);
+}
+
+//==============================================================================
+/// Libera cache de datos comprimidos.
+/// Frees cache of compressed data.
+//==============================================================================
+void JBinaryDataArray::FreeCompData()const{
+  delete[] CompData; CompData=NULL;
+  CompSize=0;
+}
+
+//==============================================================================
+/// Descomprime y anhade elementos al array.
+/// Si es ExternalPointer no permite redimensionar la memoria asignada.
+/// Decompresses and adds elements to the array.
+/// If ExternalPointer will not allow to resize the allocated memory.
+//==============================================================================
+void JBinaryDataArray::DecompData(unsigned count,const byte *data,unsigned size,JBinaryDataDef::TpComp comp,bool resize){
+  const char met[]="DecompData";
+  if(Type==JBinaryDataDef::DatText)RunException(met,"Arrays of text can not be compressed.");
+  if(count){
+    //-Reserva memoria si fuese necesario.
+    //-Allocates memory if necessary.
+    CheckMemory(count,resize);
+    FreeCompData();
+    const size_t stype=JBinaryDataDef::SizeOfType(Type);
+    const unsigned ssize=unsigned(JBinaryDataDef::ScalarSizeOfType(Type));
+    byte *ptr=((byte*)Pointer)+stype*Count;
+    if(!JDataCompress::Decompress(data,size,ptr,stype*count,ssize,comp>=JBinaryDataDef::CompShuffle,comp==JBinaryDataDef::CompDelta))
+      RunException(met,fun::PrintStr("The compressed data of array '%s' is invalid.",Name.c_str()));
+    Count+=count;
+  }
 }
 
 //==============================================================================
@@ -371,8 +546,15 @@ void JBinaryDataArray::ReadFileData(bool resize){
 /// Add elements to the array of a file. 
 /// If ExternalPointer will not allow to resize the allocated memory.
 //==============================================================================
-void JBinaryDataArray::ReadData(unsigned count,unsigned size,std::ifstream *pf,bool resize){
-  if(count){
+void JBinaryDataArray::ReadData(unsigned count,unsigned size,std::ifstream *pf,bool resize,JBinaryDataDef::TpComp comp){
+  if(count && comp!=JBinaryDataDef::CompNone){//-Compressed data.
+    byte *buf=new byte[size];
+    pf->read((char*)buf,size);
+    DecompData(count,buf,size,comp,resize);
+    delete[] buf;
+  }
+  else if(count){
+    FreeCompData();
     //-Reserva memoria si fuese necesario.
     CheckMemory(count,resize);
     //-Carga datos de fichero.
@@ -384,9 +566,9 @@ void JBinaryDataArray::ReadData(unsigned count,unsigned size,std::ifstream *pf,b
       delete[] buf;
     }
     else{
-      const unsigned stype=(unsigned)JBinaryDataDef::SizeOfType(Type);
-      const unsigned sdat=stype*count;
-      const unsigned cdat=stype*Count;
+      const size_t stype=JBinaryDataDef::SizeOfType(Type);
+      const size_t sdat=stype*count;
+      const size_t cdat=stype*Count;
       pf->read(((char*)Pointer)+cdat,sdat);
       Count+=count;
     }
@@ -401,6 +583,7 @@ void JBinaryDataArray::ReadData(unsigned count,unsigned size,std::ifstream *pf,b
 //==============================================================================
 void JBinaryDataArray::AddData(unsigned count,const void* data,bool resize){
   if(count){
+    FreeCompData();
     //-Reserva memoria si fuese necesario.
     //-Allocates memory if necessary.
     CheckMemory(count,resize);
@@ -412,9 +595,9 @@ void JBinaryDataArray::AddData(unsigned count,const void* data,bool resize){
       for(unsigned c=0;c<count;c++)strings[Count+c]=strings2[c];
     }
     else{
-      const unsigned stype=(unsigned)JBinaryDataDef::SizeOfType(Type);
-      const unsigned sdat=stype*count;
-      const unsigned cdat=stype*Count;
+      const size_t stype=JBinaryDataDef::SizeOfType(Type);
+      const size_t sdat=stype*count;
+      const size_t cdat=stype*Count;
       memcpy(((byte*)Pointer)+cdat,(byte*)data,sdat);
     }
     Count+=count;
@@ -496,11 +679,24 @@ unsigned JBinaryDataArray::GetDataCopy(unsigned size,void* pointer)const{
   else{
     count=FileDataCount;
     if(size>=count){
+      const byte *fmap=Parent->GetItemRoot()->GetFileMap(FileDataPos,FileDataSize);
       ifstream *pf=Parent->GetItemRoot()->GetFileStructure();
-      if(!pf||!pf->is_open())RunException(met,"The file with data is not available.");
-      pf->seekg(FileDataPos,ios::beg);
+      if(!fmap && (!pf||!pf->is_open()))RunException(met,"The file with data is not available.");
+      if(!fmap)pf->seekg(FileDataPos,ios::beg);
       count=FileDataCount;
-      pf->read((char*)pointer,stype*count);
+      if(FileDataComp!=JBinaryDataDef::CompNone){//-Compressed data.
+        byte *buf=NULL;
+        if(!fmap){
+          buf=new byte[FileDataSize];
+          pf->read((char*)buf,FileDataSize);
+        }
+        const unsigned ssize=unsigned(JBinaryDataDef::ScalarSizeOfType(GetType()));
+        const bool ok=JDataCompress::Decompress((fmap? fmap: buf),FileDataSize,(byte*)pointer,stype*count,ssize,FileDataComp>=JBinaryDataDef::CompShuffle,FileDataComp==JBinaryDataDef::CompDelta);
+        delete[] buf;
+        if(!ok)RunException(met,fun::PrintStr("The compressed data of array '%s' is invalid.",Name.c_str()));
+      }
+      else if(fmap)memcpy(pointer,fmap,stype*count);
+      else pf->read((char*)pointer,stype*count);
     }
   }
   if(size<count)RunException(met,"Size of array is not enough to store all data.");
@@ -518,6 +714,7 @@ JBinaryData::JBinaryData(std::string name):Name(name){
   ClassName="JBinaryData";
   Parent=NULL;
   FileStructure=NULL;
+  FileMap=NULL; FileMapSize=0;
   ValuesData=NULL;
   ValuesCacheReset();
   HideAll=HideValues=false;
@@ -533,6 +730,7 @@ JBinaryData::JBinaryData(const JBinaryData &src){
   ClassName="JBinaryData";
   Parent=NULL;
   FileStructure=NULL;
+  FileMap=NULL; FileMapSize=0;
   ValuesData=NULL;
   ValuesCacheReset();
   *this=src;
@@ -797,7 +995,8 @@ void JBinaryData::OutValue(unsigned &count,unsigned size,const byte *ptr){
 /// Put basic data Array in ptr.
 //==============================================================================
 void JBinaryData::InArrayBase(unsigned &count,unsigned size,byte *ptr,const JBinaryDataArray *ar)const{
-  InStr(count,size,ptr,CodeArrayDef);
+  const bool comp=ar->CompActive();
+  InStr(count,size,ptr,(comp? CodeArrayCompDef: CodeArrayDef));
   InStr(count,size,ptr,ar->GetName());
   InBool(count,size,ptr,ar->GetHide());
   InInt(count,size,ptr,int(ar->GetType()));
@@ -806,6 +1005,7 @@ void JBinaryData::InArrayBase(unsigned &count,unsigned size,byte *ptr,const JBin
   unsigned sizearraydata=0;
   InArrayData(sizearraydata,0,NULL,ar);
   InUint(count,size,ptr,sizearraydata);
+  if(comp)InUint(count,size,ptr,unsigned(ar->GetComp()));
 }
 //==============================================================================
 /// Introduce contendido de Array en ptr.
@@ -820,9 +1020,14 @@ void JBinaryData::InArrayData(unsigned &count,unsigned size,byte *ptr,const JBin
     const string *list=(string*)pointer;
     for(unsigned c=0;c<num;c++)InStr(count,size,ptr,list[c]);
   }
+  else if(ar->CompActive()){//-Array comprimido. Compressed array.
+    const unsigned sizecomp=ar->PrepareCompData();
+    InData(count,size,ptr,ar->GetCompData(),sizecomp);
+  }
   else{//-Array de tipos basicos.
-    unsigned sizetype=(unsigned)JBinaryDataDef::SizeOfType(ar->GetType());
-    InData(count,size,ptr,(byte*)pointer,sizetype*num);
+    const ullong sizedata=ullong(JBinaryDataDef::SizeOfType(ar->GetType()))*num;
+    if(sizedata>UINT_MAX)RunException("InArrayData",fun::PrintStr("The size of array '%s' (%llu bytes) exceeds the maximum size of an array (4 GB).",ar->GetName().c_str(),sizedata));
+    InData(count,size,ptr,(byte*)pointer,unsigned(sizedata));
   }
 }
 
@@ -884,15 +1089,22 @@ void JBinaryData::InItem(unsigned &count,unsigned size,byte *ptr,bool all)const{
 /// Extrae datos basicos del Array de ptr.
 /// Extract basic data from ptr Array 
 //==============================================================================
-JBinaryDataArray* JBinaryData::OutArrayBase(unsigned &count,unsigned size,const byte *ptr,unsigned &countdata,unsigned &sizedata){
+JBinaryDataArray* JBinaryData::OutArrayBase(unsigned &count,unsigned size,const byte *ptr,unsigned &countdata,unsigned &sizedata,JBinaryDataDef::TpComp &comp){
   const char met[]="OutArrayBase";
-  if(OutStr(count,size,ptr)!=CodeArrayDef)RunException(met,"Validation code is invalid.");
+  const string code=OutStr(count,size,ptr);
+  const bool compressed=(code==CodeArrayCompDef);
+  if(code!=CodeArrayDef && !compressed)RunException(met,"Validation code is invalid.");
   string name=OutStr(count,size,ptr);
   bool hide=OutBool(count,size,ptr);
   JBinaryDataDef::TpData type=(JBinaryDataDef::TpData)OutInt(count,size,ptr);
   countdata=OutUint(count,size,ptr);
   sizedata=OutUint(count,size,ptr);
-  if(type!=JBinaryDataDef::DatText&&sizedata!=JBinaryDataDef::SizeOfType(type)*countdata)RunException(met,"Size of data is invalid.");
+  comp=JBinaryDataDef::CompNone;
+  if(compressed){
+    comp=(JBinaryDataDef::TpComp)OutUint(count,size,ptr);
+    if(type==JBinaryDataDef::DatText || comp<JBinaryDataDef::CompLz || comp>JBinaryDataDef::CompDelta)RunException(met,"Compression of data is invalid.");
+  }
+  else if(type!=JBinaryDataDef::DatText&&sizedata!=JBinaryDataDef::SizeOfType(type)*countdata)RunException(met,"Size of data is invalid.");
   //-Crea array.
   JBinaryDataArray *ar=CreateArray(name,type);
   ar->SetHide(hide);
@@ -903,7 +1115,7 @@ JBinaryDataArray* JBinaryData::OutArrayBase(unsigned &count,unsigned size,const
 /// Extrae contenido de Array de ptr.
 /// Extract the contents of the ptr Array
 //==============================================================================
-void JBinaryData::OutArrayData(unsigned &count,unsigned size,const byte *ptr,JBinaryDataArray *ar,unsigned countdata,unsigned sizedata){
+void JBinaryData::OutArrayData(unsigned &count,unsigned size,const byte *ptr,JBinaryDataArray *ar,unsigned countdata,unsigned sizedata,JBinaryDataDef::TpComp comp){
   if(ar->GetType()==JBinaryDataDef::DatText){//-Array de strings.
     ar->AllocMemory(countdata);
     for(unsigned c=0;c<countdata;c++)ar->AddText(OutStr(count,size,ptr),false);
@@ -915,7 +1127,9 @@ void JBinaryData::OutArrayData(unsigned &count,unsigned size,const byte *ptr,JBi
     if(count2>size)RunException("OutArrayData","Overflow in reading data.");
     //-Extrae datos para el array.
     //-Extracts the data for the array.
-    ar->AddData(countdata,ptr+count,true);
+    if(comp!=JBinaryDataDef::CompNone)ar->DecompData(countdata,ptr+count,sizedata,comp,true);
+    else ar->AddData(countdata,ptr+count,true);
+    ar->SetComp(comp);
     count=count2;
   }
 }
@@ -929,10 +1143,11 @@ void JBinaryData::OutArray(unsigned &count,unsigned size,const byte *ptr){
   //-Creates and configures array from ptr 
   const unsigned sizearraydef=OutUint(count,size,ptr);
   unsigned countdata,sizedata;
-  JBinaryDataArray *ar=OutArrayBase(count,size,ptr,countdata,sizedata);
+  JBinaryDataDef::TpComp comp;
+  JBinaryDataArray *ar=OutArrayBase(count,size,ptr,countdata,sizedata,comp);
   //-Extrae contenido del array.
   //-Extract contents of the array.
-  OutArrayData(count,size,ptr,ar,countdata,sizedata);
+  OutArrayData(count,size,ptr,ar,countdata,sizedata,comp);
 }
 
 //==============================================================================
@@ -1021,8 +1236,13 @@ void JBinaryData::WriteArrayData(std::fstream *pf,const JBinaryDataArray *ar)con
     pf->write((char*)buf,cbuf);
     delete[] buf;
   }
+  else if(ar->CompActive()){//-Array comprimido. Compressed array.
+    const unsigned sizecomp=ar->PrepareCompData();
+    pf->write((char*)ar->GetCompData(),sizecomp);
+    ar->FreeCompData();
+  }
   else{//-Array de tipos basicos. Array of basic types.
-    unsigned sizetype=(unsigned)JBinaryDataDef::SizeOfType(ar->GetType());
+    const size_t sizetype=JBinaryDataDef::SizeOfType(ar->GetType());
     pf->write((char*)pointer,sizetype*countdata);
   }
 }
@@ -1087,13 +1307,14 @@ unsigned JBinaryData::ReadUint(std::ifstream *pf)const{
 /// Carga datos de array de fichero.
 /// Loads data to array from the file.
 //==============================================================================
-void JBinaryData::ReadArrayData(std::ifstream *pf,JBinaryDataArray *ar,unsigned countdata,unsigned sizedata,bool loadarraysdata){
+void JBinaryData::ReadArrayData(std::ifstream *pf,JBinaryDataArray *ar,unsigned countdata,unsigned sizedata,JBinaryDataDef::TpComp comp,bool loadarraysdata){
   const JBinaryDataDef::TpData type=ar->GetType();
-  if(loadarraysdata)ar->ReadData(countdata,sizedata,pf,true);
+  if(loadarraysdata)ar->ReadData(countdata,sizedata,pf,true,comp);
   else{
-    ar->ConfigFileData((llong)pf->tellg(),countdata,sizedata);  
+    ar->ConfigFileData((llong)pf->tellg(),countdata,sizedata,comp);  
     pf->seekg(sizedata,ios::cur);
   }
+  ar->SetComp(comp);
 }
 
 //==============================================================================
@@ -1106,11 +1327,12 @@ void JBinaryData::ReadArray(std::ifstream *pf,unsigned sbuf,byte *buf,bool loada
   const unsigned sizearraydef=ReadUint(pf);
   pf->read((char*)buf,sizearraydef);
   unsigned countdata,sizedata;
+  JBinaryDataDef::TpComp comp;
   unsigned cbuf=0;
-  JBinaryDataArray *ar=OutArrayBase(cbuf,sizearraydef,buf,countdata,sizedata);
+  JBinaryDataArray *ar=OutArrayBase(cbuf,sizearraydef,buf,countdata,sizedata,comp);
   //-Extrae contenido del array.
   //-Extract contents of the array.
-  ReadArrayData(pf,ar,countdata,sizedata,loadarraysdata);
+  ReadArrayData(pf,ar,countdata,sizedata,comp,loadarraysdata);
 }
 
 //==============================================================================
@@ -1167,15 +1389,15 @@ JBinaryData::StHeadFmtBin JBinaryData::MakeFileHead(const std::string &filecode)
 /// Returns file size and its header.
 /// If the file does not contain a header returns 0.
 //==============================================================================
-unsigned JBinaryData::GetFileHead(std::ifstream *pf,JBinaryData::StHeadFmtBin &head)const{
+llong JBinaryData::GetFileHead(std::ifstream *pf,JBinaryData::StHeadFmtBin &head)const{
   //-Obtiene size del fichero.
   //-Gets file size.
   pf->seekg(0,ios::end);
-  const unsigned fsize=(unsigned)pf->tellg();
+  const llong fsize=(llong)pf->tellg();
   pf->seekg(0,ios::beg);
   //-Lee cabecera basica.
   //-Reads basic header.
-  if(fsize>=sizeof(StHeadFmtBin))pf->read((char*)&head,sizeof(StHeadFmtBin));
+  if(fsize>=llong(sizeof(StHeadFmtBin)))pf->read((char*)&head,sizeof(StHeadFmtBin));
   else memset(&head,0,sizeof(StHeadFmtBin));
   return(fsize);
 }
@@ -1218,11 +1440,11 @@ void JBinaryData::CheckHead(const std::string &file,const StHeadFmtBin &head,con
 /// If the file is empty, it generates exception.
 /// Returns file size.
 //==============================================================================
-unsigned JBinaryData::CheckFileHead(const std::string &file,std::ifstream *pf,const std::string &filecode)const{
+llong JBinaryData::CheckFileHead(const std::string &file,std::ifstream *pf,const std::string &filecode)const{
   JBinaryData::StHeadFmtBin head;
   //-Obtiene size y cabecera del fichero.
   //-Get size and file header.
-  const unsigned fsize=GetFileHead(pf,head);
+  const llong fsize=GetFileHead(pf,head);
   //-Comprueba validez de cabecera.
   //-Check for valid header.
   CheckHead(file,head,filecode);
@@ -1237,17 +1459,17 @@ unsigned JBinaryData::CheckFileHead(const std::string &file,std::ifstream *pf,co
 /// If the file is empty generates no exception.
 /// Returns file size.
 //==============================================================================
-unsigned JBinaryData::CheckFileListHead(const std::string &file,std::fstream *pf,const std::string &filecode)const{
+llong JBinaryData::CheckFileListHead(const std::string &file,std::fstream *pf,const std::string &filecode)const{
   const char met[]="CheckFileHead";
   //-Obtiene size del fichero.
   //-Gets file size.
   pf->seekg(0,ios::end);
-  const unsigned fsize=(unsigned)pf->tellg();   //printf("CheckFileHead> FileSize:%u\n",fsize);
+  const llong fsize=(llong)pf->tellg();   //printf("CheckFileHead> FileSize:%lld\n",fsize);
   pf->seekg(0,ios::beg);
   //-Lee cabecera basica y comprueba validez.
   //-Reads basic header and checks validity.
   StHeadFmtBin head;
-  if(fsize>=sizeof(StHeadFmtBin)){
+  if(fsize>=llong(sizeof(StHeadFmtBin))){
     pf->read((char*)&head,sizeof(StHeadFmtBin));
     //-Check for valid header.
     CheckHead(file,head,filecode);
@@ -1388,6 +1610,7 @@ void JBinaryData::SetFmtDouble(const std::string &fmt,bool down){
 /// With bool "all" true the hidden elements are also included. 
 //==============================================================================
 unsigned JBinaryData::GetSizeDataConst(bool all)const{
+  FreeCompData();
   unsigned count=0;
   InItem(count,0,NULL,all);
   return(count);
@@ -1403,6 +1626,7 @@ unsigned JBinaryData::SaveDataConst(unsigned size,byte* ptr,bool all)const{
   if(!ptr)RunException("SaveDataConst","The pointer is invalid.");
   unsigned count=0;
   InItem(count,size,ptr,all);
+  FreeCompData();
   return(count);
 }
 
@@ -1417,6 +1641,7 @@ unsigned JBinaryData::SaveDataConst(unsigned size,byte* ptr,bool all)const{
 //==============================================================================
 unsigned JBinaryData::GetSizeData(bool all){
   ValuesCachePrepare(true);
+  FreeCompData();
   unsigned count=0;
   InItem(count,0,NULL,all);
   return(count);
@@ -1436,6 +1661,7 @@ unsigned JBinaryData::SaveData(unsigned size,byte* ptr,bool all){
   ValuesCachePrepare(true);
   unsigned count=0;
   InItem(count,size,ptr,all);
+  FreeCompData();
   return(count);
 }
 
@@ -1479,10 +1705,20 @@ void JBinaryData::SaveFileData(std::fstream *pf,bool head,const std::string &fil
   else{//-Graba datos directamente. Save data directly.
     const unsigned sbuf=1024;
     byte buf[sbuf];
+    FreeCompData();
     WriteItem(pf,sbuf,buf,all);
   }
 }
 
+//==============================================================================
+/// Libera la cache de datos comprimidos de arrays del item y descendientes.
+/// Frees the cache of compressed data of arrays of the item and descendants.
+//==============================================================================
+void JBinaryData::FreeCompData()const{
+  for(unsigned c=0;c<Arrays.size();c++)Arrays[c]->FreeCompData();
+  for(unsigned c=0;c<Items.size();c++)Items[c]->FreeCompData();
+}
+
 //==============================================================================
 /// Graba datos en fichero.
 /// Con memory utiliza un buffer para todos los datos. Consume mas memoria pero
@@ -1520,10 +1756,11 @@ void JBinaryData::LoadFile(const std::string &file,const std::string &filecode,b
   ifstream pf;
   pf.open(file.c_str(),ios::binary|ios::in);
   if(pf){
-    const unsigned fsize=CheckFileHead(file,&pf,filecode);
+    const llong fsize=CheckFileHead(file,&pf,filecode);
     //-Carga datos.
+    if(memory && fsize-llong(sizeof(StHeadFmtBin))>UINT_MAX)memory=false; //-Files of more than 4 GB are loaded directly.
     if(memory){//-Carga datos desde memoria. Write data from memory.
-      const unsigned sbuf=fsize-sizeof(StHeadFmtBin);
+      const unsigned sbuf=unsigned(fsize-sizeof(StHeadFmtBin));
       //printf("LoadFile> sbuf:%u\n",sbuf);
       byte *buf=new byte[sbuf];
       pf.read((char*)buf,sbuf);
@@ -1558,7 +1795,7 @@ void JBinaryData::SaveFileListApp(const std::string &file,const std::string &fil
   if(fun::FileExists(file))pf.open(file.c_str(),ios::binary|ios::out|ios::in|ios::app);
   else pf.open(file.c_str(),ios::binary|ios::out);
   if(pf){
-    const unsigned fsize=CheckFileListHead(file,&pf,filecode);
+    const llong fsize=CheckFileListHead(file,&pf,filecode);
     pf.seekp(0,pf.end);
     //-Graba datos de parent. Save parent data.
     if(!fsize)Parent->SaveFileData(&pf,true,filecode,memory,all);
@@ -1585,12 +1822,13 @@ void JBinaryData::LoadFileListApp(const std::string &file,const std::string &fil
   pf.open(file.c_str(),ios::binary|ios::in);
   if(pf){
     SetName(filecode);
-    const unsigned fsize=CheckFileHead(file,&pf,filecode);
-    unsigned pfile=(unsigned)pf.tellg();
+    const llong fsize=CheckFileHead(file,&pf,filecode);
+    if(memory && fsize-llong(sizeof(StHeadFmtBin))>UINT_MAX)memory=false; //-Files of more than 4 GB are loaded directly.
+    llong pfile=(llong)pf.tellg();
     while(pfile<fsize){
       //-Carga datos.
       if(memory){//-Carga datos desde memoria. Loads data from memory.
-        const unsigned sbuf=fsize-sizeof(StHeadFmtBin);
+        const unsigned sbuf=unsigned(fsize-sizeof(StHeadFmtBin));
         //printf("LoadFile> sbuf:%u\n",sbuf);
         byte *buf=new byte[sbuf];
         pf.read((char*)buf,sbuf);
@@ -1613,7 +1851,7 @@ void JBinaryData::LoadFileListApp(const std::string &file,const std::string &fil
         JBinaryData* ite=GetItem(lastitem);
         ite->SetName(fun::PrintStr("LS%04u_",lastitem)+ite->GetName());
       }
-      pfile=(unsigned)pf.tellg();
+      pfile=(llong)pf.tellg();
     }
     pf.close();
   }
@@ -1622,21 +1860,35 @@ void JBinaryData::LoadFileListApp(const std::string &file,const std::string &fil
 
 //==============================================================================
 /// Abre fichero y carga estructura de datos pero sin cargar el contenido de los
-/// arrays.
+/// arrays. Con map el fichero se proyecta en memoria (solo lectura) y los 
+/// arrays se leen de la proyeccion, de modo que solo se cargan las paginas 
+/// usadas. Si la proyeccion no es posible se usa la lectura normal.
 /// Open file and load data structure but without loading the contents of the
-/// arrays.
+/// arrays. With map the file is mapped in memory (read only) and arrays are 
+/// read from the mapping, so only the used pages are loaded. When mapping is 
+/// not possible the normal reading is used.
 //==============================================================================
-void JBinaryData::OpenFileStructure(const std::string &file,const std::string &filecode){
+void JBinaryData::OpenFileStructure(const std::string &file,const std::string &filecode,bool map){
   const char met[]="OpenFileStructure";
   if(Parent)RunException(met,"Item is not root.");
   Clear(); //-Limpia contenido de objeto. Clean object content.
   FileStructure=new ifstream;
   FileStructure->open(file.c_str(),ios::binary|ios::in);
   if(*FileStructure){
-    const unsigned fsize=CheckFileHead(file,FileStructure,filecode);
+    const llong fsize=CheckFileHead(file,FileStructure,filecode);
     const unsigned sbuf=1024;
     byte buf[sbuf];
     ReadItem(FileStructure,sbuf,buf,false,false);
+  #ifndef WIN32
+    if(map && fsize>0 && llong(size_t(fsize))==fsize){
+      const int fd=open(file.c_str(),O_RDONLY);
+      if(fd>=0){
+        void *ptr=mmap(NULL,size_t(fsize),PROT_READ,MAP_PRIVATE,fd,0);
+        close(fd);
+        if(ptr!=MAP_FAILED){ FileMap=(const byte*)ptr; FileMapSize=fsize; }
+      }
+    }
+  #endif
   }
   else{
     CloseFileStructure();
@@ -1651,6 +1903,39 @@ void JBinaryData::OpenFileStructure(const std::string &file,const std::string &f
 void JBinaryData::CloseFileStructure(){
   if(FileStructure&&FileStructure->is_open())FileStructure->close();
   delete FileStructure; FileStructure=NULL;
+#ifndef WIN32
+  if(FileMap)munmap((void*)FileMap,size_t(FileMapSize));
+#endif
+  FileMap=NULL; FileMapSize=0;
+}
+
+//==============================================================================
+/// Devuelve puntero a la posicion indicada del fichero proyectado en memoria
+/// con OpenFileStructure() o NULL cuando no esta disponible.
+/// Returns pointer to the given position of the file mapped in memory with
+/// OpenFileStructure() or NULL when it is not available.
+//==============================================================================
+const byte* JBinaryData::GetFileMap(llong pos,llong size)const{
+  if(Parent)RunException("GetFileMap","Item is not root.");
+  return(FileMap && pos>=0 && size>=0 && pos+size<=FileMapSize? FileMap+pos: NULL);
+}
+
+//==============================================================================
+/// Libera las paginas completas del rango indicado del fichero proyectado en
+/// memoria para reducir la memoria residente.
+/// Releases the complete pages of the given range of the file mapped in memory
+/// to reduce the resident memory.
+//==============================================================================
+void JBinaryData::ReleaseFileMap(llong pos,llong size)const{
+#ifndef WIN32
+  const byte *ptr=GetFileMap(pos,size);
+  if(ptr && size>0){
+    const size_t spage=size_t(sysconf(_SC_PAGESIZE));
+    const size_t pini=(size_t(ptr)+spage-1)/spage*spage;
+    const size_t pfin=(size_t(ptr)+size_t(size))/spage*spage;
+    if(pfin>pini)madvise((void*)pini,pfin-pini,MADV_DONTNEED);
+  }
+#endif
 }
 
 //==============================================================================
@@ -41,6 +41,14 @@
 //:# - Ahora el metodo SaveFileListApp() graba los datos del Parent al principio
 //:#   del fichero. (12-01-2014)
 //:# - Opcion en SaveFileXml() para grabar datos de arrays. (04-12-2014)
+//:# - Size de fichero y posiciones de lectura en 64 bits para permitir ficheros
+//:#   de mas de 4 GB. Comprueba que el size de cada array no supere 4 GB. (18-10-2026)
+//:# - Compresion opcional sin perdidas de arrays por bloques (JDataCompress). Los
+//:#   arrays comprimidos se graban con codigo ARRAYZ y el tipo de compresion. 
+//:#   Los ficheros sin comprimir mantienen el formato anterior. (18-10-2026)
+//:# - Opcion en OpenFileStructure() para proyectar el fichero en memoria (mmap)
+//:#   de modo que los arrays sin comprimir se pueden consultar sin copia con
+//:#   GetFileDataPointer(). (18-10-2026)
 //:#############################################################################
 
 /// \file JBinaryData.h \brief Declares the class \ref JBinaryData.
@@ -53,6 +61,7 @@
 #include <string>
 #include <vector>
 #include <fstream>
+#include <climits>
 
 class JBinaryData;
 
@@ -71,9 +80,15 @@ class JBinaryDataDef
     ,DatInt3=20,DatUint3=21,DatFloat3=22,DatDouble3=23 
   }TpData; 
 
+  ///Compression of array data: none, LZ, byte shuffle + LZ, delta + byte shuffle + LZ.
+  typedef enum{ CompNone=0,CompLz=1,CompShuffle=2,CompDelta=3 }TpComp; 
+
   static std::string TypeToStr(TpData type);
   static size_t SizeOfType(TpData type);
   static bool TypeIsTriple(TpData type);
+  static size_t ScalarSizeOfType(TpData type);
+  static std::string CompToStr(TpComp comp);
+  static TpComp CompByType(TpData type);
 };
 
 
@@ -98,6 +113,11 @@ class JBinaryDataArray : protected JObject
   llong FileDataPos;      ///<Valor mayor o igual a cero indica la posicion de lectura en el fichero abierto en el ItemHead. Value greater than or equal to zero indicates the position of reading in the file opened in the ItemHead.
   unsigned FileDataCount; ///<Numero de elemetos del array en fichero. Number of elements in the array in a file.
   unsigned FileDataSize;  ///<Size de datos del array en fichero. Size of array data in file.
+  JBinaryDataDef::TpComp FileDataComp; ///<Compresion de datos del array en fichero. Compression of array data in file.
+
+  JBinaryDataDef::TpComp Comp; ///<Compresion usada al grabar el array. Compression used to save the array.
+  mutable byte *CompData;      ///<Cache de datos comprimidos para grabar. Cache of compressed data to save.
+  mutable unsigned CompSize;   ///<Size de CompData. Size of CompData.
 
   void FreePointer(void* ptr)const;
   void* AllocPointer(unsigned size)const;
@@ -131,7 +151,15 @@ class JBinaryDataArray : protected JObject
   void AllocMemory(unsigned size,bool savedata=false);
   void ConfigExternalMemory(unsigned size,void* pointer);
 
-  void ReadData(unsigned count,unsigned size,std::ifstream *pf,bool resize);
+  void SetComp(JBinaryDataDef::TpComp comp);
+  JBinaryDataDef::TpComp GetComp()const{ return(Comp); }
+  bool CompActive()const{ return(Comp!=JBinaryDataDef::CompNone && Count); }
+  unsigned PrepareCompData()const;
+  const byte* GetCompData()const{ return(CompData); }
+  void FreeCompData()const;
+  void DecompData(unsigned count,const byte *data,unsigned size,JBinaryDataDef::TpComp comp,bool resize);
+
+  void ReadData(unsigned count,unsigned size,std::ifstream *pf,bool resize,JBinaryDataDef::TpComp comp=JBinaryDataDef::CompNone);
   void AddData(unsigned count,const void* data,bool resize);
   void SetData(unsigned count,const void* data,bool externalpointer);
 
@@ -141,11 +169,14 @@ class JBinaryDataArray : protected JObject
   void AddText(const std::string &str,bool resize);
   void AddTexts(unsigned count,const std::string *strs,bool resize);
 
-  void ConfigFileData(llong filepos,unsigned datacount,unsigned datasize);
+  void ConfigFileData(llong filepos,unsigned datacount,unsigned datasize,JBinaryDataDef::TpComp comp);
   void ClearFileData();
   unsigned GetFileDataCount()const{ return(FileDataCount); }
   unsigned GetFileDataSize()const{ return(FileDataSize); }
+  JBinaryDataDef::TpComp GetFileDataComp()const{ return(FileDataComp); }
   void ReadFileData(bool resize);
+  const void* GetFileDataPointer()const;
+  void ReleaseFileDataPointer(unsigned pini=0,unsigned count=UINT_MAX)const;
 };
 
 //##############################################################################
@@ -169,6 +200,7 @@ class JBinaryData : protected JObject
   static const std::string CodeItemDef;
   static const std::string CodeValuesDef;
   static const std::string CodeArrayDef;
+  static const std::string CodeArrayCompDef;
 
  public:
 
@@ -208,6 +240,8 @@ class JBinaryData : protected JObject
   std::vector<StValue> Values;
 
   std::ifstream *FileStructure;
+  const byte *FileMap;   ///<Fichero de OpenFileStructure() proyectado en memoria (NULL si no se usa). File of OpenFileStructure() mapped in memory (NULL when it is not used).
+  llong FileMapSize;     ///<Size de FileMap. Size of FileMap.
 
   //-Variables para cache de values. Variables to cache values.
   bool ValuesModif;
@@ -266,8 +300,8 @@ class JBinaryData : protected JObject
   void InItemBase(unsigned &count,unsigned size,byte *ptr,bool all)const;
   void InItem(unsigned &count,unsigned size,byte *ptr,bool all)const;
 
-  JBinaryDataArray* OutArrayBase(unsigned &count,unsigned size,const byte *ptr,unsigned &countdata,unsigned &sizedata);
-  void OutArrayData(unsigned &count,unsigned size,const byte *ptr,JBinaryDataArray *ar,unsigned countdata,unsigned sizedata);
+  JBinaryDataArray* OutArrayBase(unsigned &count,unsigned size,const byte *ptr,unsigned &countdata,unsigned &sizedata,JBinaryDataDef::TpComp &comp);
+  void OutArrayData(unsigned &count,unsigned size,const byte *ptr,JBinaryDataArray *ar,unsigned countdata,unsigned sizedata,JBinaryDataDef::TpComp comp);
   void OutArray(unsigned &count,unsigned size,const byte *ptr);
   JBinaryData* OutItemBase(unsigned &count,unsigned size,const byte *ptr,bool create,unsigned &narrays,unsigned &nitems,unsigned &sizevalues);
   void OutItem(unsigned &count,unsigned size,const byte *ptr,bool create);
@@ -281,16 +315,17 @@ class JBinaryData : protected JObject
   void WriteItem(std::fstream *pf,unsigned sbuf,byte *buf,bool all)const;
 
   unsigned ReadUint(std::ifstream *pf)const;
-  void ReadArrayData(std::ifstream *pf,JBinaryDataArray *ar,unsigned countdata,unsigned sizedata,bool loadarraysdata);
+  void ReadArrayData(std::ifstream *pf,JBinaryDataArray *ar,unsigned countdata,unsigned sizedata,JBinaryDataDef::TpComp comp,bool loadarraysdata);
   void ReadArray(std::ifstream *pf,unsigned sbuf,byte *buf,bool loadarraysdata);
   void ReadItem(std::ifstream *pf,unsigned sbuf,byte *buf,bool create,bool loadarraysdata);
 
   JBinaryData::StHeadFmtBin MakeFileHead(const std::string &filecode)const;
-  unsigned GetFileHead(std::ifstream *pf,JBinaryData::StHeadFmtBin &head)const;
+  llong GetFileHead(std::ifstream *pf,JBinaryData::StHeadFmtBin &head)const;
   void CheckHead(const std::string &file,const StHeadFmtBin &head,const std::string &filecode)const;
-  unsigned CheckFileHead(const std::string &file,std::ifstream *pf,const std::string &filecode)const;
-  unsigned CheckFileListHead(const std::string &file,std::fstream *pf,const std::string &filecode)const;
+  llong CheckFileHead(const std::string &file,std::ifstream *pf,const std::string &filecode)const;
+  llong CheckFileListHead(const std::string &file,std::fstream *pf,const std::string &filecode)const;
   void SaveFileData(std::fstream *pf,bool head,const std::string &filecode,bool memory,bool all)const;
+  void FreeCompData()const;
 
   void WriteFileXmlArray(const std::string &tabs,std::ofstream* pf,bool svarrays,const JBinaryDataArray* ar)const;
 
@@ -332,9 +367,11 @@ class JBinaryData : protected JObject
   void SaveFileListApp(const std::string &file,const std::string &filecode,bool memory=false,bool all=true);
   void LoadFileListApp(const std::string &file,const std::string &filecode,bool memory=false);
   
-  void OpenFileStructure(const std::string &file,const std::string &filecode="");
+  void OpenFileStructure(const std::string &file,const std::string &filecode="",bool map=false);
   void CloseFileStructure();
   std::ifstream* GetFileStructure()const;
+  const byte* GetFileMap(llong pos,llong size)const;
+  void ReleaseFileMap(llong pos,llong size)const;
 
   void SaveFileXml(std::string file,bool svarrays=false,const std::string &head=" fmt=\"JBinaryData\"")const;
 
@@ -427,13 +464,14 @@ uint size_item_def
   - [value_n]
 [array_0]    
 uint size_array_def [n]
-- "ARRAY"
+- "ARRAY" or "ARRAYZ" (compressed data)
 - str name
 - bool hide
 - int type
 - uint count
 - uint size_contenido
-  - [contenido de array]
+- uint comp         (only with "ARRAYZ")
+  - [contenido de array]  (compressed block of JDataCompress with "ARRAYZ")
 [array_1]    
 ... 
 [array_n]    
@@ -43,6 +43,9 @@ JCellDivCpu::JCellDivCpu(bool stable,bool floating,byte periactive
   CellPart=NULL;    SortPart=NULL;
   PartsInCell=NULL; BeginCell=NULL;
   VSort=NULL;
+  HugePages=HPAGES_None;
+  SizeNp=CapacityNp=ReserveNp=0;
+  MemReservedNp=false;
   Reset();
 }
 
@@ -59,9 +62,9 @@ JCellDivCpu::~JCellDivCpu(){
 /// Initialisation of variables.
 //==============================================================================
 void JCellDivCpu::Reset(){
+  FreeMemoryAll();
   SizeNp=SizeNct=0;
   IncreaseNp=0;
-  FreeMemoryAll();
   Ndiv=NdivFull=0;
   Nptot=Npb1=Npf1=Npb2=Npf2=0;
   MemAllocNp=MemAllocNct=0;
@@ -83,8 +86,11 @@ void JCellDivCpu::Reset(){
 /// Libera memoria reservada para celdas.
 //==============================================================================
 void JCellDivCpu::FreeMemoryNct(){
-  delete[] PartsInCell;   PartsInCell=NULL;
-  delete[] BeginCell;     BeginCell=NULL; 
+  if(PartsInCell || BeginCell){
+    const size_t nc=size_t(SizeBeginCell(SizeNct));
+    JArraysCpu::FreeLarge(PartsInCell,sizeof(unsigned)*(nc-1),HugePages);  PartsInCell=NULL;
+    JArraysCpu::FreeLarge(BeginCell,sizeof(unsigned)*nc,HugePages);        BeginCell=NULL; 
+  }
   MemAllocNct=0;
   BoundDivideOk=false;
 }
@@ -94,9 +100,18 @@ void JCellDivCpu::FreeMemoryNct(){
 /// Libera memoria reservada para particulas.
 //==============================================================================
 void JCellDivCpu::FreeMemoryNp(){
-  delete[] CellPart;    CellPart=NULL;
-  delete[] SortPart;    SortPart=NULL;
-  delete[] VSort;       SetMemoryVSort(NULL);
+  if(MemReservedNp){
+    JArraysCpu::FreeReserved(CellPart,sizeof(unsigned)*CapacityNp,HugePages);  CellPart=NULL;
+    JArraysCpu::FreeReserved(SortPart,sizeof(unsigned)*CapacityNp,HugePages);  SortPart=NULL;
+    JArraysCpu::FreeReserved(VSort,sizeof(tdouble3)*CapacityNp,HugePages);     SetMemoryVSort(NULL);
+  }
+  else{
+    JArraysCpu::FreeLarge(CellPart,sizeof(unsigned)*CapacityNp,HugePages);  CellPart=NULL;
+    JArraysCpu::FreeLarge(SortPart,sizeof(unsigned)*CapacityNp,HugePages);  SortPart=NULL;
+    JArraysCpu::FreeLarge(VSort,sizeof(tdouble3)*CapacityNp,HugePages);     SetMemoryVSort(NULL);
+  }
+  CapacityNp=0;
+  MemReservedNp=false;
   MemAllocNp=0;
   BoundDivideOk=false;
 }
@@ -119,6 +134,7 @@ void JCellDivCpu::SetMemoryVSort(byte *vsort){
   VSortInt=(int*)VSort;        VSortWord=(word*)VSort;
   VSortFloat=(float*)VSort;    VSortFloat3=(tfloat3*)VSort;
   VSortFloat4=(tfloat4*)VSort; VSortDouble3=(tdouble3*)VSort;
+  VSortUllong=(ullong*)VSort;
   VSortSymmatrix3f=(tsymatrix3f*)VSort;
 }
 
@@ -128,17 +144,37 @@ void JCellDivCpu::SetMemoryVSort(byte *vsort){
 //==============================================================================
 void JCellDivCpu::AllocMemoryNp(ullong np){
   const char met[]="AllocMemoryNp";
-  FreeMemoryNp();
   np=np+PARTICLES_OVERMEMORY_MIN;
-  SizeNp=unsigned(np);
   //-Check number of particles | Comprueba numero de particulas.
-  if(np!=SizeNp)RunException(met,string("Failed memory allocation for ")+fun::UlongStr(np)+" particles.");
+  if(np!=unsigned(np))RunException(met,string("Failed memory allocation for ")+fun::UlongStr(np)+" particles.");
+  //-Grows in place within reserved virtual memory | Crece sobre la memoria virtual reservada.
+  if(MemReservedNp && CellPart && np<=CapacityNp){
+    SizeNp=unsigned(np);
+    MemAllocNp=llong(GetBytesPerParticle())*SizeNp;
+    Log->Printf("**CellDiv: Resizing in place for %u particles: %.1f MB.",SizeNp,double(MemAllocNp)/(1024*1024));
+    return;
+  }
+  FreeMemoryNp();
+  SizeNp=CapacityNp=unsigned(np);
+#ifndef WIN32
+  if(ReserveNp && SizeNp<=ReserveNp){
+    CapacityNp=ReserveNp;
+    MemReservedNp=true;
+  }
+#endif
   //-Reserve memory for particles | Reserva memoria para particulas.
   MemAllocNp=0;
   try{
-    CellPart=new unsigned[SizeNp];                      MemAllocNp+=sizeof(unsigned)*SizeNp;
-    SortPart=new unsigned[SizeNp];                      MemAllocNp+=sizeof(unsigned)*SizeNp;
-    SetMemoryVSort(new byte[sizeof(tdouble3)*SizeNp]);  MemAllocNp+=sizeof(tdouble3)*SizeNp;
+    if(MemReservedNp){
+      CellPart=(unsigned*)JArraysCpu::AllocReserved(sizeof(unsigned)*CapacityNp,HugePages);     MemAllocNp+=sizeof(unsigned)*SizeNp;
+      SortPart=(unsigned*)JArraysCpu::AllocReserved(sizeof(unsigned)*CapacityNp,HugePages);     MemAllocNp+=sizeof(unsigned)*SizeNp;
+      SetMemoryVSort((byte*)JArraysCpu::AllocReserved(sizeof(tdouble3)*CapacityNp,HugePages));  MemAllocNp+=sizeof(tdouble3)*SizeNp;
+    }
+    else{
+      CellPart=(unsigned*)JArraysCpu::AllocLarge(sizeof(unsigned)*SizeNp,HugePages);     MemAllocNp+=sizeof(unsigned)*SizeNp;
+      SortPart=(unsigned*)JArraysCpu::AllocLarge(sizeof(unsigned)*SizeNp,HugePages);     MemAllocNp+=sizeof(unsigned)*SizeNp;
+      SetMemoryVSort((byte*)JArraysCpu::AllocLarge(sizeof(tdouble3)*SizeNp,HugePages));  MemAllocNp+=sizeof(tdouble3)*SizeNp;
+    }
   }
   catch(const std::bad_alloc){
     RunException(met,fun::PrintStr("Failed CPU memory allocation of %.1f MB for %u particles.",double(MemAllocNp)/(1024*1024),SizeNp));
@@ -147,6 +183,18 @@ void JCellDivCpu::AllocMemoryNp(ullong np){
   Log->Printf("**CellDiv: Requested cpu memory for %u particles: %.1f MB.",SizeNp,double(MemAllocNp)/(1024*1024));
 }
 
+//==============================================================================
+/// Establece el numero de particulas de memoria virtual reservada para los 
+/// buffers de particulas, que crecen sin copiar datos hasta este limite.
+/// Sets the number of particles of reserved virtual memory for the particle 
+/// buffers, which grow without copying data up to this limit.
+//==============================================================================
+void JCellDivCpu::SetReserveNp(unsigned np){
+  FreeMemoryNp();
+  const ullong np2=ullong(np)+PARTICLES_OVERMEMORY_MIN;
+  ReserveNp=(np? (np2==unsigned(np2)? unsigned(np2): UINT_MAX): 0);
+}
+
 //==============================================================================
 /// Assign memory according to number of cells. 
 /// Asigna memoria segun numero de celdas. 
@@ -161,8 +209,8 @@ void JCellDivCpu::AllocMemoryNct(ullong nct){
   MemAllocNct=0;
   const unsigned nc=(unsigned)SizeBeginCell(nct);
   try{
-    PartsInCell=new unsigned[nc-1];  MemAllocNct+=sizeof(unsigned)*(nc-1);
-    BeginCell=new unsigned[nc];      MemAllocNct+=sizeof(unsigned)*(nc);
+    PartsInCell=(unsigned*)JArraysCpu::AllocLarge(sizeof(unsigned)*(nc-1),HugePages);  MemAllocNct+=sizeof(unsigned)*(nc-1);
+    BeginCell=(unsigned*)JArraysCpu::AllocLarge(sizeof(unsigned)*nc,HugePages);        MemAllocNct+=sizeof(unsigned)*(nc);
   }
   catch(const std::bad_alloc){
     RunException(met,fun::PrintStr("Failed CPU memory allocation of %.1f MB for %u cells.",double(MemAllocNct)/(1024*1024),SizeNct));
@@ -180,7 +228,12 @@ void JCellDivCpu::AllocMemoryNct(ullong nct){
 //==============================================================================
 void JCellDivCpu::CheckMemoryNp(unsigned npmin){
   if(SizeNp<npmin+PARTICLES_OVERMEMORY_MIN){
-    AllocMemoryNp(ullong(npmin)+ullong(OverMemoryNp*npmin)+IncreaseNp);
+    ullong np=ullong(npmin)+ullong(OverMemoryNp*npmin)+IncreaseNp;
+    //-Over memory is limited to the reserved memory when it is enough for npmin.
+    //-La sobre-asignacion se limita a la memoria reservada cuando es suficiente para npmin.
+    const ullong npres=(MemReservedNp? CapacityNp: ReserveNp);
+    if(npres && np+PARTICLES_OVERMEMORY_MIN>npres && ullong(npmin)+PARTICLES_OVERMEMORY_MIN<=npres)np=npres-PARTICLES_OVERMEMORY_MIN;
+    AllocMemoryNp(np);
     IncreaseNp=0;
   }
   else if(!CellPart){
@@ -376,6 +429,20 @@ void JCellDivCpu::SortArray(unsigned *vec){
   memcpy(vec+ini,VSortInt+ini,sizeof(unsigned)*(n-ini));
 }
 
+//==============================================================================
+/// Reorder values of all particles (for type ullong).
+/// Reordena datos de todas las particulas (para tipo ullong).
+//==============================================================================
+void JCellDivCpu::SortArray(ullong *vec){
+  const int n=int(Nptot);
+  const int ini=(DivideFull? 0: int(NpbFinal));
+  #ifdef OMP_USE
+    #pragma omp parallel for schedule (static) if(n>OMP_LIMIT_COMPUTELIGHT)
+  #endif
+  for(int p=ini;p<n;p++)VSortUllong[p]=vec[SortPart[p]];
+  memcpy(vec+ini,VSortUllong+ini,sizeof(ullong)*(n-ini));
+}
+
 //==============================================================================
 /// Reorder values of all particles (for type float).
 /// Reordena datos de todas las particulas (para tipo float).
@@ -25,6 +25,7 @@
 #include "JObject.h"
 #include "JSphTimersCpu.h"
 #include "JLog2.h"
+#include "JArraysCpu.h"
 #include <cmath>
 #include <cstring>
 #include <sstream>
@@ -66,6 +67,9 @@ protected:
   //-Variables with allocated memory as a function of the number of particles in CPU.
   //-Memoria reservada en funcion de particulas en CPU.
   unsigned SizeNp;
+  unsigned CapacityNp;   ///<Number of particles of allocated memory (SizeNp<=CapacityNp). | Numero de particulas de la memoria asignada.
+  unsigned ReserveNp;    ///<Number of particles of virtual memory to reserve (0:disabled). | Numero de particulas de memoria virtual a reservar (0:desactivado).
+  bool MemReservedNp;    ///<Memory for particles was reserved with JArraysCpu::AllocReserved(). | La memoria para particulas se reservo con JArraysCpu::AllocReserved().
   unsigned *CellPart;
   unsigned *SortPart;
 
@@ -86,10 +90,12 @@ protected:
   tfloat3     *VSortFloat3;      ///<To order vectors tfloat3 (write to VSort). | Para ordenar vectores tfloat3 (apunta a VSort).
   tfloat4     *VSortFloat4;      ///<To order vectors tfloat4 (write to VSort). | Para ordenar vectores tfloat4 (apunta a VSort).
   tdouble3    *VSortDouble3;     ///<To order vectors tdouble3 (write to VSort). | Para ordenar vectores tdouble3 (apunta a VSort).
+  ullong      *VSortUllong;      ///<To order vectors ullong (write to VSort). | Para ordenar vectores ullong (apunta a VSort).
   tsymatrix3f *VSortSymmatrix3f; ///<To order vectors tsymatrix3f (write to VSort). | Para ordenar vectores tsymatrix3f (apunta a VSort).
 
   llong MemAllocNp;  ///<Memory reserved for particles. | Mermoria reservada para particulas.
   llong MemAllocNct; ///<Memory reserved for cells. | Mermoria reservada para celdas.
+  TpHugePages HugePages; ///<Mode of huge pages for allocated memory. | Modo de huge pages para la memoria asignada.
 
   unsigned Ndiv,NdivFull;
 
@@ -154,10 +160,14 @@ public:
     ,bool allocfullnct=true,float overmemorynp=CELLDIV_OVERMEMORYNP,word overmemorycells=CELLDIV_OVERMEMORYCELLS);
   ~JCellDivCpu();
 
+  void SetHugePages(TpHugePages hpages){ FreeMemoryAll(); HugePages=hpages; }
+  void SetReserveNp(unsigned np);
+  static unsigned GetBytesPerParticle(){ return(sizeof(unsigned)*2+sizeof(tdouble3)); }
   void DefineDomain(unsigned cellcode,tuint3 domcelini,tuint3 domcelfin,tdouble3 domposmin,tdouble3 domposmax);
 
   void SortArray(word *vec);
   void SortArray(unsigned *vec);
+  void SortArray(ullong *vec);
   void SortArray(float *vec);
   void SortArray(tdouble3 *vec);
   void SortArray(tfloat3 *vec);
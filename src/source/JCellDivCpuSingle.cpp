@@ -258,7 +258,7 @@ void JCellDivCpuSingle::PreSort(const unsigned* dcellc,const typecode *codec){
 /// excepcion en CalcCellDomainFluid();
 //==============================================================================
 void JCellDivCpuSingle::Divide(unsigned npb1,unsigned npf1,unsigned npb2,unsigned npf2,bool boundchanged
-  ,const unsigned *dcellc,const typecode* codec,const unsigned* idpc,const tdouble3* posc,TimersCpu timers)
+  ,const unsigned *dcellc,const typecode* codec,const typeidp* idpc,const tdouble3* posc,TimersCpu timers)
 {
   const char met[]="Divide";
   DivideFull=false;
@@ -47,7 +47,7 @@ public:
     ,unsigned casenbound,unsigned casenfixed,unsigned casenpb,JLog2 *log,std::string dirout);
 
   void Divide(unsigned npb1,unsigned npf1,unsigned npb2,unsigned npf2,bool boundchanged
-    ,const unsigned *dcellc,const typecode* codec,const unsigned* idpc,const tdouble3* posc,TimersCpu timers);
+    ,const unsigned *dcellc,const typecode* codec,const typeidp* idpc,const tdouble3* posc,TimersCpu timers);
 
   ullong GetAllocMemory()const{ return(JCellDivCpu::GetAllocMemory()); }
   ullong GetAllocMemoryNp()const{ return(JCellDivCpu::GetAllocMemoryNp()); };
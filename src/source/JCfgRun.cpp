@@ -46,6 +46,9 @@ void JCfgRun::Reset(){
   OmpThreads=0;
   BlockSizeMode=BSIZEMODE_Fixed;
   SvTimers=true;
+  CompactMem=false;
+  MemBudget=0;
+  HugePages=HPAGES_None;
   CellMode=CELLMODE_2H;
   DomainMode=0;
   DomainFixedMin=DomainFixedMax=TDouble3(0);
@@ -55,9 +58,19 @@ void JCfgRun::Reset(){
   DeltaSph=-1;
   Shifting=-1;
   SvRes=true; SvDomainVtk=false;
+  SvAsync=0;
+  SvCompress=false;
+  SvQuantPos=SvQuantVel=SvQuantRhop=0;
+  SvQuantFull=0;
+  SvDelta=0;
+  SvVtu=0; SvVtuCompress=false;
   Sv_Binx=false; Sv_Info=false; Sv_Vtk=false; Sv_Csv=false;
   CaseName=""; RunName=""; DirOut=""; DirDataOut=""; 
   PartBegin=0; PartBeginFirst=0; PartBeginDir="";
+  SvCheckpoint=0; RestartDir="";
+  GaugesCsv="";
+  CsvBenchDir=""; CsvBenchNp=0;
+  VtuCheckDir=""; VtuCheckNp=0;
   TimeMax=-1; TimePart=-1;
   RhopOutModif=false; RhopOutMin=700; RhopOutMax=1300;
   FtPause=-1;
@@ -101,6 +114,21 @@ void JCfgRun::VisuInfo()const{
   printf("                   by host for parallel execution, this takes the number of \n");
   printf("                   cores of the device by default (or using zero value)\n\n");
 #endif
+  printf("    -compactmem:<0/1>  Only for CPU execution, reduces the memory per particle\n");
+  printf("                   storing the Symplectic predictor position as a float\n");
+  printf("                   displacement (relative error in position below 1e-7 of\n");
+  printf("                   the displacement per step)\n\n");
+  printf("    -membudget:<int>  Only for CPU execution, memory budget (MB) for particle\n");
+  printf("                   arrays and cell-division buffers. Virtual memory is\n");
+  printf("                   reserved so arrays grow without copying data and the\n");
+  printf("                   execution stops when the budget is exceeded. It is an\n");
+  printf("                   opt-in option: by default (or zero value) nothing is\n");
+  printf("                   reserved and arrays are copied when they grow\n\n");
+  printf("    -hugepages:<mode>  Only for CPU execution, memory of large arrays is\n");
+  printf("                   aligned to 64 bytes and optionally uses huge pages\n");
+  printf("        0: No huge pages (option by default)\n");
+  printf("        1: Transparent huge pages\n");
+  printf("        2: Explicit huge pages of 2 MB (transparent when not available)\n\n");
   printf("    -blocksize:<mode>  Defines BlockSize to use in particle interactions on GPU\n");
 #ifndef DISABLE_BSMODES
   printf("        0: Fixed value (128) is used (option by default)\n");
@@ -141,6 +169,23 @@ void JCfgRun::VisuInfo()const{
   printf("    -svres:<0/1>     Generates file that summarises the execution process\n");
   printf("    -svtimers:<0/1>  Obtains timing for each individual process\n");
   printf("    -svdomainvtk:<0/1>  Generates VTK file with domain limits\n");
+  printf("    -svasync:<int>   Writes particle data in background using the given\n");
+  printf("                     number of staging buffers (0 by default, disabled)\n");
+  printf("    -svcompress:<0/1>  Compresses particle arrays in bi4 files without loss\n");
+  printf("                       of precision (0 by default)\n");
+  printf("    -svquant:errpos:errvel:errrhop[:nfull]  Stores positions, velocities\n");
+  printf("        and densities in bi4 files quantised with the given maximum absolute\n");
+  printf("        errors. One of each nfull parts is stored without loss for restart\n");
+  printf("        (0 by default, only the first part). The errors must be larger than\n");
+  printf("        the resolution of the values (float for velocity and density)\n");
+  printf("    -svdelta:<int>   Stores particle data in bi4 files as differences with the\n");
+  printf("                     previous part using Idp as key, with a complete part each\n");
+  printf("                     given number of parts (0 by default, disabled)\n");
+  printf("    -svvtu:<mode>[:<0/1>]  Stores VTK files of particles in VTU format with\n");
+  printf("        appended binary data, optionally compressed (LZ4)\n");
+  printf("        0  Legacy VTK format (by default)\n");
+  printf("        1  VTU with raw binary data\n");
+  printf("        2  VTU with base64 data\n");
   printf("    -name <string>      Specifies path and name of the case \n");
   printf("    -runname <string>   Specifies name for case execution\n");
   printf("    -dirout <dir>       Specifies the general output directory \n");
@@ -149,6 +194,25 @@ void JCfgRun::VisuInfo()const{
   printf("     Specifies the beginning of the simulation starting from a given PART\n");
   printf("     (begin) and located in the directory (dir), (first) indicates the\n");
   printf("     number of the first PART to be generated\n\n");
+  printf("    -checkpoint:<int>  Saves the full state of the solver in the file\n");
+  printf("     Checkpoint.bi4 of the data directory each given number of PARTs\n");
+  printf("     (1 by default, 0 disabled)\n");
+  printf("    -restart <dir>  Restarts the simulation from the file Checkpoint.bi4\n");
+  printf("     located in the directory (dir), which must contain the data files of\n");
+  printf("     the previous execution. The results are identical to the ones of the\n");
+  printf("     uninterrupted execution and the results files of gauges are continued\n");
+  printf("     (only CPU and not available with Inlet/Outlet, Chrono or BoundCorr)\n\n");
+  printf("    -gaugescsv <file>  Converts the results of gauges saved in binary file\n");
+  printf("     (Gauges.gbi4) to the CSV files of each gauge in the same directory.\n");
+  printf("     The simulation is not executed\n\n");
+  printf("    -csvbench:<int> <dir>  Measures the writing of CSV files of particles\n");
+  printf("     and gauges with the given number of particles (1000000 by default)\n");
+  printf("     in the directory (dir) and checks that the files are identical to\n");
+  printf("     the ones of the previous code. The simulation is not executed\n\n");
+  printf("    -vtucheck:<int> <dir>  Writes VTU files of particles with all the\n");
+  printf("     encodings of -svvtu and the given number of particles (100000 by\n");
+  printf("     default) in the directory (dir) and checks that the data loaded from\n");
+  printf("     the files is identical. The simulation is not executed\n\n");
   printf("    -rhopout:min:max Excludes fluid particles out of these density limits\n\n");
   printf("    -ftpause:<float> Time to start floating bodies movement. By default 0\n");
   printf("    -tmax:<float>   Maximum time of simulation\n");
@@ -173,6 +237,13 @@ void JCfgRun::VisuConfig()const{
   PrintVar("  PartBegin",PartBegin,ln);
   PrintVar("  PartBeginFirst",PartBeginFirst,ln);
   PrintVar("  PartBeginDir",PartBeginDir,ln);
+  PrintVar("  SvCheckpoint",SvCheckpoint,ln);
+  PrintVar("  RestartDir",RestartDir,ln);
+  PrintVar("  GaugesCsv",GaugesCsv,ln);
+  PrintVar("  CsvBenchDir",CsvBenchDir,ln);
+  PrintVar("  CsvBenchNp",CsvBenchNp,ln);
+  PrintVar("  VtuCheckDir",VtuCheckDir,ln);
+  PrintVar("  VtuCheckNp",VtuCheckNp,ln);
   PrintVar("  Cpu",Cpu,ln);
   printf("  %s  %s\n",VarStr("Gpu",Gpu).c_str(),VarStr("GpuId",GpuId).c_str());
   PrintVar("  GpuFree",GpuFree,ln);
@@ -180,6 +251,9 @@ void JCfgRun::VisuConfig()const{
   PrintVar("  PosDouble",PosDouble,ln);
   PrintVar("  OmpThreads",OmpThreads,ln);
   PrintVar("  BlockSize",BlockSizeMode,ln);
+  PrintVar("  CompactMem",CompactMem,ln);
+  PrintVar("  MemBudget",MemBudget,ln);
+  PrintVar("  HugePages",GetNameHugePages(HugePages),ln);
   PrintVar("  CellMode",GetNameCellMode(CellMode),ln);
   PrintVar("  TStep",TStep,ln);
   PrintVar("  VerletSteps",VerletSteps,ln);
@@ -192,6 +266,15 @@ void JCfgRun::VisuConfig()const{
   PrintVar("  SvRes",SvRes,ln);
   PrintVar("  SvTimers",SvTimers,ln);
   PrintVar("  SvDomainVtk",SvDomainVtk,ln);
+  PrintVar("  SvAsync",SvAsync,ln);
+  PrintVar("  SvCompress",SvCompress,ln);
+  PrintVar("  SvQuantPos",SvQuantPos,ln);
+  PrintVar("  SvQuantVel",SvQuantVel,ln);
+  PrintVar("  SvQuantRhop",SvQuantRhop,ln);
+  PrintVar("  SvQuantFull",SvQuantFull,ln);
+  PrintVar("  SvDelta",SvDelta,ln);
+  PrintVar("  SvVtu",SvVtu,ln);
+  PrintVar("  SvVtuCompress",SvVtuCompress,ln);
   PrintVar("  Sv_Binx",Sv_Binx,ln);
   PrintVar("  Sv_Info",Sv_Info,ln);
   PrintVar("  Sv_Vtk",Sv_Vtk,ln);
@@ -323,6 +406,17 @@ void JCfgRun::LoadOpts(string *optlis,int optn,int lv,string file){
         OmpThreads=atoi(txoptfull.c_str()); if(OmpThreads<0)OmpThreads=0;
       } 
 #endif
+      else if(txword=="COMPACTMEM")CompactMem=(txoptfull!=""? atoi(txoptfull.c_str()): 1)!=0;
+      else if(txword=="MEMBUDGET"){
+        MemBudget=atoi(txoptfull.c_str());
+        if(MemBudget<0)ErrorParm(opt,c,lv,file);
+      }
+      else if(txword=="HUGEPAGES"){
+        if(txoptfull=="0")HugePages=HPAGES_None;
+        else if(txoptfull=="1")HugePages=HPAGES_Transparent;
+        else if(txoptfull=="2")HugePages=HPAGES_Explicit;
+        else ErrorParm(opt,c,lv,file);
+      }
       else if(txword=="BLOCKSIZE"){
         if(txoptfull=="0")BlockSizeMode=BSIZEMODE_Fixed;
 #ifndef DISABLE_BSMODES
@@ -378,6 +472,32 @@ void JCfgRun::LoadOpts(string *optlis,int optn,int lv,string file){
       else if(txword=="SVRES")SvRes=(txoptfull!=""? atoi(txoptfull.c_str()): 1)!=0;
       else if(txword=="SVTIMERS")SvTimers=(txoptfull!=""? atoi(txoptfull.c_str()): 1)!=0;
       else if(txword=="SVDOMAINVTK")SvDomainVtk=(txoptfull!=""? atoi(txoptfull.c_str()): 1)!=0;
+      else if(txword=="SVASYNC"){
+        const int v=(txoptfull!=""? atoi(txoptfull.c_str()): 2);
+        if(v<0)ErrorParm(opt,c,lv,file);
+        SvAsync=unsigned(v);
+      }
+      else if(txword=="SVCOMPRESS")SvCompress=(txoptfull!=""? atoi(txoptfull.c_str()): 1)!=0;
+      else if(txword=="SVQUANT"){
+        std::vector<double> v;
+        const unsigned nv=fun::VectorSplitDouble(":",txoptfull,v);
+        if(nv!=3 && nv!=4)ErrorParm(opt,c,lv,file);
+        SvQuantPos=v[0]; SvQuantVel=v[1]; SvQuantRhop=v[2];
+        SvQuantFull=(nv==4 && v[3]>0? unsigned(v[3]): 0);
+        if(SvQuantPos<=0 || SvQuantVel<=0 || SvQuantRhop<=0)ErrorParm(opt,c,lv,file);
+      }
+      else if(txword=="SVDELTA"){
+        const int v=(txoptfull!=""? atoi(txoptfull.c_str()): 10);
+        if(v<0)ErrorParm(opt,c,lv,file);
+        SvDelta=unsigned(v);
+      }
+      else if(txword=="SVVTU"){
+        std::vector<int> v;
+        const unsigned nv=(txoptfull!=""? fun::VectorSplitInt(":",txoptfull,v): 0);
+        if(nv>2 || (nv && (v[0]<0 || v[0]>2)))ErrorParm(opt,c,lv,file);
+        SvVtu=(nv? unsigned(v[0]): 1);
+        SvVtuCompress=(nv==2 && v[1]!=0);
+      }
       else if(txword=="SV"){
         string txop=StrUpper(txoptfull);
         while(!txop.empty()){
@@ -409,6 +529,25 @@ void JCfgRun::LoadOpts(string *optlis,int optn,int lv,string file){
         }
         PartBeginDir=optlis[c+1]; c++; 
       }
+      else if(txword=="CHECKPOINT"){
+        const int v=(txoptfull!=""? atoi(txoptfull.c_str()): 1);
+        if(v<0)ErrorParm(opt,c,lv,file);
+        SvCheckpoint=unsigned(v);
+      }
+      else if(txword=="RESTART"&&c+1<optn){ RestartDir=optlis[c+1]; c++; }
+      else if(txword=="GAUGESCSV"&&c+1<optn){ GaugesCsv=optlis[c+1]; c++; }
+      else if(txword=="CSVBENCH"&&c+1<optn){
+        const int v=(txoptfull!=""? atoi(txoptfull.c_str()): 1000000);
+        if(v<=0)ErrorParm(opt,c,lv,file);
+        CsvBenchNp=unsigned(v);
+        CsvBenchDir=optlis[c+1]; c++;
+      }
+      else if(txword=="VTUCHECK"&&c+1<optn){
+        const int v=(txoptfull!=""? atoi(txoptfull.c_str()): 100000);
+        if(v<=0)ErrorParm(opt,c,lv,file);
+        VtuCheckNp=unsigned(v);
+        VtuCheckDir=optlis[c+1]; c++;
+      }
       else if(txword=="RHOPOUT"){ 
         RhopOutMin=float(atof(txopt1.c_str())); 
         RhopOutMax=float(atof(txopt2.c_str())); 
@@ -82,11 +82,28 @@ public:
   double TimeMax,TimePart;
   float DeltaSph;
   int Shifting;  ///<Shifting mode -1:no defined, 0:none, 1:nobound, 2:nofixed, 3:full
+  bool CompactMem;  ///<Stores Symplectic predictor positions as float displacements to save memory (only CPU).
+  TpHugePages HugePages; ///<Mode of huge pages for large CPU arrays (only CPU).
+  int MemBudget;    ///<Memory budget (MB) to reserve particle arrays and grow them without copying (0:disabled, only CPU).
   bool SvRes,SvTimers,SvDomainVtk;
+  unsigned SvAsync;  ///<Number of staging buffers to write particle data in background (0:disabled).
+  bool SvCompress;   ///<Compresses arrays of particles in bi4 files (lossless).
+  double SvQuantPos,SvQuantVel,SvQuantRhop; ///<Maximum absolute error to store quantised Pos, Vel and Rhop in bi4 files (0:disabled).
+  unsigned SvQuantFull; ///<One of each SvQuantFull parts is stored without loss (0:only the first part).
+  unsigned SvDelta;     ///<Stores parts as differences with the previous one and a keyframe each SvDelta parts (0:disabled).
+  unsigned SvVtu;       ///<Stores VTK files of particles in VTU format (0:legacy VTK, 1:raw binary, 2:base64).
+  bool SvVtuCompress;   ///<Compresses data of VTU files.
   bool Sv_Binx,Sv_Info,Sv_Csv,Sv_Vtk;
   std::string CaseName,RunName,DirOut,DirDataOut;
   std::string PartBeginDir;
   unsigned PartBegin,PartBeginFirst;
+  unsigned SvCheckpoint;  ///<Saves checkpoint file each SvCheckpoint parts (0:disabled).
+  std::string RestartDir; ///<Directory with checkpoint file to restart the simulation.
+  std::string GaugesCsv;  ///<Binary file with results of gauges to convert to CSV files (no simulation).
+  std::string CsvBenchDir; ///<Directory to measure the writing of CSV files (no simulation).
+  unsigned CsvBenchNp;     ///<Number of particles to measure the writing of CSV files.
+  std::string VtuCheckDir; ///<Directory to check the writing and reading of VTU files (no simulation).
+  unsigned VtuCheckNp;     ///<Number of particles to check the writing and reading of VTU files.
   float FtPause;
   bool RhopOutModif;              ///<Indicates whether \ref RhopOutMin or RhopOutMax is changed.
   float RhopOutMin,RhopOutMax;    ///<Limits for \ref RhopOut density correction.
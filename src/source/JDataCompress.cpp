@@ -0,0 +1,372 @@
+//HEAD_DSCODES
+/*
+ <DUALSPHYSICS>  Copyright (c) 2019 by Dr Jose M. Dominguez et al. (see http://dual.sphysics.org/index.php/developers/). 
+
+ EPHYSLAB Environmental Physics Laboratory, Universidade de Vigo, Ourense, Spain.
+ School of Mechanical, Aerospace and Civil Engineering, University of Manchester, Manchester, U.K.
+
+ This file is part of DualSPHysics. 
+
+ DualSPHysics is free software: you can redistribute it and/or modify it under the terms of the GNU Lesser General Public License 
+ as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) any later version.
+ 
+ DualSPHysics is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details. 
+
+ You should have received a copy of the GNU Lesser General Public License along with DualSPHysics. If not, see <http://www.gnu.org/licenses/>. 
+*/
+
+/// \file JDataCompress.cpp \brief Implements the class \ref JDataCompress.
+
+#include "JDataCompress.h"
+#include "OmpDefs.h"
+#include <cstring>
+#include <climits>
+#include <vector>
+#include <new>
+#include <algorithm>
+
+
+//-Constants of LZ codec (block format similar to LZ4).
+static const unsigned LZ_MINMATCH=4;      ///<Minimum length of match.
+static const unsigned LZ_LASTLITERALS=5;  ///<Last bytes are always stored as literals.
+static const unsigned LZ_MFLIMIT=12;      ///<Last match must start before this limit.
+static const unsigned LZ_HASHLOG=14;      ///<Log2 of entries in hash table.
+static const unsigned LZ_MAXOFFSET=65535; ///<Maximum distance of match.
+
+//==============================================================================
+/// Returns 4 bytes of data as unsigned.
+//==============================================================================
+inline unsigned LzRead32(const byte *p){ unsigned v; memcpy(&v,p,4); return(v); }
+
+//==============================================================================
+/// Returns hash value for 4 bytes of data.
+//==============================================================================
+inline unsigned LzHash(unsigned v){ return((v*2654435761u)>>(32-LZ_HASHLOG)); }
+
+//==============================================================================
+/// Writes extra bytes of length. Returns false when there is not space.
+//==============================================================================
+inline bool LzPutLen(unsigned len,byte *dst,unsigned &op,unsigned dstcap){
+  for(;len>=255;len-=255){
+    if(op>=dstcap)return(false);
+    dst[op++]=255;
+  }
+  if(op>=dstcap)return(false);
+  dst[op++]=byte(len);
+  return(true);
+}
+
+//==============================================================================
+/// Writes sequence of literals and match (mlen=0 for last literals).
+/// Returns false when there is not space.
+//==============================================================================
+static bool LzPutSequence(const byte *lit,unsigned litlen,unsigned offset,unsigned mlen,byte *dst,unsigned &op,unsigned dstcap){
+  if(op>=dstcap)return(false);
+  const unsigned ml=(mlen? mlen-LZ_MINMATCH: 0);
+  dst[op++]=byte(((litlen<15? litlen: 15)<<4)|(ml<15? ml: 15));
+  if(litlen>=15 && !LzPutLen(litlen-15,dst,op,dstcap))return(false);
+  if(litlen>dstcap-op)return(false);
+  memcpy(dst+op,lit,litlen); op+=litlen;
+  if(mlen){
+    if(dstcap-op<2)return(false);
+    dst[op++]=byte(offset&255);
+    dst[op++]=byte(offset>>8);
+    if(ml>=15 && !LzPutLen(ml-15,dst,op,dstcap))return(false);
+  }
+  return(true);
+}
+
+//==============================================================================
+/// Compresses n bytes of src in dst and returns the compressed size. Returns 
+/// zero when the compressed data does not fit in dstcap bytes.
+///
+/// Comprime n bytes de src en dst y devuelve el tamanho comprimido. Devuelve
+/// cero cuando los datos comprimidos no caben en dstcap bytes.
+//==============================================================================
+unsigned JDataCompress::LzCompress(const byte *src,unsigned n,byte *dst,unsigned dstcap){
+  unsigned op=0,anchor=0;
+  if(n>LZ_MFLIMIT){
+    std::vector<unsigned> htab(size_t(1)<<LZ_HASHLOG,0);
+    const unsigned mflimit=n-LZ_MFLIMIT;
+    const unsigned matchlimit=n-LZ_LASTLITERALS;
+    unsigned ip=0;
+    while(ip<mflimit){
+      const unsigned seq=LzRead32(src+ip);
+      const unsigned h=LzHash(seq);
+      const unsigned ref=htab[h];
+      htab[h]=ip;
+      if(ref<ip && ip-ref<=LZ_MAXOFFSET && LzRead32(src+ref)==seq){
+        unsigned mlen=LZ_MINMATCH;
+        while(ip+mlen<matchlimit && src[ref+mlen]==src[ip+mlen])mlen++;
+        if(!LzPutSequence(src+anchor,ip-anchor,ip-ref,mlen,dst,op,dstcap))return(0);
+        ip+=mlen; anchor=ip;
+        if(ip<mflimit)htab[LzHash(LzRead32(src+ip-2))]=ip-2;
+      }
+      else ip+=1+((ip-anchor)>>6); //-Faster skip on incompressible data.
+    }
+  }
+  if(!LzPutSequence(src+anchor,n-anchor,0,0,dst,op,dstcap))return(0);
+  return(op);
+}
+
+//==============================================================================
+/// Decompresses n bytes of src in dst. Returns false when data is corrupted or
+/// the size of decompressed data is not dstn.
+///
+/// Descomprime n bytes de src en dst. Devuelve false cuando los datos no son
+/// validos o el tamanho descomprimido no es dstn.
+//==============================================================================
+bool JDataCompress::LzDecompress(const byte *src,unsigned n,byte *dst,unsigned dstn){
+  unsigned ip=0,op=0;
+  for(;;){
+    if(ip>=n)return(false);
+    const unsigned token=src[ip++];
+    //-Copies literals.
+    unsigned lit=(token>>4);
+    if(lit==15){
+      unsigned b;
+      do{
+        if(ip>=n)return(false);
+        b=src[ip++]; lit+=b;
+      }while(b==255);
+    }
+    if(lit>n-ip || lit>dstn-op)return(false);
+    memcpy(dst+op,src+ip,lit); ip+=lit; op+=lit;
+    if(ip==n)break; //-Last sequence.
+    //-Copies match.
+    if(n-ip<2)return(false);
+    const unsigned offset=unsigned(src[ip])|(unsigned(src[ip+1])<<8);
+    ip+=2;
+    if(!offset || offset>op)return(false);
+    unsigned ml=(token&15);
+    if(ml==15){
+      unsigned b;
+      do{
+        if(ip>=n)return(false);
+        b=src[ip++]; ml+=b;
+      }while(b==255);
+    }
+    ml+=LZ_MINMATCH;
+    if(ml>dstn-op)return(false);
+    const byte *ref=dst+op-offset;
+    if(offset>=ml)memcpy(dst+op,ref,ml);
+    else for(unsigned c=0;c<ml;c++)dst[op+c]=ref[c]; //-Overlapped copy.
+    op+=ml;
+  }
+  return(op==dstn);
+}
+
+//==============================================================================
+/// Groups bytes of the same significance of each value (n bytes).
+/// Agrupa los bytes de la misma significancia de cada valor (n bytes).
+//==============================================================================
+void JDataCompress::Shuffle(unsigned n,unsigned scalarsize,const byte *src,byte *dst){
+  const unsigned nv=(scalarsize>1? n/scalarsize: 0);
+  if(nv){
+    for(unsigned b=0;b<scalarsize;b++){
+      byte *d=dst+size_t(b)*nv;
+      const byte *s=src+b;
+      for(unsigned c=0;c<nv;c++)d[c]=s[size_t(c)*scalarsize];
+    }
+  }
+  const unsigned nr=nv*scalarsize;
+  if(nr<n)memcpy(dst+nr,src+nr,n-nr);
+}
+
+//==============================================================================
+/// Reverses Shuffle() (n bytes).
+/// Deshace Shuffle() (n bytes).
+//==============================================================================
+void JDataCompress::Unshuffle(unsigned n,unsigned scalarsize,const byte *src,byte *dst){
+  const unsigned nv=(scalarsize>1? n/scalarsize: 0);
+  if(nv){
+    for(unsigned b=0;b<scalarsize;b++){
+      const byte *s=src+size_t(b)*nv;
+      byte *d=dst+b;
+      for(unsigned c=0;c<nv;c++)d[size_t(c)*scalarsize]=s[c];
+    }
+  }
+  const unsigned nr=nv*scalarsize;
+  if(nr<n)memcpy(dst+nr,src+nr,n-nr);
+}
+
+//==============================================================================
+/// Delta encoding and decoding of unsigned values (with overflow).
+//==============================================================================
+template<typename T> static void DeltaEncodeT(unsigned nv,byte *data){
+  T *v=(T*)data;
+  for(unsigned c=nv;c>1;c--)v[c-1]-=v[c-2];
+}
+template<typename T> static void DeltaDecodeT(unsigned nv,byte *data){
+  T *v=(T*)data;
+  for(unsigned c=1;c<nv;c++)v[c]+=v[c-1];
+}
+
+//==============================================================================
+/// Replaces integer values (n bytes) by the difference with previous value.
+/// Sustituye valores enteros (n bytes) por la diferencia con el anterior.
+//==============================================================================
+void JDataCompress::DeltaEncode(unsigned n,unsigned scalarsize,byte *data){
+  switch(scalarsize){
+    case 1:  DeltaEncodeT<byte>  (n,data);    break;
+    case 2:  DeltaEncodeT<word>  (n/2,data);  break;
+    case 4:  DeltaEncodeT<unsigned>(n/4,data);  break;
+    case 8:  DeltaEncodeT<ullong>(n/8,data);  break;
+  }
+}
+
+//==============================================================================
+/// Reverses DeltaEncode() (n bytes).
+/// Deshace DeltaEncode() (n bytes).
+//==============================================================================
+void JDataCompress::DeltaDecode(unsigned n,unsigned scalarsize,byte *data){
+  switch(scalarsize){
+    case 1:  DeltaDecodeT<byte>  (n,data);    break;
+    case 2:  DeltaDecodeT<word>  (n/2,data);  break;
+    case 4:  DeltaDecodeT<unsigned>(n/4,data);  break;
+    case 8:  DeltaDecodeT<ullong>(n/8,data);  break;
+  }
+}
+
+//==============================================================================
+/// Returns size of head of compressed block.
+/// Devuelve el tamanho de la cabecera del bloque comprimido.
+//==============================================================================
+size_t JDataCompress::GetHeadSize(size_t rawsize){
+  const size_t nchunks=(rawsize+CHUNKSIZE-1)/CHUNKSIZE;
+  return(sizeof(unsigned)*(3+nchunks));
+}
+
+//==============================================================================
+/// Compresses rawsize bytes of raw by chunks in parallel. Returns the size of
+/// compressed block allocated in data (must be released with delete[]), or 
+/// zero on error.
+///
+/// Comprime rawsize bytes de raw por bloques en paralelo. Devuelve el tamanho
+/// del bloque comprimido reservado en data (debe liberarse con delete[]), o 
+/// cero en caso de error.
+//==============================================================================
+size_t JDataCompress::Compress(const byte *raw,size_t rawsize,unsigned scalarsize,bool shuffle,bool delta,byte *&data){
+  data=NULL;
+  const int nchunks=int((rawsize+CHUNKSIZE-1)/CHUNKSIZE);
+  std::vector<byte*> cdata(nchunks,NULL);
+  std::vector<unsigned> csize(nchunks,0);
+  bool error=false;
+  #ifdef OMP_USE
+    #pragma omp parallel for schedule(dynamic) if(nchunks>1)
+  #endif
+  for(int cc=0;cc<nchunks;cc++){
+    const size_t off=size_t(cc)*CHUNKSIZE;
+    const unsigned n=unsigned(std::min(size_t(CHUNKSIZE),rawsize-off));
+    byte *work=NULL,*out=NULL;
+    try{
+      work=new byte[size_t(n)*2];
+      out=new byte[n];
+    }
+    catch(const std::bad_alloc&){
+      delete[] work; work=NULL;
+      error=true;
+    }
+    if(work){
+      //-Applies filters.
+      const byte *src=raw+off;
+      if(delta){
+        memcpy(work,src,n);
+        DeltaEncode(n,scalarsize,work);
+        src=work;
+      }
+      if(shuffle){
+        Shuffle(n,scalarsize,src,work+n);
+        src=work+n;
+      }
+      //-Compresses or stores filtered data.
+      unsigned size=(n>1? LzCompress(src,n,out,n-1): 0);
+      if(!size){ memcpy(out,src,n); size=n; }
+      cdata[cc]=out; csize[cc]=size;
+      delete[] work;
+    }
+  }
+  //-Joins compressed chunks in one block.
+  size_t size=0;
+  if(!error){
+    size=GetHeadSize(rawsize);
+    for(int cc=0;cc<nchunks;cc++)size+=csize[cc];
+    try{
+      data=new byte[size];
+    }
+    catch(const std::bad_alloc&){
+      data=NULL; size=0;
+    }
+  }
+  if(data){
+    unsigned *head=(unsigned*)data;
+    head[0]=CODEC_LZ;
+    head[1]=CHUNKSIZE;
+    head[2]=unsigned(nchunks);
+    for(int cc=0;cc<nchunks;cc++)head[3+cc]=csize[cc];
+    size_t pos=GetHeadSize(rawsize);
+    for(int cc=0;cc<nchunks;cc++){
+      memcpy(data+pos,cdata[cc],csize[cc]);
+      pos+=csize[cc];
+    }
+  }
+  for(int cc=0;cc<nchunks;cc++)delete[] cdata[cc];
+  return(size);
+}
+
+//==============================================================================
+/// Decompresses block of size bytes in raw (rawsize bytes) by chunks in 
+/// parallel. Returns false when data is invalid.
+///
+/// Descomprime bloque de size bytes en raw (rawsize bytes) por bloques en
+/// paralelo. Devuelve false cuando los datos no son validos.
+//==============================================================================
+bool JDataCompress::Decompress(const byte *data,size_t size,byte *raw,size_t rawsize,unsigned scalarsize,bool shuffle,bool delta){
+  if(size<sizeof(unsigned)*3)return(false);
+  unsigned head[3];
+  memcpy(head,data,sizeof(unsigned)*3);
+  const unsigned codec=head[0],chunksize=head[1];
+  const int nchunks=int(head[2]);
+  if(codec!=CODEC_LZ || !chunksize || chunksize%8)return(false);
+  if(size_t(nchunks)!=(rawsize+chunksize-1)/chunksize)return(false);
+  const size_t headsize=sizeof(unsigned)*(3+size_t(nchunks));
+  if(size<headsize)return(false);
+  //-Computes position of each chunk.
+  std::vector<size_t> cpos(nchunks+1,0);
+  cpos[0]=headsize;
+  for(int cc=0;cc<nchunks;cc++){
+    unsigned cs;
+    memcpy(&cs,data+sizeof(unsigned)*(3+cc),sizeof(unsigned));
+    cpos[cc+1]=cpos[cc]+cs;
+  }
+  if(cpos[nchunks]!=size)return(false);
+  //-Decompresses chunks.
+  bool error=false;
+  #ifdef OMP_USE
+    #pragma omp parallel for schedule(dynamic) if(nchunks>1)
+  #endif
+  for(int cc=0;cc<nchunks;cc++){
+    const size_t off=size_t(cc)*chunksize;
+    const unsigned n=unsigned(std::min(size_t(chunksize),rawsize-off));
+    const unsigned cs=unsigned(cpos[cc+1]-cpos[cc]);
+    if(cs>n)error=true;
+    else{
+      byte *work=NULL;
+      if(shuffle){
+        try{ work=new byte[n]; }
+        catch(const std::bad_alloc&){ work=NULL; error=true; }
+      }
+      if(!shuffle || work){
+        byte *dst=(shuffle? work: raw+off);
+        if(cs==n)memcpy(dst,data+cpos[cc],n);
+        else if(!LzDecompress(data+cpos[cc],cs,dst,n))error=true;
+        if(shuffle)Unshuffle(n,scalarsize,work,raw+off);
+        if(delta)DeltaDecode(n,scalarsize,raw+off);
+        delete[] work;
+      }
+    }
+  }
+  return(!error);
+}
+
@@ -0,0 +1,81 @@
+//HEAD_DSCODES
+/*
+ <DUALSPHYSICS>  Copyright (c) 2019 by Dr Jose M. Dominguez et al. (see http://dual.sphysics.org/index.php/developers/). 
+
+ EPHYSLAB Environmental Physics Laboratory, Universidade de Vigo, Ourense, Spain.
+ School of Mechanical, Aerospace and Civil Engineering, University of Manchester, Manchester, U.K.
+
+ This file is part of DualSPHysics. 
+
+ DualSPHysics is free software: you can redistribute it and/or modify it under the terms of the GNU Lesser General Public License 
+ as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) any later version.
+ 
+ DualSPHysics is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details. 
+
+ You should have received a copy of the GNU Lesser General Public License along with DualSPHysics. If not, see <http://www.gnu.org/licenses/>. 
+*/
+
+//:#############################################################################
+//:# Descripcion:
+//:# =============
+//:# Compresion sin perdidas de arrays de datos binarios:
+//:# - Los datos se dividen en bloques que se comprimen de forma independiente
+//:#   y en paralelo con OpenMP.
+//:# - Filtros opcionales antes de comprimir: delta de enteros y reordenacion 
+//:#   de bytes (shuffle) segun el tamanho de cada valor.
+//:# - Codec LZ propio (similar a LZ4) sin dependencias externas.
+//:#
+//:# Cambios:
+//:# =========
+//:# - Implementacion. (18-10-2026)
+//:#############################################################################
+
+/// \file JDataCompress.h \brief Declares the class \ref JDataCompress.
+
+#ifndef _JDataCompress_
+#define _JDataCompress_
+
+#include "TypesDef.h"
+#include <cstddef>
+
+//##############################################################################
+//# JDataCompress
+//##############################################################################
+/// \brief Implements lossless compression of binary arrays by independent chunks.
+/// The compressed block contains the codec, the chunk size and the compressed 
+/// size of each chunk so it can be decoded without additional information.
+
+class JDataCompress
+{
+public:
+  static const unsigned CODEC_LZ=1;          ///<Code of the in-tree LZ codec.
+  static const unsigned CHUNKSIZE=262144;    ///<Size of uncompressed chunks (bytes).
+
+  static unsigned LzCompress(const byte *src,unsigned n,byte *dst,unsigned dstcap);
+  static bool LzDecompress(const byte *src,unsigned n,byte *dst,unsigned dstn);
+
+  static void Shuffle(unsigned n,unsigned scalarsize,const byte *src,byte *dst);
+  static void Unshuffle(unsigned n,unsigned scalarsize,const byte *src,byte *dst);
+  static void DeltaEncode(unsigned n,unsigned scalarsize,byte *data);
+  static void DeltaDecode(unsigned n,unsigned scalarsize,byte *data);
+
+  static size_t GetHeadSize(size_t rawsize);
+  static size_t Compress(const byte *raw,size_t rawsize,unsigned scalarsize,bool shuffle,bool delta,byte *&data);
+  static bool Decompress(const byte *data,size_t size,byte *raw,size_t rawsize,unsigned scalarsize,bool shuffle,bool delta);
+};
+
+/*
+Structure of compressed block:
+===================================
+- uint codec
+- uint chunk_size
+- uint num_chunks
+- uint size_chunk[num_chunks]   (equal to uncompressed size when chunk is stored)
+- [chunk_0]
+...
+- [chunk_n]
+*/
+
+#endif
+
@@ -0,0 +1,329 @@
+//HEAD_DSPH
+/*
+ <DUALSPHYSICS>  Copyright (c) 2019 by Dr Jose M. Dominguez et al. (see http://dual.sphysics.org/index.php/developers/). 
+
+ EPHYSLAB Environmental Physics Laboratory, Universidade de Vigo, Ourense, Spain.
+ School of Mechanical, Aerospace and Civil Engineering, University of Manchester, Manchester, U.K.
+
+ This file is part of DualSPHysics. 
+
+ DualSPHysics is free software: you can redistribute it and/or modify it under the terms of the GNU Lesser General Public License 
+ as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) any later version.
+ 
+ DualSPHysics is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details. 
+
+ You should have received a copy of the GNU Lesser General Public License along with DualSPHysics. If not, see <http://www.gnu.org/licenses/>. 
+*/
+
+/// \file JFormatCheck.cpp \brief Implements the class \ref JFormatCheck.
+
+#include "JFormatCheck.h"
+#include "Functions.h"
+#include "JSaveCsv2.h"
+#include "JSaveVtu.h"
+#include "JTimer.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+using std::string;
+
+//##############################################################################
+//# JFormatCheck
+//##############################################################################
+//==============================================================================
+/// Constructor.
+//==============================================================================
+JFormatCheck::JFormatCheck(){
+  ClassName="JFormatCheck";
+  Pos=NULL; Idp=NULL; Vel=NULL; Rhop=NULL; Type=NULL;
+  Reset();
+}
+
+//==============================================================================
+/// Destructor.
+//==============================================================================
+JFormatCheck::~JFormatCheck(){
+  DestructorActive=true;
+  Reset();
+}
+
+//==============================================================================
+/// Initialisation of variables.
+//==============================================================================
+void JFormatCheck::Reset(){
+  FreeData();
+}
+
+//==============================================================================
+/// Allocates memory and creates test data of particles similar to the results
+/// of a simulation (with a deterministic sequence).
+//==============================================================================
+void JFormatCheck::AllocData(unsigned np){
+  FreeData();
+  try{
+    Pos=new tfloat3[np];
+    Idp=new unsigned[np];
+    Vel=new tfloat3[np];
+    Rhop=new float[np];
+    Type=new byte[np];
+  }
+  catch(const std::bad_alloc&){
+    RunException("AllocData",fun::PrintStr("Could not allocate the requested memory (np=%u).",np));
+  }
+  Np=np;
+  unsigned seed=12345;
+  for(unsigned p=0;p<np;p++){
+    float r[7];
+    for(unsigned c=0;c<7;c++){
+      seed=seed*1664525u+1013904223u;
+      r[c]=float(seed>>8)/float(1u<<24);
+    }
+    Pos[p]=TFloat3(r[0]*4.f,r[1],r[2]*2.f);
+    Idp[p]=p;
+    Vel[p]=TFloat3((r[3]-0.5f)*3.f,(r[4]-0.5f)*0.01f,(r[5]-0.5f)*3.f);
+    Rhop[p]=1000.f+(r[6]-0.5f)*20.f;
+    Type[p]=byte(p%3);
+  }
+}
+
+//==============================================================================
+/// Frees memory of test data.
+//==============================================================================
+void JFormatCheck::FreeData(){
+  delete[] Pos;  Pos=NULL;
+  delete[] Idp;  Idp=NULL;
+  delete[] Vel;  Vel=NULL;
+  delete[] Rhop; Rhop=NULL;
+  delete[] Type; Type=NULL;
+  Np=0;
+}
+
+//==============================================================================
+/// Returns true when both files have the same content.
+//==============================================================================
+bool JFormatCheck::FilesEqual(const std::string &file1,const std::string &file2)const{
+  std::ifstream pf1(file1.c_str(),std::ios::binary);
+  std::ifstream pf2(file2.c_str(),std::ios::binary);
+  if(!pf1)RunException("FilesEqual","Cannot open the file.",file1);
+  if(!pf2)RunException("FilesEqual","Cannot open the file.",file2);
+  const unsigned SIZE=1024*1024;
+  std::vector<char> buf1(SIZE),buf2(SIZE);
+  bool eq=true;
+  while(eq && pf1 && pf2){
+    pf1.read(&buf1[0],SIZE);
+    pf2.read(&buf2[0],SIZE);
+    eq=(pf1.gcount()==pf2.gcount() && !memcmp(&buf1[0],&buf2[0],size_t(pf1.gcount())));
+  }
+  return(eq && !pf1 && !pf2);
+}
+
+//==============================================================================
+/// Shows runtime and throughput of one writing method.
+//==============================================================================
+void JFormatCheck::PrintSpeed(const char *name,double seconds,llong size)const{
+  const double mb=double(size)/(1024.*1024.);
+  printf("  %-28s %9.3f s  %9.1f MB/s\n",name,seconds,(seconds>0? mb/seconds: 0.));
+}
+
+//==============================================================================
+/// Measures the writing of CSV files with test data of np particles. The files
+/// of particles (-sv:csv) are created with JFormatFiles2::SaveCsv() and with
+/// JSaveCsv2::SaveParticles(), and the rows of gauges are formatted with
+/// vsnprintf() and with JSaveCsv2. Returns true when the files created by each
+/// pair of methods are identical. The files are removed when they are identical.
+///
+/// Mide la escritura de ficheros CSV con datos de prueba de np particulas. Los
+/// ficheros de particulas (-sv:csv) se crean con JFormatFiles2::SaveCsv() y con
+/// JSaveCsv2::SaveParticles(), y las filas de medidores se formatean con
+/// vsnprintf() y con JSaveCsv2. Devuelve true cuando los ficheros creados por
+/// cada pareja de metodos son identicos. Los ficheros se borran cuando son
+/// identicos.
+//==============================================================================
+bool JFormatCheck::CsvBenchmark(const std::string &dir,unsigned np,bool csvsepcoma){
+  const char met[]="CsvBenchmark";
+  if(!np)RunException(met,"Number of particles is zero.");
+  if(!fun::DirExists(dir))RunException(met,"The directory does not exist.",dir);
+  const string dirout=fun::GetDirWithSlash(dir);
+  const char sep=(csvsepcoma? ',': ';');
+  printf("\nCSV benchmark with %u particles...\n",np);
+  AllocData(np);
+  JTimer tm;
+  //-CSV of particles.
+  const string filepref=dirout+"CsvBench_PartRef.csv";
+  const string filepfast=dirout+"CsvBench_PartFast.csv";
+  JFormatFiles2::StScalarData fields[4];
+  fields[0]=JFormatFiles2::DefineField("Idp" ,JFormatFiles2::UInt32 ,1,Idp);
+  fields[1]=JFormatFiles2::DefineField("Vel" ,JFormatFiles2::Float32,3,Vel);
+  fields[2]=JFormatFiles2::DefineField("Rhop",JFormatFiles2::Float32,1,Rhop);
+  fields[3]=JFormatFiles2::DefineField("Type",JFormatFiles2::UChar8 ,1,Type);
+  tm.Start();
+  JFormatFiles2::SaveCsv(filepref,csvsepcoma,np,Pos,4,fields);
+  tm.Stop();
+  const double tpref=tm.GetElapsedTimeD()/1000.;
+  tm.Start();
+  jcsv::JSaveCsv2(filepfast,false,csvsepcoma).SaveParticles(np,Pos,4,fields);
+  tm.Stop();
+  const double tpfast=tm.GetElapsedTimeD()/1000.;
+  const bool parteq=FilesEqual(filepref,filepfast);
+  printf("\n  Particles (-sv:csv) in %s:\n",fun::GetFile(filepfast).c_str());
+  PrintSpeed("JFormatFiles2::SaveCsv()",tpref,fun::FileSize(filepref));
+  PrintSpeed("JSaveCsv2::SaveParticles()",tpfast,fun::FileSize(filepfast));
+  printf("  Speedup: x%.2f   Files: %s\n",(tpfast>0? tpref/tpfast: 0.),(parteq? "identical": "DIFFERENT"));
+  //-CSV of gauges (time, velocity and position per row).
+  const string filegref=dirout+"CsvBench_GaugeRef.csv";
+  const string filegfast=dirout+"CsvBench_GaugeFast.csv";
+  const string head="time [s];velx [m/s];vely [m/s];velz [m/s];posx [m];posy [m];posz [m]";
+  tm.Start();
+  {
+    const string fmt3=fun::PrintStr("%%g%c%%g%c%%g",sep,sep);
+    string tx=head;
+    if(csvsepcoma)for(unsigned c=0;c<unsigned(tx.size());c++)if(tx[c]==';')tx[c]=sep;
+    tx.push_back('\n');
+    //-JSaveCsv2 always uses ';' between the values added with operator <<.
+    for(unsigned p=0;p<np;p++){
+      tx.append(fun::PrintStr("%g",float(p)*0.0001f)); tx.push_back(';');
+      tx.append(fun::PrintStr(fmt3.c_str(),Vel[p].x,Vel[p].y,Vel[p].z)); tx.push_back(';');
+      tx.append(fun::PrintStr(fmt3.c_str(),Pos[p].x,Pos[p].y,Pos[p].z)); tx.push_back('\n');
+    }
+    std::ofstream pf(filegref.c_str(),std::ios::binary);
+    if(!pf)RunException(met,"Cannot open the file.",filegref);
+    pf.write(tx.c_str(),tx.size());
+    if(pf.fail())RunException(met,"File writing failure.",filegref);
+  }
+  tm.Stop();
+  const double tgref=tm.GetElapsedTimeD()/1000.;
+  tm.Start();
+  {
+    jcsv::JSaveCsv2 scsv(filegfast,false,csvsepcoma);
+    scsv.SetHead();
+    scsv << head << jcsv::Endl();
+    scsv.SetData();
+    scsv << jcsv::Fmt(jcsv::TpFloat1,"%g") << jcsv::Fmt(jcsv::TpFloat3,"%g;%g;%g");
+    for(unsigned p=0;p<np;p++)scsv << float(p)*0.0001f << Vel[p] << Pos[p] << jcsv::Endl();
+    scsv.SaveData(true);
+  }
+  tm.Stop();
+  const double tgfast=tm.GetElapsedTimeD()/1000.;
+  const bool gaugeeq=FilesEqual(filegref,filegfast);
+  printf("\n  Gauge rows in %s:\n",fun::GetFile(filegfast).c_str());
+  PrintSpeed("vsnprintf()",tgref,fun::FileSize(filegref));
+  PrintSpeed("JSaveCsv2",tgfast,fun::FileSize(filegfast));
+  printf("  Speedup: x%.2f   Files: %s\n\n",(tgfast>0? tgref/tgfast: 0.),(gaugeeq? "identical": "DIFFERENT"));
+  FreeData();
+  //-Removes files when they are identical.
+  if(parteq){ remove(filepref.c_str()); remove(filepfast.c_str()); }
+  if(gaugeeq){ remove(filegref.c_str()); remove(filegfast.c_str()); }
+  return(parteq && gaugeeq);
+}
+
+//==============================================================================
+/// Loads VTU file with JSaveVtu::LoadFile() and returns true when points, 
+/// cells and fields are equal to the test data.
+///
+/// Carga fichero VTU con JSaveVtu::LoadFile() y devuelve true cuando los
+/// puntos, celdas y campos son iguales a los datos de prueba.
+//==============================================================================
+bool JFormatCheck::VtuCheckFile(const std::string &file,unsigned nfields
+  ,const JFormatFiles2::StScalarData *fields)const
+{
+  unsigned np=0;
+  std::vector<JSaveVtu::StArrayData> arrays;
+  JSaveVtu(JSaveVtu::ENC_Raw,false).LoadFile(file,np,arrays);
+  bool ok=(np==Np);
+  if(!ok)printf("    Number of points: %u (expected %u)\n",np,Np);
+  unsigned nok=0;
+  for(unsigned ca=0;ok && ca<unsigned(arrays.size());ca++){
+    const JSaveVtu::StArrayData &ar=arrays[ca];
+    const byte *data=(ar.data.empty()? NULL: &ar.data[0]);
+    const ullong size=ullong(ar.data.size());
+    bool eq=true;
+    if(ar.name=="Points"){
+      eq=(ar.type==JFormatFiles2::Float32 && ar.comp==3 && size==ullong(sizeof(tfloat3))*Np && (!size || !memcmp(data,Pos,size_t(size))));
+      nok++;
+    }
+    else if(ar.name=="connectivity" || ar.name=="offsets"){
+      //-One vertex cell per point.
+      const int *v=(const int*)data;
+      eq=(ar.type==JFormatFiles2::Int32 && size==ullong(sizeof(int))*Np);
+      const int inc=(ar.name=="offsets"? 1: 0);
+      for(unsigned p=0;eq && p<Np;p++)eq=(v[p]==int(p)+inc);
+      nok++;
+    }
+    else if(ar.name=="types"){
+      eq=(ar.type==JFormatFiles2::UChar8 && size==Np);
+      for(unsigned p=0;eq && p<Np;p++)eq=(data[p]==1); //-VTK_VERTEX.
+      nok++;
+    }
+    else{
+      unsigned cf=0;
+      for(;cf<nfields && fields[cf].name!=ar.name;cf++);
+      if(cf<nfields){
+        const JFormatFiles2::StScalarData &fd=fields[cf];
+        const ullong fsize=ullong(JSaveVtu::TypeSize(fd.type))*fd.comp*Np;
+        eq=(ar.type==fd.type && ar.comp==fd.comp && size==fsize && (!size || !memcmp(data,fd.pointer,size_t(size))));
+        nok++;
+      }
+      else eq=false;
+    }
+    if(!eq)printf("    Array \'%s\' does not match the original data.\n",ar.name.c_str());
+    ok=eq;
+  }
+  if(ok && nok!=4+nfields){
+    printf("    Number of arrays: %u (expected %u)\n",nok,4+nfields);
+    ok=false;
+  }
+  return(ok);
+}
+
+//==============================================================================
+/// Writes VTU files of test data of np particles with JSaveVtu using all 
+/// encodings (raw and base64, with and without compression) and checks that
+/// the data loaded with JSaveVtu::LoadFile() is identical. Returns true when 
+/// all files are correct. The files are removed when they are correct.
+///
+/// Graba ficheros VTU de datos de prueba de np particulas con JSaveVtu usando
+/// todas las codificaciones (raw y base64, con y sin compresion) y comprueba 
+/// que los datos cargados con JSaveVtu::LoadFile() son identicos. Devuelve true
+/// cuando todos los ficheros son correctos. Los ficheros se borran cuando son
+/// correctos.
+//==============================================================================
+bool JFormatCheck::VtuRoundTrip(const std::string &dir,unsigned np){
+  const char met[]="VtuRoundTrip";
+  if(!np)RunException(met,"Number of particles is zero.");
+  if(!fun::DirExists(dir))RunException(met,"The directory does not exist.",dir);
+  const string dirout=fun::GetDirWithSlash(dir);
+  printf("\nVTU round-trip check with %u particles...\n\n",np);
+  AllocData(np);
+  JFormatFiles2::StScalarData fields[4];
+  fields[0]=JFormatFiles2::DefineField("Idp" ,JFormatFiles2::UInt32 ,1,Idp);
+  fields[1]=JFormatFiles2::DefineField("Vel" ,JFormatFiles2::Float32,3,Vel);
+  fields[2]=JFormatFiles2::DefineField("Rhop",JFormatFiles2::Float32,1,Rhop);
+  fields[3]=JFormatFiles2::DefineField("Type",JFormatFiles2::UChar8 ,1,Type);
+  bool ok=true;
+  JTimer tm;
+  for(unsigned cm=0;cm<4;cm++){
+    const JSaveVtu::TpEncoding encoding=(cm<2? JSaveVtu::ENC_Raw: JSaveVtu::ENC_Base64);
+    const bool compress=((cm&1)!=0);
+    const string mode=JSaveVtu::GetEncodingStr(encoding)+(compress? "+lz4": "");
+    const string file=dirout+"VtuCheck_"+JSaveVtu::GetEncodingStr(encoding)+(compress? "_lz4": "")+".vtu";
+    tm.Start();
+    JSaveVtu(encoding,compress).SaveFile(file,np,Pos,4,fields);
+    tm.Stop();
+    const double tsave=tm.GetElapsedTimeD()/1000.;
+    tm.Start();
+    const bool fileok=VtuCheckFile(file,4,fields);
+    tm.Stop();
+    const double tcheck=tm.GetElapsedTimeD()/1000.;
+    printf("  %-12s %11s bytes   save:%7.3f s   load+check:%7.3f s   %s\n",mode.c_str()
+      ,fun::LongStr(fun::FileSize(file)).c_str(),tsave,tcheck,(fileok? "ok": "FAILED"));
+    if(fileok)remove(file.c_str());
+    ok=(ok && fileok);
+  }
+  printf("\n");
+  FreeData();
+  return(ok);
+}
+
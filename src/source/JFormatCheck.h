@@ -0,0 +1,70 @@
+//HEAD_DSPH
+/*
+ <DUALSPHYSICS>  Copyright (c) 2019 by Dr Jose M. Dominguez et al. (see http://dual.sphysics.org/index.php/developers/). 
+
+ EPHYSLAB Environmental Physics Laboratory, Universidade de Vigo, Ourense, Spain.
+ School of Mechanical, Aerospace and Civil Engineering, University of Manchester, Manchester, U.K.
+
+ This file is part of DualSPHysics. 
+
+ DualSPHysics is free software: you can redistribute it and/or modify it under the terms of the GNU Lesser General Public License 
+ as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) any later version.
+ 
+ DualSPHysics is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details. 
+
+ You should have received a copy of the GNU Lesser General Public License along with DualSPHysics. If not, see <http://www.gnu.org/licenses/>. 
+*/
+
+//:#############################################################################
+//:# Cambios:
+//:# =========
+//:# - Clase para medir el rendimiento de la escritura de ficheros CSV y
+//:#   comprobar que el resultado es identico al del codigo anterior. (18-10-2026)
+//:# - Comprobacion de ida y vuelta de ficheros VTU con JSaveVtu. (18-10-2026)
+//:#############################################################################
+
+/// \file JFormatCheck.h \brief Declares the class \ref JFormatCheck.
+
+#ifndef _JFormatCheck_
+#define _JFormatCheck_
+
+#include <string>
+#include "TypesDef.h"
+#include "JObject.h"
+#include "JFormatFiles2.h"
+
+//##############################################################################
+//# JFormatCheck
+//##############################################################################
+/// \brief Measures the writing of output files and checks that the result is
+/// identical to the one of the reference implementation.
+
+class JFormatCheck : protected JObject
+{
+protected:
+  unsigned Np;           ///<Number of particles or rows of test data.
+  tfloat3 *Pos;          ///<Position of particles [Np].
+  unsigned *Idp;         ///<Identifier of particles [Np].
+  tfloat3 *Vel;          ///<Velocity of particles [Np].
+  float *Rhop;           ///<Density of particles [Np].
+  byte *Type;            ///<Type of particles [Np].
+
+  void AllocData(unsigned np);
+  void FreeData();
+  bool FilesEqual(const std::string &file1,const std::string &file2)const;
+  bool VtuCheckFile(const std::string &file,unsigned nfields,const JFormatFiles2::StScalarData *fields)const;
+  void PrintSpeed(const char *name,double seconds,llong size)const;
+
+public:
+  JFormatCheck();
+  ~JFormatCheck();
+  void Reset();
+
+  bool CsvBenchmark(const std::string &dir,unsigned np,bool csvsepcoma);
+  bool VtuRoundTrip(const std::string &dir,unsigned np);
+};
+
+#endif
+
+
@@ -0,0 +1,466 @@
+//HEAD_DSPH
+/*
+ <DUALSPHYSICS>  Copyright (c) 2019 by Dr Jose M. Dominguez et al. (see http://dual.sphysics.org/index.php/developers/). 
+
+ EPHYSLAB Environmental Physics Laboratory, Universidade de Vigo, Ourense, Spain.
+ School of Mechanical, Aerospace and Civil Engineering, University of Manchester, Manchester, U.K.
+
+ This file is part of DualSPHysics. 
+
+ DualSPHysics is free software: you can redistribute it and/or modify it under the terms of the GNU Lesser General Public License 
+ as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) any later version.
+ 
+ DualSPHysics is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details. 
+
+ You should have received a copy of the GNU Lesser General Public License along with DualSPHysics. If not, see <http://www.gnu.org/licenses/>. 
+*/
+
+
+/// \file JGaugeBi4.cpp \brief Implements the classes \ref JGaugeBi4Save and \ref JGaugeBi4Load.
+
+#include "JGaugeBi4.h"
+#include "JException.h"
+#include "JSaveCsv2.h"
+#include "Functions.h"
+#include <cstring>
+#include <climits>
+
+using namespace std;
+
+//##############################################################################
+//# JGaugeBi4Save
+//##############################################################################
+//==============================================================================
+/// Constructor. Starts the writer thread.
+//==============================================================================
+JGaugeBi4Save::JGaugeBi4Save(const std::string &appname,const std::string &file)
+  :AppName(appname),File(file)
+{
+  ClassName="JGaugeBi4Save";
+  Data=new JBinaryData("JGaugeBi4");
+  GaugeCount=0;
+  InitialSaved=false;
+  Busy=0;
+  Finish=false;
+  BlockCount=0;
+  RecordCount=0;
+  Writer=std::thread(&JGaugeBi4Save::RunWriter,this);
+}
+
+//==============================================================================
+/// Destructor. Pending blocks are written before finishing the writer thread.
+/// Destructor. Los bloques pendientes se graban antes de terminar el hilo.
+//==============================================================================
+JGaugeBi4Save::~JGaugeBi4Save(){
+  DestructorActive=true;
+  {
+    std::lock_guard<std::mutex> lock(Mtx);
+    Finish=true;
+  }
+  CondPending.notify_all();
+  if(Writer.joinable())Writer.join();
+  for(unsigned c=0;c<unsigned(Pending.size());c++)delete Pending[c];
+  Pending.clear();
+  delete Data; Data=NULL;
+}
+
+//==============================================================================
+/// Main loop of the writer thread. Exceptions are stored to be thrown by the 
+/// main thread and next blocks are discarded.
+///
+/// Bucle principal del hilo de escritura. Las excepciones se almacenan para
+/// lanzarlas en el hilo principal y los siguientes bloques se descartan.
+//==============================================================================
+void JGaugeBi4Save::RunWriter(){
+  for(;;){
+    JBinaryData *blk=NULL;
+    bool skip=false;
+    {
+      std::unique_lock<std::mutex> lock(Mtx);
+      while(!Finish && Pending.empty())CondPending.wait(lock);
+      if(Pending.empty())break;
+      blk=Pending.front(); Pending.pop_front();
+      Busy++;
+      skip=!ErrorText.empty();
+    }
+    string error;
+    if(!skip){
+      try{
+        blk->SaveFileListApp(File,"JGaugeBi4",true,true);
+      }
+      catch(const JException &e){ error=e.ToStr(); }
+      catch(const std::exception &e){ error=e.what(); }
+      catch(...){ error="Unknown error."; }
+    }
+    delete blk;
+    {
+      std::lock_guard<std::mutex> lock(Mtx);
+      if(!error.empty() && ErrorText.empty())ErrorText=error;
+      Busy--;
+    }
+    CondDone.notify_all();
+  }
+}
+
+//==============================================================================
+/// Throws exception when the writer thread failed.
+/// Lanza excepcion cuando el hilo de escritura fallo.
+//==============================================================================
+void JGaugeBi4Save::CheckError(const std::string &method){
+  string error;
+  {
+    std::lock_guard<std::mutex> lock(Mtx);
+    error=ErrorText;
+  }
+  if(!error.empty())RunException(method,string("Error writing results of gauges in background: ")+error,File);
+}
+
+//==============================================================================
+/// Adds gauge to the head of the file. Gauges must be added in order of index.
+/// Anhade medida a la cabecera del fichero en orden de indice.
+//==============================================================================
+void JGaugeBi4Save::AddGauge(unsigned idx,const std::string &name,const std::string &type){
+  const char met[]="AddGauge";
+  if(InitialSaved)RunException(met,"The head of file was already saved.",File);
+  if(idx!=GaugeCount)RunException(met,"The index of gauge is invalid.",File);
+  JBinaryData *item=Data->CreateItem(fun::PrintStr("Gauge_%04u",idx));
+  item->SetvUint("Idx",idx);
+  item->SetvText("Name",name);
+  item->SetvText("Type",type);
+  GaugeCount++;
+}
+
+//==============================================================================
+/// Creates the file with the head (list of gauges).
+/// Crea el fichero con la cabecera (lista de medidas).
+//==============================================================================
+void JGaugeBi4Save::SaveInitial(){
+  if(!InitialSaved){
+    Data->SetvText("AppName",AppName);
+    Data->SetvUint("FormatVer",FormatVerDef);
+    Data->SetvUint("GaugeCount",GaugeCount);
+    Data->SaveFile(File,true,false);
+    InitialSaved=true;
+  }
+}
+
+//==============================================================================
+/// Uses the file of a previous execution truncated to fsize (restart from 
+/// checkpoint) instead of creating a new one, so new blocks are appended.
+/// Returns false when the file is not available.
+///
+/// Usa el fichero de una ejecucion anterior recortado a fsize (reinicio desde
+/// checkpoint) en lugar de crear uno nuevo, de forma que los nuevos bloques se
+/// anhaden. Devuelve false cuando el fichero no esta disponible.
+//==============================================================================
+bool JGaugeBi4Save::RestoreFile(llong fsize,unsigned blockcount,ullong recordcount){
+  if(InitialSaved)RunException("RestoreFile","The head of file was already saved.",File);
+  const bool ok=(fsize>0 && fun::FileSize(File)>=fsize && fun::FileTruncate(File,fsize));
+  if(ok){
+    InitialSaved=true;
+    BlockCount=blockcount;
+    RecordCount=recordcount;
+  }
+  return(ok);
+}
+
+//==============================================================================
+/// Waits for pending blocks and returns the size of the file (-1 when it does 
+/// not exist).
+/// Espera los bloques pendientes y devuelve el tamanho del fichero (-1 cuando
+/// no existe).
+//==============================================================================
+llong JGaugeBi4Save::GetFileSize(){
+  WaitAll();
+  return(InitialSaved? fun::FileSize(File): -1);
+}
+
+//==============================================================================
+/// Returns new block for count results of the gauge idx. The block must be 
+/// given to PushBlock() after adding the columns.
+///
+/// Devuelve un nuevo bloque para count resultados de la medida idx que debe
+/// entregarse a PushBlock() despues de anhadir las columnas.
+//==============================================================================
+JBinaryData* JGaugeBi4Save::NewBlock(unsigned idx,unsigned count){
+  CheckError("NewBlock");
+  if(idx>=GaugeCount)RunException("NewBlock","The index of gauge is invalid.",File);
+  JBinaryData *blk=new JBinaryData("Block");
+  blk->SetvUint("Gauge",idx);
+  blk->SetvUint("Count",count);
+  return(blk);
+}
+
+//==============================================================================
+/// Adds typed column to block with memory for all results and the format
+/// used to export the values to CSV.
+///
+/// Anhade columna tipada al bloque con memoria para todos los resultados y el
+/// formato usado para exportar los valores a CSV.
+//==============================================================================
+JBinaryDataArray* JGaugeBi4Save::AddColumn(JBinaryData *blk,const std::string &name
+  ,JBinaryDataDef::TpData type,const std::string &fmt)
+{
+  blk->SetvText(fun::PrintStr("Fmt%u",blk->GetArraysCount()),fmt);
+  JBinaryDataArray *ar=blk->CreateArray(name,type);
+  ar->AllocMemory(blk->GetvUint("Count"));
+  return(ar);
+}
+
+//==============================================================================
+/// Adds block to the queue of the writer thread, which takes ownership of it.
+/// Anhade bloque a la cola del hilo de escritura, que pasa a ser su dueno.
+//==============================================================================
+void JGaugeBi4Save::PushBlock(JBinaryData *blk){
+  const char met[]="PushBlock";
+  if(!InitialSaved)SaveInitial();
+  const unsigned count=blk->GetvUint("Count");
+  for(unsigned ca=0;ca<blk->GetArraysCount();ca++)if(blk->GetArray(ca)->GetCount()!=count){
+    delete blk;
+    RunException(met,"The number of values of columns does not match the number of results.",File);
+  }
+  {
+    std::lock_guard<std::mutex> lock(Mtx);
+    Pending.push_back(blk);
+    BlockCount++;
+    RecordCount+=count;
+  }
+  CondPending.notify_one();
+}
+
+//==============================================================================
+/// Waits until all pending blocks are written.
+/// Espera hasta que todos los bloques pendientes se graben.
+//==============================================================================
+void JGaugeBi4Save::WaitAll(){
+  {
+    std::unique_lock<std::mutex> lock(Mtx);
+    while(!Pending.empty() || Busy)CondDone.wait(lock);
+  }
+  CheckError("WaitAll");
+}
+
+
+//##############################################################################
+//# JGaugeBi4Load
+//##############################################################################
+//==============================================================================
+/// Constructor.
+//==============================================================================
+JGaugeBi4Load::JGaugeBi4Load(){
+  ClassName="JGaugeBi4Load";
+  Data=NULL;
+  Reset();
+}
+
+//==============================================================================
+/// Destructor.
+//==============================================================================
+JGaugeBi4Load::~JGaugeBi4Load(){
+  DestructorActive=true;
+  Reset();
+  delete Data; Data=NULL;
+}
+
+//==============================================================================
+/// Initialisation of variables.
+//==============================================================================
+void JGaugeBi4Load::Reset(){
+  FormatVer=0;
+  delete Data;
+  Data=new JBinaryData("JGaugeBi4");
+  File=AppName="";
+  GaugeName.clear();
+  GaugeType.clear();
+  GaugeBlocks.clear();
+  GaugeRecords.clear();
+}
+
+//==============================================================================
+/// Throws exception when the gauge number is invalid.
+//==============================================================================
+void JGaugeBi4Load::CheckGauge(unsigned cg)const{
+  if(cg>=GetGaugeCount())RunException("CheckGauge","Number of gauge is invalid.",File);
+}
+
+//==============================================================================
+/// Loads file and builds the index of data blocks of each gauge.
+/// Carga fichero y construye el indice de bloques de datos de cada medida.
+//==============================================================================
+void JGaugeBi4Load::LoadFile(const std::string &file){
+  const char met[]="LoadFile";
+  Reset();
+  File=file;
+  Data->LoadFileListApp(file,"JGaugeBi4",true);
+  JBinaryData *head=Data->GetItem("LS0000_JGaugeBi4");
+  if(!head)RunException(met,"The head item is missing.",file);
+  FormatVer=head->GetvUint("FormatVer",true,0);
+  if(FormatVer<FormatVerDef)RunException(met,fun::PrintStr("The data format version \'%u\' is not valid. Version \'%u\' required.",FormatVer,FormatVerDef),file);
+  AppName=head->GetvText("AppName",true);
+  const unsigned ng=head->GetvUint("GaugeCount");
+  for(unsigned cg=0;cg<ng;cg++){
+    JBinaryData *item=head->GetItem(fun::PrintStr("Gauge_%04u",cg));
+    if(!item)RunException(met,fun::PrintStr("The definition of gauge %u is missing.",cg),file);
+    GaugeName.push_back(item->GetvText("Name"));
+    GaugeType.push_back(item->GetvText("Type"));
+  }
+  GaugeBlocks.resize(ng);
+  GaugeRecords.resize(ng,0);
+  //-Builds index of blocks.
+  const unsigned nitems=Data->GetItemsCount();
+  for(unsigned c=1;c<nitems;c++){
+    JBinaryData *blk=Data->GetItem(c);
+    const unsigned cg=blk->GetvUint("Gauge");
+    if(cg>=ng)RunException(met,fun::PrintStr("The gauge of block %u is invalid.",c),file);
+    if(!GaugeBlocks[cg].empty() && GaugeBlocks[cg][0]->GetArraysCount()!=blk->GetArraysCount())RunException(met,fun::PrintStr("The columns of block %u do not match the previous blocks of gauge.",c),file);
+    GaugeBlocks[cg].push_back(blk);
+    GaugeRecords[cg]+=blk->GetvUint("Count");
+  }
+}
+
+//==============================================================================
+/// Returns index of gauge with the given name (UINT_MAX when it is missing).
+//==============================================================================
+unsigned JGaugeBi4Load::GetGaugeIdx(const std::string &name)const{
+  unsigned cg=0;
+  for(;cg<GetGaugeCount() && GaugeName[cg]!=name;cg++);
+  return(cg<GetGaugeCount()? cg: UINT_MAX);
+}
+
+//==============================================================================
+/// Returns number of columns of results of gauge (0 when there are not results).
+//==============================================================================
+unsigned JGaugeBi4Load::GetColumnCount(unsigned cg)const{
+  CheckGauge(cg);
+  return(GaugeBlocks[cg].empty()? 0: GaugeBlocks[cg][0]->GetArraysCount());
+}
+
+//==============================================================================
+/// Returns array of column col in block cb of gauge cg.
+//==============================================================================
+const JBinaryDataArray* JGaugeBi4Load::GetColumnArray(unsigned cg,unsigned col,unsigned cb)const{
+  if(col>=GetColumnCount(cg))RunException("GetColumnArray","Number of column is invalid.",File);
+  return(GaugeBlocks[cg][cb]->GetArray(col));
+}
+
+//==============================================================================
+/// Returns name of column with the CSV header (including units).
+//==============================================================================
+std::string JGaugeBi4Load::GetColumnName(unsigned cg,unsigned col)const{
+  return(GetColumnArray(cg,col,0)->GetName());
+}
+
+//==============================================================================
+/// Returns type of data of column.
+//==============================================================================
+JBinaryDataDef::TpData JGaugeBi4Load::GetColumnType(unsigned cg,unsigned col)const{
+  return(GetColumnArray(cg,col,0)->GetType());
+}
+
+//==============================================================================
+/// Loads values of column of all results as double and returns the number of
+/// values per result (3 for triple types).
+///
+/// Carga los valores de la columna de todos los resultados como double y 
+/// devuelve el numero de valores por resultado (3 para tipos triples).
+//==============================================================================
+unsigned JGaugeBi4Load::GetColumnValues(unsigned cg,unsigned col,std::vector<double> &values)const{
+  const char met[]="GetColumnValues";
+  const JBinaryDataDef::TpData type=GetColumnType(cg,col);
+  const unsigned dim=(JBinaryDataDef::TypeIsTriple(type)? 3: 1);
+  values.clear();
+  values.reserve(size_t(GaugeRecords[cg])*dim);
+  const unsigned nb=unsigned(GaugeBlocks[cg].size());
+  for(unsigned cb=0;cb<nb;cb++){
+    const JBinaryDataArray *ar=GetColumnArray(cg,col,cb);
+    if(ar->GetType()!=type)RunException(met,"The type of column does not match in all blocks.",File);
+    const unsigned n=ar->GetCount()*dim;
+    const void *ptr=ar->GetDataPointer();
+    for(unsigned c=0;c<n;c++)switch(type){
+      case JBinaryDataDef::DatInt:
+      case JBinaryDataDef::DatInt3:     values.push_back(double(((const int*)ptr)[c]));       break;
+      case JBinaryDataDef::DatUint:
+      case JBinaryDataDef::DatUint3:    values.push_back(double(((const unsigned*)ptr)[c]));  break;
+      case JBinaryDataDef::DatFloat:
+      case JBinaryDataDef::DatFloat3:   values.push_back(double(((const float*)ptr)[c]));     break;
+      case JBinaryDataDef::DatDouble:
+      case JBinaryDataDef::DatDouble3:  values.push_back(((const double*)ptr)[c]);            break;
+      default: RunException(met,string("Type of column is not supported: ")+JBinaryDataDef::TypeToStr(type),File);
+    }
+  }
+  return(dim);
+}
+
+//==============================================================================
+/// Returns name of CSV file saved by the gauge during the simulation.
+//==============================================================================
+std::string JGaugeBi4Load::GetFileCsv(unsigned cg,const std::string &dir)const{
+  CheckGauge(cg);
+  return(fun::GetDirWithSlash(dir)+"Gauges"+GaugeType[cg]+"_"+GaugeName[cg]+".csv");
+}
+
+//==============================================================================
+/// Saves results of gauge in CSV file with the same format used by the gauge.
+/// Graba resultados de la medida en fichero CSV con el formato de la medida.
+//==============================================================================
+void JGaugeBi4Load::SaveCsv(unsigned cg,const std::string &file,bool csvsepcoma)const{
+  const char met[]="SaveCsv";
+  const unsigned ncol=GetColumnCount(cg);
+  jcsv::JSaveCsv2 scsv(file,false,csvsepcoma);
+  //-Saves head.
+  string head;
+  for(unsigned col=0;col<ncol;col++)head=head+(col? ";": "")+GetColumnName(cg,col);
+  scsv.SetHead();
+  scsv << head << jcsv::Endl();
+  //-Saves data.
+  scsv.SetData();
+  const unsigned nb=unsigned(GaugeBlocks[cg].size());
+  for(unsigned cb=0;cb<nb;cb++){
+    const JBinaryData *blk=GaugeBlocks[cg][cb];
+    const unsigned count=blk->GetvUint("Count");
+    std::vector<const JBinaryDataArray*> ars(ncol);
+    std::vector<string> fmts(ncol);
+    for(unsigned col=0;col<ncol;col++){
+      ars[col]=GetColumnArray(cg,col,cb);
+      if(ars[col]->GetType()!=GetColumnType(cg,col) || ars[col]->GetCount()!=count)RunException(met,fun::PrintStr("The column %u of block %u is invalid.",col,cb),File);
+      fmts[col]=blk->GetvText(fun::PrintStr("Fmt%u",col),true);
+    }
+    for(unsigned c=0;c<count;c++){
+      for(unsigned col=0;col<ncol;col++){
+        const void *ptr=ars[col]->GetDataPointer();
+        const string &fmt=fmts[col];
+        switch(ars[col]->GetType()){
+          case JBinaryDataDef::DatInt:      if(!fmt.empty())scsv << jcsv::Fmt(jcsv::TpSigned1  ,fmt);  scsv << ((const int*)     ptr)[c];  break;
+          case JBinaryDataDef::DatUint:     if(!fmt.empty())scsv << jcsv::Fmt(jcsv::TpUnsigned1,fmt);  scsv << ((const unsigned*)ptr)[c];  break;
+          case JBinaryDataDef::DatFloat:    if(!fmt.empty())scsv << jcsv::Fmt(jcsv::TpFloat1   ,fmt);  scsv << ((const float*)   ptr)[c];  break;
+          case JBinaryDataDef::DatDouble:   if(!fmt.empty())scsv << jcsv::Fmt(jcsv::TpDouble1  ,fmt);  scsv << ((const double*)  ptr)[c];  break;
+          case JBinaryDataDef::DatInt3:     if(!fmt.empty())scsv << jcsv::Fmt(jcsv::TpSigned3  ,fmt);  scsv << ((const tint3*)   ptr)[c];  break;
+          case JBinaryDataDef::DatUint3:    if(!fmt.empty())scsv << jcsv::Fmt(jcsv::TpUnsigned3,fmt);  scsv << ((const tuint3*)  ptr)[c];  break;
+          case JBinaryDataDef::DatFloat3:   if(!fmt.empty())scsv << jcsv::Fmt(jcsv::TpFloat3   ,fmt);  scsv << ((const tfloat3*) ptr)[c];  break;
+          case JBinaryDataDef::DatDouble3:  if(!fmt.empty())scsv << jcsv::Fmt(jcsv::TpDouble3  ,fmt);  scsv << ((const tdouble3*)ptr)[c];  break;
+          default: RunException(met,string("Type of column is not supported: ")+JBinaryDataDef::TypeToStr(ars[col]->GetType()),File);
+        }
+      }
+      scsv << jcsv::Endl();
+    }
+  }
+  scsv.SaveData(true);
+}
+
+//==============================================================================
+/// Saves results of all gauges in CSV files of directory dir and returns the
+/// number of created files (gauges without results are ignored).
+///
+/// Graba los resultados de todas las medidas en ficheros CSV del directorio
+/// dir y devuelve el numero de ficheros creados.
+//==============================================================================
+unsigned JGaugeBi4Load::SaveCsv(const std::string &dir,bool csvsepcoma)const{
+  unsigned nfiles=0;
+  for(unsigned cg=0;cg<GetGaugeCount();cg++)if(GetColumnCount(cg)){
+    SaveCsv(cg,GetFileCsv(cg,dir),csvsepcoma);
+    nfiles++;
+  }
+  return(nfiles);
+}
+
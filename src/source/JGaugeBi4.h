@@ -0,0 +1,164 @@
+//HEAD_DSPH
+/*
+ <DUALSPHYSICS>  Copyright (c) 2019 by Dr Jose M. Dominguez et al. (see http://dual.sphysics.org/index.php/developers/). 
+
+ EPHYSLAB Environmental Physics Laboratory, Universidade de Vigo, Ourense, Spain.
+ School of Mechanical, Aerospace and Civil Engineering, University of Manchester, Manchester, U.K.
+
+ This file is part of DualSPHysics. 
+
+ DualSPHysics is free software: you can redistribute it and/or modify it under the terms of the GNU Lesser General Public License 
+ as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) any later version.
+ 
+ DualSPHysics is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details. 
+
+ You should have received a copy of the GNU Lesser General Public License along with DualSPHysics. If not, see <http://www.gnu.org/licenses/>. 
+*/
+
+
+//:#############################################################################
+//:# Descripcion:
+//:# =============
+//:# Clase JGaugeBi4Save para grabar los resultados de todas las medidas en un
+//:# unico fichero binario (Gauges.gbi4) desde un hilo en segundo plano.
+//:# Clase JGaugeBi4Load para recuperar los resultados y convertirlos a CSV.
+//:# Estructura del fichero:
+//:# - Cabecera con la lista de medidas (nombre y tipo) que sirve de indice.
+//:# - Bloques con Gauge (indice de la medida), Count (numero de registros) y
+//:#   un array tipado por columna de resultados con el formato CSV de cada 
+//:#   columna (valores Fmt0, Fmt1...).
+//:#
+//:# Cambios:
+//:# =========
+//:# - Implementacion. (18-10-2026)
+//:# - Metodo RestoreFile() para continuar el fichero al reiniciar desde 
+//:#   checkpoint. (18-10-2026)
+//:#############################################################################
+
+/// \file JGaugeBi4.h \brief Declares the classes \ref JGaugeBi4Save and \ref JGaugeBi4Load.
+
+#ifndef _JGaugeBi4_
+#define _JGaugeBi4_
+
+#include "JObject.h"
+#include "TypesDef.h"
+#include "JBinaryData.h"
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+
+//##############################################################################
+//# JGaugeBi4Save
+//##############################################################################
+/// \brief Writes the results of all gauges in one binary file.
+/// Each gauge stores its buffered results as a block with one typed array per 
+/// column. Blocks are appended to the file by a background thread so the 
+/// simulation does not wait for the disk.
+
+class JGaugeBi4Save : protected JObject
+{
+private:
+  static const unsigned FormatVerDef=261018;  ///<Version de formato by default. Version of format by default.
+
+  const std::string AppName;  ///<Nombre de aplicacion. Application Name.
+  const std::string File;     ///<Output file.
+  JBinaryData *Data;          ///<Head with the list of gauges (index of the file).
+  unsigned GaugeCount;        ///<Number of gauges in head.
+  bool InitialSaved;          ///<Indicates if head is recorded.
+
+  //-Variables of writer thread.
+  std::deque<JBinaryData*> Pending; ///<Blocks waiting to be written in order.
+  unsigned Busy;                   ///<Number of blocks being written.
+  bool Finish;                     ///<The writer thread must finish.
+  std::string ErrorText;           ///<Error of the writer thread.
+  std::mutex Mtx;
+  std::condition_variable CondPending;
+  std::condition_variable CondDone;
+  std::thread Writer;
+
+  //-Statistics.
+  unsigned BlockCount;             ///<Number of stored blocks.
+  ullong RecordCount;              ///<Number of stored records.
+
+  void RunWriter();
+  void CheckError(const std::string &method);
+
+public:
+  JGaugeBi4Save(const std::string &appname,const std::string &file);
+  ~JGaugeBi4Save();
+
+  static std::string GetFileName(){ return("Gauges.gbi4"); }
+  std::string GetFile()const{ return(File); }
+
+  void AddGauge(unsigned idx,const std::string &name,const std::string &type);
+  void SaveInitial();
+  bool RestoreFile(llong fsize,unsigned blockcount,ullong recordcount);
+  llong GetFileSize();
+
+  JBinaryData* NewBlock(unsigned idx,unsigned count);
+  static JBinaryDataArray* AddColumn(JBinaryData *blk,const std::string &name,JBinaryDataDef::TpData type,const std::string &fmt);
+  void PushBlock(JBinaryData *blk);
+  void WaitAll();
+
+  unsigned GetBlockCount()const{ return(BlockCount); }
+  ullong GetRecordCount()const{ return(RecordCount); }
+};
+
+
+//##############################################################################
+//# JGaugeBi4Load
+//##############################################################################
+/// \brief Reads the results of gauges saved by \ref JGaugeBi4Save and exports 
+/// them to the CSV files written by each gauge.
+
+class JGaugeBi4Load : protected JObject
+{
+private:
+  static const unsigned FormatVerDef=261018;  ///<Version de formato by default. Version of format by default.
+  unsigned FormatVer;     ///<Version de formato. Format version.
+
+  JBinaryData *Data;      ///<Contents of the file.
+  std::string File;
+  std::string AppName;
+
+  std::vector<std::string> GaugeName;
+  std::vector<std::string> GaugeType;
+  std::vector< std::vector<JBinaryData*> > GaugeBlocks; ///<Index with the data blocks of each gauge.
+  std::vector<unsigned> GaugeRecords;                    ///<Number of records of each gauge.
+
+  void CheckGauge(unsigned cg)const;
+  const JBinaryDataArray* GetColumnArray(unsigned cg,unsigned col,unsigned cb)const;
+
+public:
+  JGaugeBi4Load();
+  ~JGaugeBi4Load();
+  void Reset();
+
+  void LoadFile(const std::string &file);
+
+  std::string GetAppName()const{ return(AppName); }
+  unsigned GetGaugeCount()const{ return(unsigned(GaugeName.size())); }
+  unsigned GetGaugeIdx(const std::string &name)const;
+  std::string GetGaugeName(unsigned cg)const{ CheckGauge(cg); return(GaugeName[cg]); }
+  std::string GetGaugeType(unsigned cg)const{ CheckGauge(cg); return(GaugeType[cg]); }
+  unsigned GetRecordCount(unsigned cg)const{ CheckGauge(cg); return(GaugeRecords[cg]); }
+
+  unsigned GetColumnCount(unsigned cg)const;
+  std::string GetColumnName(unsigned cg,unsigned col)const;
+  JBinaryDataDef::TpData GetColumnType(unsigned cg,unsigned col)const;
+  unsigned GetColumnValues(unsigned cg,unsigned col,std::vector<double> &values)const;
+
+  std::string GetFileCsv(unsigned cg,const std::string &dir)const;
+  void SaveCsv(unsigned cg,const std::string &file,bool csvsepcoma)const;
+  unsigned SaveCsv(const std::string &dir,bool csvsepcoma)const;
+};
+
+
+#endif
+
+
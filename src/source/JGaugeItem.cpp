@@ -25,6 +25,9 @@
 #include "Functions.h"
 #include "FunctionsGeo3d.h"
 #include "JFormatFiles2.h"
+#include "JBinaryData.h"
+#include "JSaveVtu.h"
+#include "JGaugeBi4.h"
 #ifdef _WITHGPU
   #include "FunctionsCuda.h"
   #include "JGauge_ker.h"
@@ -61,6 +64,7 @@ void JGaugeItem::Reset(){
   TimeStep=0;
   OutCount=0;
   OutFile="";
+  OutBin=NULL;
 }
 
 //==============================================================================
@@ -118,6 +122,10 @@ std::string JGaugeItem::GetNameType(TpGauge type){
     case GAUGE_Swl:   return("SWL");
     case GAUGE_MaxZ:  return("MaxZ");
     case GAUGE_Force: return("Force");
+    case GAUGE_Mesh:  return("Mesh");
+    case GAUGE_Isosurface: return("Isosurface");
+    case GAUGE_Flow:  return("Flow");
+    case GAUGE_Pressure: return("Pressure");
   }
   return("???");
 }
@@ -153,6 +161,37 @@ void JGaugeItem::GetConfig(std::vector<std::string> &lines)const{
     lines.push_back(fun::PrintStr("MkBound.....: %u (%s particles)",gau->GetMkBound(),TpPartGetStrCode(gau->GetTypeParts())));
     lines.push_back(fun::PrintStr("Particles id: %u - %u",gau->GetIdBegin(),gau->GetIdBegin()+gau->GetCount()-1));
   }
+  else if(Type==GAUGE_Mesh){
+    const JGaugeMesh* gau=(JGaugeMesh*)this;
+    const tuint3 np=gau->GetPointNp();
+    lines.push_back(fun::PrintStr("GaugePoints: %s",fun::Double3gRangeStr(gau->GetPoint0(),gau->GetPoint2()).c_str()));
+    lines.push_back(fun::PrintStr("PointDp....: %g",gau->GetPointDp()));
+    lines.push_back(fun::PrintStr("Nodes......: %u x %u x %u = %u",np.x,np.y,np.z,gau->GetNodeCount()));
+    lines.push_back(fun::PrintStr("KcLimit....: %g",gau->GetKcLimit()));
+  }
+  else if(Type==GAUGE_Isosurface){
+    const JGaugeIsosurface* gau=(JGaugeIsosurface*)this;
+    const tuint3 np=gau->GetPointNp();
+    lines.push_back(fun::PrintStr("GaugePoints: %s",fun::Double3gRangeStr(gau->GetPoint0(),gau->GetPoint2()).c_str()));
+    lines.push_back(fun::PrintStr("PointDp....: %g",gau->GetPointDp()));
+    lines.push_back(fun::PrintStr("Nodes......: %u x %u x %u = %u",np.x,np.y,np.z,gau->GetNodeCount()));
+    lines.push_back(fun::PrintStr("MassLimit..: %g",gau->GetMassLimit()));
+  }
+  else if(Type==GAUGE_Flow){
+    const JGaugeFlow* gau=(JGaugeFlow*)this;
+    for(unsigned c=0;c<gau->GetPointsCount();c++)lines.push_back(fun::PrintStr("Point_%u....: (%g,%g,%g)",c,gau->GetPoint(c).x,gau->GetPoint(c).y,gau->GetPoint(c).z));
+    lines.push_back(fun::PrintStr("Normal.....: (%g,%g,%g)",gau->GetNormal().x,gau->GetNormal().y,gau->GetNormal().z));
+    lines.push_back(fun::PrintStr("%s: %g",(Simulate2D? "Length.....": "Area.......") ,gau->GetArea()));
+    lines.push_back(fun::PrintStr("PointDp....: %g   Points:%u",gau->GetPointDp(),gau->GetNodeCount()));
+    lines.push_back(fun::PrintStr("KcLimit....: %g",gau->GetKcLimit()));
+  }
+  else if(Type==GAUGE_Pressure){
+    const JGaugePressure* gau=(JGaugePressure*)this;
+    lines.push_back(fun::PrintStr("MkBound.....: %u (%s particles)",gau->GetMkBound(),TpPartGetStrCode(gau->GetTypeParts())));
+    lines.push_back(fun::PrintStr("Particles id: %u - %u",gau->GetIdBegin(),gau->GetIdBegin()+gau->GetCount()-1));
+    lines.push_back(fun::PrintStr("Decimation..: %u   Points:%u",gau->GetDecimation(),gau->GetNodeCount()));
+    lines.push_back(fun::PrintStr("KcLimit.....: %g",gau->GetKcLimit()));
+  }
   else RunException(met,"Type unknown.");
 }
 
@@ -190,6 +229,43 @@ void JGaugeItem::SaveResults(unsigned cpart){
   if(SaveVtkPart)SaveVtkResult(cpart);
 }
 
+//==============================================================================
+/// Stores state of output files in checkpoint data. Results in buffer must be 
+/// saved before (OutCount=0).
+/// Guarda estado de los ficheros de salida en datos de checkpoint. Los 
+/// resultados del buffer deben grabarse antes (OutCount=0).
+//==============================================================================
+void JGaugeItem::SaveCheckpoint(JBinaryData *item)const{
+  if(OutCount)RunException("SaveCheckpoint","Results in buffer must be saved before the checkpoint.");
+  item->SetvUint("OutNum",GetOutNum());
+  item->SetvText("OutFile",(OutFile.empty()? string(""): fun::GetFile(OutFile)));
+  item->SetvLlong("OutFileSize",(OutFile.empty()? 0: fun::FileSize(OutFile)));
+}
+
+//==============================================================================
+/// Restores state of output files from checkpoint. The results file of the 
+/// previous execution is truncated to its size in the checkpoint and the new 
+/// results are appended. A new file is created when it is not available.
+///
+/// Restaura estado de los ficheros de salida desde checkpoint. El fichero de
+/// resultados de la ejecucion anterior se recorta a su tamanho en el checkpoint
+/// y los nuevos resultados se anhaden. Se crea un nuevo fichero cuando no esta
+/// disponible.
+//==============================================================================
+void JGaugeItem::LoadCheckpoint(const JBinaryData *item){
+  SetOutNum(item->GetvUint("OutNum"));
+  const string file=item->GetvText("OutFile");
+  if(!file.empty()){
+    const string filefull=AppInfo.GetDirOut()+file;
+    const llong fsize=item->GetvLlong("OutFileSize");
+    if(fun::FileSize(filefull)>=fsize && fun::FileTruncate(filefull,fsize)){
+      OutFile=filefull;
+      Log->AddFileInfo(OutFile,FileInfo);
+    }
+    else Log->PrintfWarning("Results of gauge \'%s\' before the checkpoint are not available in \"%s\", a new file is created.",Name.c_str(),filefull.c_str());
+  }
+}
+
 //==============================================================================
 /// Return cell limits for interaction starting from position.
 /// Devuelve limites de celdas para interaccion a partir de posicion.
@@ -210,6 +286,42 @@ void JGaugeItem::GetInteractionCells(const tdouble3 &pos,const tint4 &nc,const t
   zfin=cz+min(nc.z-cz-1,Hdiv)+1;
 }
 
+//==============================================================================
+/// Computes nodes of a regular grid between point0 and point2. The number of 
+/// nodes in each direction is computed like in JGaugeSwl and a direction of 
+/// zero length has one node.
+//==============================================================================
+void JGaugeItem::ConfigGrid(const tdouble3 &point0,const tdouble3 &point2,double pointdp
+  ,tuint3 &pointnp,unsigned &nodecount,tdouble3 &pointdir)const
+{
+  const char met[]="ConfigGrid";
+  pointnp=TUint3(0);
+  nodecount=0;
+  pointdir=TDouble3(0);
+  if(pointdp>0){
+    if(!(point0<=point2))RunException(met,fun::PrintStr("The limits of the grid in gauge \'%s\' are invalid (point0 must be lower than point2).",Name.c_str()));
+    const tdouble3 dis=point2-point0;
+    unsigned np[3]={0,0,0};
+    double dir[3]={0,0,0};
+    for(unsigned c=0;c<3;c++){
+      const double dis1=(!c? dis.x: (c==1? dis.y: dis.z));
+      if(dis1>0){
+        unsigned n=unsigned(dis1/pointdp);
+        if(dis1-(pointdp*n)>=pointdp*0.1)n++;
+        if(n<1)n++;
+        np[c]=n+1;
+        dir[c]=dis1/n;
+      }
+      else np[c]=1;
+    }
+    const ullong nodes=ullong(np[0])*np[1]*np[2];
+    if(nodes>=UINT_MAX)RunException(met,fun::PrintStr("The number of nodes in gauge \'%s\' is too high.",Name.c_str()));
+    pointnp=TUint3(np[0],np[1],np[2]);
+    nodecount=unsigned(nodes);
+    pointdir=TDouble3(dir[0],dir[1],dir[2]);
+  }
+}
+
 #ifdef _WITHGPU
 //==============================================================================
 /// Throws exception for Cuda error.
@@ -287,6 +399,7 @@ void JGaugeVelocity::StoreResult(){
 /// Saves stored results in CSV file.
 //==============================================================================
 void JGaugeVelocity::SaveResults(){
+  if(OutCount && OutBin)SaveResultsBin();
   if(OutCount){
     const bool first=OutFile.empty();
     if(first){
@@ -309,6 +422,23 @@ void JGaugeVelocity::SaveResults(){
   }
 }
 
+//==============================================================================
+/// Saves stored results in binary file of gauges.
+//==============================================================================
+void JGaugeVelocity::SaveResultsBin(){
+  JBinaryData *blk=OutBin->NewBlock(Idx,OutCount);
+  JBinaryDataArray *atime=JGaugeBi4Save::AddColumn(blk,"time [s]",JBinaryDataDef::DatDouble,"%f");
+  JBinaryDataArray *avel =JGaugeBi4Save::AddColumn(blk,"velx [m/s];vely [m/s];velz [m/s]",JBinaryDataDef::DatFloat3,"%g;%g;%g");
+  JBinaryDataArray *apos =JGaugeBi4Save::AddColumn(blk,"posx [m];posy [m];posz [m]",JBinaryDataDef::DatFloat3,"%g;%g;%g");
+  for(unsigned c=0;c<OutCount;c++){
+    atime->AddData(1,&OutBuff[c].timestep,false);
+    avel ->AddData(1,&OutBuff[c].vel,false);
+    apos ->AddData(1,&OutBuff[c].point,false);
+  }
+  OutBin->PushBlock(blk);
+  OutCount=0;
+}
+
 //==============================================================================
 /// Saves last result in VTK file.
 //==============================================================================
@@ -334,7 +464,7 @@ unsigned JGaugeVelocity::GetPointDef(std::vector<tfloat3> &points)const{
 //==============================================================================
 void JGaugeVelocity::CalculeCpu(double timestep,tuint3 ncells,tuint3 cellmin
   ,const unsigned *begincell,unsigned npbok,unsigned npb,unsigned np
-  ,const tdouble3 *pos,const typecode *code,const unsigned *idp,const tfloat4 *velrhop)
+  ,const tdouble3 *pos,const typecode *code,const typeidp *idp,const tfloat4 *velrhop,const unsigned *ridpbound)
 {
   SetTimeStep(timestep);
   //-Start measure.
@@ -520,6 +650,7 @@ void JGaugeSwl::StoreResult(){
 /// Saves stored results in CSV file.
 //==============================================================================
 void JGaugeSwl::SaveResults(){
+  if(OutCount && OutBin)SaveResultsBin();
   if(OutCount){
     const bool first=OutFile.empty();
     if(first){
@@ -543,6 +674,25 @@ void JGaugeSwl::SaveResults(){
   }
 }
 
+//==============================================================================
+/// Saves stored results in binary file of gauges.
+//==============================================================================
+void JGaugeSwl::SaveResultsBin(){
+  JBinaryData *blk=OutBin->NewBlock(Idx,OutCount);
+  JBinaryDataArray *atime=JGaugeBi4Save::AddColumn(blk,"time [s]",JBinaryDataDef::DatDouble,"%f");
+  JBinaryDataArray *aswl =JGaugeBi4Save::AddColumn(blk,"swlx [m];swly [m];swlz [m]",JBinaryDataDef::DatFloat3,"%g;%g;%g");
+  JBinaryDataArray *apt0 =JGaugeBi4Save::AddColumn(blk,"pos0x [m];pos0y [m];pos0z [m]",JBinaryDataDef::DatFloat3,"%g;%g;%g");
+  JBinaryDataArray *apt2 =JGaugeBi4Save::AddColumn(blk,"pos2x [m];pos2y [m];pos2z [m]",JBinaryDataDef::DatFloat3,"%g;%g;%g");
+  for(unsigned c=0;c<OutCount;c++){
+    atime->AddData(1,&OutBuff[c].timestep,false);
+    aswl ->AddData(1,&OutBuff[c].posswl,false);
+    apt0 ->AddData(1,&OutBuff[c].point0,false);
+    apt2 ->AddData(1,&OutBuff[c].point2,false);
+  }
+  OutBin->PushBlock(blk);
+  OutCount=0;
+}
+
 //==============================================================================
 /// Saves last result in VTK file.
 //==============================================================================
@@ -630,33 +780,109 @@ float JGaugeSwl::CalculeMassCpu(const tdouble3 &ptpos,const tint4 &nc
   return(float(summass));
 }
 
+//==============================================================================
+/// Returns true when there are particles in the fluid cells around ptpos.
+/// Otherwise the mass computed at ptpos is zero.
+/// Devuelve true cuando hay particulas en las celdas de fluido alrededor de
+/// ptpos. En otro caso la masa calculada en ptpos es cero.
+//==============================================================================
+bool JGaugeSwl::CheckFluidCellsCpu(const tdouble3 &ptpos,const tint4 &nc
+  ,const tint3 &cellzero,unsigned cellfluid,const unsigned *begincell)const
+{
+  int cxini,cxfin,yini,yfin,zini,zfin;
+  GetInteractionCells(ptpos,nc,cellzero,cxini,cxfin,yini,yfin,zini,zfin);
+  if(cxini<cxfin)for(int z=zini;z<zfin;z++){
+    const int zmod=(nc.w)*z+cellfluid; //-Sum from start of fluid cells. | Le suma donde empiezan las celdas de fluido.
+    for(int y=yini;y<yfin;y++){
+      const int ymod=zmod+nc.x*y;
+      if(begincell[cxfin+ymod]>begincell[cxini+ymod])return(true);
+    }
+  }
+  return(false);
+}
+
+//==============================================================================
+/// Returns mass at point cp of the line (zero without fluid cells around).
+/// Devuelve la masa en el punto cp de la linea (cero sin celdas de fluido).
+//==============================================================================
+float JGaugeSwl::CalculeMassPointCpu(unsigned cp,const tint4 &nc
+  ,const tint3 &cellzero,unsigned cellfluid,const unsigned *begincell
+  ,const tdouble3 *pos,const typecode *code,const tfloat4 *velrhop)const
+{
+  const tdouble3 ptpos=Point0+(PointDir*double(cp));
+  return(CheckFluidCellsCpu(ptpos,nc,cellzero,cellfluid,begincell)? CalculeMassCpu(ptpos,nc,cellzero,cellfluid,begincell,pos,code,velrhop): 0);
+}
+
 //==============================================================================
 /// Calculates surface water level at indicated points (on CPU).
+/// The first point over MassLimit is found skipping points without fluid cells 
+/// around. The change to empty is bracketed by a coarse forward march with a 
+/// step of H inside the fluid and then it is located by bisection of the mass.
+/// When the mass in the bracket is not monotonic a linear march is used in the
+/// bracket, so the result matches the linear march over all points.
+/// El primer punto con masa mayor que MassLimit se busca saltando los puntos 
+/// sin celdas de fluido alrededor. El paso a vacio se acota avanzando con paso
+/// H y despues se localiza por biseccion de la masa. Cuando la masa en el 
+/// intervalo no es monotona se recorre linealmente el intervalo.
 //==============================================================================
 void JGaugeSwl::CalculeCpu(double timestep,tuint3 ncells,tuint3 cellmin
   ,const unsigned *begincell,unsigned npbok,unsigned npb,unsigned np
-  ,const tdouble3 *pos,const typecode *code,const unsigned *idp,const tfloat4 *velrhop)
+  ,const tdouble3 *pos,const typecode *code,const typeidp *idp,const tfloat4 *velrhop,const unsigned *ridpbound)
 {
   SetTimeStep(timestep);
   const tint4 nc=TInt4(int(ncells.x),int(ncells.y),int(ncells.z),int(ncells.x*ncells.y));
   const tint3 cellzero=TInt3(cellmin.x,cellmin.y,cellmin.z);
   const unsigned cellfluid=nc.w*nc.z+1;
 
-  //-Look for change of fluid to empty. | Busca paso de fluido a vacio.
+  //-Look for first point with fluid. | Busca primer punto con fluido.
   tdouble3 ptsurf=TDouble3(DBL_MAX);
-  float mpre=0;
-  tdouble3 ptpos=Point0;
-  for(unsigned cp=0;cp<=PointNp;cp++){
-    const float mass=CalculeMassCpu(ptpos,nc,cellzero,cellfluid,begincell,pos,code,velrhop);
-    if(mass>MassLimit)mpre=mass;
-    if(mass<MassLimit && mpre){
-      const float fxm1=(MassLimit-mpre)/(mass-mpre)-1;
+  unsigned cpa=UINT_MAX;
+  float massa=0;
+  for(unsigned cp=0;cp<=PointNp && cpa==UINT_MAX;cp++){
+    const float mass=CalculeMassPointCpu(cp,nc,cellzero,cellfluid,begincell,pos,code,velrhop);
+    if(mass>MassLimit){ cpa=cp; massa=mass; }
+  }
+  //-Look for change of fluid to empty. | Busca paso de fluido a vacio.
+  if(cpa!=UINT_MAX){
+    //-Coarse march to bracket the change between cpa (mass>=MassLimit) and cpb (mass<MassLimit).
+    //-Large steps are only used inside the fluid (mass>MassLimit*1.5) to avoid skipping thin gaps.
+    const unsigned step=max(1u,unsigned(double(H)/PointDp));
+    const float massbulk=MassLimit*1.5f;
+    unsigned cpb=UINT_MAX;
+    float massb=0;
+    while(cpb==UINT_MAX && cpa<PointNp){
+      const unsigned cp=min(cpa+(massa>massbulk? step: 1),PointNp);
+      const float mass=CalculeMassPointCpu(cp,nc,cellzero,cellfluid,begincell,pos,code,velrhop);
+      if(mass<MassLimit){ cpb=cp; massb=mass; }
+      else{ cpa=cp; massa=mass; }
+    }
+    if(cpb!=UINT_MAX){
+      const unsigned cpa0=cpa;
+      const float massa0=massa;
+      //-Bisection between cpa (mass>=MassLimit) and cpb (mass<MassLimit).
+      bool monotonic=true;
+      while(cpb-cpa>1 && monotonic){
+        const unsigned cp=(cpa+cpb)/2;
+        const float mass=CalculeMassPointCpu(cp,nc,cellzero,cellfluid,begincell,pos,code,velrhop);
+        monotonic=(mass<=massa && mass>=massb);
+        if(mass<MassLimit){ cpb=cp; massb=mass; }
+        else{ cpa=cp; massa=mass; }
+      }
+      //-Linear march in the bracket when the mass is not monotonic.
+      if(!monotonic){
+        cpa=cpa0; massa=massa0;
+        for(unsigned cp=cpa0+1;cp<cpb;cp++){
+          const float mass=CalculeMassPointCpu(cp,nc,cellzero,cellfluid,begincell,pos,code,velrhop);
+          if(mass<MassLimit){ cpb=cp; massb=mass; }
+          else{ cpa=cp; massa=mass; }
+        }
+      }
+      const float fxm1=(MassLimit-massa)/(massb-massa)-1;
+      const tdouble3 ptpos=Point0+(PointDir*double(cpb));
       ptsurf=ptpos+(PointDir*double(fxm1));
-      cp=PointNp+1;
     }
-    ptpos=ptpos+PointDir;
   }
-  if(ptsurf.x==DBL_MAX)ptsurf=Point0+(PointDir*(mpre? PointNp: 0));
+  if(ptsurf.x==DBL_MAX)ptsurf=Point0+(PointDir*(cpa!=UINT_MAX? PointNp: 0));
   //-Stores result. | Guarda resultado.
   Result.Set(timestep,ToTFloat3(Point0),ToTFloat3(Point2),ToTFloat3(ptsurf));
   //Log->Printf("------> t:%f",TimeStep);
@@ -745,6 +971,7 @@ void JGaugeMaxZ::StoreResult(){
 /// Saves stored results in CSV file.
 //==============================================================================
 void JGaugeMaxZ::SaveResults(){
+  if(OutCount && OutBin)SaveResultsBin();
   if(OutCount){
     const bool first=OutFile.empty();
     if(first){
@@ -767,6 +994,23 @@ void JGaugeMaxZ::SaveResults(){
   }
 }
 
+//==============================================================================
+/// Saves stored results in binary file of gauges.
+//==============================================================================
+void JGaugeMaxZ::SaveResultsBin(){
+  JBinaryData *blk=OutBin->NewBlock(Idx,OutCount);
+  JBinaryDataArray *atime=JGaugeBi4Save::AddColumn(blk,"time [s]",JBinaryDataDef::DatDouble,"%f");
+  JBinaryDataArray *azmax=JGaugeBi4Save::AddColumn(blk,"zmax [m]",JBinaryDataDef::DatFloat,"%g");
+  JBinaryDataArray *apos =JGaugeBi4Save::AddColumn(blk,"posx [m];posy [m];posz [m]",JBinaryDataDef::DatFloat3,"%g;%g;%g");
+  for(unsigned c=0;c<OutCount;c++){
+    atime->AddData(1,&OutBuff[c].timestep,false);
+    azmax->AddData(1,&OutBuff[c].zmax,false);
+    apos ->AddData(1,&OutBuff[c].point0,false);
+  }
+  OutBin->PushBlock(blk);
+  OutCount=0;
+}
+
 //==============================================================================
 /// Saves last result in VTK file.
 //==============================================================================
@@ -828,7 +1072,7 @@ void JGaugeMaxZ::GetInteractionCellsMaxZ(const tdouble3 &pos,const tint4 &nc,con
 //==============================================================================
 void JGaugeMaxZ::CalculeCpu(double timestep,tuint3 ncells,tuint3 cellmin
   ,const unsigned *begincell,unsigned npbok,unsigned npb,unsigned np
-  ,const tdouble3 *pos,const typecode *code,const unsigned *idp,const tfloat4 *velrhop)
+  ,const tdouble3 *pos,const typecode *code,const typeidp *idp,const tfloat4 *velrhop,const unsigned *ridpbound)
 {
   //Log->Printf("JGaugeMaxZ----> timestep:%g  (%d)",timestep,(DG?1:0));
   SetTimeStep(timestep);
@@ -985,6 +1229,7 @@ void JGaugeForce::StoreResult(){
 /// Saves stored results in CSV file.
 //==============================================================================
 void JGaugeForce::SaveResults(){
+  if(OutCount && OutBin)SaveResultsBin();
   if(OutCount){
     const bool first=OutFile.empty();
     if(first){
@@ -1008,6 +1253,24 @@ void JGaugeForce::SaveResults(){
   }
 }
 
+//==============================================================================
+/// Saves stored results in binary file of gauges.
+//==============================================================================
+void JGaugeForce::SaveResultsBin(){
+  JBinaryData *blk=OutBin->NewBlock(Idx,OutCount);
+  JBinaryDataArray *atime =JGaugeBi4Save::AddColumn(blk,"time [s]",JBinaryDataDef::DatDouble,"%f");
+  JBinaryDataArray *aforce=JGaugeBi4Save::AddColumn(blk,"force [N]",JBinaryDataDef::DatFloat,"%g");
+  JBinaryDataArray *afxyz =JGaugeBi4Save::AddColumn(blk,"forcex [N];forcey [N];forcez [N]",JBinaryDataDef::DatFloat3,"%g;%g;%g");
+  for(unsigned c=0;c<OutCount;c++){
+    const float force=fgeo::PointDist(OutBuff[c].force);
+    atime ->AddData(1,&OutBuff[c].timestep,false);
+    aforce->AddData(1,&force,false);
+    afxyz ->AddData(1,&OutBuff[c].force,false);
+  }
+  OutBin->PushBlock(blk);
+  OutCount=0;
+}
+
 //==============================================================================
 /// Saves last result in VTK file.
 //==============================================================================
@@ -1029,25 +1292,30 @@ unsigned JGaugeForce::GetPointDef(std::vector<tfloat3> &points)const{
 
 //==============================================================================
 /// Calculates force sumation on selected fixed or moving particles using only fluid particles (on CPU).
-/// Ignores periodic boundary particles to avoid race condition problems.
+/// Only the particles of the mk block are visited using ridpbound[] (position 
+/// of normal boundary particles according to idp), so periodic boundary 
+/// particles are ignored to avoid race condition problems.
 //==============================================================================
 void JGaugeForce::CalculeCpu(double timestep,tuint3 ncells,tuint3 cellmin
   ,const unsigned *begincell,unsigned npbok,unsigned npb,unsigned np
-  ,const tdouble3 *pos,const typecode *code,const unsigned *idp,const tfloat4 *velrhop)
+  ,const tdouble3 *pos,const typecode *code,const typeidp *idp,const tfloat4 *velrhop,const unsigned *ridpbound)
 {
   if(!Cpu)RunException("CalculeCpu","Method is not allowed for GPU executions.");
+  if(!ridpbound)RunException("CalculeCpu","Index of boundary particles is missing.");
   SetTimeStep(timestep);
   const tint4 nc=TInt4(int(ncells.x),int(ncells.y),int(ncells.z),int(ncells.x*ncells.y));
   const tint3 cellzero=TInt3(cellmin.x,cellmin.y,cellmin.z);
   const unsigned cellfluid=nc.w*nc.z+1;
 
   //-Computes acceleration in selected boundary particles.
-  memset(PartAcec,0,sizeof(tfloat3)*Count);
-  const int n=int(TypeParts==TpPartFixed || TypeParts==TpPartMoving? npbok: np);
+  const unsigned *ridp=ridpbound+IdBegin;
+  const int n=int(Count);
   #ifdef OMP_USE
     #pragma omp parallel for schedule (guided)
   #endif
-  for(int p1=0;p1<n;p1++)if(CODE_GetTypeAndValue(code[p1])==Code && CODE_IsNormal(code[p1])){//-Ignores periodic boundaries.
+  for(int cp=0;cp<n;cp++){
+    const unsigned p1=ridp[cp];
+    if(p1>=npbok){ PartAcec[cp]=TFloat3(0); continue; }//-Particle is excluded or out of domain.
     //-Obtain limits of interaction. | Obtiene limites de interaccion.
     int cxini,cxfin,yini,yfin,zini,zfin;
     const tdouble3 ptpos1=pos[p1];
@@ -1120,7 +1388,7 @@ void JGaugeForce::CalculeCpu(double timestep,tuint3 ncells,tuint3 cellmin
       }
     }
     //-Saves ace.
-    PartAcec[idp[p1]-IdBegin]=ace;
+    PartAcec[cp]=ace;
   }
   //-Computes total ace.
   tfloat3 acesum=TFloat3(0);
@@ -1173,3 +1441,1288 @@ void JGaugeForce::CalculeGpu(double timestep,tuint3 ncells,tuint3 cellmin
 
 
 
+
+
+//##############################################################################
+//# JGaugeMesh
+//##############################################################################
+//==============================================================================
+/// Constructor.
+//==============================================================================
+JGaugeMesh::JGaugeMesh(unsigned idx,std::string name,tdouble3 point0,tdouble3 point2
+  ,double pointdp,float kclimit,bool cpu,JLog2* log)
+  :JGaugeItem(GAUGE_Mesh,idx,name,cpu,log)
+{
+  ClassName="JGaugeMesh";
+  FileInfo=string("Saves velocity, density and pressure interpolated on a mesh of points (by ")+ClassName+").";
+  ResVel=NULL; ResRhop=NULL; ResPress=NULL;
+  Reset();
+  SetPoints(point0,point2,pointdp);
+  KcLimit=kclimit;
+  //-Allocates memory for the last measure.
+  ResVel=new tfloat3[NodeCount];
+  ResRhop=new float[NodeCount];
+  ResPress=new float[NodeCount];
+  ClearResult();
+}
+
+//==============================================================================
+/// Destructor (frees memory of results).
+//==============================================================================
+JGaugeMesh::~JGaugeMesh(){
+  DestructorActive=true;
+  Reset();
+}
+
+//==============================================================================
+/// Initialisation of variables.
+//==============================================================================
+void JGaugeMesh::Reset(){
+  delete[] ResVel;   ResVel=NULL;
+  delete[] ResRhop;  ResRhop=NULL;
+  delete[] ResPress; ResPress=NULL;
+  SetPoints(TDouble3(0),TDouble3(0),0);
+  KcLimit=0;
+  ResTimeStep=0;
+  OutTimes.clear();
+  OutVel.clear();
+  OutRhop.clear();
+  OutPress.clear();
+  OutNum=0;
+  JGaugeItem::Reset();
+}
+
+//==============================================================================
+/// Initialises values of the last measure.
+//==============================================================================
+void JGaugeMesh::ClearResult(){
+  ResTimeStep=0;
+  if(NodeCount){
+    memset(ResVel,0,sizeof(tfloat3)*NodeCount);
+    memset(ResRhop,0,sizeof(float)*NodeCount);
+    memset(ResPress,0,sizeof(float)*NodeCount);
+  }
+}
+
+//==============================================================================
+/// Returns mean velocity modulus of the mesh nodes in the last measure.
+/// Devuelve el modulo medio de la velocidad de los nodos en la ultima medida.
+//==============================================================================
+double JGaugeMesh::GetResultVelMean()const{
+  double vsum=0;
+  for(unsigned cn=0;cn<NodeCount;cn++){
+    const tfloat3 v=ResVel[cn];
+    vsum+=sqrt(double(v.x)*v.x+double(v.y)*v.y+double(v.z)*v.z);
+  }
+  return(NodeCount? vsum/NodeCount: 0);
+}
+
+//==============================================================================
+/// Changes points definition.
+//==============================================================================
+void JGaugeMesh::SetPoints(const tdouble3 &point0,const tdouble3 &point2,double pointdp){
+  Point0=point0;
+  Point2=point2;
+  PointDp=pointdp;
+  ConfigGrid(Point0,Point2,PointDp,PointNp,NodeCount,PointDir);
+}
+
+//==============================================================================
+/// Record the last measure result.
+//==============================================================================
+void JGaugeMesh::StoreResult(){
+  if(OutputSave){
+    //-Empty buffer.
+    if(OutBufferFull())SaveResults();
+    //-Allocates memory.
+    const size_t ini=size_t(OutCount)*NodeCount;
+    if(OutVel.size()<ini+NodeCount){
+      OutVel.resize(ini+NodeCount);
+      OutRhop.resize(ini+NodeCount);
+      OutPress.resize(ini+NodeCount);
+    }
+    if(OutTimes.size()<OutCount+1)OutTimes.resize(OutCount+1);
+    //-Stores last results.
+    OutTimes[OutCount]=ResTimeStep;
+    memcpy(&OutVel[ini],ResVel,sizeof(tfloat3)*NodeCount);
+    memcpy(&OutRhop[ini],ResRhop,sizeof(float)*NodeCount);
+    memcpy(&OutPress[ini],ResPress,sizeof(float)*NodeCount);
+    OutCount++;
+    //-Updates OutputNext.
+    if(OutputDt){
+      const unsigned nt=unsigned(TimeStep/OutputDt);
+      OutputNext=OutputDt*nt;
+      if(OutputNext<=TimeStep)OutputNext=OutputDt*(nt+1);
+    }
+  }
+}
+
+//==============================================================================
+/// Returns filename for output results in binary format.
+//==============================================================================
+std::string JGaugeMesh::GetResultsFileBin()const{
+  return(AppInfo.GetDirOut()+"Gauges"+GetNameType(Type)+"_"+Name)+".bi4";
+}
+
+//==============================================================================
+/// Saves stored results in binary file. The first call writes the mesh 
+/// definition and each measure is appended as item DATA_XXXXXX.
+//==============================================================================
+void JGaugeMesh::SaveResults(){
+  if(OutCount){
+    const bool first=OutFile.empty();
+    if(first){
+      OutFile=GetResultsFileBin();
+      Log->AddFileInfo(OutFile,FileInfo);
+    }
+    JBinaryData bdat(ClassName);
+    JBinaryData *item=bdat.CreateItem("Data");
+    //-Saves head.
+    if(first){
+      bdat.SetvText("AppName",AppInfo.GetFullName());
+      bdat.SetvText("Name",Name);
+      bdat.SetvDouble3("Point0",Point0);
+      bdat.SetvDouble3("Point2",Point2);
+      bdat.SetvDouble("PointDp",PointDp);
+      bdat.SetvDouble3("PointDir",PointDir);
+      bdat.SetvUint3("PointNp",PointNp);
+      bdat.SetvUint("NodeCount",NodeCount);
+      bdat.SetvFloat("KcLimit",KcLimit);
+      item->SetHide(true);
+      bdat.SaveFile(OutFile,true,false);
+    }
+    //-Saves data.
+    for(unsigned c=0;c<OutCount;c++){
+      const size_t ini=size_t(c)*NodeCount;
+      item->SetName(fun::PrintStr("DATA_%06u",OutNum));
+      item->SetvUint("Num",OutNum);
+      item->SetvDouble("TimeStep",OutTimes[c]);
+      item->CreateArray("Vel",JBinaryDataDef::DatFloat3,NodeCount,&OutVel[ini],false);
+      item->CreateArray("Rhop",JBinaryDataDef::DatFloat,NodeCount,&OutRhop[ini],false);
+      item->CreateArray("Press",JBinaryDataDef::DatFloat,NodeCount,&OutPress[ini],false);
+      item->SaveFileListApp(OutFile,ClassName,true,true);
+      item->RemoveArrays();
+      OutNum++;
+    }
+    OutCount=0;
+  }
+}
+
+//==============================================================================
+/// Saves last result in VTK file.
+//==============================================================================
+void JGaugeMesh::SaveVtkResult(unsigned cpart){
+  std::vector<tfloat3> points;
+  GetPointDef(points);
+  //-Prepares data.
+  std::vector<JFormatFiles2::StScalarData> fields;
+  fields.push_back(JFormatFiles2::DefineField("Vel"  ,JFormatFiles2::Float32,3,ResVel));
+  fields.push_back(JFormatFiles2::DefineField("Rhop" ,JFormatFiles2::Float32,1,ResRhop));
+  fields.push_back(JFormatFiles2::DefineField("Press",JFormatFiles2::Float32,1,ResPress));
+  //-Saves VTK file.
+  Log->AddFileInfo(fun::FileNameSec(GetResultsFileVtk(),UINT_MAX),FileInfo);
+  JFormatFiles2::SaveVtk(fun::FileNameSec(GetResultsFileVtk(),cpart),NodeCount,&(points[0]),fields);
+}
+
+//==============================================================================
+/// Loads and returns number definition points.
+//==============================================================================
+unsigned JGaugeMesh::GetPointDef(std::vector<tfloat3> &points)const{
+  for(unsigned cn=0;cn<NodeCount;cn++)points.push_back(ToTFloat3(GetNodePos(cn)));
+  return(NodeCount);
+}
+
+//==============================================================================
+/// Calculates velocity, density and pressure at mesh nodes (on CPU).
+/// Values are corrected with the kernel sum (Shepard) and nodes with a kernel
+/// sum lower than KcLimit are stored as zero.
+//==============================================================================
+void JGaugeMesh::CalculeCpu(double timestep,tuint3 ncells,tuint3 cellmin
+  ,const unsigned *begincell,unsigned npbok,unsigned npb,unsigned np
+  ,const tdouble3 *pos,const typecode *code,const typeidp *idp,const tfloat4 *velrhop,const unsigned *ridpbound)
+{
+  SetTimeStep(timestep);
+  const tint4 nc=TInt4(int(ncells.x),int(ncells.y),int(ncells.z),int(ncells.x*ncells.y));
+  const tint3 cellzero=TInt3(cellmin.x,cellmin.y,cellmin.z);
+  const unsigned cellfluid=nc.w*nc.z+1;
+  //-Start measure.
+  const int n=int(NodeCount);
+  #ifdef OMP_USE
+    #pragma omp parallel for schedule (guided)
+  #endif
+  for(int cn=0;cn<n;cn++){
+    const tdouble3 ptpos=GetNodePos(unsigned(cn));
+    tfloat3 ptvel=TFloat3(0);
+    float ptrhop=0,ptpress=0;
+    const bool ptout=PointIsOut(ptpos.x,ptpos.y,ptpos.z);//-Verify that the point is within domain boundaries. | Comprueba que el punto este dentro de limites del dominio.
+    if(!ptout){
+      const bool rsymp1=(Symmetry && (ptpos.y<=H+H)); //<vs_syymmetry>
+      //-Obtain limits of interaction. | Obtiene limites de interaccion.
+      int cxini,cxfin,yini,yfin,zini,zfin;
+      GetInteractionCells(ptpos,nc,cellzero,cxini,cxfin,yini,yfin,zini,zfin);
+
+      //-Auxiliary variables.
+      double sumwab=0,sumrhop=0,sumpress=0;
+      tdouble3 sumvel=TDouble3(0);
+
+      //-Search for neighbors in adjacent cells. | Busqueda de vecinos en celdas adyacentes.
+      if(cxini<cxfin)for(int z=zini;z<zfin;z++){
+        const int zmod=(nc.w)*z+cellfluid; //-Sum from start of fluid cells. | Le suma donde empiezan las celdas de fluido.
+        for(int y=yini;y<yfin;y++){
+          int ymod=zmod+nc.x*y;
+          const unsigned pini=begincell[cxini+ymod];
+          const unsigned pfin=begincell[cxfin+ymod];
+
+          //-Interaction with Fluid/Floating | Interaccion con varias Fluid/Floating.
+          //--------------------------------------------------------------------------
+          bool rsym=false; //<vs_syymmetry>
+          for(unsigned p2=pini;p2<pfin;p2++){
+            const float drx=float(ptpos.x-pos[p2].x);
+                  float dry=float(ptpos.y-pos[p2].y);
+            if(rsym)    dry=float(ptpos.y+pos[p2].y); //<vs_syymmetry>
+            const float drz=float(ptpos.z-pos[p2].z);
+            const float rr2=(drx*drx+dry*dry+drz*drz);
+            //-Interaction with real neighboring particles. | Interaccion con particulas vecinas reales.
+            if(rr2<=Fourh2 && rr2>=ALMOSTZERO && CODE_IsFluid(code[p2])){
+              float wab;
+              {//-Wendland kernel.
+                const float qq=sqrt(rr2)/H;
+                const float wqq=2.f*qq+1.f;
+                const float wqq1=1.f-0.5f*qq;
+                const float wqq2=wqq1*wqq1;
+                wab=Awen*wqq*wqq2*wqq2; //-Kernel.
+              }
+              tfloat4 velrhop2=velrhop[p2];
+              if(rsym)velrhop2.y=-velrhop2.y; //<vs_syymmetry>
+              const float press2=CteB*(pow(velrhop2.w/RhopZero,Gamma)-1.0f);
+              wab*=MassFluid/velrhop2.w;
+              sumwab+=wab;
+              sumvel.x+=wab*velrhop2.x;
+              sumvel.y+=wab*velrhop2.y;
+              sumvel.z+=wab*velrhop2.z;
+              sumrhop+=wab*velrhop2.w;
+              sumpress+=wab*press2;
+              rsym=(rsymp1 && !rsym && float(ptpos.y-dry)<=H+H); //<vs_syymmetry>
+              if(rsym)p2--;                                      //<vs_syymmetry>
+            }
+            else rsym=false;                                     //<vs_syymmetry>
+          }
+        }
+      }
+      //-Applies kernel correction when there is enough fluid around the node.
+      if(sumwab>=KcLimit){
+        ptvel=ToTFloat3(sumvel/sumwab);
+        ptrhop=float(sumrhop/sumwab);
+        ptpress=float(sumpress/sumwab);
+      }
+    }
+    //-Stores result. | Guarda resultado.
+    ResVel[cn]=ptvel;
+    ResRhop[cn]=ptrhop;
+    ResPress[cn]=ptpress;
+  }
+  ResTimeStep=timestep;
+  if(Output(timestep))StoreResult();
+}
+
+#ifdef _WITHGPU
+//==============================================================================
+/// Calculates velocity, density and pressure at mesh nodes (on GPU).
+//==============================================================================
+void JGaugeMesh::CalculeGpu(double timestep,tuint3 ncells,tuint3 cellmin
+  ,const int2 *beginendcell,unsigned npbok,unsigned npb,unsigned np
+  ,const double2 *posxy,const double *posz,const typecode *code,const unsigned *idp,const float4 *velrhop,float3 *aux)
+{
+  RunException("CalculeGpu","Mesh gauge is not available for GPU executions.");
+}
+#endif
+
+
+//##############################################################################
+//# JGaugeIsosurface
+//##############################################################################
+///Corners of the 6 tetrahedra of a grid cell, all of them along the diagonal 0-7.
+static const byte ISO_TETRA[6][4]={{0,1,3,7},{0,1,5,7},{0,2,3,7},{0,2,6,7},{0,4,5,7},{0,4,6,7}};
+///Corners of the 2 triangles of a grid cell on plane XZ (2D).
+static const byte ISO_TRIAN[2][3]={{0,1,5},{0,4,5}};
+
+//==============================================================================
+/// Constructor.
+//==============================================================================
+JGaugeIsosurface::JGaugeIsosurface(unsigned idx,std::string name,tdouble3 point0,tdouble3 point2
+  ,double pointdp,float masslimit,double dp,bool cpu,JLog2* log)
+  :JGaugeItem(GAUGE_Isosurface,idx,name,cpu,log)
+{
+  ClassName="JGaugeIsosurface";
+  FileInfo=string("Saves isosurface of fluid mass calculated during the simulation (by ")+ClassName+").";
+  Reset();
+  SetPoints(point0,point2,pointdp);
+  MassLimit=masslimit;
+  Dp=dp;
+}
+
+//==============================================================================
+/// Destructor (frees memory of results).
+//==============================================================================
+JGaugeIsosurface::~JGaugeIsosurface(){
+  DestructorActive=true;
+  Reset();
+}
+
+//==============================================================================
+/// Initialisation of variables.
+//==============================================================================
+void JGaugeIsosurface::Reset(){
+  SetPoints(TDouble3(0),TDouble3(0),0);
+  MassLimit=0;
+  Dp=0;
+  ClearResult();
+  std::vector<float>().swap(NodeMass);
+  std::vector<tfloat3>().swap(ResPos);
+  std::vector<unsigned>().swap(ResCells);
+  OutNum=0;
+  JGaugeItem::Reset();
+}
+
+//==============================================================================
+/// Initialises the last isosurface.
+//==============================================================================
+void JGaugeIsosurface::ClearResult(){
+  ResTimeStep=0;
+  ResNvCell=0;
+  ResPos.clear();
+  ResCells.clear();
+}
+
+//==============================================================================
+/// Returns mean Z of the points of the last isosurface.
+/// Devuelve la Z media de los puntos de la ultima isosuperficie.
+//==============================================================================
+double JGaugeIsosurface::GetResultZMean()const{
+  const unsigned np=unsigned(ResPos.size());
+  double zsum=0;
+  for(unsigned p=0;p<np;p++)zsum+=ResPos[p].z;
+  return(np? zsum/np: 0);
+}
+
+//==============================================================================
+/// Changes points definition.
+//==============================================================================
+void JGaugeIsosurface::SetPoints(const tdouble3 &point0,const tdouble3 &point2,double pointdp){
+  Point0=point0;
+  Point2=point2;
+  PointDp=pointdp;
+  ConfigGrid(Point0,Point2,PointDp,PointNp,NodeCount,PointDir);
+  for(unsigned c=0;c<8;c++)CornerOff[c]=(c&1)+((c>>1)&1)*PointNp.x+(c>>2)*PointNp.x*PointNp.y;
+  NodeMass.clear();
+}
+
+//==============================================================================
+/// Returns identifier of the edge between two corners of the grid cell 
+/// starting at node. Each node has 7 edges towards the corners 1-7 of its cell.
+//==============================================================================
+ullong JGaugeIsosurface::GetEdgeId(unsigned node,byte corner1,byte corner2)const{
+  const byte c1=((corner1&corner2)==corner1? corner1: corner2);
+  const byte c2=corner1^corner2^c1;
+  return(ullong(node+CornerOff[c1])*7+(c1^c2)-1);
+}
+
+//==============================================================================
+/// Adds cell (triangle or line) defined by the edges between pairs of corners.
+/// Triangles are oriented with the normal from corner cin (inside fluid) 
+/// towards corner cout (outside fluid).
+//==============================================================================
+void JGaugeIsosurface::AddCell(std::vector<ullong> &cells,unsigned node
+  ,unsigned nv,const byte *edges,byte cin,byte cout)const
+{
+  bool swap=false;
+  if(nv==3){
+    //-Computes orientation using midpoints of edges (x2) in the cell.
+    tint3 m[3];
+    for(unsigned cv=0;cv<3;cv++){
+      const byte ca=edges[cv*2],cb=edges[cv*2+1];
+      m[cv]=TInt3((ca&1)+(cb&1),((ca>>1)&1)+((cb>>1)&1),(ca>>2)+(cb>>2));
+    }
+    const tint3 v1=TInt3(m[1].x-m[0].x,m[1].y-m[0].y,m[1].z-m[0].z);
+    const tint3 v2=TInt3(m[2].x-m[0].x,m[2].y-m[0].y,m[2].z-m[0].z);
+    const tint3 nor=TInt3(v1.y*v2.z-v1.z*v2.y,v1.z*v2.x-v1.x*v2.z,v1.x*v2.y-v1.y*v2.x);
+    const tint3 dir=TInt3(int(cout&1)-int(cin&1),int((cout>>1)&1)-int((cin>>1)&1),int(cout>>2)-int(cin>>2));
+    swap=(nor.x*dir.x+nor.y*dir.y+nor.z*dir.z<0);
+  }
+  cells.push_back(GetEdgeId(node,edges[0],edges[1]));
+  if(swap){
+    cells.push_back(GetEdgeId(node,edges[4],edges[5]));
+    cells.push_back(GetEdgeId(node,edges[2],edges[3]));
+  }
+  else for(unsigned cv=1;cv<nv;cv++)cells.push_back(GetEdgeId(node,edges[cv*2],edges[cv*2+1]));
+}
+
+//==============================================================================
+/// Extracts the isosurface of NodeMass with marching tetrahedra (triangles 
+/// in 2D). Layers of grid cells are computed in parallel and the points are 
+/// shared by the cells.
+//==============================================================================
+void JGaugeIsosurface::ComputeSurface(){
+  const char met[]="ComputeSurface";
+  ResNvCell=(Simulate2D? 2: 3);
+  ResPos.clear();
+  ResCells.clear();
+  const unsigned ncx=(PointNp.x>1? PointNp.x-1: 0);
+  const unsigned ncy=(Simulate2D? 1: (PointNp.y>1? PointNp.y-1: 0));
+  const int ncz=int(PointNp.z>1? PointNp.z-1: 0);
+  const byte cornersall=(Simulate2D? 0x33: 0xFF);
+  //-Computes cells of each layer of the grid (as edge identifiers).
+  std::vector< std::vector<ullong> > layers(ncz);
+  #ifdef OMP_USE
+    #pragma omp parallel for schedule (dynamic)
+  #endif
+  for(int cz=0;cz<ncz;cz++){
+    std::vector<ullong> &cells=layers[cz];
+    for(unsigned cy=0;cy<ncy;cy++)for(unsigned cx=0;cx<ncx;cx++){
+      const unsigned node=cx+cy*PointNp.x+unsigned(cz)*PointNp.x*PointNp.y;
+      //-Corners of the cell inside the fluid.
+      byte cornersin=0;
+      for(byte c=0;c<8;c++)if((cornersall&(1<<c)) && NodeMass[node+CornerOff[c]]>=MassLimit)cornersin|=byte(1<<c);
+      if(!cornersin || cornersin==cornersall)continue;
+      const unsigned ns=(Simulate2D? 2: 6);
+      const unsigned nvs=(Simulate2D? 3: 4);
+      for(unsigned cs=0;cs<ns;cs++){
+        const byte *vs=(Simulate2D? ISO_TRIAN[cs]: ISO_TETRA[cs]);
+        byte vin[4],vout[4];
+        unsigned nin=0,nout=0;
+        for(unsigned cv=0;cv<nvs;cv++){
+          if(cornersin&(1<<vs[cv]))vin[nin++]=vs[cv];
+          else vout[nout++]=vs[cv];
+        }
+        if(nin && nout){
+          if(nin==1 || nout==1){//-Cell with edges from the single corner.
+            const byte c0=(nin==1? vin[0]: vout[0]);
+            const byte *vo=(nin==1? vout: vin);
+            const byte edges[6]={c0,vo[0],c0,vo[1],c0,byte(nvs==4? vo[2]: 0)};
+            AddCell(cells,node,ResNvCell,edges,vin[0],vout[0]);
+          }
+          else{//-Quad split in two triangles (only with tetrahedra).
+            const byte a=vin[0],b=vin[1],c=vout[0],d=vout[1];
+            const byte edges1[6]={a,c,a,d,b,d};
+            const byte edges2[6]={a,c,b,d,b,c};
+            AddCell(cells,node,3,edges1,a,c);
+            AddCell(cells,node,3,edges2,a,c);
+          }
+        }
+      }
+    }
+  }
+  //-Joins cells of all layers.
+  std::vector<ullong> cells;
+  {
+    size_t size=0;
+    for(int cz=0;cz<ncz;cz++)size+=layers[cz].size();
+    cells.reserve(size);
+    for(int cz=0;cz<ncz;cz++){
+      cells.insert(cells.end(),layers[cz].begin(),layers[cz].end());
+      std::vector<ullong>().swap(layers[cz]);
+    }
+  }
+  //-Obtains sorted list of edges used by cells.
+  std::vector<ullong> edges(cells);
+  std::sort(edges.begin(),edges.end());
+  edges.erase(std::unique(edges.begin(),edges.end()),edges.end());
+  if(edges.size()>=UINT_MAX || cells.size()>=INT_MAX)RunException(met,fun::PrintStr("The size of the isosurface in gauge \'%s\' is too high.",Name.c_str()));
+  //-Computes position of points on edges.
+  const int npt=int(edges.size());
+  ResPos.resize(npt);
+  #ifdef OMP_USE
+    #pragma omp parallel for schedule (static)
+  #endif
+  for(int p=0;p<npt;p++){
+    const unsigned node1=unsigned(edges[p]/7);
+    const unsigned node2=node1+CornerOff[unsigned(edges[p]%7)+1];
+    const float mass1=NodeMass[node1],mass2=NodeMass[node2];
+    const double fx=(MassLimit-mass1)/(mass2-mass1);
+    const tdouble3 pos1=GetNodePos(node1);
+    ResPos[p]=ToTFloat3(pos1+(GetNodePos(node2)-pos1)*fx);
+  }
+  //-Replaces edges of cells by the index of points.
+  const int nc=int(cells.size());
+  ResCells.resize(nc);
+  #ifdef OMP_USE
+    #pragma omp parallel for schedule (static)
+  #endif
+  for(int c=0;c<nc;c++)ResCells[c]=unsigned(std::lower_bound(edges.begin(),edges.end(),cells[c])-edges.begin());
+}
+
+//==============================================================================
+/// Saves the last isosurface in a new VTU file.
+//==============================================================================
+void JGaugeIsosurface::StoreResult(){
+  if(OutputSave){
+    if(!OutNum)Log->AddFileInfo(fun::FileNameSec(GetResultsFileVtu(),UINT_MAX),FileInfo);
+    const unsigned npt=GetResNumPoints();
+    const unsigned ncells=GetResNumCells();
+    JSaveVtu svtu(JSaveVtu::ENC_Raw,false);
+    svtu.SaveFilePolys(fun::FileNameSec(GetResultsFileVtu(),OutNum),npt,(npt? &ResPos[0]: NULL)
+      ,ncells,ResNvCell,(ncells? &ResCells[0]: NULL),0,NULL);
+    OutNum++;
+    //-Updates OutputNext.
+    if(OutputDt){
+      const unsigned nt=unsigned(TimeStep/OutputDt);
+      OutputNext=OutputDt*nt;
+      if(OutputNext<=TimeStep)OutputNext=OutputDt*(nt+1);
+    }
+  }
+}
+
+//==============================================================================
+/// Changes number of saved files (restart from checkpoint).
+//==============================================================================
+void JGaugeIsosurface::SetOutNum(unsigned num){
+  OutNum=num;
+  if(OutNum)Log->AddFileInfo(fun::FileNameSec(GetResultsFileVtu(),UINT_MAX),FileInfo);
+}
+
+//==============================================================================
+/// Returns filename for output results in VTU files.
+//==============================================================================
+std::string JGaugeIsosurface::GetResultsFileVtu()const{
+  return(AppInfo.GetDirDataOut()+"Gauges"+GetNameType(Type)+"_"+Name)+".vtu";
+}
+
+//==============================================================================
+/// Results are not stored in buffer since each isosurface is saved by 
+/// StoreResult().
+//==============================================================================
+void JGaugeIsosurface::SaveResults(){
+}
+
+//==============================================================================
+/// Saves last isosurface in VTU file for the PART.
+//==============================================================================
+void JGaugeIsosurface::SaveVtkResult(unsigned cpart){
+  const string file=fun::GetWithoutExtension(GetResultsFileVtk())+"_Part.vtu";
+  Log->AddFileInfo(fun::FileNameSec(file,UINT_MAX),FileInfo);
+  const unsigned npt=GetResNumPoints();
+  const unsigned ncells=GetResNumCells();
+  JSaveVtu svtu(JSaveVtu::ENC_Raw,false);
+  svtu.SaveFilePolys(fun::FileNameSec(file,cpart),npt,(npt? &ResPos[0]: NULL)
+    ,ncells,ResNvCell,(ncells? &ResCells[0]: NULL),0,NULL);
+}
+
+//==============================================================================
+/// Loads and returns number definition points.
+//==============================================================================
+unsigned JGaugeIsosurface::GetPointDef(std::vector<tfloat3> &points)const{
+  points.push_back(ToTFloat3(Point0));
+  points.push_back(ToTFloat3(Point2));
+  return(2);
+}
+
+//==============================================================================
+/// Calculates mass of fluid at grid nodes and extracts the isosurface (on CPU).
+/// The mass of a node is the kernel interpolation of the fluid density 
+/// multiplied by the volume of one particle.
+//==============================================================================
+void JGaugeIsosurface::CalculeCpu(double timestep,tuint3 ncells,tuint3 cellmin
+  ,const unsigned *begincell,unsigned npbok,unsigned npb,unsigned np
+  ,const tdouble3 *pos,const typecode *code,const typeidp *idp,const tfloat4 *velrhop,const unsigned *ridpbound)
+{
+  SetTimeStep(timestep);
+  const tint4 nc=TInt4(int(ncells.x),int(ncells.y),int(ncells.z),int(ncells.x*ncells.y));
+  const tint3 cellzero=TInt3(cellmin.x,cellmin.y,cellmin.z);
+  const unsigned cellfluid=nc.w*nc.z+1;
+  const float massvol=float(MassFluid*(Simulate2D? Dp*Dp: Dp*Dp*Dp));
+  //-Computes mass on grid nodes.
+  NodeMass.resize(NodeCount);
+  const int n=int(NodeCount);
+  #ifdef OMP_USE
+    #pragma omp parallel for schedule (guided)
+  #endif
+  for(int cn=0;cn<n;cn++){
+    const tdouble3 ptpos=GetNodePos(unsigned(cn));
+    double summass=0;
+    const bool ptout=PointIsOut(ptpos.x,ptpos.y,ptpos.z);//-Verify that the point is within domain boundaries. | Comprueba que el punto este dentro de limites del dominio.
+    if(!ptout){
+      const bool rsymp1=(Symmetry && (ptpos.y<=H+H)); //<vs_syymmetry>
+      //-Obtain limits of interaction. | Obtiene limites de interaccion.
+      int cxini,cxfin,yini,yfin,zini,zfin;
+      GetInteractionCells(ptpos,nc,cellzero,cxini,cxfin,yini,yfin,zini,zfin);
+
+      //-Search for neighbors in adjacent cells. | Busqueda de vecinos en celdas adyacentes.
+      if(cxini<cxfin)for(int z=zini;z<zfin;z++){
+        const int zmod=(nc.w)*z+cellfluid; //-Sum from start of fluid cells. | Le suma donde empiezan las celdas de fluido.
+        for(int y=yini;y<yfin;y++){
+          int ymod=zmod+nc.x*y;
+          const unsigned pini=begincell[cxini+ymod];
+          const unsigned pfin=begincell[cxfin+ymod];
+
+          //-Interaction with Fluid/Floating | Interaccion con varias Fluid/Floating.
+          //--------------------------------------------------------------------------
+          bool rsym=false; //<vs_syymmetry>
+          for(unsigned p2=pini;p2<pfin;p2++){
+            const float drx=float(ptpos.x-pos[p2].x);
+                  float dry=float(ptpos.y-pos[p2].y);
+            if(rsym)    dry=float(ptpos.y+pos[p2].y); //<vs_syymmetry>
+            const float drz=float(ptpos.z-pos[p2].z);
+            const float rr2=(drx*drx+dry*dry+drz*drz);
+            //-Interaction with real neighboring particles. | Interaccion con particulas vecinas reales.
+            if(rr2<=Fourh2 && CODE_IsFluid(code[p2])){
+              float wab;
+              {//-Wendland kernel.
+                const float qq=sqrt(rr2)/H;
+                const float wqq=2.f*qq+1.f;
+                const float wqq1=1.f-0.5f*qq;
+                const float wqq2=wqq1*wqq1;
+                wab=Awen*wqq*wqq2*wqq2; //-Kernel.
+              }
+              summass+=wab;
+              rsym=(rsymp1 && !rsym && float(ptpos.y-dry)<=H+H); //<vs_syymmetry>
+              if(rsym)p2--;                                      //<vs_syymmetry>
+            }
+            else rsym=false;                                     //<vs_syymmetry>
+          }
+        }
+      }
+    }
+    NodeMass[cn]=float(summass*massvol);
+  }
+  //-Extracts isosurface.
+  ComputeSurface();
+  ResTimeStep=timestep;
+  if(Output(timestep))StoreResult();
+}
+
+#ifdef _WITHGPU
+//==============================================================================
+/// Calculates isosurface of fluid mass (on GPU).
+//==============================================================================
+void JGaugeIsosurface::CalculeGpu(double timestep,tuint3 ncells,tuint3 cellmin
+  ,const int2 *beginendcell,unsigned npbok,unsigned npb,unsigned np
+  ,const double2 *posxy,const double *posz,const typecode *code,const unsigned *idp,const float4 *velrhop,float3 *aux)
+{
+  RunException("CalculeGpu","Isosurface gauge is not available for GPU executions.");
+}
+#endif
+
+
+//##############################################################################
+//# JGaugeFlow
+//##############################################################################
+//==============================================================================
+/// Constructor.
+//==============================================================================
+JGaugeFlow::JGaugeFlow(unsigned idx,std::string name,const std::vector<tdouble3> &points
+  ,double pointdp,const tdouble3 &direction,float kclimit,bool cpu,JLog2* log)
+  :JGaugeItem(GAUGE_Flow,idx,name,cpu,log)
+{
+  ClassName="JGaugeFlow";
+  FileInfo=string("Saves flow rate across a section (by ")+ClassName+").";
+  ResVn=NULL; ResRhop=NULL;
+  Reset();
+  SetPoints(points,pointdp,direction);
+  KcLimit=kclimit;
+  //-Allocates memory for the last measure.
+  const unsigned nn=GetNodeCount();
+  ResVn=new float[nn];
+  ResRhop=new float[nn];
+  ClearResult();
+}
+
+//==============================================================================
+/// Destructor (frees memory of results).
+//==============================================================================
+JGaugeFlow::~JGaugeFlow(){
+  DestructorActive=true;
+  Reset();
+}
+
+//==============================================================================
+/// Initialisation of variables.
+//==============================================================================
+void JGaugeFlow::Reset(){
+  delete[] ResVn;   ResVn=NULL;
+  delete[] ResRhop; ResRhop=NULL;
+  Points.clear();
+  PointDp=0;
+  KcLimit=0;
+  Normal=TDouble3(0);
+  Area=0;
+  Nodes.clear();
+  NodeArea=0;
+  Result.Reset();
+  OutBuff.clear();
+  JGaugeItem::Reset();
+}
+
+//==============================================================================
+/// Initialises values of the last measure.
+//==============================================================================
+void JGaugeFlow::ClearResult(){
+  Result.Reset();
+  const unsigned nn=GetNodeCount();
+  if(nn){
+    memset(ResVn,0,sizeof(float)*nn);
+    memset(ResRhop,0,sizeof(float)*nn);
+  }
+}
+
+//==============================================================================
+/// Defines the section and its sampling points. Two points define a segment
+/// (2D) and three or more points define a planar polygon (3D). The sampling
+/// points are the centres of a regular grid (cells of size close to pointdp)
+/// inside the section. The normal follows the order of the vertices and it 
+/// is reversed when it is opposite to direction (when direction is not zero).
+///
+/// Define la seccion y sus puntos de muestreo. Dos puntos definen un segmento
+/// (2D) y tres o mas un poligono plano (3D). Los puntos de muestreo son los 
+/// centros de una malla regular dentro de la seccion.
+//==============================================================================
+void JGaugeFlow::SetPoints(const std::vector<tdouble3> &points,double pointdp,const tdouble3 &direction){
+  const char met[]="SetPoints";
+  Points=points;
+  PointDp=pointdp;
+  Nodes.clear();
+  const unsigned npt=unsigned(Points.size());
+  if(!npt)return;
+  if(npt<2 || PointDp<=0)RunException(met,"The definition of the section is invalid.");
+  if(npt==2){//-Segment on plane XZ (2D).
+    const tdouble3 p0=Points[0],vec=Points[1]-Points[0];
+    Area=sqrt(vec.x*vec.x+vec.z*vec.z);
+    if(Area<=0)RunException(met,"The length of the section is zero.");
+    Normal=TDouble3(vec.z/Area,0,-vec.x/Area);
+    const unsigned ns=max(1u,unsigned(ceil(Area/PointDp)));
+    for(unsigned c=0;c<ns;c++){
+      const double f=(c+0.5)/ns;
+      Nodes.push_back(TDouble3(p0.x+vec.x*f,p0.y,p0.z+vec.z*f));
+    }
+  }
+  else{//-Planar polygon (3D).
+    //-Computes normal and area using Newell's method.
+    tdouble3 nor=TDouble3(0);
+    for(unsigned c=0;c<npt;c++)nor=nor+fgeo::ProductVec(Points[c],Points[(c+1)%npt]);
+    const double nmod=fgeo::PointDist(nor);
+    Area=nmod*0.5;
+    if(Area<=0)RunException(met,"The area of the section is zero.");
+    Normal=nor/nmod;
+    for(unsigned c=0;c<npt;c++)if(fabs(fgeo::ProductScalar(Points[c]-Points[0],Normal))>PointDp*0.01)
+      RunException(met,"The points of the section are not on the same plane.");
+    //-Local 2D coordinates of the vertices on the plane.
+    const tdouble3 p0=Points[0];
+    const tdouble3 vu=fgeo::VecUnitary(Points[1]-p0);
+    const tdouble3 vv=fgeo::ProductVec(Normal,vu);
+    std::vector<tdouble2> ptuv(npt);
+    tdouble2 pmin=TDouble2(DBL_MAX),pmax=TDouble2(-DBL_MAX);
+    for(unsigned c=0;c<npt;c++){
+      const tdouble3 d=Points[c]-p0;
+      const tdouble2 uv=TDouble2(fgeo::ProductScalar(d,vu),fgeo::ProductScalar(d,vv));
+      ptuv[c]=uv;
+      pmin=TDouble2(min(pmin.x,uv.x),min(pmin.y,uv.y));
+      pmax=TDouble2(max(pmax.x,uv.x),max(pmax.y,uv.y));
+    }
+    //-Selects centres of grid cells inside the polygon (crossing number).
+    const unsigned nu=max(1u,unsigned(ceil((pmax.x-pmin.x)/PointDp)));
+    const unsigned nv=max(1u,unsigned(ceil((pmax.y-pmin.y)/PointDp)));
+    const double du=(pmax.x-pmin.x)/nu,dv=(pmax.y-pmin.y)/nv;
+    for(unsigned cv=0;cv<nv;cv++)for(unsigned cu=0;cu<nu;cu++){
+      const double u=pmin.x+du*(cu+0.5),v=pmin.y+dv*(cv+0.5);
+      bool inside=false;
+      for(unsigned c=0,c2=npt-1;c<npt;c2=c++){
+        const tdouble2 a=ptuv[c],b=ptuv[c2];
+        if((a.y>v)!=(b.y>v) && u<(b.x-a.x)*(v-a.y)/(b.y-a.y)+a.x)inside=!inside;
+      }
+      if(inside)Nodes.push_back(p0+vu*u+vv*v);
+    }
+    if(Nodes.empty())RunException(met,"There are no sampling points inside the section.");
+  }
+  //-Orientation of the normal.
+  if(fgeo::ProductScalar(Normal,direction)<0)Normal=TDouble3(0)-Normal;
+  NodeArea=Area/GetNodeCount();
+}
+
+//==============================================================================
+/// Record the last measure result.
+//==============================================================================
+void JGaugeFlow::StoreResult(){
+  if(OutputSave){
+    //-Allocates memory.
+    while(unsigned(OutBuff.size())<OutSize)OutBuff.push_back(StrGaugeFlowRes());
+    //-Empty buffer.
+    if(OutCount+1>=OutSize)SaveResults();
+    //-Stores last results.
+    OutBuff[OutCount]=Result;
+    OutCount++;
+    //-Updates OutputNext.
+    if(OutputDt){
+      const unsigned nt=unsigned(TimeStep/OutputDt);
+      OutputNext=OutputDt*nt;
+      if(OutputNext<=TimeStep)OutputNext=OutputDt*(nt+1);
+    }
+  }
+}
+
+//==============================================================================
+/// Saves stored results in CSV file.
+//==============================================================================
+void JGaugeFlow::SaveResults(){
+  if(OutCount && OutBin)SaveResultsBin();
+  if(OutCount){
+    const bool first=OutFile.empty();
+    if(first){
+      OutFile=GetResultsFileCsv();
+      Log->AddFileInfo(OutFile,FileInfo);
+    }
+    jcsv::JSaveCsv2 scsv(OutFile,!first,AppInfo.GetCsvSepComa());
+    //-Saves head.
+    if(first){
+      scsv.SetHead();
+      if(Simulate2D)scsv <<"time [s];flow [m^2/s];massflow [kg/m/s];wetlength [m]" << jcsv::Endl();
+      else          scsv <<"time [s];flow [m^3/s];massflow [kg/s];wetarea [m^2]" << jcsv::Endl();
+    }
+    //-Saves data.
+    scsv.SetData();
+    scsv << jcsv::Fmt(jcsv::TpDouble1,"%g");
+    for(unsigned c=0;c<OutCount;c++){
+      scsv << OutBuff[c].timestep << OutBuff[c].flow << OutBuff[c].massflow << OutBuff[c].wetarea << jcsv::Endl();
+    }
+    OutCount=0;
+  }
+}
+
+//==============================================================================
+/// Saves stored results in binary file of gauges.
+//==============================================================================
+void JGaugeFlow::SaveResultsBin(){
+  JBinaryData *blk=OutBin->NewBlock(Idx,OutCount);
+  JBinaryDataArray *atime=JGaugeBi4Save::AddColumn(blk,"time [s]",JBinaryDataDef::DatDouble,"%g");
+  JBinaryDataArray *aflow=JGaugeBi4Save::AddColumn(blk,(Simulate2D? "flow [m^2/s]": "flow [m^3/s]"),JBinaryDataDef::DatDouble,"%g");
+  JBinaryDataArray *amass=JGaugeBi4Save::AddColumn(blk,(Simulate2D? "massflow [kg/m/s]": "massflow [kg/s]"),JBinaryDataDef::DatDouble,"%g");
+  JBinaryDataArray *awet =JGaugeBi4Save::AddColumn(blk,(Simulate2D? "wetlength [m]": "wetarea [m^2]"),JBinaryDataDef::DatDouble,"%g");
+  for(unsigned c=0;c<OutCount;c++){
+    atime->AddData(1,&OutBuff[c].timestep,false);
+    aflow->AddData(1,&OutBuff[c].flow,false);
+    amass->AddData(1,&OutBuff[c].massflow,false);
+    awet ->AddData(1,&OutBuff[c].wetarea,false);
+  }
+  OutBin->PushBlock(blk);
+  OutCount=0;
+}
+
+//==============================================================================
+/// Saves last result in VTK file.
+//==============================================================================
+void JGaugeFlow::SaveVtkResult(unsigned cpart){
+  std::vector<tfloat3> points;
+  const unsigned nn=GetPointDef(points);
+  //-Prepares data.
+  std::vector<JFormatFiles2::StScalarData> fields;
+  fields.push_back(JFormatFiles2::DefineField("Vn"  ,JFormatFiles2::Float32,1,ResVn));
+  fields.push_back(JFormatFiles2::DefineField("Rhop",JFormatFiles2::Float32,1,ResRhop));
+  //-Saves VTK file.
+  Log->AddFileInfo(fun::FileNameSec(GetResultsFileVtk(),UINT_MAX),FileInfo);
+  JFormatFiles2::SaveVtk(fun::FileNameSec(GetResultsFileVtk(),cpart),nn,&(points[0]),fields);
+}
+
+//==============================================================================
+/// Loads and returns number definition points.
+//==============================================================================
+unsigned JGaugeFlow::GetPointDef(std::vector<tfloat3> &points)const{
+  const unsigned nn=GetNodeCount();
+  for(unsigned cn=0;cn<nn;cn++)points.push_back(ToTFloat3(Nodes[cn]));
+  return(nn);
+}
+
+//==============================================================================
+/// Calculates flow rate across the section (on CPU).
+/// Velocity and density are interpolated with kernel correction (Shepard) at
+/// the sampling points and only the points with a kernel sum of KcLimit or
+/// more contribute to the flux. Only the cells around the section are visited.
+//==============================================================================
+void JGaugeFlow::CalculeCpu(double timestep,tuint3 ncells,tuint3 cellmin
+  ,const unsigned *begincell,unsigned npbok,unsigned npb,unsigned np
+  ,const tdouble3 *pos,const typecode *code,const typeidp *idp,const tfloat4 *velrhop,const unsigned *ridpbound)
+{
+  SetTimeStep(timestep);
+  const tint4 nc=TInt4(int(ncells.x),int(ncells.y),int(ncells.z),int(ncells.x*ncells.y));
+  const tint3 cellzero=TInt3(cellmin.x,cellmin.y,cellmin.z);
+  const unsigned cellfluid=nc.w*nc.z+1;
+  const tfloat3 nor=ToTFloat3(Normal);
+  //-Start measure.
+  const int n=int(GetNodeCount());
+  #ifdef OMP_USE
+    #pragma omp parallel for schedule (guided)
+  #endif
+  for(int cn=0;cn<n;cn++){
+    const tdouble3 ptpos=Nodes[cn];
+    float ptvn=0,ptrhop=0;
+    const bool ptout=PointIsOut(ptpos.x,ptpos.y,ptpos.z);//-Verify that the point is within domain boundaries. | Comprueba que el punto este dentro de limites del dominio.
+    if(!ptout){
+      const bool rsymp1=(Symmetry && (ptpos.y<=H+H)); //<vs_syymmetry>
+      //-Obtain limits of interaction. | Obtiene limites de interaccion.
+      int cxini,cxfin,yini,yfin,zini,zfin;
+      GetInteractionCells(ptpos,nc,cellzero,cxini,cxfin,yini,yfin,zini,zfin);
+
+      //-Auxiliary variables.
+      double sumwab=0,sumrhop=0;
+      tdouble3 sumvel=TDouble3(0);
+
+      //-Search for neighbors in adjacent cells. | Busqueda de vecinos en celdas adyacentes.
+      if(cxini<cxfin)for(int z=zini;z<zfin;z++){
+        const int zmod=(nc.w)*z+cellfluid; //-Sum from start of fluid cells. | Le suma donde empiezan las celdas de fluido.
+        for(int y=yini;y<yfin;y++){
+          int ymod=zmod+nc.x*y;
+          const unsigned pini=begincell[cxini+ymod];
+          const unsigned pfin=begincell[cxfin+ymod];
+
+          //-Interaction with Fluid/Floating | Interaccion con varias Fluid/Floating.
+          //--------------------------------------------------------------------------
+          bool rsym=false; //<vs_syymmetry>
+          for(unsigned p2=pini;p2<pfin;p2++){
+            const float drx=float(ptpos.x-pos[p2].x);
+                  float dry=float(ptpos.y-pos[p2].y);
+            if(rsym)    dry=float(ptpos.y+pos[p2].y); //<vs_syymmetry>
+            const float drz=float(ptpos.z-pos[p2].z);
+            const float rr2=(drx*drx+dry*dry+drz*drz);
+            //-Interaction with real neighboring particles. | Interaccion con particulas vecinas reales.
+            if(rr2<=Fourh2 && rr2>=ALMOSTZERO && CODE_IsFluid(code[p2])){
+              float wab;
+              {//-Wendland kernel.
+                const float qq=sqrt(rr2)/H;
+                const float wqq=2.f*qq+1.f;
+                const float wqq1=1.f-0.5f*qq;
+                const float wqq2=wqq1*wqq1;
+                wab=Awen*wqq*wqq2*wqq2; //-Kernel.
+              }
+              tfloat4 velrhop2=velrhop[p2];
+              if(rsym)velrhop2.y=-velrhop2.y; //<vs_syymmetry>
+              wab*=MassFluid/velrhop2.w;
+              sumwab+=wab;
+              sumvel.x+=wab*velrhop2.x;
+              sumvel.y+=wab*velrhop2.y;
+              sumvel.z+=wab*velrhop2.z;
+              sumrhop+=wab*velrhop2.w;
+              rsym=(rsymp1 && !rsym && float(ptpos.y-dry)<=H+H); //<vs_syymmetry>
+              if(rsym)p2--;                                      //<vs_syymmetry>
+            }
+            else rsym=false;                                     //<vs_syymmetry>
+          }
+        }
+      }
+      //-Applies kernel correction when there is enough fluid around the point.
+      if(sumwab>=KcLimit){
+        const tfloat3 ptvel=ToTFloat3(sumvel/sumwab);
+        ptvn=ptvel.x*nor.x+ptvel.y*nor.y+ptvel.z*nor.z;
+        ptrhop=float(sumrhop/sumwab);
+      }
+    }
+    //-Stores values of the point.
+    ResVn[cn]=ptvn;
+    ResRhop[cn]=ptrhop;
+  }
+  //-Integrates flux over the section (in order so results do not depend on the number of threads).
+  double flow=0,massflow=0;
+  unsigned nwet=0;
+  for(int cn=0;cn<n;cn++)if(ResRhop[cn]){
+    flow+=ResVn[cn];
+    massflow+=double(ResVn[cn])*ResRhop[cn];
+    nwet++;
+  }
+  Result.Set(timestep,flow*NodeArea,massflow*NodeArea,NodeArea*nwet);
+  if(Output(timestep))StoreResult();
+}
+
+#ifdef _WITHGPU
+//==============================================================================
+/// Calculates flow rate across the section (on GPU).
+//==============================================================================
+void JGaugeFlow::CalculeGpu(double timestep,tuint3 ncells,tuint3 cellmin
+  ,const int2 *beginendcell,unsigned npbok,unsigned npb,unsigned np
+  ,const double2 *posxy,const double *posz,const typecode *code,const unsigned *idp,const float4 *velrhop,float3 *aux)
+{
+  RunException("CalculeGpu","Flow gauge is not available for GPU executions.");
+}
+#endif
+
+
+//##############################################################################
+//# JGaugePressure
+//##############################################################################
+//==============================================================================
+/// Constructor.
+//==============================================================================
+JGaugePressure::JGaugePressure(unsigned idx,std::string name,word mkbound
+  ,TpParticles typeparts,unsigned idbegin,unsigned count,typecode code
+  ,tfloat3 center,unsigned decimation,float kclimit,bool cpu,JLog2* log)
+  :JGaugeItem(GAUGE_Pressure,idx,name,cpu,log)
+{
+  ClassName="JGaugePressure";
+  FileInfo=string("Saves pressure interpolated on boundary particles (by ")+ClassName+").";
+  ResPos=NULL; ResPress=NULL;
+  Reset();
+  MkBound=mkbound;
+  TypeParts=typeparts;
+  IdBegin=idbegin;
+  Count=count;
+  Code=code;
+  InitialCenter=center;
+  Decimation=max(decimation,1u);
+  KcLimit=kclimit;
+  NodeCount=(Count+Decimation-1)/Decimation;
+  SavePos=(TypeParts!=TpPartFixed);
+  //-Allocates memory for the last measure.
+  ResPos=new tfloat3[NodeCount];
+  ResPress=new float[NodeCount];
+  ClearResult();
+}
+
+//==============================================================================
+/// Destructor (frees memory of results).
+//==============================================================================
+JGaugePressure::~JGaugePressure(){
+  DestructorActive=true;
+  Reset();
+}
+
+//==============================================================================
+/// Initialisation of variables.
+//==============================================================================
+void JGaugePressure::Reset(){
+  delete[] ResPos;   ResPos=NULL;
+  delete[] ResPress; ResPress=NULL;
+  MkBound=0;
+  TypeParts=TpPartUnknown;
+  IdBegin=Count=0;
+  Code=0;
+  InitialCenter=TFloat3(0);
+  Decimation=1;
+  KcLimit=0;
+  NodeCount=0;
+  SavePos=false;
+  ResTimeStep=0;
+  OutTimes.clear();
+  OutPos.clear();
+  OutPress.clear();
+  OutNum=0;
+  JGaugeItem::Reset();
+}
+
+//==============================================================================
+/// Initialises values of the last measure.
+//==============================================================================
+void JGaugePressure::ClearResult(){
+  ResTimeStep=0;
+  if(NodeCount){
+    memset(ResPos,0,sizeof(tfloat3)*NodeCount);
+    memset(ResPress,0,sizeof(float)*NodeCount);
+  }
+}
+
+//==============================================================================
+/// Returns mean pressure of the selected particles in the last measure.
+/// Devuelve la presion media de las particulas seleccionadas en la ultima medida.
+//==============================================================================
+double JGaugePressure::GetResultPressMean()const{
+  double psum=0;
+  for(unsigned cn=0;cn<NodeCount;cn++)psum+=ResPress[cn];
+  return(NodeCount? psum/NodeCount: 0);
+}
+
+//==============================================================================
+/// Record the last measure result.
+//==============================================================================
+void JGaugePressure::StoreResult(){
+  if(OutputSave){
+    //-Empty buffer.
+    if(OutBufferFull())SaveResults();
+    //-Allocates memory.
+    const size_t ini=size_t(OutCount)*NodeCount;
+    if(OutPress.size()<ini+NodeCount){
+      if(SavePos)OutPos.resize(ini+NodeCount);
+      OutPress.resize(ini+NodeCount);
+    }
+    if(OutTimes.size()<OutCount+1)OutTimes.resize(OutCount+1);
+    //-Stores last results.
+    OutTimes[OutCount]=ResTimeStep;
+    if(SavePos)memcpy(&OutPos[ini],ResPos,sizeof(tfloat3)*NodeCount);
+    memcpy(&OutPress[ini],ResPress,sizeof(float)*NodeCount);
+    OutCount++;
+    //-Updates OutputNext.
+    if(OutputDt){
+      const unsigned nt=unsigned(TimeStep/OutputDt);
+      OutputNext=OutputDt*nt;
+      if(OutputNext<=TimeStep)OutputNext=OutputDt*(nt+1);
+    }
+  }
+}
+
+//==============================================================================
+/// Returns filename for output results in binary format.
+//==============================================================================
+std::string JGaugePressure::GetResultsFileBin()const{
+  return(AppInfo.GetDirOut()+"Gauges"+GetNameType(Type)+"_"+Name)+".bi4";
+}
+
+//==============================================================================
+/// Saves stored results in binary file. The first call writes the definition 
+/// with the Idp of the nodes (and their positions for fixed boundaries) and 
+/// each measure is appended as item DATA_XXXXXX.
+//==============================================================================
+void JGaugePressure::SaveResults(){
+  if(OutCount){
+    const bool first=OutFile.empty();
+    if(first){
+      OutFile=GetResultsFileBin();
+      Log->AddFileInfo(OutFile,FileInfo);
+    }
+    JBinaryData bdat(ClassName);
+    JBinaryData *item=bdat.CreateItem("Data");
+    //-Saves head.
+    if(first){
+      bdat.SetvText("AppName",AppInfo.GetFullName());
+      bdat.SetvText("Name",Name);
+      bdat.SetvUint("MkBound",MkBound);
+      bdat.SetvText("TypeParts",TpPartGetStrCode(TypeParts));
+      bdat.SetvUint("IdBegin",IdBegin);
+      bdat.SetvUint("Count",Count);
+      bdat.SetvUint("Decimation",Decimation);
+      bdat.SetvUint("NodeCount",NodeCount);
+      bdat.SetvFloat("KcLimit",KcLimit);
+      bdat.SetvBool("SavePos",SavePos);
+      std::vector<unsigned> nodeidp(NodeCount);
+      for(unsigned cn=0;cn<NodeCount;cn++)nodeidp[cn]=GetNodeIdp(cn);
+      bdat.CreateArray("Idp",JBinaryDataDef::DatUint,NodeCount,nodeidp.data(),false);
+      if(!SavePos)bdat.CreateArray("Pos",JBinaryDataDef::DatFloat3,NodeCount,ResPos,false);
+      item->SetHide(true);
+      bdat.SaveFile(OutFile,true,false);
+    }
+    //-Saves data.
+    for(unsigned c=0;c<OutCount;c++){
+      const size_t ini=size_t(c)*NodeCount;
+      item->SetName(fun::PrintStr("DATA_%06u",OutNum));
+      item->SetvUint("Num",OutNum);
+      item->SetvDouble("TimeStep",OutTimes[c]);
+      if(SavePos)item->CreateArray("Pos",JBinaryDataDef::DatFloat3,NodeCount,&OutPos[ini],false);
+      item->CreateArray("Press",JBinaryDataDef::DatFloat,NodeCount,&OutPress[ini],false);
+      item->SaveFileListApp(OutFile,ClassName,true,true);
+      item->RemoveArrays();
+      OutNum++;
+    }
+    OutCount=0;
+  }
+}
+
+//==============================================================================
+/// Saves last result in VTK file.
+//==============================================================================
+void JGaugePressure::SaveVtkResult(unsigned cpart){
+  std::vector<unsigned> nodeidp(NodeCount);
+  for(unsigned cn=0;cn<NodeCount;cn++)nodeidp[cn]=GetNodeIdp(cn);
+  //-Prepares data.
+  std::vector<JFormatFiles2::StScalarData> fields;
+  fields.push_back(JFormatFiles2::DefineField("Idp"  ,JFormatFiles2::UInt32,1,nodeidp.data()));
+  fields.push_back(JFormatFiles2::DefineField("Press",JFormatFiles2::Float32,1,ResPress));
+  //-Saves VTK file.
+  Log->AddFileInfo(fun::FileNameSec(GetResultsFileVtk(),UINT_MAX),FileInfo);
+  JFormatFiles2::SaveVtk(fun::FileNameSec(GetResultsFileVtk(),cpart),NodeCount,ResPos,fields);
+}
+
+//==============================================================================
+/// Loads and returns number definition points.
+//==============================================================================
+unsigned JGaugePressure::GetPointDef(std::vector<tfloat3> &points)const{
+  points.push_back(InitialCenter);
+  return(1);
+}
+
+//==============================================================================
+/// Calculates pressure at the selected boundary particles (on CPU).
+/// Each node is computed independently in one parallel loop using ridpbound[]
+/// to find the particle and the cells of fluid around it. Nodes with a kernel
+/// sum lower than KcLimit and excluded particles are stored with zero 
+/// pressure (the position of excluded particles is not updated).
+//==============================================================================
+void JGaugePressure::CalculeCpu(double timestep,tuint3 ncells,tuint3 cellmin
+  ,const unsigned *begincell,unsigned npbok,unsigned npb,unsigned np
+  ,const tdouble3 *pos,const typecode *code,const typeidp *idp,const tfloat4 *velrhop,const unsigned *ridpbound)
+{
+  if(!ridpbound)RunException("CalculeCpu","Index of boundary particles is missing.");
+  SetTimeStep(timestep);
+  const tint4 nc=TInt4(int(ncells.x),int(ncells.y),int(ncells.z),int(ncells.x*ncells.y));
+  const tint3 cellzero=TInt3(cellmin.x,cellmin.y,cellmin.z);
+  const unsigned cellfluid=nc.w*nc.z+1;
+  //-Start measure.
+  const unsigned *ridp=ridpbound+IdBegin;
+  const int n=int(NodeCount);
+  #ifdef OMP_USE
+    #pragma omp parallel for schedule (guided)
+  #endif
+  for(int cn=0;cn<n;cn++){
+    const unsigned p1=ridp[unsigned(cn)*Decimation];
+    if(p1>=npbok){ ResPress[cn]=0; continue; }//-Particle is excluded or out of domain.
+    const tdouble3 ptpos=pos[p1];
+    float ptpress=0;
+    const bool rsymp1=(Symmetry && (ptpos.y<=H+H)); //<vs_syymmetry>
+    //-Obtain limits of interaction. | Obtiene limites de interaccion.
+    int cxini,cxfin,yini,yfin,zini,zfin;
+    GetInteractionCells(ptpos,nc,cellzero,cxini,cxfin,yini,yfin,zini,zfin);
+
+    //-Auxiliary variables.
+    double sumwab=0,sumpress=0;
+
+    //-Search for neighbors in adjacent cells. | Busqueda de vecinos en celdas adyacentes.
+    if(cxini<cxfin)for(int z=zini;z<zfin;z++){
+      const int zmod=(nc.w)*z+cellfluid; //-Sum from start of fluid cells. | Le suma donde empiezan las celdas de fluido.
+      for(int y=yini;y<yfin;y++){
+        int ymod=zmod+nc.x*y;
+        const unsigned pini=begincell[cxini+ymod];
+        const unsigned pfin=begincell[cxfin+ymod];
+
+        //-Interaction with Fluid/Floating | Interaccion con varias Fluid/Floating.
+        //--------------------------------------------------------------------------
+        bool rsym=false; //<vs_syymmetry>
+        for(unsigned p2=pini;p2<pfin;p2++){
+          const float drx=float(ptpos.x-pos[p2].x);
+                float dry=float(ptpos.y-pos[p2].y);
+          if(rsym)    dry=float(ptpos.y+pos[p2].y); //<vs_syymmetry>
+          const float drz=float(ptpos.z-pos[p2].z);
+          const float rr2=(drx*drx+dry*dry+drz*drz);
+          //-Interaction with real neighboring particles. | Interaccion con particulas vecinas reales.
+          if(rr2<=Fourh2 && rr2>=ALMOSTZERO && CODE_IsFluid(code[p2])){
+            float wab;
+            {//-Wendland kernel.
+              const float qq=sqrt(rr2)/H;
+              const float wqq=2.f*qq+1.f;
+              const float wqq1=1.f-0.5f*qq;
+              const float wqq2=wqq1*wqq1;
+              wab=Awen*wqq*wqq2*wqq2; //-Kernel.
+            }
+            const float rhop2=velrhop[p2].w;
+            const float press2=CteB*(pow(rhop2/RhopZero,Gamma)-1.0f);
+            wab*=MassFluid/rhop2;
+            sumwab+=wab;
+            sumpress+=wab*press2;
+            rsym=(rsymp1 && !rsym && float(ptpos.y-dry)<=H+H); //<vs_syymmetry>
+            if(rsym)p2--;                                      //<vs_syymmetry>
+          }
+          else rsym=false;                                     //<vs_syymmetry>
+        }
+      }
+    }
+    //-Applies kernel correction when there is enough fluid around the node.
+    if(sumwab>=KcLimit)ptpress=float(sumpress/sumwab);
+    //-Stores result. | Guarda resultado.
+    ResPos[cn]=ToTFloat3(ptpos);
+    ResPress[cn]=ptpress;
+  }
+  ResTimeStep=timestep;
+  if(Output(timestep))StoreResult();
+}
+
+#ifdef _WITHGPU
+//==============================================================================
+/// Calculates pressure at the selected boundary particles (on GPU).
+//==============================================================================
+void JGaugePressure::CalculeGpu(double timestep,tuint3 ncells,tuint3 cellmin
+  ,const int2 *beginendcell,unsigned npbok,unsigned npb,unsigned np
+  ,const double2 *posxy,const double *posz,const typecode *code,const unsigned *idp,const float4 *velrhop,float3 *aux)
+{
+  RunException("CalculeGpu","Pressure gauge is not available for GPU executions.");
+}
+#endif
@@ -21,6 +21,20 @@
 //:# =========
 //:# - Clase para medir magnitudes fisicas durante la simulacion. (12-02-2018)
 //:# - Se escriben las unidades en las cabeceras de los ficheros CSV. (26-04-2018)
+//:# - Acceso a ComputeNext y OutputNext para checkpoint/restart. (18-10-2026)
+//:# - Metodo OutBufferFull() para vaciar buffers fuera del calculo en paralelo. (18-10-2026)
+//:# - JGaugeSwl busca la superficie con celdas ocupadas y biseccion. (18-10-2026)
+//:# - Nueva clase JGaugeMesh para interpolar velocidad, presion y densidad en 
+//:#   una malla regular con grabacion en binario. (18-10-2026)
+//:# - Nueva clase JGaugeIsosurface para calcular la superficie libre durante 
+//:#   la simulacion y grabarla en ficheros VTU. (18-10-2026)
+//:# - Nueva clase JGaugeFlow para medir el caudal a traves de una seccion. (18-10-2026)
+//:# - Grabacion opcional de resultados en el fichero binario comun de medidas
+//:#   (JGaugeBi4Save) en lugar de ficheros CSV. (18-10-2026)
+//:# - Nueva clase JGaugePressure para interpolar la presion en las particulas
+//:#   de contorno de un mk con grabacion en binario. (18-10-2026)
+//:# - Estado de los ficheros de resultados en checkpoint para continuarlos al
+//:#   reiniciar. (18-10-2026)
 //:#############################################################################
 
 /// \file JGaugeItem.h \brief Declares the class \ref JGaugeItem.
@@ -38,6 +52,8 @@
 #endif
 
 class JLog2;
+class JGaugeBi4Save;
+class JBinaryData;
 
 
 //##############################################################################
@@ -55,6 +71,10 @@ public:
     ,GAUGE_Swl
     ,GAUGE_MaxZ
     ,GAUGE_Force
+    ,GAUGE_Mesh
+    ,GAUGE_Isosurface
+    ,GAUGE_Flow
+    ,GAUGE_Pressure
   }TpGauge;
 
   ///Structure with default configuration for JGaugeItem objects.
@@ -110,6 +130,7 @@ protected:
   static const unsigned OutSize=200; ///<Maximum number of results in buffer.
   unsigned OutCount;                 ///<Number of stored results in buffer.
   std::string OutFile;
+  JGaugeBi4Save *OutBin;             ///<Binary file for results of all gauges instead of CSV file (NULL: disabled).
 
   JGaugeItem(TpGauge type,unsigned idx,std::string name,bool cpu,JLog2* log);
   void Reset();
@@ -119,11 +140,13 @@ protected:
   bool PointIsOut(double px,double py)const{ return(px!=px || py!=py || px<DomPosMin.x || py<DomPosMin.y || px>=DomPosMax.x || py>=DomPosMax.y); }
   inline void GetInteractionCells(const tdouble3 &pos,const tint4 &nc,const tint3 &cellzero
     ,int &cxini,int &cxfin,int &yini,int &yfin,int &zini,int &zfin)const;
-
-  static std::string GetNameType(TpGauge type);
+  void ConfigGrid(const tdouble3 &point0,const tdouble3 &point2,double pointdp
+    ,tuint3 &pointnp,unsigned &nodecount,tdouble3 &pointdir)const;
 
   virtual void ClearResult()=0;
   virtual void StoreResult()=0;
+  virtual unsigned GetOutNum()const{ return(0); } ///<Number of saved outputs (measures or files).
+  virtual void SetOutNum(unsigned num){}
 
  #ifdef _WITHGPU
   void RunExceptionCuda(const std::string &method,const std::string &msg,cudaError_t error);
@@ -135,6 +158,8 @@ public:
   const unsigned Idx;
   const std::string Name;
 
+  virtual ~JGaugeItem(){}
+
   void Config(bool simulate2d,bool symmetry
     ,tdouble3 domposmin,tdouble3 domposmax
     ,float scell,int hdiv,float h,float massfluid,float massbound
@@ -143,8 +168,11 @@ public:
   void ConfigComputeTiming(double start,double end,double dt);
   void ConfigOutputTiming(bool save,double start,double end,double dt);
 
+  void SetOutBin(JGaugeBi4Save *outbin){ OutBin=outbin; }
   void GetConfig(std::vector<std::string> &lines)const;
 
+  static std::string GetNameType(TpGauge type);
+
   std::string GetResultsFileCsv()const;
   std::string GetResultsFileVtk()const;
   virtual void SaveResults()=0;
@@ -161,12 +189,22 @@ public:
   double GetOutputStart()const{ return(OutputStart); }
   double GetOutputEnd()const{ return(OutputEnd); }
 
+  double GetComputeNext()const{ return(ComputeNext); }
+  double GetOutputNext()const{ return(OutputNext); }
+  void SetNextTimes(double computenext,double outputnext){ ComputeNext=computenext; OutputNext=outputnext; }
+  void SetOutputNext(double outputnext){ OutputNext=outputnext; }
+
+  void SaveCheckpoint(JBinaryData *item)const;
+  void LoadCheckpoint(const JBinaryData *item);
+
   bool Update(double timestep)const{ return(timestep>=ComputeNext && ComputeStart<=timestep && timestep<=ComputeEnd); }
   bool Output(double timestep)const{ return(OutputSave && timestep>=OutputNext && OutputStart<=timestep && timestep<=OutputEnd); }
+  virtual bool OutBufferFull()const{ return(OutCount+1>=OutSize); }
+  virtual bool CpuOwnThreads()const{ return(false); } ///<CalculeCpu() uses its own parallel loops.
 
   virtual void CalculeCpu(double timestep,tuint3 ncells,tuint3 cellmin
     ,const unsigned *begincell,unsigned npbok,unsigned npb,unsigned np
-    ,const tdouble3 *pos,const typecode *code,const unsigned *idp,const tfloat4 *velrhop)=0;
+    ,const tdouble3 *pos,const typecode *code,const typeidp *idp,const tfloat4 *velrhop,const unsigned *ridpbound)=0;
 
  #ifdef _WITHGPU
   virtual void CalculeGpu(double timestep,tuint3 ncells,tuint3 cellmin
@@ -210,6 +248,7 @@ protected:
   void Reset();
   void ClearResult(){ Result.Reset(); }
   void StoreResult();
+  void SaveResultsBin();
 
 public:
   JGaugeVelocity(unsigned idx,std::string name,tdouble3 point,bool cpu,JLog2* log);
@@ -226,7 +265,7 @@ public:
 
   void CalculeCpu(double timestep,tuint3 ncells,tuint3 cellmin
     ,const unsigned *begincell,unsigned npbok,unsigned npb,unsigned np
-    ,const tdouble3 *pos,const typecode *code,const unsigned *idp,const tfloat4 *velrhop);
+    ,const tdouble3 *pos,const typecode *code,const typeidp *idp,const tfloat4 *velrhop,const unsigned *ridpbound);
 
  #ifdef _WITHGPU
   void CalculeGpu(double timestep,tuint3 ncells,tuint3 cellmin
@@ -277,9 +316,15 @@ protected:
   void Reset();
   void ClearResult(){ Result.Reset(); }
   void StoreResult();
+  void SaveResultsBin();
   float CalculeMassCpu(const tdouble3 &ptpos,const tint4 &nc
     ,const tint3 &cellzero,unsigned cellfluid,const unsigned *begincell
     ,const tdouble3 *pos,const typecode *code,const tfloat4 *velrhop)const;
+  bool CheckFluidCellsCpu(const tdouble3 &ptpos,const tint4 &nc
+    ,const tint3 &cellzero,unsigned cellfluid,const unsigned *begincell)const;
+  float CalculeMassPointCpu(unsigned cp,const tint4 &nc
+    ,const tint3 &cellzero,unsigned cellfluid,const unsigned *begincell
+    ,const tdouble3 *pos,const typecode *code,const tfloat4 *velrhop)const;
 
 public:
   JGaugeSwl(unsigned idx,std::string name,tdouble3 point0,tdouble3 point2,double pointdp,float masslimit,bool cpu,JLog2* log);
@@ -299,7 +344,7 @@ public:
 
   void CalculeCpu(double timestep,tuint3 ncells,tuint3 cellmin
     ,const unsigned *begincell,unsigned npbok,unsigned npb,unsigned np
-    ,const tdouble3 *pos,const typecode *code,const unsigned *idp,const tfloat4 *velrhop);
+    ,const tdouble3 *pos,const typecode *code,const typeidp *idp,const tfloat4 *velrhop,const unsigned *ridpbound);
 
  #ifdef _WITHGPU
   void CalculeGpu(double timestep,tuint3 ncells,tuint3 cellmin
@@ -345,6 +390,7 @@ protected:
   void Reset();
   void ClearResult(){ Result.Reset(); }
   void StoreResult();
+  void SaveResultsBin();
   void GetInteractionCellsMaxZ(const tdouble3 &pos,const tint4 &nc,const tint3 &cellzero
     ,int &cxini,int &cxfin,int &yini,int &yfin,int &zini,int &zfin)const;
 
@@ -367,7 +413,7 @@ public:
 
   void CalculeCpu(double timestep,tuint3 ncells,tuint3 cellmin
     ,const unsigned *begincell,unsigned npbok,unsigned npb,unsigned np
-    ,const tdouble3 *pos,const typecode *code,const unsigned *idp,const tfloat4 *velrhop);
+    ,const tdouble3 *pos,const typecode *code,const typeidp *idp,const tfloat4 *velrhop,const unsigned *ridpbound);
 
  #ifdef _WITHGPU
   void CalculeGpu(double timestep,tuint3 ncells,tuint3 cellmin
@@ -423,6 +469,7 @@ protected:
   void Reset();
   void ClearResult(){ Result.Reset(); }
   void StoreResult();
+  void SaveResultsBin();
 
 public:
   JGaugeForce(unsigned idx,std::string name,word mkbound,TpParticles typeparts
@@ -441,9 +488,330 @@ public:
   tfloat3     GetInitialCenter()const{ return(InitialCenter); }
   const StGaugeForceRes& GetResult()const{ return(Result); }
 
+  bool CpuOwnThreads()const{ return(true); }
+
+  void CalculeCpu(double timestep,tuint3 ncells,tuint3 cellmin
+    ,const unsigned *begincell,unsigned npbok,unsigned npb,unsigned np
+    ,const tdouble3 *pos,const typecode *code,const typeidp *idp,const tfloat4 *velrhop,const unsigned *ridpbound);
+
+ #ifdef _WITHGPU
+  void CalculeGpu(double timestep,tuint3 ncells,tuint3 cellmin
+    ,const int2 *beginendcell,unsigned npbok,unsigned npb,unsigned np
+    ,const double2 *posxy,const double *posz,const typecode *code,const unsigned *idp,const float4 *velrhop,float3 *aux);
+ #endif
+};
+
+
+//##############################################################################
+//# JGaugeMesh
+//##############################################################################
+/// \brief Calculates velocity, pressure and density on a regular grid of points.
+/// Values are interpolated from fluid particles with Shepard correction and 
+/// the results are saved in binary format (GaugesMesh_<name>.bi4) where 
+/// each measure is an item DATA_XXXXXX with arrays Vel, Rhop and Press.
+class JGaugeMesh : public JGaugeItem
+{
+protected:
+  static const unsigned OutMemory=1024*1024*16; ///<Maximum size of results in buffer (bytes).
+
+  //-Definition.
+  tdouble3 Point0;     ///<Position of the first node.
+  tdouble3 Point2;     ///<Position of the last node.
+  double PointDp;      ///<Distance between nodes.
+  float KcLimit;       ///<Minimum kernel sum (Shepard) to compute values of a node.
+  //-Auxiliary variables.
+  tuint3 PointNp;      ///<Number of nodes in each direction.
+  unsigned NodeCount;  ///<Total number of nodes.
+  tdouble3 PointDir;   ///<Distance between nodes in each direction.
+
+  //-Result of the last measure.
+  double ResTimeStep;
+  tfloat3 *ResVel;
+  float *ResRhop;
+  float *ResPress;
+
+  //-Results in buffer.
+  std::vector<double>  OutTimes;
+  std::vector<tfloat3> OutVel;
+  std::vector<float>   OutRhop;
+  std::vector<float>   OutPress;
+  unsigned OutNum;     ///<Number of saved measures.
+
+  void Reset();
+  void ClearResult();
+  void StoreResult();
+  unsigned GetOutNum()const{ return(OutNum); }
+  void SetOutNum(unsigned num){ OutNum=num; }
+  void SetPoints(const tdouble3 &point0,const tdouble3 &point2,double pointdp);
+
+public:
+  JGaugeMesh(unsigned idx,std::string name,tdouble3 point0,tdouble3 point2,double pointdp,float kclimit,bool cpu,JLog2* log);
+  ~JGaugeMesh();
+
+  std::string GetResultsFileBin()const;
+  void SaveResults();
+  void SaveVtkResult(unsigned cpart);
+  unsigned GetPointDef(std::vector<tfloat3> &points)const;
+
+  tdouble3 GetPoint0()const{ return(Point0); }
+  tdouble3 GetPoint2()const{ return(Point2); }
+  double   GetPointDp()const{ return(PointDp); }
+  float    GetKcLimit()const{ return(KcLimit); }
+  tuint3   GetPointNp()const{ return(PointNp); }
+  unsigned GetNodeCount()const{ return(NodeCount); }
+  tdouble3 GetNodePos(unsigned cn)const{ 
+    const unsigned cx=cn%PointNp.x,cy=(cn/PointNp.x)%PointNp.y,cz=cn/(PointNp.x*PointNp.y);
+    return(TDouble3(Point0.x+PointDir.x*cx,Point0.y+PointDir.y*cy,Point0.z+PointDir.z*cz));
+  }
+  double GetResultVelMean()const;
+
+  bool OutBufferFull()const{ return(OutCount && (OutCount+1>=OutSize || ullong(OutCount+1)*NodeCount*(sizeof(tfloat3)+sizeof(float)*2)>OutMemory)); }
+  bool CpuOwnThreads()const{ return(true); }
+
+  void CalculeCpu(double timestep,tuint3 ncells,tuint3 cellmin
+    ,const unsigned *begincell,unsigned npbok,unsigned npb,unsigned np
+    ,const tdouble3 *pos,const typecode *code,const typeidp *idp,const tfloat4 *velrhop,const unsigned *ridpbound);
+
+ #ifdef _WITHGPU
+  void CalculeGpu(double timestep,tuint3 ncells,tuint3 cellmin
+    ,const int2 *beginendcell,unsigned npbok,unsigned npb,unsigned np
+    ,const double2 *posxy,const double *posz,const typecode *code,const unsigned *idp,const float4 *velrhop,float3 *aux);
+ #endif
+};
+
+
+//##############################################################################
+//# JGaugeIsosurface
+//##############################################################################
+/// \brief Calculates the free surface of the fluid as an isosurface of mass.
+/// The mass of fluid is interpolated on the nodes of a regular grid and the 
+/// surface is extracted with marching tetrahedra (6 per cell of the grid).
+/// Each output is saved as triangles (or lines in 2D) in a VTU file 
+/// (GaugesIsosurface_<name>_XXXX.vtu).
+class JGaugeIsosurface : public JGaugeItem
+{
+protected:
+  //-Definition.
+  tdouble3 Point0;     ///<Minimum position of the grid.
+  tdouble3 Point2;     ///<Maximum position of the grid.
+  double PointDp;      ///<Distance between nodes.
+  float MassLimit;     ///<Mass value of the isosurface.
+  double Dp;           ///<Initial distance between particles (to compute the mass of nodes).
+  //-Auxiliary variables.
+  tuint3 PointNp;      ///<Number of nodes in each direction.
+  unsigned NodeCount;  ///<Total number of nodes.
+  tdouble3 PointDir;   ///<Distance between nodes in each direction.
+  unsigned CornerOff[8];       ///<Offset of the nodes of each corner of a grid cell (corner bits: 1:x, 2:y, 4:z).
+  std::vector<float> NodeMass; ///<Mass of fluid on nodes [NodeCount].
+
+  //-Result of the last measure.
+  double ResTimeStep;
+  unsigned ResNvCell;            ///<Number of points per cell (3:triangles, 2:lines).
+  std::vector<tfloat3> ResPos;   ///<Position of points of the surface.
+  std::vector<unsigned> ResCells;///<Points of cells [ncells*ResNvCell].
+  unsigned OutNum;     ///<Number of saved files.
+
+  void Reset();
+  void ClearResult();
+  void SetPoints(const tdouble3 &point0,const tdouble3 &point2,double pointdp);
+  ullong GetEdgeId(unsigned node,byte corner1,byte corner2)const;
+  void AddCell(std::vector<ullong> &cells,unsigned node,unsigned nv,const byte *edges,byte cin,byte cout)const;
+  void ComputeSurface();
+  void StoreResult();
+  unsigned GetOutNum()const{ return(OutNum); }
+  void SetOutNum(unsigned num);
+
+public:
+  JGaugeIsosurface(unsigned idx,std::string name,tdouble3 point0,tdouble3 point2,double pointdp,float masslimit,double dp,bool cpu,JLog2* log);
+  ~JGaugeIsosurface();
+
+  std::string GetResultsFileVtu()const;
+  void SaveResults();
+  void SaveVtkResult(unsigned cpart);
+  unsigned GetPointDef(std::vector<tfloat3> &points)const;
+
+  tdouble3 GetPoint0()const{ return(Point0); }
+  tdouble3 GetPoint2()const{ return(Point2); }
+  double   GetPointDp()const{ return(PointDp); }
+  float    GetMassLimit()const{ return(MassLimit); }
+  tuint3   GetPointNp()const{ return(PointNp); }
+  unsigned GetNodeCount()const{ return(NodeCount); }
+  tdouble3 GetNodePos(unsigned cn)const{ 
+    const unsigned cx=cn%PointNp.x,cy=(cn/PointNp.x)%PointNp.y,cz=cn/(PointNp.x*PointNp.y);
+    return(TDouble3(Point0.x+PointDir.x*cx,Point0.y+PointDir.y*cy,Point0.z+PointDir.z*cz));
+  }
+  unsigned GetResNumPoints()const{ return(unsigned(ResPos.size())); }
+  unsigned GetResNumCells()const{ return(ResNvCell? unsigned(ResCells.size()/ResNvCell): 0); }
+  double GetResultZMean()const;
+
+  bool OutBufferFull()const{ return(false); }
+  bool CpuOwnThreads()const{ return(true); }
+
+  void CalculeCpu(double timestep,tuint3 ncells,tuint3 cellmin
+    ,const unsigned *begincell,unsigned npbok,unsigned npb,unsigned np
+    ,const tdouble3 *pos,const typecode *code,const typeidp *idp,const tfloat4 *velrhop,const unsigned *ridpbound);
+
+ #ifdef _WITHGPU
+  void CalculeGpu(double timestep,tuint3 ncells,tuint3 cellmin
+    ,const int2 *beginendcell,unsigned npbok,unsigned npb,unsigned np
+    ,const double2 *posxy,const double *posz,const typecode *code,const unsigned *idp,const float4 *velrhop,float3 *aux);
+ #endif
+};
+
+
+//##############################################################################
+//# JGaugeFlow
+//##############################################################################
+/// \brief Calculates volumetric and mass flow rate across a planar section.
+/// The section is a polygon in 3D or a segment on plane XZ in 2D (flow per 
+/// unit of width). Velocity and density of the fluid are interpolated at 
+/// points distributed over the section and the flux is integrated only where
+/// the kernel sum reaches KcLimit (wet area).
+class JGaugeFlow : public JGaugeItem
+{
+public:
+  ///Structure with result of JGaugeFlow object.
+  typedef struct StrGaugeFlowRes{
+    double timestep;
+    double flow;      ///<Volumetric flow rate [m^3/s] (or [m^2/s] in 2D).
+    double massflow;  ///<Mass flow rate [kg/s] (or [kg/m/s] in 2D).
+    double wetarea;   ///<Area of the section with fluid [m^2] (or length [m] in 2D).
+    bool modified;
+    StrGaugeFlowRes(){ Reset(); }
+    void Reset(){
+      Set(0,0,0,0);
+      modified=false;
+    }
+    void Set(double t,double flowres,double massflowres,double wetarearres){
+      timestep=t; flow=flowres; massflow=massflowres; wetarea=wetarearres; modified=true;
+    }
+  }StGaugeFlowRes;
+
+protected:
+  //-Definition.
+  std::vector<tdouble3> Points; ///<Vertices of the section (2 in 2D).
+  double PointDp;      ///<Distance between sampling points.
+  float KcLimit;       ///<Minimum kernel sum (Shepard) to consider a sampling point with fluid.
+  //-Auxiliary variables.
+  tdouble3 Normal;     ///<Unit normal of the section (positive direction of the flow).
+  double Area;         ///<Area of the section (length in 2D).
+  std::vector<tdouble3> Nodes; ///<Sampling points on the section.
+  double NodeArea;     ///<Area represented by each sampling point (Area/NodeCount).
+  float *ResVn;        ///<Normal velocity at sampling points of the last measure [NodeCount].
+  float *ResRhop;      ///<Density at sampling points of the last measure (zero without fluid) [NodeCount].
+
+  StGaugeFlowRes Result; ///<Result of the last measure.
+
+  std::vector<StGaugeFlowRes> OutBuff; ///<Results in buffer.
+
+  void Reset();
+  void ClearResult();
+  void StoreResult();
+  void SaveResultsBin();
+  void SetPoints(const std::vector<tdouble3> &points,double pointdp,const tdouble3 &direction);
+
+public:
+  JGaugeFlow(unsigned idx,std::string name,const std::vector<tdouble3> &points,double pointdp
+    ,const tdouble3 &direction,float kclimit,bool cpu,JLog2* log);
+  ~JGaugeFlow();
+
+  void SaveResults();
+  void SaveVtkResult(unsigned cpart);
+  unsigned GetPointDef(std::vector<tfloat3> &points)const;
+
+  unsigned GetPointsCount()const{ return(unsigned(Points.size())); }
+  tdouble3 GetPoint(unsigned c)const{ return(Points[c]); }
+  double   GetPointDp()const{ return(PointDp); }
+  float    GetKcLimit()const{ return(KcLimit); }
+  tdouble3 GetNormal()const{ return(Normal); }
+  double   GetArea()const{ return(Area); }
+  unsigned GetNodeCount()const{ return(unsigned(Nodes.size())); }
+  const StGaugeFlowRes& GetResult()const{ return(Result); }
+
+  bool CpuOwnThreads()const{ return(true); }
+
+  void CalculeCpu(double timestep,tuint3 ncells,tuint3 cellmin
+    ,const unsigned *begincell,unsigned npbok,unsigned npb,unsigned np
+    ,const tdouble3 *pos,const typecode *code,const typeidp *idp,const tfloat4 *velrhop,const unsigned *ridpbound);
+
+ #ifdef _WITHGPU
+  void CalculeGpu(double timestep,tuint3 ncells,tuint3 cellmin
+    ,const int2 *beginendcell,unsigned npbok,unsigned npb,unsigned np
+    ,const double2 *posxy,const double *posz,const typecode *code,const unsigned *idp,const float4 *velrhop,float3 *aux);
+ #endif
+};
+
+//##############################################################################
+//# JGaugePressure
+//##############################################################################
+/// \brief Calculates pressure of the fluid on the boundary particles of one mk.
+/// Pressure is interpolated from fluid particles with Shepard correction at 
+/// the position of every boundary particle of the mk block (or one of each 
+/// Decimation particles) and the pressure map is saved in binary format 
+/// (GaugesPressure_<name>.bi4) where each measure is an item DATA_XXXXXX with
+/// array Press (and Pos for moving boundaries).
+class JGaugePressure : public JGaugeItem
+{
+protected:
+  static const unsigned OutMemory=1024*1024*16; ///<Maximum size of results in buffer (bytes).
+
+  //-Definition.
+  word MkBound;
+  TpParticles TypeParts;
+  unsigned IdBegin;
+  unsigned Count;
+  typecode Code;
+  tfloat3 InitialCenter;
+  unsigned Decimation; ///<Uses one of each Decimation particles of the mk block.
+  float KcLimit;       ///<Minimum kernel sum (Shepard) to compute pressure of a node.
+  //-Auxiliary variables.
+  unsigned NodeCount;  ///<Number of selected boundary particles.
+  bool SavePos;        ///<Positions are saved with each measure (moving boundary).
+
+  //-Result of the last measure.
+  double ResTimeStep;
+  tfloat3 *ResPos;
+  float *ResPress;
+
+  //-Results in buffer.
+  std::vector<double>  OutTimes;
+  std::vector<tfloat3> OutPos;
+  std::vector<float>   OutPress;
+  unsigned OutNum;     ///<Number of saved measures.
+
+  void Reset();
+  void ClearResult();
+  void StoreResult();
+  unsigned GetOutNum()const{ return(OutNum); }
+  void SetOutNum(unsigned num){ OutNum=num; }
+
+public:
+  JGaugePressure(unsigned idx,std::string name,word mkbound,TpParticles typeparts
+    ,unsigned idbegin,unsigned count,typecode code,tfloat3 center
+    ,unsigned decimation,float kclimit,bool cpu,JLog2* log);
+  ~JGaugePressure();
+
+  std::string GetResultsFileBin()const;
+  void SaveResults();
+  void SaveVtkResult(unsigned cpart);
+  unsigned GetPointDef(std::vector<tfloat3> &points)const;
+
+  word        GetMkBound()   const{ return(MkBound); }
+  TpParticles GetTypeParts() const{ return(TypeParts); }
+  unsigned    GetIdBegin()   const{ return(IdBegin); }
+  unsigned    GetCount()     const{ return(Count); }
+  unsigned    GetDecimation()const{ return(Decimation); }
+  float       GetKcLimit()   const{ return(KcLimit); }
+  unsigned    GetNodeCount() const{ return(NodeCount); }
+  unsigned    GetNodeIdp(unsigned cn)const{ return(IdBegin+cn*Decimation); }
+  double      GetResultPressMean()const;
+
+  bool OutBufferFull()const{ return(OutCount && (OutCount+1>=OutSize || ullong(OutCount+1)*NodeCount*(sizeof(float)+(SavePos? sizeof(tfloat3): 0))>OutMemory)); }
+  bool CpuOwnThreads()const{ return(true); }
+
   void CalculeCpu(double timestep,tuint3 ncells,tuint3 cellmin
     ,const unsigned *begincell,unsigned npbok,unsigned npb,unsigned np
-    ,const tdouble3 *pos,const typecode *code,const unsigned *idp,const tfloat4 *velrhop);
+    ,const tdouble3 *pos,const typecode *code,const typeidp *idp,const tfloat4 *velrhop,const unsigned *ridpbound);
 
  #ifdef _WITHGPU
   void CalculeGpu(double timestep,tuint3 ncells,tuint3 cellmin
@@ -26,8 +26,14 @@
 #include "FunctionsGeo3d.h"
 #include "JSphMk.h"
 #include "JFormatFiles2.h"
+#include "JSphCheckpoint.h"
+#include "JGaugeBi4.h"
 #include <cfloat>
+#ifdef OMP_USE
+  #include <omp.h>
+#endif
 #include <climits>
+#include <cmath>
 #include <algorithm>
 #ifdef _WITHGPU
  #include "FunctionsCuda.h"
@@ -43,6 +49,7 @@ using namespace std;
 //==============================================================================
 JGaugeSystem::JGaugeSystem(bool cpu,JLog2* log):Cpu(cpu),Log(log){
   ClassName="JGaugeSystem";
+  OutBin=NULL;
  #ifdef _WITHGPU
   AuxMemoryg=NULL;
  #endif
@@ -71,8 +78,11 @@ void JGaugeSystem::Reset(){
   Hdiv=0;
   H=MassFluid=MassBound=CteB=Gamma=RhopZero=0;
   ResetCfgDefault();
+  SaveBinary=false;
+  delete OutBin; OutBin=NULL;
   for(unsigned c=0;c<Gauges.size();c++)delete Gauges[c];
   Gauges.clear();
+  GaugesCalc.clear();
  #ifdef _WITHGPU
   if(AuxMemoryg)cudaFree(AuxMemoryg); AuxMemoryg=NULL;
  #endif
@@ -213,6 +223,7 @@ void JGaugeSystem::ReadXml(JXml *sxml,TiXmlElement* lis,const JSphMk* mkinfo){
   //-Loads default configuration.
   ResetCfgDefault();
   CfgDefault=ReadXmlCommon(sxml,lis->FirstChildElement("default"));
+  if(lis->FirstChildElement("default"))SaveBinary=sxml->ReadElementBool(lis->FirstChildElement("default"),"outputbin","value",true,false);
   //-Loads gauge definitions.
   TiXmlElement* ele=lis->FirstChildElement(); 
   while(ele){
@@ -270,6 +281,77 @@ void JGaugeSystem::ReadXml(JXml *sxml,TiXmlElement* lis,const JSphMk* mkinfo){
         const word mkbound=(word)sxml->ReadElementUnsigned(ele,"target","mkbound");
         gau=AddGaugeForce(name,cfg.computestart,cfg.computeend,cfg.computedt,mkinfo,mkbound);
       }
+      else if(cmd=="mesh"){
+        //-Reads pointdp.
+        double pointdp=0;
+        switch(sxml->CheckElementAttributes(ele,"pointdp","value coefdp",true,true)){
+          case 0:
+          case 1:  pointdp=sxml->ReadElementFloat(ele,"pointdp","value");      break;
+          case 2:  pointdp=Dp*sxml->ReadElementFloat(ele,"pointdp","coefdp");  break;
+        }
+        if(pointdp<=0)RunException(met,fun::PrintStr("The pointdp (%f) is invalid.",pointdp),sxml->ErrGetFileRow(ele));
+        //-Reads kclimit.
+        const float kclimit=sxml->ReadElementFloat(ele,"kclimit","value",true,0.5f);
+        if(kclimit<=0)RunException(met,fun::PrintStr("The kclimit (%f) is invalid.",kclimit),sxml->ErrGetFileRow(ele));
+        //-Reads point0 and point2.
+        const tdouble3 pt0=sxml->ReadElementDouble3(ele,"point0");
+        const tdouble3 pt2=sxml->ReadElementDouble3(ele,"point2");
+        gau=AddGaugeMesh(name,cfg.computestart,cfg.computeend,cfg.computedt,pt0,pt2,pointdp,kclimit);
+      }
+      else if(cmd=="isosurface"){
+        //-Reads masslimit.
+        float masslimit=0;
+        switch(sxml->CheckElementAttributes(ele,"masslimit","value coef",true,true)){
+          case 1:  masslimit=sxml->ReadElementFloat(ele,"masslimit","value");           break;
+          case 2:  masslimit=MassFluid*sxml->ReadElementFloat(ele,"masslimit","coef");  break;
+          case 0:  masslimit=MassFluid*0.5f;                                            break;
+        }
+        if(masslimit<=0)RunException(met,fun::PrintStr("The masslimit (%f) is invalid.",masslimit),sxml->ErrGetFileRow(ele));
+        //-Reads pointdp.
+        double pointdp=0;
+        switch(sxml->CheckElementAttributes(ele,"pointdp","value coefdp",true,true)){
+          case 0:
+          case 1:  pointdp=sxml->ReadElementFloat(ele,"pointdp","value");      break;
+          case 2:  pointdp=Dp*sxml->ReadElementFloat(ele,"pointdp","coefdp");  break;
+        }
+        if(pointdp<=0)RunException(met,fun::PrintStr("The pointdp (%f) is invalid.",pointdp),sxml->ErrGetFileRow(ele));
+        //-Reads point0 and point2.
+        const tdouble3 pt0=sxml->ReadElementDouble3(ele,"point0");
+        const tdouble3 pt2=sxml->ReadElementDouble3(ele,"point2");
+        gau=AddGaugeIsosurface(name,cfg.computestart,cfg.computeend,cfg.computedt,pt0,pt2,pointdp,masslimit);
+      }
+      else if(cmd=="flow"){
+        //-Reads pointdp (default=Dp).
+        double pointdp=0;
+        switch(sxml->CheckElementAttributes(ele,"pointdp","value coefdp",true,true)){
+          case 0:  pointdp=Dp;                                                 break;
+          case 1:  pointdp=sxml->ReadElementFloat(ele,"pointdp","value");      break;
+          case 2:  pointdp=Dp*sxml->ReadElementFloat(ele,"pointdp","coefdp");  break;
+        }
+        if(pointdp<=0)RunException(met,fun::PrintStr("The pointdp (%f) is invalid.",pointdp),sxml->ErrGetFileRow(ele));
+        //-Reads kclimit.
+        const float kclimit=sxml->ReadElementFloat(ele,"kclimit","value",true,0.5f);
+        if(kclimit<=0)RunException(met,fun::PrintStr("The kclimit (%f) is invalid.",kclimit),sxml->ErrGetFileRow(ele));
+        //-Reads vertices of the section and direction of positive flow.
+        std::vector<tdouble3> points;
+        TiXmlElement* elep=sxml->GetFirstElement(ele,"points");
+        TiXmlElement* elept=elep->FirstChildElement("point");
+        while(elept){
+          points.push_back(sxml->GetAttributeDouble3(elept));
+          elept=elept->NextSiblingElement("point");
+        }
+        const tdouble3 direction=sxml->ReadElementDouble3(ele,"direction",true,TDouble3(0));
+        gau=AddGaugeFlow(name,cfg.computestart,cfg.computeend,cfg.computedt,points,pointdp,direction,kclimit);
+      }
+      else if(cmd=="pressure"){
+        const word mkbound=(word)sxml->ReadElementUnsigned(ele,"target","mkbound");
+        const unsigned decimation=sxml->ReadElementUnsigned(ele,"decimation","value",true,1);
+        if(!decimation)RunException(met,"The decimation value must be greater than zero.",sxml->ErrGetFileRow(ele));
+        //-Reads kclimit.
+        const float kclimit=sxml->ReadElementFloat(ele,"kclimit","value",true,0.2f);
+        if(kclimit<=0)RunException(met,fun::PrintStr("The kclimit (%f) is invalid.",kclimit),sxml->ErrGetFileRow(ele));
+        gau=AddGaugePressure(name,cfg.computestart,cfg.computeend,cfg.computedt,mkinfo,mkbound,decimation,kclimit);
+      }
       else RunException(met,fun::PrintStr("Gauge type \'%s\' is invalid.",cmd.c_str()),sxml->ErrGetFileRow(ele));
       gau->SetSaveVtkPart(cfg.savevtkpart);
       //gau->ConfigComputeTiming(cfg.computestart,cfg.computeend,cfg.computedt);
@@ -367,12 +449,116 @@ JGaugeForce* JGaugeSystem::AddGaugeForce(std::string name,double computestart,do
   return(gau);
 }
 
+//==============================================================================
+/// Creates new gauge-Mesh and returns pointer.
+//==============================================================================
+JGaugeMesh* JGaugeSystem::AddGaugeMesh(std::string name,double computestart,double computeend,double computedt
+  ,tdouble3 point0,tdouble3 point2,double pointdp,float kclimit)
+{
+  const char met[]="AddGaugeMesh";
+  if(GetGaugeIdx(name)!=UINT_MAX)RunException(met,fun::PrintStr("The name \'%s\' already exists.",name.c_str()));
+  if(!Cpu)RunException(met,fun::PrintStr("Gauge-Mesh \'%s\' is only available for CPU executions.",name.c_str()));
+  //-Creates object.
+  JGaugeMesh* gau=new JGaugeMesh(GetCount(),name,point0,point2,pointdp,kclimit,Cpu,Log);
+  gau->Config(Simulate2D,Symmetry,DomPosMin,DomPosMax,Scell,Hdiv,H,MassFluid,MassBound,CteB,Gamma,RhopZero);
+  gau->ConfigComputeTiming(computestart,computeend,computedt);
+  //-Uses common configuration.
+  gau->SetSaveVtkPart(CfgDefault.savevtkpart);
+  gau->ConfigOutputTiming(CfgDefault.output,CfgDefault.outputstart,CfgDefault.outputend,CfgDefault.outputdt);
+  Gauges.push_back(gau);
+  return(gau);
+}
+
+//==============================================================================
+/// Creates new gauge-Isosurface and returns pointer.
+//==============================================================================
+JGaugeIsosurface* JGaugeSystem::AddGaugeIsosurface(std::string name,double computestart,double computeend,double computedt
+  ,tdouble3 point0,tdouble3 point2,double pointdp,float masslimit)
+{
+  const char met[]="AddGaugeIsosurface";
+  if(GetGaugeIdx(name)!=UINT_MAX)RunException(met,fun::PrintStr("The name \'%s\' already exists.",name.c_str()));
+  if(!Cpu)RunException(met,fun::PrintStr("Gauge-Isosurface \'%s\' is only available for CPU executions.",name.c_str()));
+  if(masslimit<=0)masslimit=MassFluid*0.5f;
+  //-Creates object.
+  JGaugeIsosurface* gau=new JGaugeIsosurface(GetCount(),name,point0,point2,pointdp,masslimit,Dp,Cpu,Log);
+  gau->Config(Simulate2D,Symmetry,DomPosMin,DomPosMax,Scell,Hdiv,H,MassFluid,MassBound,CteB,Gamma,RhopZero);
+  gau->ConfigComputeTiming(computestart,computeend,computedt);
+  //-Checks dimensions of the grid.
+  const tuint3 np=gau->GetPointNp();
+  if(Simulate2D && (np.x<2 || np.y!=1 || np.z<2)){
+    delete gau;
+    RunException(met,fun::PrintStr("The grid of gauge-Isosurface \'%s\' must be a plane XZ for 2-D simulations.",name.c_str()));
+  }
+  if(!Simulate2D && (np.x<2 || np.y<2 || np.z<2)){
+    delete gau;
+    RunException(met,fun::PrintStr("The grid of gauge-Isosurface \'%s\' must be a box for 3-D simulations.",name.c_str()));
+  }
+  //-Uses common configuration.
+  gau->SetSaveVtkPart(CfgDefault.savevtkpart);
+  gau->ConfigOutputTiming(CfgDefault.output,CfgDefault.outputstart,CfgDefault.outputend,CfgDefault.outputdt);
+  Gauges.push_back(gau);
+  return(gau);
+}
+
+//==============================================================================
+/// Creates new gauge-Flow and returns pointer.
+//==============================================================================
+JGaugeFlow* JGaugeSystem::AddGaugeFlow(std::string name,double computestart,double computeend,double computedt
+  ,const std::vector<tdouble3> &points,double pointdp,const tdouble3 &direction,float kclimit)
+{
+  const char met[]="AddGaugeFlow";
+  if(GetGaugeIdx(name)!=UINT_MAX)RunException(met,fun::PrintStr("The name \'%s\' already exists.",name.c_str()));
+  if(!Cpu)RunException(met,fun::PrintStr("Gauge-Flow \'%s\' is only available for CPU executions.",name.c_str()));
+  if(Simulate2D && points.size()!=2)RunException(met,fun::PrintStr("The section of gauge-Flow \'%s\' must be defined with 2 points for 2-D simulations.",name.c_str()));
+  if(!Simulate2D && points.size()<3)RunException(met,fun::PrintStr("The section of gauge-Flow \'%s\' must be defined with 3 or more points for 3-D simulations.",name.c_str()));
+  if(kclimit<=0)kclimit=0.5f;
+  //-Creates object.
+  JGaugeFlow* gau=new JGaugeFlow(GetCount(),name,points,pointdp,direction,kclimit,Cpu,Log);
+  gau->Config(Simulate2D,Symmetry,DomPosMin,DomPosMax,Scell,Hdiv,H,MassFluid,MassBound,CteB,Gamma,RhopZero);
+  gau->ConfigComputeTiming(computestart,computeend,computedt);
+  //-Uses common configuration.
+  gau->SetSaveVtkPart(CfgDefault.savevtkpart);
+  gau->ConfigOutputTiming(CfgDefault.output,CfgDefault.outputstart,CfgDefault.outputend,CfgDefault.outputdt);
+  Gauges.push_back(gau);
+  return(gau);
+}
+
+//==============================================================================
+/// Creates new gauge-Pressure and returns pointer.
+//==============================================================================
+JGaugePressure* JGaugeSystem::AddGaugePressure(std::string name,double computestart,double computeend,double computedt
+  ,const JSphMk* mkinfo,word mkbound,unsigned decimation,float kclimit)
+{
+  const char met[]="AddGaugePressure";
+  if(GetGaugeIdx(name)!=UINT_MAX)RunException(met,fun::PrintStr("The name \'%s\' already exists.",name.c_str()));
+  if(!Cpu)RunException(met,fun::PrintStr("Gauge-Pressure \'%s\' is only available for CPU executions.",name.c_str()));
+  //-Obtains data from mkbound particles.
+  const unsigned cmk=mkinfo->GetMkBlockByMkBound(mkbound);
+  if(cmk>=mkinfo->Size())RunException(met,fun::PrintStr("Error loading boundary objects. Mkbound=%u is unknown.",mkbound));
+  const JSphMkBlock* mkb=mkinfo->Mkblock(cmk);
+  const TpParticles typeparts=mkb->Type;
+  if(typeparts!=TpPartFixed && typeparts!=TpPartMoving)RunException(met,fun::PrintStr("Type of boundary particles (Mkbound=%u) is invalid. Only fixed or moving particles are allowed.",mkbound));
+  const tfloat3 center=ToTFloat3((mkb->GetPosMin()+mkb->GetPosMax())/TDouble3(2));
+  if(kclimit<=0)kclimit=0.2f;
+  //-Creates object.
+  JGaugePressure* gau=new JGaugePressure(GetCount(),name,mkbound,typeparts,mkb->Begin,mkb->Count,mkb->Code,center,decimation,kclimit,Cpu,Log);
+  gau->Config(Simulate2D,Symmetry,DomPosMin,DomPosMax,Scell,Hdiv,H,MassFluid,MassBound,CteB,Gamma,RhopZero);
+  gau->ConfigComputeTiming(computestart,computeend,computedt);
+  //-Uses common configuration.
+  gau->SetSaveVtkPart(CfgDefault.savevtkpart);
+  gau->ConfigOutputTiming(CfgDefault.output,CfgDefault.outputstart,CfgDefault.outputend,CfgDefault.outputdt);
+  Gauges.push_back(gau);
+  return(gau);
+}
+
 //==============================================================================
 /// Shows object configuration using Log.
 //==============================================================================
 void JGaugeSystem::VisuConfig(std::string txhead,std::string txfoot){
   SaveVtkInitPoints(); //-Includes gauges defined by coding.
+  if(SaveBinary && !OutBin)ConfigOutBin();
   if(!txhead.empty())Log->Print(txhead);
+  if(OutBin)Log->Printf("Results of gauges in binary file: %s",fun::GetFile(OutBin->GetFile()).c_str());
   for(unsigned cg=0;cg<GetCount();cg++){
     const JGaugeItem* gau=Gauges[cg];
     Log->Printf("Guage_%u: \'%s\'",gau->Idx,gau->Name.c_str());
@@ -445,20 +631,47 @@ JGaugeItem* JGaugeSystem::GetGauge(unsigned c)const{
   return(Gauges[c]);
 }
 
+//==============================================================================
+/// Returns number of gauges of the requested type.
+/// Devuelve numero de gauges del tipo indicado.
+//==============================================================================
+unsigned JGaugeSystem::GetCountType(JGaugeItem::TpGauge type)const{
+  unsigned n=0;
+  for(unsigned cg=0;cg<GetCount();cg++)if(Gauges[cg]->Type==type)n++;
+  return(n);
+}
+
 //==============================================================================
 /// Updates results on gauges (on CPU).
+/// Gauges are computed in parallel and the full buffers are saved afterwards
+/// in gauge order, so the output files do not depend on the number of threads.
+/// Las medidas se calculan en paralelo y los buffers llenos se graban despues
+/// en orden, de forma que los ficheros no dependen del numero de hilos.
 //==============================================================================
 void JGaugeSystem::CalculeCpu(double timestep,bool svpart,tuint3 ncells
   ,tuint3 cellmin,const unsigned *begincell,unsigned npbok,unsigned npb,unsigned np
-  ,const tdouble3 *pos,const typecode *code,const unsigned *idp,const tfloat4 *velrhop)
+  ,const tdouble3 *pos,const typecode *code,const typeidp *idp,const tfloat4 *velrhop,const unsigned *ridpbound)
 {
+  //-Selects gauges to compute. Gauges with their own parallel loops are placed at the end.
   const unsigned ng=GetCount();
-  for(unsigned cg=0;cg<ng;cg++){
-    JGaugeItem* gau=Gauges[cg];
-    if(gau->Update(timestep)){
-      gau->CalculeCpu(timestep,ncells,cellmin,begincell,npbok,npb,np,pos,code,idp,velrhop);
-    }
+  GaugesCalc.clear();
+  for(unsigned cg=0;cg<ng;cg++)if(Gauges[cg]->Update(timestep) && !Gauges[cg]->CpuOwnThreads())GaugesCalc.push_back(Gauges[cg]);
+  const int nc=int(GaugesCalc.size());
+  for(unsigned cg=0;cg<ng;cg++)if(Gauges[cg]->Update(timestep) && Gauges[cg]->CpuOwnThreads())GaugesCalc.push_back(Gauges[cg]);
+  //-Computes light measures in parallel. A single gauge uses its own parallel loops.
+  #ifdef OMP_USE
+    #pragma omp parallel for schedule (dynamic) if(nc>1)
+  #endif
+  for(int c=0;c<nc;c++){
+    GaugesCalc[c]->CalculeCpu(timestep,ncells,cellmin,begincell,npbok,npb,np,pos,code,idp,velrhop,ridpbound);
+  }
+  //-Computes heavy measures one by one using all threads.
+  const int nct=int(GaugesCalc.size());
+  for(int c=nc;c<nct;c++){
+    GaugesCalc[c]->CalculeCpu(timestep,ncells,cellmin,begincell,npbok,npb,np,pos,code,idp,velrhop,ridpbound);
   }
+  //-Saves full buffers in order (creation of files is not thread-safe).
+  for(int c=0;c<nct;c++)if(GaugesCalc[c]->OutBufferFull())GaugesCalc[c]->SaveResults();
 }
 
 #ifdef _WITHGPU
@@ -491,5 +704,116 @@ void JGaugeSystem::SaveResults(unsigned cpart){
   for(unsigned cg=0;cg<ng;cg++)Gauges[cg]->SaveResults(cpart);
 }
 
+//==============================================================================
+/// Creates binary file for results of all gauges (including gauges defined by 
+/// coding) which replaces the CSV files of each gauge. With checkpoint data 
+/// the file of the previous execution is continued when it is available.
+///
+/// Crea el fichero binario para los resultados de todas las medidas que 
+/// sustituye a los ficheros CSV de cada medida. Con datos de checkpoint se 
+/// continua el fichero de la ejecucion anterior cuando esta disponible.
+//==============================================================================
+void JGaugeSystem::ConfigOutBin(const JBinaryData *ckpitem){
+  delete OutBin; OutBin=NULL;
+  OutBin=new JGaugeBi4Save(AppInfo.GetFullName(),AppInfo.GetDirOut()+JGaugeBi4Save::GetFileName());
+  for(unsigned cg=0;cg<GetCount();cg++){
+    OutBin->AddGauge(Gauges[cg]->Idx,Gauges[cg]->Name,JGaugeItem::GetNameType(Gauges[cg]->Type));
+    Gauges[cg]->SetOutBin(OutBin);
+  }
+  bool restored=false;
+  if(ckpitem && ckpitem->GetvLlong("OutBinSize",true,-1)>0){
+    restored=OutBin->RestoreFile(ckpitem->GetvLlong("OutBinSize"),ckpitem->GetvUint("OutBinBlocks"),ckpitem->GetvUllong("OutBinRecords"));
+    if(!restored)Log->PrintfWarning("Results of gauges before the checkpoint are not available in \"%s\", a new file is created.",OutBin->GetFile().c_str());
+  }
+  if(!restored)OutBin->SaveInitial();
+  Log->AddFileInfo(OutBin->GetFile(),"Saves results of gauges in binary format (by JGaugeSystem).");
+}
+
+//==============================================================================
+/// Waits until the results of gauges are written in the binary file.
+/// Espera hasta que los resultados de las medidas se graben en el fichero binario.
+//==============================================================================
+void JGaugeSystem::FinishResults(){
+  if(OutBin){
+    OutBin->WaitAll();
+    Log->Printf("Results of gauges in binary file: %u blocks with %llu records.",OutBin->GetBlockCount(),OutBin->GetRecordCount());
+  }
+}
+
+//==============================================================================
+/// Stores next computation and output times of gauges and state of output 
+/// files in checkpoint data. Results in buffers are saved before so the files
+/// contain all the results until the checkpoint.
+///
+/// Guarda los siguientes instantes de calculo y salida y el estado de los 
+/// ficheros de salida en datos de checkpoint. Los resultados en buffer se 
+/// graban antes para que los ficheros contengan todos los resultados hasta
+/// el checkpoint.
+//==============================================================================
+void JGaugeSystem::SaveCheckpoint(JBinaryData *data){
+  JBinaryData *item=data->CreateItem("GaugeSystem");
+  const unsigned ng=GetCount();
+  item->SetvUint("Count",ng);
+  if(ng){
+    std::vector<double> cnext(ng),onext(ng);
+    for(unsigned cg=0;cg<ng;cg++){
+      cnext[cg]=Gauges[cg]->GetComputeNext();
+      onext[cg]=Gauges[cg]->GetOutputNext();
+    }
+    item->CreateArray("ComputeNext",JBinaryDataDef::DatDouble,ng,&cnext[0],false);
+    item->CreateArray("OutputNext",JBinaryDataDef::DatDouble,ng,&onext[0],false);
+    //-Saves results in buffer and stores state of output files.
+    for(unsigned cg=0;cg<ng;cg++){
+      Gauges[cg]->SaveResults();
+      Gauges[cg]->SaveCheckpoint(item->CreateItem(fun::PrintStr("Gauge_%04u",cg)));
+    }
+    if(OutBin){
+      item->SetvLlong("OutBinSize",OutBin->GetFileSize());
+      item->SetvUint("OutBinBlocks",OutBin->GetBlockCount());
+      item->SetvUllong("OutBinRecords",OutBin->GetRecordCount());
+    }
+  }
+}
+
+//==============================================================================
+/// Restores next output times and output files of gauges from checkpoint. It
+/// is called before the initial measure so it is not saved again.
+///
+/// Restaura los siguientes instantes de salida y los ficheros de salida desde
+/// checkpoint. Se llama antes de la medida inicial para que no se grabe otra vez.
+//==============================================================================
+void JGaugeSystem::LoadCheckpointOutput(const JSphCheckpoint *ckp){
+  JBinaryData *item=ckp->GetItem("GaugeSystem");
+  const unsigned ng=GetCount();
+  if(item->GetvUint("Count")!=ng)RunException("LoadCheckpointOutput","Number of gauges does not match the checkpoint.");
+  if(ng){
+    std::vector<double> onext(ng);
+    ckp->LoadArray(item,"OutputNext",JBinaryDataDef::DatDouble,ng,&onext[0]);
+    //-Results at the time of the checkpoint were already saved (also when outputdt is zero).
+    const double onextmin=nextafter(ckp->GetData()->GetvDouble("TimeStep"),DBL_MAX);
+    for(unsigned cg=0;cg<ng;cg++){
+      Gauges[cg]->SetOutputNext(max(onext[cg],onextmin));
+      Gauges[cg]->LoadCheckpoint(ckp->GetItem(item,fun::PrintStr("Gauge_%04u",cg)));
+    }
+    if(SaveBinary && !OutBin)ConfigOutBin(item);
+  }
+}
+
+//==============================================================================
+/// Restores next computation and output times of gauges from checkpoint.
+/// Restaura los siguientes instantes de calculo y salida desde checkpoint.
+//==============================================================================
+void JGaugeSystem::LoadCheckpoint(const JSphCheckpoint *ckp){
+  JBinaryData *item=ckp->GetItem("GaugeSystem");
+  const unsigned ng=GetCount();
+  if(item->GetvUint("Count")!=ng)RunException("LoadCheckpoint","Number of gauges does not match the checkpoint.");
+  if(ng){
+    std::vector<double> cnext(ng),onext(ng);
+    ckp->LoadArray(item,"ComputeNext",JBinaryDataDef::DatDouble,ng,&cnext[0]);
+    ckp->LoadArray(item,"OutputNext",JBinaryDataDef::DatDouble,ng,&onext[0]);
+    for(unsigned cg=0;cg<ng;cg++)Gauges[cg]->SetNextTimes(cnext[cg],onext[cg]);
+  }
+}
+
 
 
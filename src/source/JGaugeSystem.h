@@ -23,6 +23,17 @@
 //:#   automatica y simple. (12-02-2017)
 //:# - Error corregido cargando <default><output>. (03-03-2017)
 //:# - Nueva opcion para calcular fuerzas sobre fixed o moving boundary. (20-11-2018)
+//:# - Grabacion y carga del estado de medicion para checkpoint/restart. (18-10-2026)
+//:# - Calculo en paralelo de las medidas en CPU. (18-10-2026)
+//:# - Nueva medida <mesh> de velocidad, densidad y presion en una malla. (18-10-2026)
+//:# - Nueva medida <isosurface> para calcular la superficie libre. (18-10-2026)
+//:# - Nueva medida <flow> para calcular el caudal a traves de una seccion. (18-10-2026)
+//:# - Opcion <default><outputbin> para grabar los resultados de todas las
+//:#   medidas en un fichero binario en segundo plano. (18-10-2026)
+//:# - Nueva medida <pressure> de la presion sobre las particulas de contorno
+//:#   de un mk. (18-10-2026)
+//:# - Los ficheros de resultados se continuan al reiniciar desde checkpoint.
+//:#   (18-10-2026)
 //:#############################################################################
 
 /// \file JGaugeSystem.h \brief Declares the class \ref JGaugeSystem.
@@ -40,6 +51,9 @@ class JXml;
 class TiXmlElement;
 class JLog2;
 class JSphMk;
+class JBinaryData;
+class JSphCheckpoint;
+class JGaugeBi4Save;
 
 //##############################################################################
 //# XML format in _FmtXML_Gauges.xml.
@@ -75,8 +89,11 @@ private:
   float RhopZero;
 
   JGaugeItem::StDefault CfgDefault; ///<Default configuration.
+  bool SaveBinary;                  ///<Saves results of all gauges in binary file instead of CSV files.
+  JGaugeBi4Save *OutBin;            ///<Writes results of gauges in binary file (when SaveBinary).
 
   std::vector<JGaugeItem*> Gauges;
+  std::vector<JGaugeItem*> GaugesCalc; ///<Auxiliary list of gauges to compute in CalculeCpu().
 
   //-Variables for GPU.
  #ifdef _WITHGPU
@@ -91,6 +108,7 @@ private:
   JGaugeItem::StDefault ReadXmlCommon(JXml *sxml,TiXmlElement* ele)const;
   void ReadXml(JXml *sxml,TiXmlElement* ele,const JSphMk* mkinfo);
   void SaveVtkInitPoints()const;
+  void ConfigOutBin(const JBinaryData *ckpitem=NULL);
 
 public:
   JGaugeSystem(bool cpu,JLog2* log);
@@ -121,14 +139,19 @@ public:
   JGaugeSwl*      AddGaugeSwl  (std::string name,double computestart,double computeend,double computedt,tdouble3 point0,tdouble3 point2,double pointdp,float masslimit=0);
   JGaugeMaxZ*     AddGaugeMaxZ (std::string name,double computestart,double computeend,double computedt,tdouble3 point0,double height,float distlimit);
   JGaugeForce*    AddGaugeForce(std::string name,double computestart,double computeend,double computedt,const JSphMk* mkinfo,word mkbound);
+  JGaugeMesh*     AddGaugeMesh (std::string name,double computestart,double computeend,double computedt,tdouble3 point0,tdouble3 point2,double pointdp,float kclimit);
+  JGaugeFlow*     AddGaugeFlow (std::string name,double computestart,double computeend,double computedt,const std::vector<tdouble3> &points,double pointdp,const tdouble3 &direction,float kclimit=0);
+  JGaugePressure* AddGaugePressure(std::string name,double computestart,double computeend,double computedt,const JSphMk* mkinfo,word mkbound,unsigned decimation=1,float kclimit=0);
+  JGaugeIsosurface* AddGaugeIsosurface(std::string name,double computestart,double computeend,double computedt,tdouble3 point0,tdouble3 point2,double pointdp,float masslimit=0);
 
   unsigned GetCount()const{ return(unsigned(Gauges.size())); }
+  unsigned GetCountType(JGaugeItem::TpGauge type)const;
   unsigned GetGaugeIdx(const std::string &name)const;
   JGaugeItem* GetGauge(unsigned c)const;
 
   void CalculeCpu(double timestep,bool svpart,tuint3 ncells,tuint3 cellmin
     ,const unsigned *begincell,unsigned npbok,unsigned npb,unsigned np
-    ,const tdouble3 *pos,const typecode *code,const unsigned *idp,const tfloat4 *velrhop);
+    ,const tdouble3 *pos,const typecode *code,const typeidp *idp,const tfloat4 *velrhop,const unsigned *ridpbound);
 
  #ifdef _WITHGPU
   void CalculeGpu(double timestep,bool svpart,tuint3 ncells,tuint3 cellmin
@@ -137,6 +160,11 @@ public:
  #endif
 
   void SaveResults(unsigned cpart);
+  void FinishResults();
+
+  void SaveCheckpoint(JBinaryData *data);
+  void LoadCheckpointOutput(const JSphCheckpoint *ckp);
+  void LoadCheckpoint(const JSphCheckpoint *ckp);
 };
 
 
@@ -28,6 +28,8 @@
 #include <cstdlib>
 #include <iostream>
 #include <sstream>
+#include <climits>
+#include <algorithm>
 
 #pragma warning(disable : 4996) //Cancels sprintf() deprecated.
 
@@ -42,7 +44,10 @@ using namespace std;
 JPartDataBi4::JPartDataBi4(){
   ClassName="JPartDataBi4";
   Data=NULL;
+  Compress=false;
+  FileMap=false;
   Reset();
+  ResetDelta();
 }
 
 //==============================================================================
@@ -337,7 +342,16 @@ void JPartDataBi4::AddPartDataVar(const std::string &name,JBinaryDataDef::TpData
   //-Comprueba valor de npok. Checks value of npok.
   if(Part->GetvUint("Npok")!=npok)RunException(met,"Part information is invalid.");
   //-Crea array con particulas validas. Creates valid particles array.
-  Part->CreateArray(name,type,npok,v,externalpointer);
+  CreatePartArray(name,type,npok,v,externalpointer);
+}
+
+//==============================================================================
+/// Crea array de particulas en Part con la compresion configurada.
+/// Creates array of particles in Part with the configured compression.
+//==============================================================================
+void JPartDataBi4::CreatePartArray(const std::string &name,JBinaryDataDef::TpData type,unsigned npok,const void *v,bool externalpointer){
+  JBinaryDataArray *ar=Part->CreateArray(name,type,npok,v,externalpointer);
+  if(Compress)ar->SetComp(JBinaryDataDef::CompByType(type));
 }
 
 //==============================================================================
@@ -351,12 +365,12 @@ void JPartDataBi4::AddPartData(unsigned npok,const unsigned *idp,const ullong *i
   //-Comprueba valor de npok. Checks value of npok.
   if(Part->GetvUint("Npok")!=npok)RunException(met,"Part information is invalid.");
   //-Crea array con particulas validas. Creates valid particles array.
-  if(idpd)Part->CreateArray("Idpd",JBinaryDataDef::DatUllong,npok,idpd,externalpointer);
-  else    Part->CreateArray("Idp" ,JBinaryDataDef::DatUint,npok,idp,externalpointer);
-  if(posd)Part->CreateArray("Posd",JBinaryDataDef::DatDouble3,npok,posd,externalpointer);
-  else    Part->CreateArray("Pos" ,JBinaryDataDef::DatFloat3,npok,pos,externalpointer);
-  Part->CreateArray("Vel",JBinaryDataDef::DatFloat3,npok,vel,externalpointer);
-  Part->CreateArray("Rhop",JBinaryDataDef::DatFloat,npok,rhop,externalpointer);
+  if(idpd)CreatePartArray("Idpd",JBinaryDataDef::DatUllong,npok,idpd,externalpointer);
+  else    CreatePartArray("Idp" ,JBinaryDataDef::DatUint,npok,idp,externalpointer);
+  if(posd)CreatePartArray("Posd",JBinaryDataDef::DatDouble3,npok,posd,externalpointer);
+  else    CreatePartArray("Pos" ,JBinaryDataDef::DatFloat3,npok,pos,externalpointer);
+  CreatePartArray("Vel",JBinaryDataDef::DatFloat3,npok,vel,externalpointer);
+  CreatePartArray("Rhop",JBinaryDataDef::DatFloat,npok,rhop,externalpointer);
 }
 
 //==============================================================================
@@ -370,8 +384,482 @@ void JPartDataBi4::AddPartDataSplitting(unsigned npok,const float *mass,const fl
   if(Part->GetvUint("Npok")!=npok)RunException(met,"Part information is invalid.");
   if(!Data->GetvBool("Splitting"))RunException(met,"Splitting is not configured.");
   //-Crea array con particulas validas. Creates valid particles array.
-  Part->CreateArray("Mass",JBinaryDataDef::DatFloat,npok,mass,externalpointer);
-  Part->CreateArray("Hvar",JBinaryDataDef::DatFloat,npok,hvar,externalpointer);
+  CreatePartArray("Mass",JBinaryDataDef::DatFloat,npok,mass,externalpointer);
+  CreatePartArray("Hvar",JBinaryDataDef::DatFloat,npok,hvar,externalpointer);
+}
+
+//==============================================================================
+/// Anhade array cuantizado de np valores con nc componentes (float o double).
+/// Cada componente se guarda como desplazamiento entero desde su minimo con 
+/// paso de casi 2*err, de modo que el error absoluto maximo es err al 
+/// reconstruir con la precision de los datos de entrada. Usa ushort cuando el
+/// rango lo permite y uint en otro caso. Genera excepcion cuando err no supera
+/// la resolucion de esa precision para el rango de valores.
+/// Adds quantised array of np values with nc components (float or double).
+/// Each component is stored as integer offset from its minimum with step of 
+/// almost 2*err, so the maximum absolute error is err when it is reconstructed
+/// with the precision of the input data. It uses ushort when the range allows
+/// it and uint otherwise. An exception is thrown when err does not exceed the
+/// resolution of that precision for the range of values.
+//==============================================================================
+void JPartDataBi4::AddQuantArray(const std::string &name,unsigned np,unsigned nc,const float *vf,const double *vd,double err){
+  const char met[]="AddQuantArray";
+  if(err<=0)RunException(met,fun::PrintStr("The quantisation error of '%s' is invalid.",name.c_str()));
+  const unsigned n=np*nc;
+  //-Computes minimum and maximum of each component.
+  double vmin[3]={0,0,0},vmax[3]={0,0,0};
+  for(unsigned c=0;c<nc;c++){
+    vmin[c]=DBL_MAX; vmax[c]=-DBL_MAX;
+    for(unsigned p=0;p<np;p++){
+      const double v=(vf? double(vf[p*nc+c]): vd[p*nc+c]);
+      if(vmin[c]>v)vmin[c]=v;
+      if(vmax[c]<v)vmax[c]=v;
+    }
+    if(!np)vmin[c]=vmax[c]=0;
+  }
+  //-Computes quantised values (the step leaves room for the rounding of 
+  //-reconstructed values to the precision of the input data).
+  double vabs=0;
+  for(unsigned c=0;c<nc;c++)vabs=max(vabs,max(fabs(vmin[c]),fabs(vmax[c])));
+  const double verr=vabs*(vf? double(FLT_EPSILON): DBL_EPSILON);
+  if(err<=verr)RunException(met,fun::PrintStr("The quantisation error of '%s' (%g) is below the %s resolution of the values (%g).",name.c_str(),err,(vf? "float": "double"),verr));
+  const double step=(err-verr)*2;
+  double qmax=0;
+  for(unsigned c=0;c<nc;c++)qmax=max(qmax,(vmax[c]-vmin[c])/step+1);
+  if(qmax>=double(UINT_MAX))RunException(met,fun::PrintStr("The quantisation error of '%s' is too small for the range of values.",name.c_str()));
+  unsigned *q=new unsigned[n];
+  for(unsigned p=0;p<np;p++)for(unsigned c=0;c<nc;c++){
+    const double v=(vf? double(vf[p*nc+c]): vd[p*nc+c]);
+    q[p*nc+c]=unsigned((v-vmin[c])/step+0.5);
+  }
+  //-Stores array and information to reconstruct values.
+  JBinaryDataArray *ar=NULL;
+  if(qmax<=65535){
+    word *qw=new word[n];
+    for(unsigned c=0;c<n;c++)qw[c]=word(q[c]);
+    ar=Part->CreateArray(name,JBinaryDataDef::DatUshort,n,qw,false);
+    delete[] qw;
+  }
+  else ar=Part->CreateArray(name,JBinaryDataDef::DatUint,n,q,false);
+  delete[] q;
+  if(Compress)ar->SetComp(JBinaryDataDef::CompShuffle);
+  if(nc==3)Part->SetvDouble3(name+"Min",TDouble3(vmin[0],vmin[1],vmin[2]));
+  else Part->SetvDouble(name+"Min",vmin[0]);
+  Part->SetvDouble(name+"Step",step);
+}
+
+//==============================================================================
+/// Reconstruye valores de array cuantizado con AddQuantArray().
+/// Reconstructs values of array quantised with AddQuantArray().
+//==============================================================================
+void JPartDataBi4::GetQuantArray(const std::string &name,unsigned np,unsigned nc,float *vf,double *vd)const{
+  const char met[]="GetQuantArray";
+  JBinaryDataArray *ar=GetArray(name);
+  const unsigned n=np*nc;
+  if(ar->GetFileDataCount()!=n && ar->GetCount()!=n)RunException(met,fun::PrintStr("Size of array '%s' is invalid.",name.c_str()));
+  double vmin[3]={0,0,0};
+  if(nc==3){
+    const tdouble3 v=GetPart()->GetvDouble3(name+"Min");
+    vmin[0]=v.x; vmin[1]=v.y; vmin[2]=v.z;
+  }
+  else vmin[0]=GetPart()->GetvDouble(name+"Min");
+  const double step=GetPart()->GetvDouble(name+"Step");
+  unsigned *q=new unsigned[n];
+  if(ar->GetType()==JBinaryDataDef::DatUshort){
+    word *qw=new word[n];
+    ar->GetDataCopy(n,qw);
+    for(unsigned c=0;c<n;c++)q[c]=qw[c];
+    delete[] qw;
+  }
+  else GetArray(name,JBinaryDataDef::DatUint)->GetDataCopy(n,q);
+  for(unsigned p=0;p<np;p++)for(unsigned c=0;c<nc;c++){
+    const double v=vmin[c]+step*q[p*nc+c];
+    if(vf)vf[p*nc+c]=float(v);
+    else vd[p*nc+c]=v;
+  }
+  delete[] q;
+}
+
+//==============================================================================
+/// Anhade datos de particulas de nuevo part cuantizando Pos, Vel y Rhop con 
+/// los errores absolutos maximos indicados. Idp se graba sin perdidas.
+/// Adds data of particles to new part quantising Pos, Vel and Rhop with the 
+/// given maximum absolute errors. Idp is stored without loss.
+//==============================================================================
+void JPartDataBi4::AddPartDataQuant(unsigned npok,const unsigned *idp,const ullong *idpd,const tdouble3 *posd,const tfloat3 *vel,const float *rhop,double errpos,double errvel,double errrhop){
+  const char met[]="AddPartDataQuant";
+  if((!idp && !idpd) || !posd || !vel || !rhop)RunException(met,"The pointer data is invalid.");
+  //-Comprueba valor de npok. Checks value of npok.
+  if(Part->GetvUint("Npok")!=npok)RunException(met,"Part information is invalid.");
+  //-Crea arrays con particulas validas. Creates valid particles arrays.
+  if(idpd)CreatePartArray("Idpd",JBinaryDataDef::DatUllong,npok,idpd,false);
+  else    CreatePartArray("Idp" ,JBinaryDataDef::DatUint,npok,idp,false);
+  AddQuantArray("PosQ",npok,3,NULL,(const double*)posd,errpos);
+  AddQuantArray("VelQ",npok,3,(const float*)vel,NULL,errvel);
+  AddQuantArray("RhopQ",npok,1,rhop,NULL,errrhop);
+  Part->SetvBool("Quantised",true);
+}
+
+//==============================================================================
+/// Codifica diferencia entera con signo como entero sin signo pequenho (zigzag).
+/// Encodes signed integer difference as small unsigned integer (zigzag).
+//==============================================================================
+static inline unsigned DeltaZig(unsigned d){ return((d<<1)^unsigned(int(d)>>31)); }
+static inline ullong DeltaZig(ullong d){ return((d<<1)^ullong(llong(d)>>63)); }
+static inline unsigned DeltaUnzig(unsigned z){ return((z>>1)^(0u-(z&1))); }
+static inline ullong DeltaUnzig(ullong z){ return((z>>1)^(0ull-(z&1))); }
+
+//==============================================================================
+/// Devuelve copia de array de part comprobando tipo y numero de elementos.
+/// Returns copy of array of part checking type and number of elements.
+//==============================================================================
+template<class T> void JPartDataBi4::DeltaGetArray(JBinaryData *part,const std::string &name,JBinaryDataDef::TpData type,unsigned n,std::vector<T> &v)const{
+  JBinaryDataArray *ar=part->GetArray(name);
+  if(!ar || ar->GetType()!=type || max(ar->GetCount(),ar->GetFileDataCount())!=n)RunException("DeltaGetArray",fun::PrintStr("Array \'%s\' of delta part is invalid.",name.c_str()));
+  v.resize(n*JBinaryDataDef::SizeOfType(type)/sizeof(T));
+  if(n)ar->GetDataCopy(n,&v[0]);
+}
+
+//==============================================================================
+/// Devuelve copia de array de Idp de part diferencial de 32 bits (name) o de
+/// 64 bits (name+"64").
+/// Returns copy of Idp array of delta part of 32 bits (name) or 64 bits 
+/// (name+"64").
+//==============================================================================
+void JPartDataBi4::DeltaGetIdArray(JBinaryData *part,const std::string &name,unsigned n,std::vector<ullong> &v)const{
+  if(part->GetArray(name+"64"))DeltaGetArray(part,name+"64",JBinaryDataDef::DatUllong,n,v);
+  else{
+    vector<unsigned> v32;
+    DeltaGetArray(part,name,JBinaryDataDef::DatUint,n,v32);
+    v.assign(v32.begin(),v32.end());
+  }
+}
+
+//==============================================================================
+/// Crea array de Idp de part diferencial con 32 bits (name) cuando todos los 
+/// valores caben y con 64 bits (name64) en otro caso.
+/// Creates Idp array of delta part with 32 bits (name) when all values fit and
+/// with 64 bits (name64) otherwise.
+//==============================================================================
+void JPartDataBi4::DeltaAddIdArray(JBinaryData *part,const std::string &name,const std::string &name64,const std::vector<ullong> &v,bool compress)const{
+  const unsigned n=unsigned(v.size());
+  const bool id64=(n && *max_element(v.begin(),v.end())>UINT_MAX);
+  JBinaryDataArray *ar=NULL;
+  if(id64)ar=part->CreateArray(name64,JBinaryDataDef::DatUllong,n,&v[0],false);
+  else{
+    vector<unsigned> v32(v.begin(),v.end());
+    ar=part->CreateArray(name,JBinaryDataDef::DatUint,n,(n? &v32[0]: NULL),false);
+  }
+  if(compress)ar->SetComp(JBinaryDataDef::CompDelta);
+}
+
+//==============================================================================
+/// Elimina el estado para partes diferenciales de modo que el siguiente part 
+/// grabado sera un keyframe.
+/// Removes the state for delta parts so the next saved part will be a keyframe.
+//==============================================================================
+void JPartDataBi4::ResetDelta(){
+  DeltaKey=UINT_MAX; DeltaCpart=0;
+  DeltaPosDouble=false;
+  DeltaIdp.clear();  DeltaPos.clear();
+  DeltaVel.clear();  DeltaRhop.clear();
+}
+
+//==============================================================================
+/// Anhade datos de particulas de nuevo part como keyframe (datos completos) o
+/// como diferencias respecto al part anterior usando el Idp como clave: Idp de
+/// particulas nuevas y eliminadas, valores de las nuevas y diferencias de los 
+/// bits de Pos, Vel y Rhop (sin perdidas) de las comunes en orden de Idp. 
+/// Los arrays diferenciales se graban siempre comprimidos.
+/// Adds data of particles to new part as keyframe (complete data) or as 
+/// differences with the previous part using Idp as key: Idp of new and removed
+/// particles, values of new ones and differences of the bits of Pos, Vel and
+/// Rhop (lossless) of common ones in Idp order. Delta arrays are always saved
+/// compressed.
+//==============================================================================
+void JPartDataBi4::AddPartDataDelta(unsigned npok,const unsigned *idp,const ullong *idpd,const tfloat3 *pos,const tdouble3 *posd,const tfloat3 *vel,const float *rhop,bool keyframe){
+  const char met[]="AddPartDataDelta";
+  if((!idp && !idpd) || (!pos && !posd) || !vel || !rhop)RunException(met,"The pointer data is invalid.");
+  //-Comprueba valor de npok. Checks value of npok.
+  if(Part->GetvUint("Npok")!=npok)RunException(met,"Part information is invalid.");
+  const bool posdouble=(posd!=NULL);
+  //-Sorts particles by Idp.
+  vector< pair<ullong,unsigned> > sidx(npok);
+  for(unsigned p=0;p<npok;p++)sidx[p]=make_pair((idpd? idpd[p]: ullong(idp[p])),p);
+  sort(sidx.begin(),sidx.end());
+  vector<ullong> sidp(npok);
+  vector<unsigned> svel(npok*3),srhop(npok);
+  vector<ullong> spos(npok*3);
+  for(unsigned c=0;c<npok;c++){
+    const unsigned p=sidx[c].second;
+    sidp[c]=sidx[c].first;
+    if(posdouble){
+      memcpy(&spos[c*3],posd+p,sizeof(tdouble3));
+    }
+    else{
+      unsigned v[3]; memcpy(v,pos+p,sizeof(tfloat3));
+      spos[c*3]=v[0]; spos[c*3+1]=v[1]; spos[c*3+2]=v[2];
+    }
+    memcpy(&svel[c*3],vel+p,sizeof(tfloat3));
+    memcpy(&srhop[c],rhop+p,sizeof(float));
+    if(c && sidp[c]==sidp[c-1])RunException(met,"Idp of particles is repeated.");
+  }
+  sidx.clear();
+  if(keyframe || DeltaKey==UINT_MAX || DeltaPosDouble!=posdouble){
+    //-Stores complete data.
+    AddPartData(npok,idp,idpd,pos,posd,vel,rhop,true);
+    DeltaKey=Cpart;
+  }
+  else{
+    //-Computes differences with previous part.
+    const unsigned n0=unsigned(DeltaIdp.size());
+    vector<ullong> idnew,iddel;
+    vector<unsigned> velnew,rhopnew,velx,rhopx;
+    vector<ullong> posnew,posx;
+    unsigned i=0,j=0;
+    while(i<n0 || j<npok){
+      if(j>=npok || (i<n0 && DeltaIdp[i]<sidp[j])){ iddel.push_back(DeltaIdp[i]); i++; }
+      else if(i>=n0 || sidp[j]<DeltaIdp[i]){
+        idnew.push_back(sidp[j]);
+        for(unsigned k=0;k<3;k++){ posnew.push_back(spos[j*3+k]); velnew.push_back(svel[j*3+k]); }
+        rhopnew.push_back(srhop[j]);
+        j++;
+      }
+      else{
+        for(unsigned k=0;k<3;k++){
+          if(posdouble)posx.push_back(DeltaZig(spos[j*3+k]-DeltaPos[i*3+k]));
+          else posx.push_back(DeltaZig(unsigned(spos[j*3+k])-unsigned(DeltaPos[i*3+k])));
+          velx.push_back(DeltaZig(svel[j*3+k]-DeltaVel[i*3+k]));
+        }
+        rhopx.push_back(DeltaZig(srhop[j]-DeltaRhop[i]));
+        i++; j++;
+      }
+    }
+    //-Stores delta arrays.
+    Part->SetvUint("DeltaKey",DeltaKey);
+    Part->SetvUint("DeltaPrev",DeltaCpart);
+    Part->SetvBool("DeltaPosDouble",posdouble);
+    const unsigned nnew=unsigned(idnew.size()),ncom=unsigned(rhopx.size());
+    DeltaAddIdArray(Part,"DeltaIdpNew","DeltaIdpNew64",idnew,true);
+    DeltaAddIdArray(Part,"DeltaIdpDel","DeltaIdpDel64",iddel,true);
+    if(posdouble)Part->CreateArray("DeltaPosNew",JBinaryDataDef::DatUllong,nnew*3,(nnew? &posnew[0]: NULL),false)->SetComp(JBinaryDataDef::CompShuffle);
+    else{
+      vector<unsigned> posnew32(posnew.begin(),posnew.end());
+      Part->CreateArray("DeltaPosNew",JBinaryDataDef::DatUint,nnew*3,(nnew? &posnew32[0]: NULL),false)->SetComp(JBinaryDataDef::CompShuffle);
+    }
+    Part->CreateArray("DeltaVelNew",JBinaryDataDef::DatUint,nnew*3,(nnew? &velnew[0]: NULL),false)->SetComp(JBinaryDataDef::CompShuffle);
+    Part->CreateArray("DeltaRhopNew",JBinaryDataDef::DatUint,nnew,(nnew? &rhopnew[0]: NULL),false)->SetComp(JBinaryDataDef::CompShuffle);
+    if(posdouble)Part->CreateArray("DeltaPosX",JBinaryDataDef::DatUllong,ncom*3,(ncom? &posx[0]: NULL),false)->SetComp(JBinaryDataDef::CompShuffle);
+    else{
+      vector<unsigned> posx32(posx.begin(),posx.end());
+      Part->CreateArray("DeltaPosX",JBinaryDataDef::DatUint,ncom*3,(ncom? &posx32[0]: NULL),false)->SetComp(JBinaryDataDef::CompShuffle);
+    }
+    Part->CreateArray("DeltaVelX",JBinaryDataDef::DatUint,ncom*3,(ncom? &velx[0]: NULL),false)->SetComp(JBinaryDataDef::CompShuffle);
+    Part->CreateArray("DeltaRhopX",JBinaryDataDef::DatUint,ncom,(ncom? &rhopx[0]: NULL),false)->SetComp(JBinaryDataDef::CompShuffle);
+  }
+  //-Updates state with current part.
+  DeltaCpart=Cpart;
+  DeltaPosDouble=posdouble;
+  DeltaIdp.swap(sidp);
+  DeltaPos.swap(spos);
+  DeltaVel.swap(svel);
+  DeltaRhop.swap(srhop);
+}
+
+//==============================================================================
+/// Carga estado para partes diferenciales a partir de keyframe.
+/// Loads state for delta parts from keyframe.
+//==============================================================================
+void JPartDataBi4::DeltaLoadKeyframe(const JBinaryData *part){
+  const char met[]="DeltaLoadKeyframe";
+  JBinaryData *pt=(JBinaryData *)part;
+  const bool idpdouble=(pt->GetArray("Idpd")!=NULL);
+  if(pt->ExistsValue("DeltaKey") || pt->GetvBool("Quantised",true,false) || (!pt->GetArray("Idp") && !idpdouble))RunException(met,"The keyframe of delta parts is invalid.");
+  const unsigned np=pt->GetvUint("Npok");
+  const bool posdouble=(pt->GetArray("Posd")!=NULL);
+  vector<unsigned> vel,rhop;
+  vector<ullong> idp,pos;
+  if(idpdouble)DeltaGetArray(pt,"Idpd",JBinaryDataDef::DatUllong,np,idp);
+  else{
+    vector<unsigned> idp32;
+    DeltaGetArray(pt,"Idp",JBinaryDataDef::DatUint,np,idp32);
+    idp.assign(idp32.begin(),idp32.end());
+  }
+  if(posdouble)DeltaGetArray(pt,"Posd",JBinaryDataDef::DatDouble3,np,pos);
+  else{
+    vector<unsigned> pos32;
+    DeltaGetArray(pt,"Pos",JBinaryDataDef::DatFloat3,np,pos32);
+    pos.assign(pos32.begin(),pos32.end());
+  }
+  DeltaGetArray(pt,"Vel",JBinaryDataDef::DatFloat3,np,vel);
+  DeltaGetArray(pt,"Rhop",JBinaryDataDef::DatFloat,np,rhop);
+  //-Sorts particles by Idp.
+  vector< pair<ullong,unsigned> > sidx(np);
+  for(unsigned p=0;p<np;p++)sidx[p]=make_pair(idp[p],p);
+  sort(sidx.begin(),sidx.end());
+  DeltaIdp.resize(np); DeltaPos.resize(np*3); DeltaVel.resize(np*3); DeltaRhop.resize(np);
+  for(unsigned c=0;c<np;c++){
+    const unsigned p=sidx[c].second;
+    DeltaIdp[c]=sidx[c].first;
+    for(unsigned k=0;k<3;k++){ DeltaPos[c*3+k]=pos[p*3+k]; DeltaVel[c*3+k]=vel[p*3+k]; }
+    DeltaRhop[c]=rhop[p];
+  }
+  DeltaPosDouble=posdouble;
+  DeltaKey=DeltaCpart=pt->GetvUint("Cpart");
+}
+
+//==============================================================================
+/// Aplica diferencias de part diferencial al estado actual.
+/// Applies differences of delta part to the current state.
+//==============================================================================
+void JPartDataBi4::DeltaApply(const JBinaryData *part){
+  const char met[]="DeltaApply";
+  JBinaryData *pt=(JBinaryData *)part;
+  if(pt->GetvUint("DeltaKey")!=DeltaKey || pt->GetvUint("DeltaPrev")!=DeltaCpart || pt->GetvBool("DeltaPosDouble")!=DeltaPosDouble)RunException(met,"The sequence of delta parts is invalid.");
+  const unsigned np=pt->GetvUint("Npok");
+  const unsigned n0=unsigned(DeltaIdp.size());
+  const JBinaryDataArray *arnew=(pt->GetArray("DeltaIdpNew64")? pt->GetArray("DeltaIdpNew64"): pt->GetArray("DeltaIdpNew"));
+  const JBinaryDataArray *ardel=(pt->GetArray("DeltaIdpDel64")? pt->GetArray("DeltaIdpDel64"): pt->GetArray("DeltaIdpDel"));
+  if(!arnew || !ardel)RunException(met,"Arrays of delta part are missing.");
+  const unsigned nnew=max(arnew->GetCount(),arnew->GetFileDataCount());
+  const unsigned ndel=max(ardel->GetCount(),ardel->GetFileDataCount());
+  if(n0+nnew<ndel || n0+nnew-ndel!=np)RunException(met,"Number of particles of delta part is invalid.");
+  const unsigned ncom=n0-ndel;
+  const JBinaryDataDef::TpData tpos=(DeltaPosDouble? JBinaryDataDef::DatUllong: JBinaryDataDef::DatUint);
+  vector<unsigned> velnew,rhopnew,velx,rhopx;
+  vector<ullong> idnew,iddel,posnew,posx;
+  DeltaGetIdArray(pt,"DeltaIdpNew",nnew,idnew);
+  DeltaGetIdArray(pt,"DeltaIdpDel",ndel,iddel);
+  DeltaGetArray(pt,"DeltaVelNew",JBinaryDataDef::DatUint,nnew*3,velnew);
+  DeltaGetArray(pt,"DeltaRhopNew",JBinaryDataDef::DatUint,nnew,rhopnew);
+  DeltaGetArray(pt,"DeltaVelX",JBinaryDataDef::DatUint,ncom*3,velx);
+  DeltaGetArray(pt,"DeltaRhopX",JBinaryDataDef::DatUint,ncom,rhopx);
+  if(DeltaPosDouble){
+    DeltaGetArray(pt,"DeltaPosNew",tpos,nnew*3,posnew);
+    DeltaGetArray(pt,"DeltaPosX",tpos,ncom*3,posx);
+  }
+  else{
+    vector<unsigned> v32;
+    DeltaGetArray(pt,"DeltaPosNew",tpos,nnew*3,v32); posnew.assign(v32.begin(),v32.end());
+    DeltaGetArray(pt,"DeltaPosX",tpos,ncom*3,v32);   posx.assign(v32.begin(),v32.end());
+  }
+  //-Merges previous state with differences.
+  vector<unsigned> svel(np*3),srhop(np);
+  vector<ullong> sidp(np),spos(np*3);
+  unsigned i=0,inew=0,idel=0,icom=0,c=0;
+  while(i<n0 || inew<nnew){
+    if(i<n0 && idel<ndel && DeltaIdp[i]==iddel[idel]){ i++; idel++; }
+    else if(inew<nnew && (i>=n0 || idnew[inew]<DeltaIdp[i])){
+      if(c>=np)RunException(met,"Data of delta part is invalid.");
+      sidp[c]=idnew[inew];
+      for(unsigned k=0;k<3;k++){ spos[c*3+k]=posnew[inew*3+k]; svel[c*3+k]=velnew[inew*3+k]; }
+      srhop[c]=rhopnew[inew];
+      inew++; c++;
+    }
+    else{
+      if(c>=np || icom>=ncom)RunException(met,"Data of delta part is invalid.");
+      sidp[c]=DeltaIdp[i];
+      for(unsigned k=0;k<3;k++){
+        if(DeltaPosDouble)spos[c*3+k]=DeltaPos[i*3+k]+DeltaUnzig(posx[icom*3+k]);
+        else spos[c*3+k]=unsigned(DeltaPos[i*3+k])+DeltaUnzig(unsigned(posx[icom*3+k]));
+        svel[c*3+k]=DeltaVel[i*3+k]+DeltaUnzig(velx[icom*3+k]);
+      }
+      srhop[c]=DeltaRhop[i]+DeltaUnzig(rhopx[icom]);
+      i++; icom++; c++;
+    }
+  }
+  if(c!=np || idel!=ndel)RunException(met,"Data of delta part is invalid.");
+  DeltaIdp.swap(sidp);
+  DeltaPos.swap(spos);
+  DeltaVel.swap(svel);
+  DeltaRhop.swap(srhop);
+  DeltaCpart=pt->GetvUint("Cpart");
+}
+
+//==============================================================================
+/// Reconstruye los datos de particulas del part diferencial cargado a partir
+/// de su keyframe y los parts intermedios. Reutiliza el estado de la carga 
+/// anterior cuando es posible, de modo que la lectura secuencial solo aplica 
+/// las diferencias de cada part. Las particulas quedan ordenadas por Idp.
+/// Rebuilds data of particles of the loaded delta part from its keyframe and
+/// the intermediate parts. It reuses the state of previous load when possible,
+/// so sequential reading only applies the differences of each part. Particles
+/// are sorted by Idp.
+//==============================================================================
+void JPartDataBi4::DeltaRebuild(const std::string &dir,unsigned piece,unsigned npiece){
+  const unsigned key=Part->GetvUint("DeltaKey");
+  const unsigned cpart=Cpart;
+  if(DeltaKey!=key || DeltaCpart>=cpart){
+    JPartDataBi4 pd;
+    pd.ConfigFileMap(FileMap);
+    pd.LoadFileData(fun::GetDirWithSlash(dir)+GetFileNamePart(key,piece,npiece),key,piece,npiece);
+    DeltaLoadKeyframe(pd.Part);
+  }
+  for(unsigned cp=DeltaCpart+1;cp<cpart;cp++){
+    JPartDataBi4 pd;
+    pd.ConfigFileMap(FileMap);
+    pd.LoadFileData(fun::GetDirWithSlash(dir)+GetFileNamePart(cp,piece,npiece),cp,piece,npiece);
+    DeltaApply(pd.Part);
+  }
+  DeltaApply(Part);
+  //-Creates arrays of particles with reconstructed data.
+  const unsigned np=unsigned(DeltaIdp.size());
+  DeltaAddIdArray(Part,"Idp","Idpd",DeltaIdp,false);
+  if(DeltaPosDouble)Part->CreateArray("Posd",JBinaryDataDef::DatDouble3,np,(np? &DeltaPos[0]: NULL),false);
+  else{
+    vector<unsigned> pos32(DeltaPos.begin(),DeltaPos.end());
+    Part->CreateArray("Pos",JBinaryDataDef::DatFloat3,np,(np? &pos32[0]: NULL),false);
+  }
+  Part->CreateArray("Vel",JBinaryDataDef::DatFloat3,np,(np? &DeltaVel[0]: NULL),false);
+  Part->CreateArray("Rhop",JBinaryDataDef::DatFloat,np,(np? &DeltaRhop[0]: NULL),false);
+}
+
+//==============================================================================
+/// Devuelve posiciones en simple precision (reconstruidas si estan cuantizadas).
+/// Returns positions in single precision (reconstructed when quantised).
+//==============================================================================
+unsigned JPartDataBi4::Get_Pos(unsigned size,tfloat3 *data)const{
+  if(!ArrayExists("PosQ"))return(GetArray("Pos",JBinaryDataDef::DatFloat3)->GetDataCopy(size,data));
+  const unsigned np=Get_Npok();
+  if(size<np)RunException("Get_Pos","Size of array is not enough to store all data.");
+  GetQuantArray("PosQ",np,3,(float*)data,NULL);
+  return(np);
+}
+
+//==============================================================================
+/// Devuelve posiciones en doble precision (reconstruidas si estan cuantizadas).
+/// Returns positions in double precision (reconstructed when quantised).
+//==============================================================================
+unsigned JPartDataBi4::Get_Posd(unsigned size,tdouble3 *data)const{
+  if(!ArrayExists("PosQ"))return(GetArray("Posd",JBinaryDataDef::DatDouble3)->GetDataCopy(size,data));
+  const unsigned np=Get_Npok();
+  if(size<np)RunException("Get_Posd","Size of array is not enough to store all data.");
+  GetQuantArray("PosQ",np,3,NULL,(double*)data);
+  return(np);
+}
+
+//==============================================================================
+/// Devuelve velocidades (reconstruidas si estan cuantizadas).
+/// Returns velocities (reconstructed when quantised).
+//==============================================================================
+unsigned JPartDataBi4::Get_Vel(unsigned size,tfloat3 *data)const{
+  if(!ArrayExists("VelQ"))return(GetArray("Vel",JBinaryDataDef::DatFloat3)->GetDataCopy(size,data));
+  const unsigned np=Get_Npok();
+  if(size<np)RunException("Get_Vel","Size of array is not enough to store all data.");
+  GetQuantArray("VelQ",np,3,(float*)data,NULL);
+  return(np);
+}
+
+//==============================================================================
+/// Devuelve densidades (reconstruidas si estan cuantizadas).
+/// Returns densities (reconstructed when quantised).
+//==============================================================================
+unsigned JPartDataBi4::Get_Rhop(unsigned size,float *data)const{
+  if(!ArrayExists("RhopQ"))return(GetArray("Rhop",JBinaryDataDef::DatFloat)->GetDataCopy(size,data));
+  const unsigned np=Get_Npok();
+  if(size<np)RunException("Get_Rhop","Size of array is not enough to store all data.");
+  GetQuantArray("RhopQ",np,1,data,NULL);
+  return(np);
 }
 
 //==============================================================================
@@ -446,11 +934,42 @@ unsigned JPartDataBi4::GetPiecesFileCase(std::string dir,std::string casename)co
 //==============================================================================
 unsigned JPartDataBi4::GetPiecesFilePart(std::string dir,unsigned cpart)const{
   unsigned npieces=0;
-  if(fun::FileExists(Dir+GetFileNamePart(cpart,0,1)))npieces=1;
+  if(fun::FileExists(dir+GetFileNamePart(cpart,0,1)))npieces=1;
   else npieces=GetPiecesFile(dir+GetFileNamePart(cpart,0,2));
   return(npieces);
 }
 
+//==============================================================================
+/// Devuelve el numero de particulas del fichero indicado leyendo solo la
+/// cabecera (los parts diferenciales no se reconstruyen).
+/// Returns the number of particles of the indicated file reading only the
+/// header (delta parts are not rebuilt).
+//==============================================================================
+unsigned JPartDataBi4::GetNpokFile(std::string file,unsigned cpart)const{
+  const char met[]="GetNpokFile";
+  JBinaryData dat(ClassName);
+  dat.OpenFileStructure(file,ClassName);
+  const JBinaryData *part=dat.GetItem(GetNamePart(cpart));
+  if(!part)RunException(met,"PART data is invalid.",file);
+  return(part->GetvUint("Npok"));
+}
+
+//==============================================================================
+/// Devuelve el numero de particulas de la pieza indicada del caso.
+/// Returns the number of particles of the indicated piece of the case.
+//==============================================================================
+unsigned JPartDataBi4::GetNpokFileCase(std::string dir,std::string casename,unsigned piece,unsigned npiece)const{
+  return(GetNpokFile(fun::GetDirWithSlash(dir)+GetFileNameCase(casename,piece,npiece),0));
+}
+
+//==============================================================================
+/// Devuelve el numero de particulas de la pieza indicada del PART.
+/// Returns the number of particles of the indicated piece of the PART.
+//==============================================================================
+unsigned JPartDataBi4::GetNpokFilePart(std::string dir,unsigned cpart,unsigned piece,unsigned npiece)const{
+  return(GetNpokFile(fun::GetDirWithSlash(dir)+GetFileNamePart(cpart,piece,npiece),cpart));
+}
+
 //==============================================================================
 /// Graba fichero BI4 con el nombre da caso indicado.
 /// Writes file BI4 with the case name indicated.
@@ -459,7 +978,7 @@ void JPartDataBi4::LoadFileData(std::string file,unsigned cpart,unsigned piece,u
   const char met[]="LoadFileData";
   ResetData();
   Cpart=cpart; Piece=piece; Npiece=npiece;
-  Data->OpenFileStructure(file,ClassName);
+  Data->OpenFileStructure(file,ClassName,FileMap);
   if(Piece!=Data->GetvUint("Piece")||Npiece!=Data->GetvUint("Npiece"))RunException(met,"PART configuration is invalid.");
   Part=Data->GetItem(GetNamePart(Cpart));
   if(!Part)RunException(met,"PART data is invalid.");
@@ -480,6 +999,7 @@ void JPartDataBi4::LoadFileCase(std::string dir,std::string casename,unsigned pi
 //==============================================================================
 void JPartDataBi4::LoadFilePart(std::string dir,unsigned cpart,unsigned piece,unsigned npiece){
   LoadFileData(fun::GetDirWithSlash(dir)+GetFileNamePart(cpart,piece,npiece),cpart,piece,npiece);
+  if(Get_Delta())DeltaRebuild(dir,piece,npiece);
 }
 
 //==============================================================================
@@ -554,6 +1074,34 @@ JBinaryDataArray* JPartDataBi4::GetArray(std::string name,JBinaryDataDef::TpData
   return(ar);
 }
 
+//==============================================================================
+/// Devuelve puntero de solo lectura a los datos del array sin copiarlos. Los
+/// datos pueden estar en memoria o en el fichero proyectado (ConfigFileMap()).
+/// Devuelve NULL cuando no es posible (array comprimido, cuantizado o fichero
+/// no proyectado), en cuyo caso deben usarse los metodos Get_XXX().
+/// Returns read-only pointer to data of the array without copying them. The
+/// data can be in memory or in the mapped file (ConfigFileMap()). Returns NULL
+/// when it is not possible (array compressed, quantised or file not mapped),
+/// and then the methods Get_XXX() must be used.
+//==============================================================================
+const void* JPartDataBi4::GetArrayView(std::string name,JBinaryDataDef::TpData type)const{
+  JBinaryDataArray* ar=GetPart()->GetArray(name);
+  if(!ar || ar->GetType()!=type)return(NULL);
+  if(ar->DataInPointer())return(ar->GetPointer());
+  return(ar->GetFileDataPointer());
+}
+
+//==============================================================================
+/// Libera la memoria residente usada por GetArrayView() con fichero proyectado
+/// para los elementos indicados.
+/// Releases the resident memory used by GetArrayView() with mapped file for 
+/// the given elements.
+//==============================================================================
+void JPartDataBi4::ReleaseArrayView(std::string name,unsigned pini,unsigned count)const{
+  JBinaryDataArray* ar=GetPart()->GetArray(name);
+  if(ar && !ar->DataInPointer())ar->ReleaseFileDataPointer(pini,count);
+}
+
 //==============================================================================
 /// Devuelve el valor de Y de datos 2D.
 /// Returns Y value in 2-D data.
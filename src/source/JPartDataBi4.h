@@ -48,6 +48,23 @@
 //:# - Establece PERI_Unknown por defecto. (27-04-2018)
 //:# - Improved definition of the periodic conditions. (27-04-2018)
 //:# - Incluye informacion de Symmetry. (13-05-2018)
+//:# - Opcion de compresion sin perdidas de los arrays de particulas. (18-10-2026)
+//:# - Grabacion cuantizada (con perdidas) de Pos, Vel y Rhop con error absoluto
+//:#   maximo indicado. Los metodos Get_Pos(), Get_Vel()... reconstruyen los 
+//:#   valores de forma transparente. (18-10-2026)
+//:# - Grabacion de parts como diferencias temporales respecto al part anterior
+//:#   usando el Idp como clave, con parts completos (keyframes) cada N parts. 
+//:#   LoadFilePart() reconstruye los parts diferenciales. (18-10-2026)
+//:# - Opcion de carga de ficheros proyectados en memoria con acceso sin copia
+//:#   a los arrays mediante GetArrayView(). (18-10-2026)
+//:# - Metodos GetNpokFileCase() y GetNpokFilePart() para obtener el numero de
+//:#   particulas de una pieza leyendo solo la cabecera. (18-10-2026)
+//:# - Corregido GetPiecesFilePart() que usaba Dir en lugar de dir. (18-10-2026)
+//:# - AddQuantArray() genera excepcion cuando el error es menor que la resolucion
+//:#   de los valores en lugar de superar el error indicado. (18-10-2026)
+//:# - AddPartDataQuant() y AddPartDataDelta() admiten Idp de 64 bits (Idpd). Los
+//:#   arrays de Idp de parts diferenciales se graban con 64 bits solo cuando 
+//:#   algun valor no cabe en 32 bits. (18-10-2026)
 //:#############################################################################
 
 /// \file JPartDataBi4.h \brief Declares the class \ref JPartDataBi4.
@@ -88,13 +105,37 @@ class JPartDataBi4 : protected JObject
   unsigned Piece;    ///<Numero de parte. Part number.
   unsigned Npiece;   ///<Numero total de partes. Number of total parts.
   unsigned Cpart;    ///<Numero de PART. PART number.
+  bool Compress;     ///<Comprime los arrays de particulas al grabar. Compresses arrays of particles when saving.
+  bool FileMap;      ///<Proyecta en memoria los ficheros cargados. Maps in memory the loaded files.
+
+  //-Estado para partes diferenciales (ultimo part ordenado por Idp).
+  //-State for delta parts (last part sorted by Idp).
+  unsigned DeltaKey;                ///<PART del keyframe del estado (UINT_MAX sin estado). PART of keyframe of the state (UINT_MAX without state).
+  unsigned DeltaCpart;              ///<PART del estado. PART of the state.
+  bool DeltaPosDouble;              ///<Posicion en doble precision. Position in double precision.
+  std::vector<ullong> DeltaIdp;     ///<Idp de particulas en orden creciente. Idp of particles in increasing order.
+  std::vector<ullong> DeltaPos;     ///<Bits de las componentes de posicion (bits de float en simple precision). Bits of position components (float bits in single precision).
+  std::vector<unsigned> DeltaVel;   ///<Bits de las componentes de velocidad. Bits of velocity components.
+  std::vector<unsigned> DeltaRhop;  ///<Bits de densidad. Bits of density.
 
   static std::string GetNamePart(unsigned cpart);
+  void CreatePartArray(const std::string &name,JBinaryDataDef::TpData type,unsigned npok,const void *v,bool externalpointer);
+  void AddQuantArray(const std::string &name,unsigned np,unsigned nc,const float *vf,const double *vd,double err);
+  void GetQuantArray(const std::string &name,unsigned np,unsigned nc,float *vf,double *vd)const;
   void AddPartData(unsigned npok,const unsigned *idp,const ullong *idpd,const tfloat3 *pos,const tdouble3 *posd,const tfloat3 *vel,const float *rhop,bool externalpointer=true);
   void AddPartDataVar(const std::string &name,JBinaryDataDef::TpData type,unsigned npok,const void *v,bool externalpointer=true);
+  void AddPartDataQuant(unsigned npok,const unsigned *idp,const ullong *idpd,const tdouble3 *posd,const tfloat3 *vel,const float *rhop,double errpos,double errvel,double errrhop);
+  void AddPartDataDelta(unsigned npok,const unsigned *idp,const ullong *idpd,const tfloat3 *pos,const tdouble3 *posd,const tfloat3 *vel,const float *rhop,bool keyframe);
+  template<class T> void DeltaGetArray(JBinaryData *part,const std::string &name,JBinaryDataDef::TpData type,unsigned n,std::vector<T> &v)const;
+  void DeltaGetIdArray(JBinaryData *part,const std::string &name,unsigned n,std::vector<ullong> &v)const;
+  void DeltaAddIdArray(JBinaryData *part,const std::string &name,const std::string &name64,const std::vector<ullong> &v,bool compress)const;
+  void DeltaLoadKeyframe(const JBinaryData *part);
+  void DeltaApply(const JBinaryData *part);
+  void DeltaRebuild(const std::string &dir,unsigned piece,unsigned npiece);
 
   void SaveFileData(std::string fname);
   unsigned GetPiecesFile(std::string file)const;
+  unsigned GetNpokFile(std::string file,unsigned cpart)const;
   void LoadFileData(std::string file,unsigned cpart,unsigned piece,unsigned npiece);
 
  public:
@@ -126,6 +167,8 @@ class JPartDataBi4 : protected JObject
   void ConfigSplitting(bool splitting);
 
   void ConfigSimDiv(TpAxisDiv axisdiv);
+  void ConfigCompression(bool compress){ Compress=compress; }
+  bool GetCompression()const{ return(Compress); }
 
   //-Configuracion de parts. Configuration of parts.
   JBinaryData* AddPartInfo(unsigned cpart,double timestep,unsigned npok,unsigned nout,unsigned step,double runtime,tdouble3 domainmin,tdouble3 domainmax,ullong nptotal=0,ullong idmax=0);
@@ -134,6 +177,11 @@ class JPartDataBi4 : protected JObject
   void AddPartData(unsigned npok,const ullong   *idpd,const tfloat3  *pos, const tfloat3 *vel,const float *rhop,bool externalpointer=true){  AddPartData(npok,NULL,idpd,pos ,NULL,vel,rhop,externalpointer);  }
   void AddPartData(unsigned npok,const ullong   *idpd,const tdouble3 *posd,const tfloat3 *vel,const float *rhop,bool externalpointer=true){  AddPartData(npok,NULL,idpd,NULL,posd,vel,rhop,externalpointer);  }
   void AddPartDataSplitting(unsigned npok,const float *mass,const float *hvar,bool externalpointer=true);
+  void AddPartDataQuant(unsigned npok,const unsigned *idp,const tdouble3 *posd,const tfloat3 *vel,const float *rhop,double errpos,double errvel,double errrhop){  AddPartDataQuant(npok,idp,NULL,posd,vel,rhop,errpos,errvel,errrhop);  }
+  void AddPartDataQuant(unsigned npok,const ullong *idpd,const tdouble3 *posd,const tfloat3 *vel,const float *rhop,double errpos,double errvel,double errrhop){  AddPartDataQuant(npok,NULL,idpd,posd,vel,rhop,errpos,errvel,errrhop);  }
+  void AddPartDataDelta(unsigned npok,const unsigned *idp,const tfloat3 *pos,const tdouble3 *posd,const tfloat3 *vel,const float *rhop,bool keyframe){  AddPartDataDelta(npok,idp,NULL,pos,posd,vel,rhop,keyframe);  }
+  void AddPartDataDelta(unsigned npok,const ullong *idpd,const tfloat3 *pos,const tdouble3 *posd,const tfloat3 *vel,const float *rhop,bool keyframe){  AddPartDataDelta(npok,NULL,idpd,pos,posd,vel,rhop,keyframe);  }
+  void ResetDelta();
 
   void AddPartData(const std::string &name,unsigned npok,const float    *v,bool externalpointer=true){  AddPartDataVar(name,JBinaryDataDef::DatFloat  ,npok,(const void *)v,externalpointer);  }
   void AddPartData(const std::string &name,unsigned npok,const double   *v,bool externalpointer=true){  AddPartDataVar(name,JBinaryDataDef::DatDouble ,npok,(const void *)v,externalpointer);  }
@@ -161,8 +209,12 @@ class JPartDataBi4 : protected JObject
   //Loading data:
   //================
   //-Carga de fichero. File loaded.
+  void ConfigFileMap(bool filemap){ FileMap=filemap; }
+  bool GetFileMap()const{ return(FileMap); }
   unsigned GetPiecesFileCase(std::string dir,std::string casename)const;
   unsigned GetPiecesFilePart(std::string dir,unsigned cpart)const;
+  unsigned GetNpokFileCase(std::string dir,std::string casename,unsigned piece=0,unsigned npiece=1)const;
+  unsigned GetNpokFilePart(std::string dir,unsigned cpart,unsigned piece=0,unsigned npiece=1)const;
   void LoadFileCase(std::string dir,std::string casename,unsigned piece=0,unsigned npiece=1);
   void LoadFilePart(std::string dir,unsigned cpart,unsigned piece=0,unsigned npiece=1);
 
@@ -234,14 +286,18 @@ class JPartDataBi4 : protected JObject
   JBinaryDataArray* GetArray(std::string name)const;
   JBinaryDataArray* GetArray(std::string name,JBinaryDataDef::TpData type)const;
   unsigned Get_ArrayCount(std::string name)const{ return(GetArray(name)->GetCount()); }
+  const void* GetArrayView(std::string name,JBinaryDataDef::TpData type)const;
+  void ReleaseArrayView(std::string name,unsigned pini=0,unsigned count=UINT_MAX)const;
   bool Get_IdpSimple()const{ return(ArrayExists("Idp")); }
-  bool Get_PosSimple()const{ return(ArrayExists("Pos")); }
+  bool Get_PosSimple()const{ return(ArrayExists("Pos") || ArrayExists("PosQ")); }
+  bool Get_Quantised()const{ return(GetPart()->GetvBool("Quantised",true,false)); }
+  bool Get_Delta()const{ return(GetPart()->ExistsValue("DeltaKey")); }
   unsigned Get_Idp  (unsigned size,unsigned *data)const{ return(GetArray("Idp" ,JBinaryDataDef::DatUint   )->GetDataCopy(size,data)); }
   unsigned Get_Idpd (unsigned size,ullong   *data)const{ return(GetArray("Idpd",JBinaryDataDef::DatUllong )->GetDataCopy(size,data)); }
-  unsigned Get_Pos  (unsigned size,tfloat3  *data)const{ return(GetArray("Pos" ,JBinaryDataDef::DatFloat3 )->GetDataCopy(size,data)); }
-  unsigned Get_Posd (unsigned size,tdouble3 *data)const{ return(GetArray("Posd",JBinaryDataDef::DatDouble3)->GetDataCopy(size,data)); }
-  unsigned Get_Vel  (unsigned size,tfloat3  *data)const{ return(GetArray("Vel" ,JBinaryDataDef::DatFloat3 )->GetDataCopy(size,data)); }
-  unsigned Get_Rhop (unsigned size,float    *data)const{ return(GetArray("Rhop",JBinaryDataDef::DatFloat  )->GetDataCopy(size,data)); }
+  unsigned Get_Pos  (unsigned size,tfloat3  *data)const;
+  unsigned Get_Posd (unsigned size,tdouble3 *data)const;
+  unsigned Get_Vel  (unsigned size,tfloat3  *data)const;
+  unsigned Get_Rhop (unsigned size,float    *data)const;
   unsigned Get_Mass (unsigned size,float    *data)const{ return(GetArray("Mass",JBinaryDataDef::DatFloat  )->GetDataCopy(size,data)); }
   unsigned Get_Hvar (unsigned size,float    *data)const{ return(GetArray("Hvar",JBinaryDataDef::DatFloat  )->GetDataCopy(size,data)); }
 
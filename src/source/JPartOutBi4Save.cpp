@@ -226,7 +226,7 @@ void JPartOutBi4Save::SavePartOut(){
 /// Records particles excluded from the PART.
 //==============================================================================
 void JPartOutBi4Save::SavePartOut(bool posdouble,unsigned cpart,double timestep,unsigned nout
-  ,const unsigned *idp,const tfloat3 *posf,const tdouble3 *posd,const tfloat3 *vel
+  ,const unsigned *idp,const ullong *idpd,const tfloat3 *posf,const tdouble3 *posd,const tfloat3 *vel
   ,const float *rhop,const byte *motive)
 {
   if(!posf && !posd)RunException("SavePartOut","The position of particles is invalid.");
@@ -234,19 +234,19 @@ void JPartOutBi4Save::SavePartOut(bool posdouble,unsigned cpart,double timestep,
     if(posd==NULL){
       tdouble3 *xpos=new tdouble3[nout];
       for(unsigned c=0;c<nout;c++)xpos[c]=ToTDouble3(posf[c]);
-      SavePartOut(cpart,timestep,nout,idp,xpos,vel,rhop,motive);
+      AddPartOut(cpart,timestep,nout,idp,idpd,NULL,xpos,vel,rhop,motive); SavePartOut();
       delete[] xpos; xpos=NULL;
     }
-    else SavePartOut(cpart,timestep,nout,idp,posd,vel,rhop,motive);
+    else{ AddPartOut(cpart,timestep,nout,idp,idpd,NULL,posd,vel,rhop,motive); SavePartOut(); }
   }
   else{
     if(posf==NULL){
       tfloat3 *xpos=new tfloat3[nout];
       for(unsigned c=0;c<nout;c++)xpos[c]=ToTFloat3(posd[c]);
-      SavePartOut(cpart,timestep,nout,idp,xpos,vel,rhop,motive);
+      AddPartOut(cpart,timestep,nout,idp,idpd,xpos,NULL,vel,rhop,motive); SavePartOut();
       delete[] xpos; xpos=NULL;
     }
-    else SavePartOut(cpart,timestep,nout,idp,posf,vel,rhop,motive);
+    else{ AddPartOut(cpart,timestep,nout,idp,idpd,posf,NULL,vel,rhop,motive); SavePartOut(); }
   }
 }
 
@@ -29,6 +29,7 @@
 //:# =========
 //:# - Implementacion. (23-11-2013)
 //:# - Ahora se guarda tambien el motivo de exclusion. (20-03-2018)
+//:# - SavePartOut() general admite Idp de 64 bits (Idpd). (18-10-2026)
 //:#############################################################################
 
 /// \file JPartOutBi4Save.h \brief Declares the class \ref JPartOutBi4Save.
@@ -114,7 +115,9 @@ class JPartOutBi4Save : protected JObject
   void SavePartOut(unsigned cpart,double timestep,unsigned nout,const ullong  *idpd,const tdouble3 *posd,const tfloat3 *vel,const float *rhop,const byte *motive){  AddPartOut(cpart,timestep,nout,NULL,idpd,NULL,posd,vel,rhop,motive); SavePartOut();  }
 
   //-Grabacion de fichero general. General file recording.
-  void SavePartOut(bool posdouble,unsigned cpart,double timestep,unsigned nout,const unsigned *idp,const tfloat3 *posf,const tdouble3 *posd,const tfloat3 *vel,const float *rhop,const byte *motive);
+  void SavePartOut(bool posdouble,unsigned cpart,double timestep,unsigned nout,const unsigned *idp,const ullong *idpd,const tfloat3 *posf,const tdouble3 *posd,const tfloat3 *vel,const float *rhop,const byte *motive);
+  void SavePartOut(bool posdouble,unsigned cpart,double timestep,unsigned nout,const unsigned *idp,const tfloat3 *posf,const tdouble3 *posd,const tfloat3 *vel,const float *rhop,const byte *motive){  SavePartOut(posdouble,cpart,timestep,nout,idp ,NULL,posf,posd,vel,rhop,motive);  }
+  void SavePartOut(bool posdouble,unsigned cpart,double timestep,unsigned nout,const ullong  *idpd,const tfloat3 *posf,const tdouble3 *posd,const tfloat3 *vel,const float *rhop,const byte *motive){  SavePartOut(posdouble,cpart,timestep,nout,NULL,idpd,posf,posd,vel,rhop,motive);  }
 
   unsigned GetBlockNoutMin()const{ return(BlockNoutMin); }
   unsigned GetBlockNoutMax()const{ return(BlockNoutMin); }
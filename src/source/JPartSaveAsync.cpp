@@ -0,0 +1,310 @@
+//HEAD_DSPH
+/*
+ <DUALSPHYSICS>  Copyright (c) 2019 by Dr Jose M. Dominguez et al. (see http://dual.sphysics.org/index.php/developers/). 
+
+ EPHYSLAB Environmental Physics Laboratory, Universidade de Vigo, Ourense, Spain.
+ School of Mechanical, Aerospace and Civil Engineering, University of Manchester, Manchester, U.K.
+
+ This file is part of DualSPHysics. 
+
+ DualSPHysics is free software: you can redistribute it and/or modify it under the terms of the GNU Lesser General Public License 
+ as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) any later version.
+ 
+ DualSPHysics is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details. 
+
+ You should have received a copy of the GNU Lesser General Public License along with DualSPHysics. If not, see <http://www.gnu.org/licenses/>. 
+*/
+
+/// \file JPartSaveAsync.cpp \brief Implements the classes \ref JPartSaveBuf and \ref JPartSaveAsync.
+
+#include "JPartSaveAsync.h"
+#include "JException.h"
+#include "JTimer.h"
+#include <cstring>
+#include <algorithm>
+
+using namespace std;
+
+//##############################################################################
+//# JPartSaveBuf
+//##############################################################################
+//==============================================================================
+/// Constructor.
+//==============================================================================
+JPartSaveBuf::JPartSaveBuf(){
+  ClassName="JPartSaveBuf";
+  Size=SizeOut=0;
+  OwnIdp=NULL; OwnPos=NULL; OwnVel=NULL; OwnRhop=NULL;
+  OwnOutIdp=NULL; OwnOutPos=NULL; OwnOutVel=NULL; OwnOutRhop=NULL; OwnOutMotive=NULL;
+  Reset();
+}
+
+//==============================================================================
+/// Destructor.
+//==============================================================================
+JPartSaveBuf::~JPartSaveBuf(){
+  DestructorActive=true;
+  Reset();
+  AllocMemory(0,0);
+}
+
+//==============================================================================
+/// Initialisation of variables (own memory is kept).
+/// Inicializacion de variables (se mantiene la memoria propia).
+//==============================================================================
+void JPartSaveBuf::Reset(){
+  Part=0; TimeStep=0; Npok=Nout=0; Nstep=0; RunTime=0;
+  DomMin=DomMax=TDouble3(0);
+  TotalNp=0;
+  SymplecticDtPre=DemDtForce=0;
+  InfoPlus=false;
+  memset(&InfoPlusData,0,sizeof(JSph::StInfoPartPlus));
+  DtMean=DtMin=DtMax=0;
+  DtErrorUse=false; DtError=0;
+  Idp=NULL; Pos=NULL; Vel=NULL; Rhop=NULL;
+  OutCount=0;
+  OutIdp=NULL; OutPos=NULL; OutVel=NULL; OutRhop=NULL; OutMotive=NULL;
+  FtCenter.clear(); FtVel.clear(); FtOmega.clear();
+}
+
+//==============================================================================
+/// Allocates own memory for particles and excluded particles. Previous data 
+/// is not kept and memory is never reduced except with zero size.
+///
+/// Asigna memoria propia para particulas y particulas excluidas. Los datos
+/// previos no se mantienen.
+//==============================================================================
+void JPartSaveBuf::AllocMemory(unsigned size,unsigned sizeout){
+  if(!size || size>Size){
+    delete[] OwnIdp;  OwnIdp=NULL;
+    delete[] OwnPos;  OwnPos=NULL;
+    delete[] OwnVel;  OwnVel=NULL;
+    delete[] OwnRhop; OwnRhop=NULL;
+    Size=0;
+    if(size){
+      try{
+        OwnIdp =new typeidp[size];
+        OwnPos =new tdouble3[size];
+        OwnVel =new tfloat3[size];
+        OwnRhop=new float[size];
+      }
+      catch(const std::bad_alloc){
+        RunException("AllocMemory","Could not allocate the requested memory.");
+      }
+      Size=size;
+    }
+  }
+  if(!sizeout || sizeout>SizeOut){
+    delete[] OwnOutIdp;    OwnOutIdp=NULL;
+    delete[] OwnOutPos;    OwnOutPos=NULL;
+    delete[] OwnOutVel;    OwnOutVel=NULL;
+    delete[] OwnOutRhop;   OwnOutRhop=NULL;
+    delete[] OwnOutMotive; OwnOutMotive=NULL;
+    SizeOut=0;
+    if(sizeout){
+      try{
+        OwnOutIdp   =new typeidp[sizeout];
+        OwnOutPos   =new tdouble3[sizeout];
+        OwnOutVel   =new tfloat3[sizeout];
+        OwnOutRhop  =new float[sizeout];
+        OwnOutMotive=new byte[sizeout];
+      }
+      catch(const std::bad_alloc){
+        RunException("AllocMemory","Could not allocate the requested memory.");
+      }
+      SizeOut=sizeout;
+    }
+  }
+}
+
+//==============================================================================
+/// Returns the allocated memory.
+/// Devuelve la memoria reservada.
+//==============================================================================
+llong JPartSaveBuf::GetAllocMemory()const{
+  llong s=0;
+  s+=llong(sizeof(typeidp)+sizeof(tdouble3)+sizeof(tfloat3)+sizeof(float))*Size;
+  s+=llong(sizeof(typeidp)+sizeof(tdouble3)+sizeof(tfloat3)+sizeof(float)+sizeof(byte))*SizeOut;
+  return(s);
+}
+
+//==============================================================================
+/// Copies the data of external pointers to own memory so the external memory 
+/// can be modified before writing the files.
+///
+/// Copia los datos de punteros externos a memoria propia para que la memoria
+/// externa pueda modificarse antes de grabar los ficheros.
+//==============================================================================
+void JPartSaveBuf::CopyData(){
+  const unsigned np=(Idp||Pos||Vel||Rhop? Npok: 0);
+  const unsigned npout=(OutIdp||OutPos||OutVel||OutRhop||OutMotive? OutCount: 0);
+  AllocMemory((np? max(np,Size): Size),(npout? max(npout,SizeOut): SizeOut));
+  if(Idp  && Idp!=OwnIdp  ){ memcpy(OwnIdp ,Idp ,sizeof(typeidp) *np); Idp =OwnIdp;  }
+  if(Pos  && Pos!=OwnPos  ){ memcpy(OwnPos ,Pos ,sizeof(tdouble3)*np); Pos =OwnPos;  }
+  if(Vel  && Vel!=OwnVel  ){ memcpy(OwnVel ,Vel ,sizeof(tfloat3) *np); Vel =OwnVel;  }
+  if(Rhop && Rhop!=OwnRhop){ memcpy(OwnRhop,Rhop,sizeof(float)   *np); Rhop=OwnRhop; }
+  if(OutIdp    && OutIdp!=OwnOutIdp      ){ memcpy(OwnOutIdp   ,OutIdp   ,sizeof(typeidp) *npout); OutIdp   =OwnOutIdp;    }
+  if(OutPos    && OutPos!=OwnOutPos      ){ memcpy(OwnOutPos   ,OutPos   ,sizeof(tdouble3)*npout); OutPos   =OwnOutPos;    }
+  if(OutVel    && OutVel!=OwnOutVel      ){ memcpy(OwnOutVel   ,OutVel   ,sizeof(tfloat3) *npout); OutVel   =OwnOutVel;    }
+  if(OutRhop   && OutRhop!=OwnOutRhop    ){ memcpy(OwnOutRhop  ,OutRhop  ,sizeof(float)   *npout); OutRhop  =OwnOutRhop;   }
+  if(OutMotive && OutMotive!=OwnOutMotive){ memcpy(OwnOutMotive,OutMotive,sizeof(byte)    *npout); OutMotive=OwnOutMotive; }
+}
+
+
+//##############################################################################
+//# JPartSaveAsync
+//##############################################################################
+//==============================================================================
+/// Constructor.
+//==============================================================================
+JPartSaveAsync::JPartSaveAsync(JSph *sph,unsigned depth):Sph(sph),Depth(depth){
+  ClassName="JPartSaveAsync";
+  if(!Depth)RunException("JPartSaveAsync","The number of staging buffers must be greater than zero.");
+  Busy=0;
+  Finish=false;
+  PartCount=WaitCount=MaxPending=0;
+  WaitTime=0;
+  Writer=std::thread(&JPartSaveAsync::RunWriter,this);
+}
+
+//==============================================================================
+/// Destructor. Pending buffers are written before finishing the writer thread.
+/// Destructor. Los buffers pendientes se graban antes de terminar el hilo.
+//==============================================================================
+JPartSaveAsync::~JPartSaveAsync(){
+  DestructorActive=true;
+  {
+    std::lock_guard<std::mutex> lock(Mtx);
+    Finish=true;
+  }
+  CondPending.notify_all();
+  if(Writer.joinable())Writer.join();
+  for(unsigned c=0;c<unsigned(Bufs.size());c++)delete Bufs[c];
+  Bufs.clear(); Free.clear(); Pending.clear();
+}
+
+//==============================================================================
+/// Main loop of the writer thread. Exceptions are stored to be thrown by the 
+/// main thread and next buffers are discarded.
+///
+/// Bucle principal del hilo de escritura. Las excepciones se almacenan para
+/// lanzarlas en el hilo principal y los siguientes buffers se descartan.
+//==============================================================================
+void JPartSaveAsync::RunWriter(){
+  for(;;){
+    JPartSaveBuf *buf=NULL;
+    bool skip=false;
+    {
+      std::unique_lock<std::mutex> lock(Mtx);
+      while(!Finish && Pending.empty())CondPending.wait(lock);
+      if(Pending.empty())break;
+      buf=Pending.front(); Pending.pop_front();
+      Busy++;
+      skip=!ErrorText.empty();
+    }
+    string error;
+    if(!skip){
+      try{
+        Sph->SavePartBuf(*buf);
+      }
+      catch(const JException &e){ error=e.ToStr(); }
+      catch(const std::exception &e){ error=e.what(); }
+      catch(...){ error="Unknown error."; }
+    }
+    buf->Reset();
+    {
+      std::lock_guard<std::mutex> lock(Mtx);
+      if(!error.empty() && ErrorText.empty())ErrorText=error;
+      Busy--;
+      Free.push_back(buf);
+    }
+    CondFree.notify_all();
+  }
+}
+
+//==============================================================================
+/// Throws exception when the writer thread failed.
+/// Lanza excepcion cuando el hilo de escritura fallo.
+//==============================================================================
+void JPartSaveAsync::CheckError(const std::string &method){
+  string error;
+  {
+    std::lock_guard<std::mutex> lock(Mtx);
+    error=ErrorText;
+  }
+  if(!error.empty())RunException(method,string("Error writing particle data in background: ")+error);
+}
+
+//==============================================================================
+/// Returns a free staging buffer. When all buffers are waiting to be written 
+/// the main thread waits until the writer releases one (back-pressure).
+///
+/// Devuelve un buffer intermedio libre. Cuando todos los buffers estan 
+/// pendientes de grabacion el hilo principal espera a que se libere uno.
+//==============================================================================
+JPartSaveBuf* JPartSaveAsync::GetFreeBuf(){
+  CheckError("GetFreeBuf");
+  JPartSaveBuf *buf=NULL;
+  {
+    std::unique_lock<std::mutex> lock(Mtx);
+    if(Free.empty() && unsigned(Bufs.size())<Depth){
+      buf=new JPartSaveBuf();
+      Bufs.push_back(buf);
+    }
+    else{
+      if(Free.empty()){
+        JTimer tm;
+        tm.Start();
+        while(Free.empty() && ErrorText.empty())CondFree.wait(lock);
+        tm.Stop();
+        WaitCount++;
+        WaitTime+=tm.GetElapsedTimeD()/1000.;
+      }
+      if(!Free.empty()){
+        buf=Free.front(); Free.pop_front();
+      }
+    }
+  }
+  if(!buf)CheckError("GetFreeBuf");
+  buf->Reset();
+  return(buf);
+}
+
+//==============================================================================
+/// Adds buffer with data to the queue of the writer thread.
+/// Anhade buffer con datos a la cola del hilo de escritura.
+//==============================================================================
+void JPartSaveAsync::PushBuf(JPartSaveBuf *buf){
+  {
+    std::lock_guard<std::mutex> lock(Mtx);
+    Pending.push_back(buf);
+    PartCount++;
+    MaxPending=max(MaxPending,unsigned(Pending.size()));
+  }
+  CondPending.notify_one();
+}
+
+//==============================================================================
+/// Waits until all pending buffers are written.
+/// Espera hasta que todos los buffers pendientes se graben.
+//==============================================================================
+void JPartSaveAsync::WaitAll(){
+  {
+    std::unique_lock<std::mutex> lock(Mtx);
+    while(!Pending.empty() || Busy)CondFree.wait(lock);
+  }
+  CheckError("WaitAll");
+}
+
+//==============================================================================
+/// Returns the allocated memory in staging buffers.
+/// Devuelve la memoria reservada en los buffers intermedios.
+//==============================================================================
+llong JPartSaveAsync::GetAllocMemory(){
+  std::lock_guard<std::mutex> lock(Mtx);
+  llong s=0;
+  for(unsigned c=0;c<unsigned(Bufs.size());c++)s+=Bufs[c]->GetAllocMemory();
+  return(s);
+}
+
@@ -0,0 +1,161 @@
+//HEAD_DSPH
+/*
+ <DUALSPHYSICS>  Copyright (c) 2019 by Dr Jose M. Dominguez et al. (see http://dual.sphysics.org/index.php/developers/). 
+
+ EPHYSLAB Environmental Physics Laboratory, Universidade de Vigo, Ourense, Spain.
+ School of Mechanical, Aerospace and Civil Engineering, University of Manchester, Manchester, U.K.
+
+ This file is part of DualSPHysics. 
+
+ DualSPHysics is free software: you can redistribute it and/or modify it under the terms of the GNU Lesser General Public License 
+ as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) any later version.
+ 
+ DualSPHysics is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details. 
+
+ You should have received a copy of the GNU Lesser General Public License along with DualSPHysics. If not, see <http://www.gnu.org/licenses/>. 
+*/
+
+//:#############################################################################
+//:# Cambios:
+//:# =========
+//:# - Grabacion asincrona de datos de particulas usando buffers intermedios y
+//:#   un hilo de escritura en segundo plano. (18-10-2026)
+//:#############################################################################
+
+/// \file JPartSaveAsync.h \brief Declares the classes \ref JPartSaveBuf and \ref JPartSaveAsync.
+
+#ifndef _JPartSaveAsync_
+#define _JPartSaveAsync_
+
+#include "Types.h"
+#include "JObject.h"
+#include "JSph.h"
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+//##############################################################################
+//# JPartSaveBuf
+//##############################################################################
+/// \brief Stores data of one PART (particles, excluded particles and floatings) until writing the output files.
+
+class JPartSaveBuf : protected JObject
+{
+protected:
+  unsigned Size;        ///<Number of particles allocated in own memory.          | Numero de particulas reservadas en memoria propia.
+  unsigned SizeOut;     ///<Number of excluded particles allocated in own memory. | Numero de particulas excluidas reservadas en memoria propia.
+
+  typeidp  *OwnIdp;
+  tdouble3 *OwnPos;
+  tfloat3  *OwnVel;
+  float    *OwnRhop;
+
+  typeidp  *OwnOutIdp;
+  tdouble3 *OwnOutPos;
+  tfloat3  *OwnOutVel;
+  float    *OwnOutRhop;
+  byte     *OwnOutMotive;
+
+  void AllocMemory(unsigned size,unsigned sizeout);
+
+public:
+  //-Information of PART.
+  unsigned Part;
+  double TimeStep;
+  unsigned Npok;
+  unsigned Nout;
+  int Nstep;
+  double RunTime;             ///<Runtime since last PART (seconds).
+  tdouble3 DomMin,DomMax;
+  ullong TotalNp;
+  double SymplecticDtPre;
+  double DemDtForce;
+  bool InfoPlus;              ///<Extra information is available.
+  JSph::StInfoPartPlus InfoPlusData;
+  double DtMean,DtMin,DtMax;
+  bool DtErrorUse;
+  double DtError;
+
+  //-Particle data (external pointers or own memory after CopyData()).
+  const typeidp  *Idp;
+  const tdouble3 *Pos;
+  const tfloat3  *Vel;
+  const float    *Rhop;
+
+  //-Excluded particles (external pointers or own memory after CopyData()).
+  unsigned OutCount;
+  const typeidp  *OutIdp;
+  const tdouble3 *OutPos;
+  const tfloat3  *OutVel;
+  const float    *OutRhop;
+  const byte     *OutMotive;
+
+  //-Data of floating bodies.
+  std::vector<tdouble3> FtCenter;
+  std::vector<tfloat3>  FtVel;
+  std::vector<tfloat3>  FtOmega;
+
+  JPartSaveBuf();
+  ~JPartSaveBuf();
+  void Reset();
+  llong GetAllocMemory()const;
+  void CopyData();
+};
+
+//##############################################################################
+//# JPartSaveAsync
+//##############################################################################
+/// \brief Writes the output files of particle data in a background thread.
+/// The main thread copies data of each PART in a free staging buffer and 
+/// continues the simulation while the writer thread saves the buffers in order.
+/// When all buffers are pending the main thread waits (back-pressure).
+
+class JPartSaveAsync : protected JObject
+{
+protected:
+  JSph *Sph;                       ///<Object that writes the files of one buffer.
+  const unsigned Depth;            ///<Maximum number of staging buffers (queue depth). | Numero maximo de buffers intermedios.
+
+  std::vector<JPartSaveBuf*> Bufs; ///<Allocated staging buffers.
+  std::deque<JPartSaveBuf*> Free;  ///<Buffers available to store data.
+  std::deque<JPartSaveBuf*> Pending; ///<Buffers waiting to be written in order.
+  unsigned Busy;                   ///<Number of buffers being written.
+  bool Finish;                     ///<The writer thread must finish.
+  std::string ErrorText;           ///<Error of the writer thread.
+
+  std::mutex Mtx;
+  std::condition_variable CondPending;
+  std::condition_variable CondFree;
+  std::thread Writer;
+
+  //-Statistics.
+  unsigned PartCount;              ///<Number of PARTs stored in background.
+  unsigned WaitCount;              ///<Number of times the main thread waited for a free buffer.
+  double WaitTime;                 ///<Time waiting for a free buffer (seconds).
+  unsigned MaxPending;             ///<Maximum number of buffers waiting to be written.
+
+  void RunWriter();
+  void CheckError(const std::string &method);
+
+public:
+  JPartSaveAsync(JSph *sph,unsigned depth);
+  ~JPartSaveAsync();
+
+  JPartSaveBuf* GetFreeBuf();
+  void PushBuf(JPartSaveBuf *buf);
+  void WaitAll();
+
+  llong GetAllocMemory();
+  unsigned GetDepth()const{ return(Depth); }
+  unsigned GetPartCount()const{ return(PartCount); }
+  unsigned GetWaitCount()const{ return(WaitCount); }
+  double GetWaitTime()const{ return(WaitTime); }
+  unsigned GetMaxPending()const{ return(MaxPending); }
+};
+
+#endif
+
@@ -22,6 +22,9 @@
 #include "Functions.h"
 #include "JPartDataBi4.h"
 #include "JRadixSort.h"
+#include "JException.h"
+#include "OmpDefs.h"
+#include <vector>
 #include <climits>
 #include <cfloat>
 
@@ -76,7 +79,7 @@ void JPartsLoad4::AllocMemory(unsigned count){
   delete[] VelRhop;  VelRhop=NULL; 
   if(Count){
     try{
-      Idp=new unsigned[Count];
+      Idp=new typeidp[Count];
       Pos=new tdouble3[Count];
       VelRhop=new tfloat4[Count];
     }
@@ -93,7 +96,7 @@ void JPartsLoad4::AllocMemory(unsigned count){
 llong JPartsLoad4::GetAllocMemory()const{  
   llong s=0;
   //-Allocated in AllocMemory().
-  if(Idp)s+=sizeof(unsigned)*Count;
+  if(Idp)s+=sizeof(typeidp)*Count;
   if(Pos)s+=sizeof(tdouble3)*Count;
   if(VelRhop)s+=sizeof(tfloat4)*Count;
   return(s);
@@ -119,7 +122,23 @@ void JPartsLoad4::CheckSortParticles(){
   if(nbound){
     unsigned lastbound=0;
     //-Computes position of last boundary particle.
-    for(unsigned p=0;p<Count;p++)if(Idp[p]<nbound && p>lastbound)lastbound=p;
+    const int n=int(Count);
+    #ifdef OMP_USE
+      #pragma omp parallel if(UseOmp && n>OMP_LIMIT_COMPUTELIGHT)
+    #endif
+    {
+      unsigned lastbound2=0;
+      #ifdef OMP_USE
+        #pragma omp for nowait
+      #endif
+      for(int p=0;p<n;p++)if(Idp[p]<nbound && unsigned(p)>lastbound2)lastbound2=unsigned(p);
+      #ifdef OMP_USE
+        #pragma omp critical 
+      #endif
+      {
+        if(lastbound<lastbound2)lastbound=lastbound2;
+      }
+    }
     if(lastbound+1!=nbound)RunException("CheckSortParticles","Order of boundary (fixed and moving) particles is invalid.");
   }
 }
@@ -131,7 +150,23 @@ void JPartsLoad4::CheckSortParticles(){
 void JPartsLoad4::SortParticles(){
   //-Checks order. | Comprueba orden.
   bool sorted=true;
-  for(unsigned p=1;p<Count && sorted;p++)sorted=(Idp[p-1]<Idp[p]);
+  const int n=int(Count);
+  #ifdef OMP_USE
+    #pragma omp parallel if(UseOmp && n>OMP_LIMIT_COMPUTELIGHT)
+  #endif
+  {
+    bool sorted2=true;
+    #ifdef OMP_USE
+      #pragma omp for schedule(static) nowait
+    #endif
+    for(int p=1;p<n;p++)if(sorted2 && Idp[p-1]>=Idp[p])sorted2=false;
+    #ifdef OMP_USE
+      #pragma omp critical 
+    #endif
+    {
+      if(!sorted2)sorted=false;
+    }
+  }
   if(!sorted){
     //-Sorts points according to id. | Ordena puntos segun id.
     JRadixSort rs(UseOmp);
@@ -141,6 +176,142 @@ void JPartsLoad4::SortParticles(){
   }
 }
 
+//==============================================================================
+/// Loads particles of one piece starting at position pini of the arrays.
+/// Carga particulas de una pieza a partir de la posicion pini de los arrays.
+//==============================================================================
+void JPartsLoad4::LoadPiece(JPartDataBi4 &pd,unsigned pini,bool omp){
+  const char met[]="LoadPiece";
+  const unsigned npok=pd.Get_Npok();
+  if(!npok)return;
+  const bool possingle=pd.Get_PosSimple();
+  const bool idpsimple=pd.Get_IdpSimple();
+  if(!idpsimple && !pd.ArrayExists("Idpd"))RunException(met,"Array of Idp is missing.");
+  typeidp *idp=Idp+pini;
+  tdouble3 *pos=Pos+pini;
+  tfloat4 *velrhop=VelRhop+pini;
+  ullong idpmax=0;
+  //-Uncompressed arrays are converted directly from the mapped file by 
+  //-blocks, releasing the pages already used to limit resident memory.
+  const tfloat3  *vpos =(possingle? (const tfloat3*)pd.GetArrayView("Pos",JBinaryDataDef::DatFloat3): NULL);
+  const tdouble3 *vposd=(!possingle? (const tdouble3*)pd.GetArrayView("Posd",JBinaryDataDef::DatDouble3): NULL);
+  const unsigned *vidp =(idpsimple? (const unsigned*)pd.GetArrayView("Idp",JBinaryDataDef::DatUint): NULL);
+  const ullong   *vidpd=(!idpsimple? (const ullong*)pd.GetArrayView("Idpd",JBinaryDataDef::DatUllong): NULL);
+  const tfloat3  *vvel =(const tfloat3*)pd.GetArrayView("Vel",JBinaryDataDef::DatFloat3);
+  const float    *vrhop=(const float*)pd.GetArrayView("Rhop",JBinaryDataDef::DatFloat);
+  const bool views=((vpos || vposd) && (vidp || vidpd) && vvel && vrhop);
+  if(views){
+    const unsigned nblock=1048576;
+    const int nb=int((npok+nblock-1)/nblock);
+    #ifdef OMP_USE
+      #pragma omp parallel for schedule(dynamic) if(omp && nb>1)
+    #endif
+    for(int cb=0;cb<nb;cb++){
+      const unsigned bini=unsigned(cb)*nblock;
+      const unsigned n=min(nblock,npok-bini);
+      const unsigned bfin=bini+n;
+      if(vpos){
+        for(unsigned p=bini;p<bfin;p++)pos[p]=ToTDouble3(vpos[p]);
+        pd.ReleaseArrayView("Pos",bini,n);
+      }
+      else{
+        memcpy(pos+bini,vposd+bini,sizeof(tdouble3)*n);
+        pd.ReleaseArrayView("Posd",bini,n);
+      }
+    #ifdef IDP_SIZE8
+      if(vidp){
+        for(unsigned p=bini;p<bfin;p++)idp[p]=vidp[p];
+        pd.ReleaseArrayView("Idp",bini,n);
+      }
+      else{
+        memcpy(idp+bini,vidpd+bini,sizeof(ullong)*n);
+        pd.ReleaseArrayView("Idpd",bini,n);
+      }
+    #else
+      if(vidp){
+        memcpy(idp+bini,vidp+bini,sizeof(unsigned)*n);
+        pd.ReleaseArrayView("Idp",bini,n);
+      }
+      else{//-Idp of 64 bits is valid when values fit in 32 bits.
+        ullong vmax=0;
+        for(unsigned p=bini;p<bfin;p++){
+          if(vmax<vidpd[p])vmax=vidpd[p];
+          idp[p]=unsigned(vidpd[p]);
+        }
+        pd.ReleaseArrayView("Idpd",bini,n);
+        if(vmax>UINT_MAX){
+          #ifdef OMP_USE
+            #pragma omp critical 
+          #endif
+          {
+            if(idpmax<vmax)idpmax=vmax;
+          }
+        }
+      }
+    #endif
+      for(unsigned p=bini;p<bfin;p++)velrhop[p]=TFloat4(vvel[p].x,vvel[p].y,vvel[p].z,vrhop[p]);
+      pd.ReleaseArrayView("Vel",bini,n);
+      pd.ReleaseArrayView("Rhop",bini,n);
+    }
+  }
+  else{
+    const int n=int(npok);
+    tfloat3 *auxf3=NULL;
+    float *auxf=NULL;
+    ullong *auxull=NULL;
+    try{
+      auxf3=new tfloat3[npok];
+      auxf=new float[npok];
+    #ifndef IDP_SIZE8
+      if(!idpsimple)auxull=new ullong[npok];
+    #endif
+    }
+    catch(const std::bad_alloc){
+      delete[] auxf3; auxf3=NULL;
+      delete[] auxf;  auxf=NULL;
+      RunException(met,"Could not allocate the requested memory.");
+    }
+    if(possingle){
+      pd.Get_Pos(npok,auxf3);
+      #ifdef OMP_USE
+        #pragma omp parallel for schedule(static) if(omp && n>OMP_LIMIT_COMPUTELIGHT)
+      #endif
+      for(int p=0;p<n;p++)pos[p]=ToTDouble3(auxf3[p]);
+    }
+    else pd.Get_Posd(npok,pos);
+  #ifdef IDP_SIZE8
+    if(idpsimple){//-Idp of 32 bits is loaded in auxf (same size) and converted to 64 bits.
+      pd.Get_Idp(npok,(unsigned*)auxf);
+      const unsigned *auxu=(const unsigned*)auxf;
+      #ifdef OMP_USE
+        #pragma omp parallel for schedule(static) if(omp && n>OMP_LIMIT_COMPUTELIGHT)
+      #endif
+      for(int p=0;p<n;p++)idp[p]=auxu[p];
+    }
+    else pd.Get_Idpd(npok,idp);
+  #else
+    if(idpsimple)pd.Get_Idp(npok,idp);
+    else{//-Idp of 64 bits is valid when values fit in 32 bits.
+      pd.Get_Idpd(npok,auxull);
+      for(unsigned p=0;p<npok;p++){
+        if(idpmax<auxull[p])idpmax=auxull[p];
+        idp[p]=unsigned(auxull[p]);
+      }
+    }
+  #endif
+    pd.Get_Vel(npok,auxf3);  
+    pd.Get_Rhop(npok,auxf);  
+    #ifdef OMP_USE
+      #pragma omp parallel for schedule(static) if(omp && n>OMP_LIMIT_COMPUTELIGHT)
+    #endif
+    for(int p=0;p<n;p++)velrhop[p]=TFloat4(auxf3[p].x,auxf3[p].y,auxf3[p].z,auxf[p]);
+    delete[] auxf3; auxf3=NULL;
+    delete[] auxf;  auxf=NULL;
+    delete[] auxull; auxull=NULL;
+  }
+  if(idpmax>UINT_MAX)RunException(met,fun::PrintStr("Idp %llu is greater than the maximum value supported (32 bits).",idpmax));
+}
+
 //==============================================================================
 /// It loads particles of bi4 file and it orders them by Id.
 /// Carga particulas de fichero bi4 y las ordena por Id.
@@ -152,19 +323,20 @@ void JPartsLoad4::LoadParticles(const std::string &casedir,const std::string &ca
   Reset();
   PartBegin=partbegin;
   JPartDataBi4 pd;
+  pd.ConfigFileMap(true);
   //-Loads file piece_0 and obtains configuration.
   //-Carga fichero piece_0 y obtiene configuracion.
   const string dir=fun::GetDirWithSlash(!PartBegin? casedir: casedirbegin);
   if(!PartBegin){
     const string file1=dir+JPartDataBi4::GetFileNameCase(casename,0,1);
     if(fun::FileExists(file1))pd.LoadFileCase(dir,casename,0,1);
-    else if(fun::FileExists(dir+JPartDataBi4::GetFileNameCase(casename,0,2)))pd.LoadFileCase(dir,casename,0,2);
+    else if(fun::FileExists(dir+JPartDataBi4::GetFileNameCase(casename,0,2)))pd.LoadFileCase(dir,casename,0,pd.GetPiecesFileCase(dir,casename));
     else RunException(met,"File of the particles was not found.",file1);
   }
   else{
     const string file1=dir+JPartDataBi4::GetFileNamePart(PartBegin,0,1);
     if(fun::FileExists(file1))pd.LoadFilePart(dir,PartBegin,0,1);
-    else if(fun::FileExists(dir+JPartDataBi4::GetFileNamePart(PartBegin,0,2)))pd.LoadFilePart(dir,PartBegin,0,2);
+    else if(fun::FileExists(dir+JPartDataBi4::GetFileNamePart(PartBegin,0,2)))pd.LoadFilePart(dir,PartBegin,0,pd.GetPiecesFilePart(dir,PartBegin));
     else RunException(met,"File of the particles was not found.",file1);
   }
   //-Obtains configuration. | Obtiene configuracion.
@@ -188,57 +360,74 @@ void JPartsLoad4::LoadParticles(const std::string &casedir,const std::string &ca
   MapSize=(MapPosMin!=MapPosMax);
   CasePosMin=pd.Get_CasePosMin();
   CasePosMax=pd.Get_CasePosMax();
-  const bool possingle=pd.Get_PosSimple();
-  if(!pd.Get_IdpSimple())RunException(met,"Only Idp (32 bits) is valid at the moment.");
   //-Loads data for restarting.
   if(PartBegin){
+    if(pd.Get_Quantised())RunException(met,fun::PrintStr("Data of PART %u is quantised (lossy) and can not be used to restart the simulation.",PartBegin));
     SymplecticDtPre=pd.GetPart()->GetvDouble("SymplecticDtPre",true,0);
     DemDtForce=pd.GetPart()->GetvDouble("DemDtForce",true,0);
   }
-  //-Calculates number of particles. | Calcula numero de particulas.
-  unsigned sizetot=pd.Get_Npok();
-  for(unsigned piece=1;piece<Npiece;piece++){
-    JPartDataBi4 pd2;
-    if(!PartBegin)pd2.LoadFileCase(dir,casename,piece,Npiece);
-    else pd2.LoadFilePart(dir,PartBegin,piece,Npiece);
-    sizetot+=pd.Get_Npok();
+  //-Calculates number of particles of each piece and their position in the arrays.
+  //-Calcula numero de particulas de cada pieza y su posicion en los arrays.
+  std::vector<ullong> pieceini(Npiece+1,0);
+  pieceini[1]=pd.Get_Npok();
+  if(Npiece>1){
+    const int npie=int(Npiece);
+    std::vector<JException> error;
+    #ifdef OMP_USE
+      #pragma omp parallel for schedule(dynamic) if(UseOmp)
+    #endif
+    for(int piece=1;piece<npie;piece++){
+      try{
+        JPartDataBi4 pd2;
+        pieceini[piece+1]=(!PartBegin? pd2.GetNpokFileCase(dir,casename,piece,Npiece): pd2.GetNpokFilePart(dir,PartBegin,piece,Npiece));
+      }
+      catch(const JException &e){
+        #ifdef OMP_USE
+          #pragma omp critical 
+        #endif
+        {
+          if(error.empty())error.push_back(e);
+        }
+      }
+    }
+    if(!error.empty())throw error[0];
   }
+  for(unsigned piece=0;piece<Npiece;piece++)pieceini[piece+1]+=pieceini[piece];
+  if(pieceini[Npiece]>UINT_MAX)RunException(met,fun::PrintStr("Number of particles (%llu) is greater than the maximum value supported (32 bits).",pieceini[Npiece]));
+  const unsigned sizetot=unsigned(pieceini[Npiece]);
   //-Allocates memory.
   AllocMemory(sizetot);
-  //-Loads particles.
-  {
-    unsigned ntot=0;
-    unsigned auxsize=0;
-    tfloat3 *auxf3=NULL;
-    float *auxf=NULL;
-    for(unsigned piece=0;piece<Npiece;piece++){
-      if(piece){
-        if(!PartBegin)pd.LoadFileCase(dir,casename,piece,Npiece);
-        else pd.LoadFilePart(dir,PartBegin,piece,Npiece);
-      }
-      const unsigned npok=pd.Get_Npok();
-      if(npok){
-        if(auxsize<npok){
-          auxsize=npok;
-          delete[] auxf3; auxf3=NULL;
-          delete[] auxf;  auxf=NULL;
-          auxf3=new tfloat3[auxsize];
-          auxf=new float[auxsize];
+  //-Loads particles of the pieces in parallel, each one in its own range.
+  //-Carga particulas de las piezas en paralelo, cada una en su propio rango.
+  if(Npiece==1)LoadPiece(pd,0,UseOmp);
+  else{
+    const int npie=int(Npiece);
+    std::vector<JException> error;
+    #ifdef OMP_USE
+      #pragma omp parallel for schedule(dynamic) if(UseOmp)
+    #endif
+    for(int piece=0;piece<npie;piece++){
+      try{
+        if(!piece)LoadPiece(pd,0,false);
+        else{
+          JPartDataBi4 pd2;
+          pd2.ConfigFileMap(true);
+          if(!PartBegin)pd2.LoadFileCase(dir,casename,piece,Npiece);
+          else pd2.LoadFilePart(dir,PartBegin,piece,Npiece);
+          if(pd2.Get_Npok()!=unsigned(pieceini[piece+1]-pieceini[piece]))RunException(met,fun::PrintStr("Number of particles of piece %d is invalid.",piece));
+          LoadPiece(pd2,unsigned(pieceini[piece]),false);
         }
-        if(possingle){
-          pd.Get_Pos(npok,auxf3);
-          for(unsigned p=0;p<npok;p++)Pos[ntot+p]=ToTDouble3(auxf3[p]);
+      }
+      catch(const JException &e){
+        #ifdef OMP_USE
+          #pragma omp critical 
+        #endif
+        {
+          if(error.empty())error.push_back(e);
         }
-        else pd.Get_Posd(npok,Pos+ntot);
-        pd.Get_Idp(npok,Idp+ntot);  
-        pd.Get_Vel(npok,auxf3);  
-        pd.Get_Rhop(npok,auxf);  
-        for(unsigned p=0;p<npok;p++)VelRhop[ntot+p]=TFloat4(auxf3[p].x,auxf3[p].y,auxf3[p].z,auxf[p]);
       }
-      ntot+=npok;
     }
-    delete[] auxf3; auxf3=NULL;
-    delete[] auxf;  auxf=NULL;
+    if(!error.empty())throw error[0];
   }
   //-In simulations 2D, if PosY is invalid then calculates starting from position of particles.
   if(Simulate2DPosY==DBL_MAX){
@@ -284,12 +473,12 @@ void JPartsLoad4::RemoveBoundary(){
   for(;nbound<Count && Idp[nbound]<casenbound;nbound++);
   //-Saves old pointers and allocates new memory.
   unsigned count0=Count;
-  unsigned *idp0=Idp;        Idp=NULL;
+  typeidp *idp0=Idp;         Idp=NULL;
   tdouble3 *pos0=Pos;        Pos=NULL;
   tfloat4 *velrhop0=VelRhop; VelRhop=NULL;
   AllocMemory(count0-nbound);
   //-Copies data in new pointers.
-  memcpy(Idp,idp0+nbound,sizeof(unsigned)*Count);
+  memcpy(Idp,idp0+nbound,sizeof(typeidp)*Count);
   memcpy(Pos,pos0+nbound,sizeof(tdouble3)*Count);
   memcpy(VelRhop,velrhop0+nbound,sizeof(tfloat4)*Count);
   //-Frees old pointers.
@@ -316,14 +505,31 @@ void JPartsLoad4::CalculateCasePos(){
   tdouble3 pmin=TDouble3(DBL_MAX),pmax=TDouble3(-DBL_MAX);
   //-Calculates minimum and maximum position. 
   //-Calcula posicion minima y maxima. 
-  for(unsigned p=0;p<Count;p++){
-    const tdouble3 ps=Pos[p];
-    if(pmin.x>ps.x)pmin.x=ps.x;
-    if(pmin.y>ps.y)pmin.y=ps.y;
-    if(pmin.z>ps.z)pmin.z=ps.z;
-    if(pmax.x<ps.x)pmax.x=ps.x;
-    if(pmax.y<ps.y)pmax.y=ps.y;
-    if(pmax.z<ps.z)pmax.z=ps.z;
+  const int n=int(Count);
+  #ifdef OMP_USE
+    #pragma omp parallel if(UseOmp && n>OMP_LIMIT_COMPUTELIGHT)
+  #endif
+  {
+    tdouble3 pmin2=TDouble3(DBL_MAX),pmax2=TDouble3(-DBL_MAX);
+    #ifdef OMP_USE
+      #pragma omp for nowait
+    #endif
+    for(int p=0;p<n;p++){
+      const tdouble3 ps=Pos[p];
+      if(pmin2.x>ps.x)pmin2.x=ps.x;
+      if(pmin2.y>ps.y)pmin2.y=ps.y;
+      if(pmin2.z>ps.z)pmin2.z=ps.z;
+      if(pmax2.x<ps.x)pmax2.x=ps.x;
+      if(pmax2.y<ps.y)pmax2.y=ps.y;
+      if(pmax2.z<ps.z)pmax2.z=ps.z;
+    }
+    #ifdef OMP_USE
+      #pragma omp critical 
+    #endif
+    {
+      pmin=MinValues(pmin,pmin2);
+      pmax=MaxValues(pmax,pmax2);
+    }
   }
   CasePosMin=pmin; CasePosMax=pmax;
 }
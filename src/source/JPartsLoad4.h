@@ -33,6 +33,16 @@
 //:# - Documentacion del codigo en ingles. (08-08-2017)
 //:# - No reordena paraticulas para reducir diferencias usando restart. (23-04-2018)
 //:# - Improved definition of the periodic conditions. (27-04-2018)
+//:# - Carga Idp de 64 bits cuando sus valores caben en 32 bits. (18-10-2026)
+//:# - No permite restart desde datos cuantizados con perdidas. (18-10-2026)
+//:# - Carga ficheros proyectados en memoria y convierte los arrays sin copias
+//:#   intermedias. (18-10-2026)
+//:# - Carga las piezas en paralelo sobre rangos reservados de antemano y 
+//:#   conversion, comprobacion de orden y limites con OpenMP. (18-10-2026)
+//:# - Corregido el calculo del numero total de particulas con varias piezas
+//:#   (sumaba siempre el numero de la pieza 0) y la carga de la pieza 0 con
+//:#   un numero de piezas distinto de 2. (18-10-2026)
+//:# - Idp de tipo typeidp, de 64 bits cuando se compila con IDP_SIZE8. (18-10-2026)
 //:#############################################################################
 
 /// \file JPartsLoad4.h \brief Declares the class \ref JPartsLoad4.
@@ -40,11 +50,12 @@
 #ifndef _JPartsLoad4_
 #define _JPartsLoad4_
 
-#include "TypesDef.h"
-#include "JPeriodicDef.h"
+#include "Types.h"
 #include "JObject.h"
 #include <cstring>
 
+class JPartDataBi4;
+
 //##############################################################################
 //# JPartsLoad4
 //##############################################################################
@@ -86,11 +97,12 @@ protected:
 
   //-Variables for particles.
   unsigned Count;    //-Number of particles.
-  unsigned *Idp;
+  typeidp *Idp;
   tdouble3 *Pos;
   tfloat4 *VelRhop;
 
   void AllocMemory(unsigned count);
+  void LoadPiece(JPartDataBi4 &pd,unsigned pini,bool omp);
   template<typename T> T* SortParticles(const unsigned *vsort,unsigned count,T *v)const;
   void CheckSortParticles();
   void SortParticles();
@@ -117,7 +129,7 @@ public:
   double GetPartBeginTimeStep()const{ return(PartBeginTimeStep); }
   ullong GetPartBeginTotalNp()const{ return(PartBeginTotalNp); }
 
-  const unsigned* GetIdp(){ return(Idp); }
+  const typeidp* GetIdp(){ return(Idp); }
   const tdouble3* GetPos(){ return(Pos); }
   const tfloat4* GetVelRhop(){ return(VelRhop); }
 
@@ -88,7 +88,7 @@ llong JPartsOut::GetAllocMemory()const{
   llong s=0;
   //Reservada en AllocMemory()
   //Allocated in AllocMemory()
-  if(Idp)s+=sizeof(unsigned)*Size;
+  if(Idp)s+=sizeof(typeidp)*Size;
   if(Pos)s+=sizeof(tdouble3)*Size;
   if(Vel)s+=sizeof(tfloat3)*Size;
   if(Rhop)s+=sizeof(float)*Size;
@@ -99,11 +99,11 @@ llong JPartsOut::GetAllocMemory()const{
 //==============================================================================
 /// Resizes arrays for particles.
 //==============================================================================
-void JPartsOut::AddParticles(unsigned np,const unsigned* idp,const tdouble3* pos
+void JPartsOut::AddParticles(unsigned np,const typeidp* idp,const tdouble3* pos
   ,const tfloat3* vel,const float* rhop,const typecode* code)
 {
   if(Count+np>Size)AllocMemory(Count+np+SizeIni,false);
-  memcpy(Idp+Count,idp,sizeof(unsigned)*np);
+  memcpy(Idp+Count,idp,sizeof(typeidp)*np);
   memcpy(Pos+Count,pos,sizeof(tdouble3)*np);
   memcpy(Vel+Count,vel,sizeof(tfloat3)*np);
   memcpy(Rhop+Count,rhop,sizeof(float)*np);
@@ -51,7 +51,7 @@ protected:
   
   unsigned OutPosCount,OutRhopCount,OutMoveCount;
 
-  unsigned *Idp;
+  typeidp *Idp;
   tdouble3 *Pos;
   tfloat3 *Vel;
   float *Rhop;
@@ -64,7 +64,7 @@ public:
   ~JPartsOut();
   void Reset();
   llong GetAllocMemory()const;
-  void AddParticles(unsigned np,const unsigned* idp,const tdouble3* pos,const tfloat3* vel,const float* rhop,const typecode* code);
+  void AddParticles(unsigned np,const typeidp* idp,const tdouble3* pos,const tfloat3* vel,const float* rhop,const typecode* code);
 
   unsigned GetSize()const{ return(Size); }
   unsigned GetCount()const{ return(Count); }
@@ -73,7 +73,7 @@ public:
   unsigned GetOutRhopCount()const{ return(OutRhopCount); }
   unsigned GetOutMoveCount()const{ return(OutMoveCount); }
 
-  const unsigned* GetIdpOut(){ return(Idp); }
+  const typeidp* GetIdpOut(){ return(Idp); }
   const tdouble3* GetPosOut(){ return(Pos); }
   const tfloat3* GetVelOut(){ return(Vel); }
   const float* GetRhopOut(){ return(Rhop); }
@@ -23,7 +23,13 @@
 
 #include <cstring>
 #include <cstdlib>
+#include <cstdio>
+#include <cmath>
+#include <climits>
 #include <stdarg.h>
+#ifdef OMP_USE
+  #include <omp.h>
+#endif
 
 #pragma warning(disable : 4996) //Cancels sprintf() deprecated.
 
@@ -31,6 +37,402 @@ using namespace std;
 
 namespace jcsv{
 
+//##############################################################################
+//# FastFmt
+//##############################################################################
+static const ullong FastFmtPow10[20]={1ull,10ull,100ull,1000ull,10000ull,100000ull
+  ,1000000ull,10000000ull,100000000ull,1000000000ull,10000000000ull,100000000000ull
+  ,1000000000000ull,10000000000000ull,100000000000000ull,1000000000000000ull
+  ,10000000000000000ull,100000000000000000ull,1000000000000000000ull,10000000000000000000ull};
+
+//==============================================================================
+/// Computes the 128-bit product a*b.
+//==============================================================================
+static inline void FastFmtMul64(ullong a,ullong b,ullong &hi,ullong &lo){
+  const ullong a0=a&0xFFFFFFFFull,a1=a>>32;
+  const ullong b0=b&0xFFFFFFFFull,b1=b>>32;
+  const ullong p00=a0*b0,p01=a0*b1,p10=a1*b0,p11=a1*b1;
+  const ullong mid=(p00>>32)+(p01&0xFFFFFFFFull)+(p10&0xFFFFFFFFull);
+  lo=(mid<<32)|(p00&0xFFFFFFFFull);
+  hi=p11+(p01>>32)+(p10>>32)+(mid>>32);
+}
+
+//==============================================================================
+/// Computes qfloor=floor(m*2^e*10^k) and up=(remainder>0.5).
+/// Returns false when k is out of range, the result does not fit in 64 bits
+/// or the remainder is exactly 0.5 (tie resolved by snprintf()).
+//==============================================================================
+static bool FastFmtScale(ullong m,int e,int k,ullong &qfloor,bool &up){
+  if(k<0 || k>22)return(false);
+  //-Computes num=m*10^k in 128 bits (m<2^53 so num<2^127 when k<=22).
+  ullong hi,lo;
+  if(k<=19)FastFmtMul64(m,FastFmtPow10[k],hi,lo);
+  else{
+    ullong h2,l2;
+    FastFmtMul64(m,FastFmtPow10[19],hi,lo);
+    const ullong f=FastFmtPow10[k-19];
+    FastFmtMul64(lo,f,h2,l2);
+    hi=hi*f+h2; lo=l2;
+  }
+  up=false;
+  if(e>=0){
+    if(hi || e>=64 || (e && (lo>>(64-e))))return(false);
+    qfloor=(lo<<e);
+    return(true);
+  }
+  const int s=-e;
+  if(s>=128){ qfloor=0; return(true); } //-num<2^127 is less than half.
+  ullong qh,ql,rh,rl,hh,hl;
+  if(s<64){
+    ql=(lo>>s)|(hi<<(64-s)); qh=hi>>s;
+    rh=0; rl=lo&((1ull<<s)-1);
+    hh=0; hl=1ull<<(s-1);
+  }
+  else if(s==64){
+    ql=hi; qh=0;
+    rh=0; rl=lo;
+    hh=0; hl=1ull<<63;
+  }
+  else{
+    ql=hi>>(s-64); qh=0;
+    rh=hi&((1ull<<(s-64))-1); rl=lo;
+    hh=1ull<<(s-65); hl=0;
+  }
+  if(qh)return(false);
+  if(rh==hh && rl==hl)return(false);
+  up=(rh>hh || (rh==hh && rl>hl));
+  if(up && ql==ULLONG_MAX)return(false);
+  qfloor=ql;
+  return(true);
+}
+
+//==============================================================================
+/// Writes the decimal digits of v in buffer (without terminating null) and 
+/// returns the number of digits. The buffer must have space for 20 characters.
+//==============================================================================
+static inline unsigned FastFmtDigits(ullong v,char *buf){
+  char tmp[24];
+  unsigned n=0;
+  do{ tmp[n++]=char('0'+(v%10)); v/=10; }while(v);
+  for(unsigned c=0;c<n;c++)buf[c]=tmp[n-1-c];
+  return(n);
+}
+
+//==============================================================================
+/// Writes the exponent of e-style (e+XX) and returns the number of characters.
+//==============================================================================
+static inline unsigned FastFmtExponent(int x,char ce,char *buf){
+  unsigned n=0;
+  buf[n++]=ce;
+  buf[n++]=(x<0? '-': '+');
+  const unsigned ux=unsigned(x<0? -x: x);
+  if(ux<10)buf[n++]='0';
+  n+=FastFmtDigits(ux,buf+n);
+  return(n);
+}
+
+//==============================================================================
+/// Parses the conversion starting at spec ('%') and returns its number of 
+/// characters.
+//==============================================================================
+unsigned FastFmt::ParseSpec(const char *spec,StSpec &sp){
+  sp.spec=spec;
+  sp.conv=0; sp.left=sp.plus=sp.space=sp.zero=false;
+  sp.width=0; sp.prec=-1; sp.lmod=0; sp.fast=true;
+  const char *fm=spec+1;
+  //-Flags.
+  for(;*fm;fm++){
+    const char f=*fm;
+    if(f=='-')sp.left=true;
+    else if(f=='+')sp.plus=true;
+    else if(f==' ')sp.space=true;
+    else if(f=='0')sp.zero=true;
+    else if(f=='#')sp.fast=false;
+    else break;
+  }
+  //-Width.
+  if(*fm=='*'){ sp.fast=false; fm++; }
+  for(;*fm>='0' && *fm<='9';fm++)if(sp.width<100000)sp.width=sp.width*10+(*fm-'0');
+  //-Precision.
+  if(*fm=='.'){
+    fm++; sp.prec=0;
+    if(*fm=='*'){ sp.fast=false; fm++; }
+    for(;*fm>='0' && *fm<='9';fm++)if(sp.prec<100000)sp.prec=sp.prec*10+(*fm-'0');
+  }
+  //-Length modifier.
+  if(*fm=='h'){ sp.lmod=1; fm++; if(*fm=='h'){ sp.lmod=2; fm++; } }
+  else if(*fm=='l'){ sp.lmod=3; fm++; if(*fm=='l'){ sp.lmod=4; fm++; } }
+  else if(*fm=='L' || *fm=='j' || *fm=='z' || *fm=='t' || *fm=='q'){ sp.lmod=5; fm++; }
+  //-Conversion.
+  if(*fm){ sp.conv=*fm; fm++; }
+  sp.nspec=unsigned(fm-spec);
+  const char cv=sp.conv;
+  const bool cvint=(cv=='d' || cv=='i' || cv=='u');
+  const bool cvdbl=(cv=='f' || cv=='F' || cv=='e' || cv=='E' || cv=='g' || cv=='G');
+  if(!(cvint || cvdbl) || sp.lmod==5 || (cvint && sp.prec>=0) || (cvdbl && sp.lmod!=0 && sp.lmod!=3))sp.fast=false;
+  if(sp.width>=100000 || sp.prec>=100000)sp.fast=false;
+  return(sp.nspec);
+}
+
+//==============================================================================
+/// Returns the number of values used by format.
+//==============================================================================
+unsigned FastFmt::CountValues(const char *format){
+  unsigned n=0;
+  for(const char *fm=format;*fm;){
+    if(*fm!='%')fm++;
+    else if(fm[1]=='%')fm+=2;
+    else{
+      StSpec sp;
+      fm+=ParseSpec(fm,sp);
+      n++;
+    }
+  }
+  return(n);
+}
+
+//==============================================================================
+/// Adds formatted value using snprintf().
+//==============================================================================
+void FastFmt::AppendPrintf(std::string &out,const StSpec &sp,const StValue &v){
+  const char cv=sp.conv;
+  char specbuf[64];
+  std::string specstr;
+  const char *spec=specbuf;
+  if(sp.nspec<sizeof(specbuf)){ memcpy(specbuf,sp.spec,sp.nspec); specbuf[sp.nspec]='\0'; }
+  else{ specstr.assign(sp.spec,sp.nspec); spec=specstr.c_str(); }
+  const unsigned SIZE=256;
+  char buffer[SIZE];
+  std::vector<char> buffer2;
+  for(int cr=0;cr<2;cr++){
+    char *buf=(cr? &buffer2[0]: buffer);
+    const size_t sbuf=(cr? buffer2.size(): SIZE);
+    int n=-1;
+    if(cv=='f' || cv=='F' || cv=='e' || cv=='E' || cv=='g' || cv=='G' || cv=='a' || cv=='A'){
+      const double vd=(v.isint? (v.issigned? double(v.vi): double(v.vu)): v.vd);
+      if(sp.lmod==5 && sp.spec[sp.nspec-2]=='L')n=snprintf(buf,sbuf,spec,(long double)vd);
+      else n=snprintf(buf,sbuf,spec,vd);
+    }
+    else if(cv=='d' || cv=='i' || cv=='u' || cv=='o' || cv=='x' || cv=='X' || cv=='c'){
+      const llong vi=(v.isint? v.vi: llong(v.vd));
+      if(sp.lmod==4 || sp.lmod==5)n=snprintf(buf,sbuf,spec,vi);
+      else if(sp.lmod==3)n=snprintf(buf,sbuf,spec,long(vi));
+      else n=snprintf(buf,sbuf,spec,int(vi));
+    }
+    else{ //-Conversion without numeric value is written as text.
+      out.append(sp.spec,sp.nspec);
+      return;
+    }
+    if(n<0)throw "Error in FastFmt::AppendPrintf(): Invalid format.";
+    if(size_t(n)<sbuf){ out.append(buf,size_t(n)); return; }
+    buffer2.resize(size_t(n)+1);
+  }
+}
+
+//==============================================================================
+/// Adds body of number with sign and padding according to flags and width.
+//==============================================================================
+void FastFmt::AppendPadded(std::string &out,const StSpec &sp,bool neg,const char *body,unsigned nbody){
+  const char sign=(neg? '-': (sp.plus? '+': (sp.space? ' ': 0)));
+  const unsigned len=nbody+(sign? 1: 0);
+  const unsigned pad=(unsigned(sp.width)>len? unsigned(sp.width)-len: 0);
+  if(sp.left){
+    if(sign)out.push_back(sign);
+    out.append(body,nbody);
+    if(pad)out.append(pad,' ');
+  }
+  else if(sp.zero){
+    if(sign)out.push_back(sign);
+    if(pad)out.append(pad,'0');
+    out.append(body,nbody);
+  }
+  else{
+    if(pad)out.append(pad,' ');
+    if(sign)out.push_back(sign);
+    out.append(body,nbody);
+  }
+}
+
+//==============================================================================
+/// Adds integer value (d,i,u). Returns false when it is not supported.
+//==============================================================================
+bool FastFmt::AppendInt(std::string &out,const StSpec &sp,const StValue &v){
+  const llong vi=(v.isint? v.vi: llong(v.vd));
+  bool neg=false;
+  ullong u=0;
+  if(sp.conv=='u'){
+    switch(sp.lmod){
+      case 0: u=unsigned(vi);        break;
+      case 1: u=(unsigned short)vi;  break;
+      case 2: u=(unsigned char)vi;   break;
+      case 3: u=(unsigned long)vi;   break;
+      case 4: u=ullong(vi);          break;
+      default: return(false);
+    }
+  }
+  else{
+    llong s=0;
+    switch(sp.lmod){
+      case 0: s=int(vi);          break;
+      case 1: s=short(vi);        break;
+      case 2: s=(signed char)vi;  break;
+      case 3: s=long(vi);         break;
+      case 4: s=vi;               break;
+      default: return(false);
+    }
+    neg=(s<0);
+    u=(neg? ullong(0)-ullong(s): ullong(s));
+  }
+  char body[24];
+  const unsigned n=FastFmtDigits(u,body);
+  AppendPadded(out,sp,neg,body,n);
+  return(true);
+}
+
+//==============================================================================
+/// Adds floating point value (f,F,e,E,g,G). Returns false when it is not 
+/// supported and snprintf() must be used.
+//==============================================================================
+bool FastFmt::AppendDbl(std::string &out,const StSpec &sp,double v){
+  //-Splits value in m*2^e.
+  ullong bits;
+  memcpy(&bits,&v,sizeof(double));
+  const bool neg=((bits>>63)!=0);
+  const int bexp=int((bits>>52)&0x7FF);
+  ullong m=(bits&0xFFFFFFFFFFFFFull);
+  if(bexp==0x7FF)return(false); //-Inf or NaN.
+  const bool zero=(bexp==0 && m==0);
+  int e;
+  if(bexp)e=bexp-1075,m|=(1ull<<52);
+  else e=-1074;
+  const char cv=sp.conv;
+  const int prec=(sp.prec<0? 6: sp.prec);
+  char body[64];
+  unsigned nb=0;
+  if(cv=='f' || cv=='F'){
+    if(prec>22)return(false);
+    ullong q=0;
+    if(!zero){
+      bool up;
+      if(!FastFmtScale(m,e,prec,q,up))return(false);
+      if(up)q++;
+    }
+    char dg[24];
+    unsigned nd=FastFmtDigits(q,dg);
+    if(nd<=unsigned(prec)){ //-Adds leading zeros.
+      const unsigned nz=unsigned(prec)+1-nd;
+      memmove(dg+nz,dg,nd);
+      memset(dg,'0',nz);
+      nd+=nz;
+    }
+    const unsigned nint=nd-unsigned(prec);
+    memcpy(body,dg,nint); nb=nint;
+    if(prec){
+      body[nb++]='.';
+      memcpy(body+nb,dg+nint,unsigned(prec)); nb+=unsigned(prec);
+    }
+  }
+  else{
+    const bool gstyle=(cv=='g' || cv=='G');
+    const int ndig=(gstyle? (prec? prec: 1): prec+1); //-Significant digits.
+    if(ndig>18)return(false);
+    //-Computes ndig significant digits (q) and decimal exponent (x).
+    ullong q=0;
+    int x=0;
+    if(!zero){
+      x=int(floor(log10(fabs(v))));
+      bool ok=false,up=false;
+      ullong qf=0;
+      for(int cr=0;cr<4 && !ok;cr++){
+        if(!FastFmtScale(m,e,ndig-1-x,qf,up))return(false);
+        if(qf>=FastFmtPow10[ndig])x++;
+        else if(qf<FastFmtPow10[ndig-1])x--;
+        else ok=true;
+      }
+      if(!ok)return(false);
+      q=qf+(up? 1: 0);
+      if(q==FastFmtPow10[ndig]){ q=FastFmtPow10[ndig-1]; x++; }
+    }
+    char dg[24];
+    if(zero)memset(dg,'0',unsigned(ndig));
+    else FastFmtDigits(q,dg);
+    const char ce=(cv=='e' || cv=='g'? 'e': 'E');
+    if(!gstyle){
+      body[nb++]=dg[0];
+      if(ndig>1){
+        body[nb++]='.';
+        memcpy(body+nb,dg+1,unsigned(ndig-1)); nb+=unsigned(ndig-1);
+      }
+      nb+=FastFmtExponent(x,ce,body+nb);
+    }
+    else{
+      //-Removes trailing zeros.
+      int nsig=ndig;
+      while(nsig>1 && dg[nsig-1]=='0')nsig--;
+      if(x<-4 || x>=ndig){
+        body[nb++]=dg[0];
+        if(nsig>1){
+          body[nb++]='.';
+          memcpy(body+nb,dg+1,unsigned(nsig-1)); nb+=unsigned(nsig-1);
+        }
+        nb+=FastFmtExponent(x,ce,body+nb);
+      }
+      else if(x>=0){
+        memcpy(body,dg,unsigned(x+1)); nb=unsigned(x+1);
+        if(nsig>x+1){
+          body[nb++]='.';
+          memcpy(body+nb,dg+x+1,unsigned(nsig-x-1)); nb+=unsigned(nsig-x-1);
+        }
+      }
+      else{
+        body[nb++]='0';
+        body[nb++]='.';
+        for(int c=0;c<-x-1;c++)body[nb++]='0';
+        memcpy(body+nb,dg,unsigned(nsig)); nb+=unsigned(nsig);
+      }
+    }
+  }
+  AppendPadded(out,sp,neg,body,nb);
+  return(true);
+}
+
+//==============================================================================
+/// Adds formatted value according to conversion.
+//==============================================================================
+void FastFmt::AppendValue(std::string &out,const StSpec &sp,const StValue &v){
+  bool ok=false;
+  if(sp.fast){
+    const char cv=sp.conv;
+    if(cv=='d' || cv=='i' || cv=='u')ok=AppendInt(out,sp,v);
+    else ok=AppendDbl(out,sp,(v.isint? (v.issigned? double(v.vi): double(v.vu)): v.vd));
+  }
+  if(!ok)AppendPrintf(out,sp,v);
+}
+
+//==============================================================================
+/// Adds text formatted with nv values. Missing values are formatted as zero.
+//==============================================================================
+void FastFmt::Append(std::string &out,const char *format,unsigned nv,const StValue *v){
+  unsigned cv=0;
+  const char *fm=format;
+  while(*fm){
+    const char *fm2=fm;
+    while(*fm2 && *fm2!='%')fm2++;
+    if(fm2!=fm)out.append(fm,size_t(fm2-fm));
+    fm=fm2;
+    if(*fm=='%'){
+      if(fm[1]=='%'){ out.push_back('%'); fm+=2; }
+      else{
+        StSpec sp;
+        fm+=ParseSpec(fm,sp);
+        AppendValue(out,sp,(cv<nv? v[cv]: Value(0)));
+        cv++;
+      }
+    }
+  }
+}
+
+
 //##############################################################################
 //# JSaveCsv2
 //##############################################################################
@@ -119,34 +521,42 @@ void JSaveCsv2::InitFmt(){
 /// Adds string to data or head.
 //==============================================================================
 void JSaveCsv2::AddStr(std::string tx){
-  if(AutoSepEnable)SetSeparators(tx);
+  std::string &dst=(DataSelected? Data: Head);
   const bool jump=(!tx.empty() && tx[0]=='\n');
-  if(DataSelected){
-    if(!(Data.empty() || Data[Data.size()-1]=='\n' || jump))Data.append(";");
-    Data.append(tx);
-    //printf("Data:[%s]\n",Data.c_str());
-  }
-  else{
-    if(!(Head.empty() || Head[Head.size()-1]=='\n' || jump))Head.append(";");
-    Head.append(tx);
-    //printf("Head:[%s]\n",Head.c_str());
-  }
+  if(!(dst.empty() || dst[dst.size()-1]=='\n' || jump))dst.append(";");
+  const size_t pini=dst.size();
+  dst.append(tx);
+  if(AutoSepEnable)SetSeparators(dst,pini);
+}
+
+//==============================================================================
+/// Adds values formatted directly in data or head according to current format 
+/// of tfmt, with the same result of AddStr(ToStr(...)).
+//==============================================================================
+void JSaveCsv2::AddValues(TpFormat tfmt,unsigned nv,const FastFmt::StValue *v){
+  std::string &dst=(DataSelected? Data: Head);
+  const bool lineini=(dst.empty() || dst[dst.size()-1]=='\n');
+  const size_t pini=dst.size();
+  FastFmt::Append(dst,FmtCurrent[tfmt].c_str(),nv,v);
+  if(AutoSepEnable)SetSeparators(dst,pini);
+  const bool jump=(dst.size()>pini && dst[pini]=='\n');
+  if(!(lineini || jump))dst.insert(pini,1,';');
 }
  
 //==============================================================================
 /// Adds one or several field separators.
 //==============================================================================
 void JSaveCsv2::AddSeparator(unsigned count){
-  if(DataSelected)for(unsigned c=0;c<count;c++)Data=Data+";";
-  else for(unsigned c=0;c<count;c++)Head=Head+";";
+  if(DataSelected)Data.append(count,';');
+  else Head.append(count,';');
 }
  
 //==============================================================================
 /// Adds end of line.
 //==============================================================================
 void JSaveCsv2::AddEndl(){
-  if(DataSelected)Data=Data+"\n";
-  else Head=Head+"\n";
+  if(DataSelected)Data.push_back('\n');
+  else Head.push_back('\n');
 }
   
 //==============================================================================
@@ -230,11 +640,11 @@ void JSaveCsv2::Save(const std::string &tx){
 /// Sets separators according configuration.
 /// Cambia separadores segun configuracion.
 //==============================================================================
-void JSaveCsv2::SetSeparators(std::string &tx)const{
+void JSaveCsv2::SetSeparators(std::string &tx,size_t pini)const{
   const char sep0=(CsvSepComa? ';': ',');
   const char sep1=(CsvSepComa? ',': ';');
-  const unsigned size=unsigned(tx.size());
-  for(unsigned c=0;c<size;c++)if(tx[c]==sep0)tx[c]=sep1;
+  const size_t size=tx.size();
+  for(size_t c=pini;c<size;c++)if(tx[c]==sep0)tx[c]=sep1;
 }
 
 //==============================================================================
@@ -256,5 +666,88 @@ void JSaveCsv2::SaveData(bool closefile){
   }
 }
 
+//==============================================================================
+/// Returns component cv of particle p as value to format.
+//==============================================================================
+static inline FastFmt::StValue SaveParticlesValue(const JFormatFiles2::StScalarData &fd,unsigned p,unsigned cv){
+  const unsigned c=p*fd.comp+cv;
+  switch(fd.type){
+    case JFormatFiles2::UChar8:   return(FastFmt::Value(unsigned(((const byte*)fd.pointer)[c])));
+    case JFormatFiles2::Char8:    return(FastFmt::Value(int(((const char*)fd.pointer)[c])));
+    case JFormatFiles2::UShort16: return(FastFmt::Value(unsigned(((const word*)fd.pointer)[c])));
+    case JFormatFiles2::Short16:  return(FastFmt::Value(int(((const short*)fd.pointer)[c])));
+    case JFormatFiles2::UInt32:   return(FastFmt::Value(((const unsigned*)fd.pointer)[c]));
+    case JFormatFiles2::Int32:    return(FastFmt::Value(((const int*)fd.pointer)[c]));
+    case JFormatFiles2::Float32:  return(FastFmt::Value(double(((const float*)fd.pointer)[c])));
+    case JFormatFiles2::Double64: return(FastFmt::Value(((const double*)fd.pointer)[c]));
+    case JFormatFiles2::ULlong64: return(FastFmt::Value(((const ullong*)fd.pointer)[c]));
+    case JFormatFiles2::Llong64:  return(FastFmt::Value(((const llong*)fd.pointer)[c]));
+    default: break;
+  }
+  return(FastFmt::Value(0));
+}
+
+//==============================================================================
+/// Writes particle data with the same output of JFormatFiles2::SaveCsv().
+/// Rows are formatted in parallel by blocks and written in order.
+/// Graba datos de particulas con el mismo resultado que JFormatFiles2::SaveCsv().
+/// Las filas se formatean en paralelo por bloques y se graban en orden.
+//==============================================================================
+void JSaveCsv2::SaveParticles(unsigned np,const tfloat3 *pos,unsigned nfields
+  ,const JFormatFiles2::StScalarData *fields)
+{
+  const char met[]="SaveParticles";
+  JFormatFiles2::CheckFields(nfields,fields);
+  SaveData();
+  const char sep=(CsvSepComa? ',': ';');
+  //-Precompiles formats and writes head.
+  const char *cpname[4]={".x",".y",".z",".w"};
+  const char fmtpos[]="%15.7E";
+  std::string head=std::string("Pos.x [m]")+sep+"Pos.y [m]"+sep+"Pos.z [m]"+sep;
+  for(unsigned cf=0;cf<nfields;cf++){
+    const JFormatFiles2::StScalarData &fd=fields[cf];
+    if(fd.comp<1 || fd.comp>4)RunException(met,fun::PrintStr("Number of components of field \'%s\' is invalid.",fd.name.c_str()),FileName);
+    if(fd.comp==1)head=head+fd.name+fd.units+sep;
+    else for(unsigned cv=0;cv<fd.comp;cv++)head=head+fd.name+cpname[cv]+fd.units+sep;
+    if(FastFmt::CountValues(fd.fmt.c_str())!=1)RunException(met,fun::PrintStr("Output format of field \'%s\' is invalid.",fd.name.c_str()),FileName);
+  }
+  head.push_back('\n');
+  Save(head);
+  //-Formats and writes rows by blocks.
+  const unsigned BLOCKROWS=4096;
+  const int nblocks=int((np+BLOCKROWS-1)/BLOCKROWS);
+  const int nbatch=64;
+  std::vector<std::string> txblock(nbatch);
+  for(int cb0=0;cb0<nblocks;cb0+=nbatch){
+    const int nb=min(nbatch,nblocks-cb0);
+    #ifdef OMP_USE
+      #pragma omp parallel for schedule (dynamic)
+    #endif
+    for(int cb=0;cb<nb;cb++){
+      std::string &tx=txblock[cb];
+      tx.clear();
+      const unsigned pini=unsigned(cb0+cb)*BLOCKROWS;
+      const unsigned pfin=min(np,pini+BLOCKROWS);
+      for(unsigned p=pini;p<pfin;p++){
+        const FastFmt::StValue vpos[3]={FastFmt::Value(double(pos[p].x)),FastFmt::Value(double(pos[p].y)),FastFmt::Value(double(pos[p].z))};
+        for(unsigned cv=0;cv<3;cv++){ FastFmt::Append(tx,fmtpos,1,vpos+cv); tx.push_back(sep); }
+        for(unsigned cf=0;cf<nfields;cf++){
+          const JFormatFiles2::StScalarData &fd=fields[cf];
+          for(unsigned cv=0;cv<fd.comp;cv++){
+            const FastFmt::StValue v=SaveParticlesValue(fd,p,cv);
+            FastFmt::Append(tx,fd.fmt.c_str(),1,&v);
+            tx.push_back(sep);
+          }
+        }
+        tx.push_back('\n');
+      }
+    }
+    for(int cb=0;cb<nb;cb++)Pf->write(txblock[cb].c_str(),txblock[cb].size());
+    if(Pf->fail())RunException(met,"File writing failure.",FileName);
+  }
+  Pf->flush();
+  if(Pf->fail())RunException(met,"File writing failure.",FileName);
+}
+
 }
 
@@ -31,6 +31,9 @@
 //:# - Control de excepciones en el destructor. (21-03-2018)
 //:# - Nuevo metodo GetAppendMode() para saber si se va ampliar un fichero existente. (06-07-2018)
 //:# - Error corregido en SaveData() por el que siempre se grababa el head. (13-08-2018)
+//:# - Formateo de valores con FastFmt sin vsnprintf() y con el mismo resultado. (18-10-2026)
+//:# - Se mantiene la disposicion de la clase usada por librerias precompiladas. (18-10-2026)
+//:# - Nuevo metodo SaveParticles() que formatea los datos en paralelo. (18-10-2026)
 //:#############################################################################
 
 /// \file JSaveCsv2.h \brief Declares the class \ref JSaveCsv2.
@@ -40,6 +43,7 @@
 
 #include "TypesDef.h"
 #include "JObject.h"
+#include "JFormatFiles2.h"
 
 #include <string>
 #include <fstream>
@@ -129,6 +133,58 @@ public:
 };
 
 
+//##############################################################################
+//# FastFmt
+//##############################################################################
+/// \brief Formats values like snprintf() without calling it in most cases.
+/// Conversions d,i,u,f,F,e,E,g,G with flags (-+ 0), width and precision are 
+/// formatted directly with exact rounding. Other conversions, exact ties and 
+/// values out of range use snprintf(), so the output is always identical.
+
+class FastFmt
+{
+public:
+  /// Value to format.
+  typedef struct{
+    bool isint;          ///<Integer value.
+    bool issigned;       ///<Signed integer value.
+    llong vi;            ///<Value as signed integer.
+    ullong vu;           ///<Value as unsigned integer.
+    double vd;           ///<Value as floating point.
+  }StValue;
+
+  /// Conversion of format.
+  typedef struct{
+    const char *spec;    ///<Text of the conversion for snprintf() (e.g. "%15.7E").
+    unsigned nspec;      ///<Number of characters of spec.
+    char conv;           ///<Conversion character.
+    bool left,plus,space,zero; ///<Flags of conversion.
+    int width;           ///<Minimum width (0:none).
+    int prec;            ///<Precision (-1:none).
+    int lmod;            ///<Length modifier (0:none, 1:h, 2:hh, 3:l, 4:ll, 5:other).
+    bool fast;           ///<Conversion is formatted without snprintf().
+  }StSpec;
+
+private:
+  static unsigned ParseSpec(const char *spec,StSpec &sp);
+  static void AppendPrintf(std::string &out,const StSpec &sp,const StValue &v);
+  static void AppendPadded(std::string &out,const StSpec &sp,bool neg,const char *body,unsigned nbody);
+  static bool AppendInt(std::string &out,const StSpec &sp,const StValue &v);
+  static bool AppendDbl(std::string &out,const StSpec &sp,double v);
+
+public:
+  static StValue Value(double v){   StValue r={false,false,0,0,v}; return(r); }
+  static StValue Value(llong v){    StValue r={true,true,v,ullong(v),double(v)}; return(r); }
+  static StValue Value(ullong v){   StValue r={true,false,llong(v),v,double(v)}; return(r); }
+  static StValue Value(int v){      return(Value(llong(v))); }
+  static StValue Value(unsigned v){ return(Value(ullong(v))); }
+
+  static unsigned CountValues(const char *format);
+  static void Append(std::string &out,const char *format,unsigned nv,const StValue *v);
+  static void AppendValue(std::string &out,const StSpec &sp,const StValue &v);
+};
+
+
 //##############################################################################
 //# JSaveCsv2
 //##############################################################################
@@ -160,10 +216,15 @@ private:
 
   void InitFmt();
   void AddStr(std::string tx);
+  void AddValues(TpFormat tfmt,unsigned nv,const FastFmt::StValue *v);
+  template<class T> void AddValue(TpFormat tfmt,T v){ const FastFmt::StValue vv=FastFmt::Value(v); AddValues(tfmt,1,&vv); }
+  template<class T> void AddValue2(TpFormat tfmt,T x,T y){ const FastFmt::StValue vv[2]={FastFmt::Value(x),FastFmt::Value(y)}; AddValues(tfmt,2,vv); }
+  template<class T> void AddValue3(TpFormat tfmt,T x,T y,T z){ const FastFmt::StValue vv[3]={FastFmt::Value(x),FastFmt::Value(y),FastFmt::Value(z)}; AddValues(tfmt,3,vv); }
+  template<class T> void AddValue4(TpFormat tfmt,T x,T y,T z,T w){ const FastFmt::StValue vv[4]={FastFmt::Value(x),FastFmt::Value(y),FastFmt::Value(z),FastFmt::Value(w)}; AddValues(tfmt,4,vv); }
   void AddSeparator(unsigned count);
   void AddEndl();
   void Save(const std::string &tx);
-  void SetSeparators(std::string &tx)const;
+  void SetSeparators(std::string &tx,size_t pini=0)const;
   void OpenFile();
   void RunException(const std::string &method,const std::string &msg){
     ExceptionThrown=true; JObject::RunException(method,msg);
@@ -197,36 +258,38 @@ public:
 
   JSaveCsv2& operator <<(const std::string &v){ AddStr(v); return(*this); }
 
-  JSaveCsv2& operator <<(char     v){ AddStr(ToStr(FmtCurrent[TpSigned1  ].c_str(),v)); return(*this); }
-  JSaveCsv2& operator <<(short    v){ AddStr(ToStr(FmtCurrent[TpSigned1  ].c_str(),v)); return(*this); }
-  JSaveCsv2& operator <<(int      v){ AddStr(ToStr(FmtCurrent[TpSigned1  ].c_str(),v)); return(*this); }
-  JSaveCsv2& operator <<(byte     v){ AddStr(ToStr(FmtCurrent[TpUnsigned1].c_str(),v)); return(*this); }
-  JSaveCsv2& operator <<(word     v){ AddStr(ToStr(FmtCurrent[TpUnsigned1].c_str(),v)); return(*this); }
-  JSaveCsv2& operator <<(unsigned v){ AddStr(ToStr(FmtCurrent[TpUnsigned1].c_str(),v)); return(*this); }
+  JSaveCsv2& operator <<(char     v){ AddValue(TpSigned1  ,int(v));      return(*this); }
+  JSaveCsv2& operator <<(short    v){ AddValue(TpSigned1  ,int(v));      return(*this); }
+  JSaveCsv2& operator <<(int      v){ AddValue(TpSigned1  ,v);           return(*this); }
+  JSaveCsv2& operator <<(byte     v){ AddValue(TpUnsigned1,unsigned(v)); return(*this); }
+  JSaveCsv2& operator <<(word     v){ AddValue(TpUnsigned1,unsigned(v)); return(*this); }
+  JSaveCsv2& operator <<(unsigned v){ AddValue(TpUnsigned1,v);           return(*this); }
 
-  JSaveCsv2& operator <<(llong    v){ AddStr(ToStr(FmtCurrent[TpLlong1   ].c_str(),v)); return(*this); }
-  JSaveCsv2& operator <<(ullong   v){ AddStr(ToStr(FmtCurrent[TpUllong1  ].c_str(),v)); return(*this); }
+  JSaveCsv2& operator <<(llong    v){ AddValue(TpLlong1   ,v);           return(*this); }
+  JSaveCsv2& operator <<(ullong   v){ AddValue(TpUllong1  ,v);           return(*this); }
 
-  JSaveCsv2& operator <<(float    v){ AddStr(ToStr(FmtCurrent[TpFloat1   ].c_str(),v)); return(*this); }
-  JSaveCsv2& operator <<(double   v){ AddStr(ToStr(FmtCurrent[TpDouble1  ].c_str(),v)); return(*this); }
+  JSaveCsv2& operator <<(float    v){ AddValue(TpFloat1   ,double(v));   return(*this); }
+  JSaveCsv2& operator <<(double   v){ AddValue(TpDouble1  ,v);           return(*this); }
 
-  JSaveCsv2& operator <<(const tint2   &v){ AddStr(ToStr(FmtCurrent[TpSigned2  ].c_str(),v.x,v.y));         return(*this); }
-  JSaveCsv2& operator <<(const tint3   &v){ AddStr(ToStr(FmtCurrent[TpSigned3  ].c_str(),v.x,v.y,v.z));     return(*this); }
-  JSaveCsv2& operator <<(const tint4   &v){ AddStr(ToStr(FmtCurrent[TpSigned4  ].c_str(),v.x,v.y,v.z,v.w)); return(*this); }
+  JSaveCsv2& operator <<(const tint2   &v){ AddValue2(TpSigned2  ,v.x,v.y);         return(*this); }
+  JSaveCsv2& operator <<(const tint3   &v){ AddValue3(TpSigned3  ,v.x,v.y,v.z);     return(*this); }
+  JSaveCsv2& operator <<(const tint4   &v){ AddValue4(TpSigned4  ,v.x,v.y,v.z,v.w); return(*this); }
 
-  JSaveCsv2& operator <<(const tuint2  &v){ AddStr(ToStr(FmtCurrent[TpUnsigned2].c_str(),v.x,v.y));         return(*this); }
-  JSaveCsv2& operator <<(const tuint3  &v){ AddStr(ToStr(FmtCurrent[TpUnsigned3].c_str(),v.x,v.y,v.z));     return(*this); }
-  JSaveCsv2& operator <<(const tuint4  &v){ AddStr(ToStr(FmtCurrent[TpUnsigned4].c_str(),v.x,v.y,v.z,v.w)); return(*this); }
+  JSaveCsv2& operator <<(const tuint2  &v){ AddValue2(TpUnsigned2,v.x,v.y);         return(*this); }
+  JSaveCsv2& operator <<(const tuint3  &v){ AddValue3(TpUnsigned3,v.x,v.y,v.z);     return(*this); }
+  JSaveCsv2& operator <<(const tuint4  &v){ AddValue4(TpUnsigned4,v.x,v.y,v.z,v.w); return(*this); }
 
-  JSaveCsv2& operator <<(const tfloat2  &v){ AddStr(ToStr(FmtCurrent[TpFloat2  ].c_str(),v.x,v.y));         return(*this); }
-  JSaveCsv2& operator <<(const tfloat3  &v){ AddStr(ToStr(FmtCurrent[TpFloat3  ].c_str(),v.x,v.y,v.z));     return(*this); }
-  JSaveCsv2& operator <<(const tfloat4  &v){ AddStr(ToStr(FmtCurrent[TpFloat4  ].c_str(),v.x,v.y,v.z,v.w)); return(*this); }
+  JSaveCsv2& operator <<(const tfloat2  &v){ AddValue2(TpFloat2  ,double(v.x),double(v.y));                         return(*this); }
+  JSaveCsv2& operator <<(const tfloat3  &v){ AddValue3(TpFloat3  ,double(v.x),double(v.y),double(v.z));             return(*this); }
+  JSaveCsv2& operator <<(const tfloat4  &v){ AddValue4(TpFloat4  ,double(v.x),double(v.y),double(v.z),double(v.w)); return(*this); }
 
-  JSaveCsv2& operator <<(const tdouble2 &v){ AddStr(ToStr(FmtCurrent[TpDouble2 ].c_str(),v.x,v.y));         return(*this); }
-  JSaveCsv2& operator <<(const tdouble3 &v){ AddStr(ToStr(FmtCurrent[TpDouble3 ].c_str(),v.x,v.y,v.z));     return(*this); }
-  JSaveCsv2& operator <<(const tdouble4 &v){ AddStr(ToStr(FmtCurrent[TpDouble4 ].c_str(),v.x,v.y,v.z,v.w)); return(*this); }
+  JSaveCsv2& operator <<(const tdouble2 &v){ AddValue2(TpDouble2 ,v.x,v.y);         return(*this); }
+  JSaveCsv2& operator <<(const tdouble3 &v){ AddValue3(TpDouble3 ,v.x,v.y,v.z);     return(*this); }
+  JSaveCsv2& operator <<(const tdouble4 &v){ AddValue4(TpDouble4 ,v.x,v.y,v.z,v.w); return(*this); }
 
   void SaveData(bool closefile=false);
+
+  void SaveParticles(unsigned np,const tfloat3 *pos,unsigned nfields,const JFormatFiles2::StScalarData *fields);
 };
 
 }
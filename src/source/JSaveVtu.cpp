@@ -0,0 +1,531 @@
+//HEAD_DSCODES
+/*
+ <DUALSPHYSICS>  Copyright (c) 2019 by Dr Jose M. Dominguez et al. (see http://dual.sphysics.org/index.php/developers/). 
+
+ EPHYSLAB Environmental Physics Laboratory, Universidade de Vigo, Ourense, Spain.
+ School of Mechanical, Aerospace and Civil Engineering, University of Manchester, Manchester, U.K.
+
+ This file is part of DualSPHysics. 
+
+ DualSPHysics is free software: you can redistribute it and/or modify it under the terms of the GNU Lesser General Public License 
+ as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) any later version.
+ 
+ DualSPHysics is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details. 
+
+ You should have received a copy of the GNU Lesser General Public License along with DualSPHysics. If not, see <http://www.gnu.org/licenses/>. 
+*/
+
+/// \file JSaveVtu.cpp \brief Implements the class \ref JSaveVtu.
+
+#include "JSaveVtu.h"
+#include "JDataCompress.h"
+#include "Functions.h"
+#include "OmpDefs.h"
+#include <cstring>
+#include <cstdlib>
+#include <climits>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+
+using namespace std;
+
+//-Characters of base64 encoding.
+static const char B64_CHARS[]="ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+static const unsigned B64_CHUNK=3*65536;  ///<Size of data encoded by each OpenMP iteration (multiple of 3).
+
+//==============================================================================
+/// Returns value c of header with integers of hsize bytes (4 or 8).
+//==============================================================================
+inline ullong VtuGetHead(const void *buf,unsigned hsize,ullong c){
+  if(hsize==8){ ullong v; memcpy(&v,(const byte*)buf+c*8,8); return(v); }
+  else{ unsigned v; memcpy(&v,(const byte*)buf+c*4,4); return(v); }
+}
+
+//==============================================================================
+/// Returns number of characters in base64 for n bytes.
+//==============================================================================
+inline ullong VtuB64Len(ullong n){ return((n+2)/3*4); }
+
+//##############################################################################
+//# JSaveVtu
+//##############################################################################
+//==============================================================================
+/// Constructor.
+//==============================================================================
+JSaveVtu::JSaveVtu(TpEncoding encoding,bool compress):Encoding(encoding),Compress(compress){
+  ClassName="JSaveVtu";
+}
+
+//==============================================================================
+/// Destructor.
+//==============================================================================
+JSaveVtu::~JSaveVtu(){
+  DestructorActive=true;
+}
+
+//==============================================================================
+/// Returns encoding as string.
+//==============================================================================
+std::string JSaveVtu::GetEncodingStr(TpEncoding encoding){
+  return(encoding==ENC_Raw? "raw": (encoding==ENC_Base64? "base64": "???"));
+}
+
+//==============================================================================
+/// Returns name of data type in VTK files.
+//==============================================================================
+const char* JSaveVtu::TypeName(JFormatFiles2::TpData type){
+  switch(type){
+    case JFormatFiles2::UChar8:   return("UInt8");
+    case JFormatFiles2::Char8:    return("Int8");
+    case JFormatFiles2::UShort16: return("UInt16");
+    case JFormatFiles2::Short16:  return("Int16");
+    case JFormatFiles2::UInt32:   return("UInt32");
+    case JFormatFiles2::Int32:    return("Int32");
+    case JFormatFiles2::Float32:  return("Float32");
+    case JFormatFiles2::Double64: return("Float64");
+    case JFormatFiles2::ULlong64: return("UInt64");
+    case JFormatFiles2::Llong64:  return("Int64");
+    default: return(NULL);
+  }
+}
+
+//==============================================================================
+/// Returns data type according to its name in VTK files.
+//==============================================================================
+JFormatFiles2::TpData JSaveVtu::TypeFromName(const std::string &name){
+  for(int c=0;c<int(JFormatFiles2::TpDataNull);c++){
+    const JFormatFiles2::TpData type=JFormatFiles2::TpData(c);
+    if(name==TypeName(type))return(type);
+  }
+  return(JFormatFiles2::TpDataNull);
+}
+
+//==============================================================================
+/// Returns size in bytes of data type.
+//==============================================================================
+unsigned JSaveVtu::TypeSize(JFormatFiles2::TpData type){
+  switch(type){
+    case JFormatFiles2::UChar8:
+    case JFormatFiles2::Char8:    return(1);
+    case JFormatFiles2::UShort16:
+    case JFormatFiles2::Short16:  return(2);
+    case JFormatFiles2::UInt32:
+    case JFormatFiles2::Int32:
+    case JFormatFiles2::Float32:  return(4);
+    case JFormatFiles2::Double64:
+    case JFormatFiles2::ULlong64:
+    case JFormatFiles2::Llong64:  return(8);
+    default: return(0);
+  }
+}
+
+//==============================================================================
+/// Returns value of attribute in XML tag or empty string when it is missing.
+//==============================================================================
+std::string JSaveVtu::GetAttrib(const std::string &tag,const std::string &name){
+  const string key=string(" ")+name+"=\"";
+  const size_t pos=tag.find(key);
+  if(pos==string::npos)return("");
+  const size_t pini=pos+key.size();
+  const size_t pfin=tag.find('"',pini);
+  return(pfin==string::npos? string(""): tag.substr(pini,pfin-pini));
+}
+
+//==============================================================================
+/// Appends data encoded in base64 to out. Groups of B64_CHUNK bytes are 
+/// encoded in parallel.
+///
+/// Anhade a out los datos codificados en base64. Los grupos de B64_CHUNK bytes
+/// se codifican en paralelo.
+//==============================================================================
+void JSaveVtu::Base64Encode(const byte *data,ullong size,std::vector<byte> &out){
+  const size_t out0=out.size();
+  out.resize(out0+size_t((size+2)/3*4));
+  byte *res=(out.empty()? NULL: &out[out0]);
+  const int nchunks=int((size+B64_CHUNK-1)/B64_CHUNK);
+  #ifdef OMP_USE
+    #pragma omp parallel for schedule(static) if(nchunks>1)
+  #endif
+  for(int cc=0;cc<nchunks;cc++){
+    const ullong ini=ullong(cc)*B64_CHUNK;
+    const ullong fin=std::min(ini+B64_CHUNK,size);
+    byte *pr=res+size_t(ini/3*4);
+    ullong c=ini;
+    for(;c+3<=fin;c+=3){
+      const unsigned v=(unsigned(data[c])<<16)|(unsigned(data[c+1])<<8)|unsigned(data[c+2]);
+      pr[0]=B64_CHARS[(v>>18)&63]; pr[1]=B64_CHARS[(v>>12)&63];
+      pr[2]=B64_CHARS[(v>>6)&63];  pr[3]=B64_CHARS[v&63];
+      pr+=4;
+    }
+    if(c<fin){//-Last group with padding.
+      const bool two=(c+1<fin);
+      const unsigned v=(unsigned(data[c])<<16)|(two? unsigned(data[c+1])<<8: 0);
+      pr[0]=B64_CHARS[(v>>18)&63]; pr[1]=B64_CHARS[(v>>12)&63];
+      pr[2]=(two? B64_CHARS[(v>>6)&63]: '=');  pr[3]='=';
+    }
+  }
+}
+
+//==============================================================================
+/// Decodes ntxt characters in base64 (multiple of 4) and returns the number of
+/// bytes written in data. Returns ULLONG_MAX when data is invalid.
+///
+/// Decodifica ntxt caracteres en base64 (multiplo de 4) y devuelve el numero
+/// de bytes escritos en data. Devuelve ULLONG_MAX cuando los datos no son validos.
+//==============================================================================
+ullong JSaveVtu::Base64Decode(const char *txt,ullong ntxt,byte *data){
+  if(ntxt%4)return(ULLONG_MAX);
+  byte tab[256];
+  memset(tab,255,sizeof(tab));
+  for(unsigned c=0;c<64;c++)tab[byte(B64_CHARS[c])]=byte(c);
+  ullong n=0;
+  for(ullong c=0;c<ntxt;c+=4){
+    unsigned v=0,npad=0;
+    for(unsigned cv=0;cv<4;cv++){
+      const byte ch=byte(txt[c+cv]);
+      if(ch=='=' && cv>=2 && c+4==ntxt){ npad++; v<<=6; }
+      else if(tab[ch]==255 || npad)return(ULLONG_MAX);
+      else v=(v<<6)|tab[ch];
+    }
+    data[n++]=byte(v>>16);
+    if(npad<2)data[n++]=byte((v>>8)&255);
+    if(npad<1)data[n++]=byte(v&255);
+  }
+  return(n);
+}
+
+//==============================================================================
+/// Compresses and encodes the arrays according to the configuration. Blocks
+/// of all arrays are compressed in parallel.
+///
+/// Comprime y codifica los arrays segun la configuracion. Los bloques de todos
+/// los arrays se comprimen en paralelo.
+//==============================================================================
+void JSaveVtu::EncodeArrays(std::vector<StArrayOut> &arrays)const{
+  const unsigned na=unsigned(arrays.size());
+  if(!Compress){
+    //-Header (size of data) and data are encoded together.
+    if(Encoding==ENC_Base64)for(unsigned ca=0;ca<na;ca++){
+      StArrayOut &ar=arrays[ca];
+      //-First bytes of data are encoded with the header to keep groups of 3 bytes.
+      const ullong nhead=std::min(ullong(1),ar.size);
+      byte head[sizeof(ullong)+1];
+      memcpy(head,&ar.size,sizeof(ullong));
+      if(nhead)head[sizeof(ullong)]=ar.data[0];
+      Base64Encode(head,sizeof(ullong)+nhead,ar.enc);
+      if(ar.size>nhead)Base64Encode(ar.data+nhead,ar.size-nhead,ar.enc);
+    }
+  }
+  else{
+    //-Prepares list of blocks of all arrays.
+    std::vector<unsigned> blockar;
+    std::vector<ullong> blockini;
+    for(unsigned ca=0;ca<na;ca++){
+      for(ullong ini=0;ini<arrays[ca].size;ini+=BLOCKSIZE){ blockar.push_back(ca); blockini.push_back(ini); }
+    }
+    //-Compresses blocks in parallel.
+    const int nb=int(blockar.size());
+    std::vector< std::vector<byte> > blocks(nb);
+    bool error=false;
+    #ifdef OMP_USE
+      #pragma omp parallel for schedule(dynamic) if(nb>1)
+    #endif
+    for(int cb=0;cb<nb;cb++){
+      const StArrayOut &ar=arrays[blockar[cb]];
+      const unsigned n=unsigned(std::min(ullong(BLOCKSIZE),ar.size-blockini[cb]));
+      const unsigned cap=n+n/255+16;
+      std::vector<byte> &out=blocks[cb];
+      out.resize(cap);
+      const unsigned size=JDataCompress::LzCompress(ar.data+blockini[cb],n,&out[0],cap);
+      if(!size)error=true;
+      out.resize(size);
+    }
+    if(error)RunException("EncodeArrays","Error compressing data of VTU file.");
+    //-Joins header and compressed blocks of each array.
+    int cb=0;
+    for(unsigned ca=0;ca<na;ca++){
+      StArrayOut &ar=arrays[ca];
+      const ullong nblocks=(ar.size+BLOCKSIZE-1)/BLOCKSIZE;
+      std::vector<ullong> head(3+size_t(nblocks));
+      head[0]=nblocks;
+      head[1]=BLOCKSIZE;
+      head[2]=ar.size%BLOCKSIZE;
+      ullong csize=0;
+      for(ullong c=0;c<nblocks;c++){ head[3+size_t(c)]=blocks[cb+c].size(); csize+=blocks[cb+c].size(); }
+      std::vector<byte> cdata;
+      std::vector<byte> &dest=(Encoding==ENC_Base64? cdata: ar.enc);
+      if(Encoding==ENC_Base64)Base64Encode((const byte*)&head[0],sizeof(ullong)*head.size(),ar.enc);
+      else dest.insert(dest.end(),(const byte*)&head[0],(const byte*)&head[0]+sizeof(ullong)*head.size());
+      dest.reserve(dest.size()+size_t(csize));
+      for(ullong c=0;c<nblocks;c++,cb++)dest.insert(dest.end(),blocks[cb].begin(),blocks[cb].end());
+      //-Header and compressed blocks are encoded independently in base64.
+      if(Encoding==ENC_Base64 && !cdata.empty())Base64Encode(&cdata[0],cdata.size(),ar.enc);
+    }
+  }
+}
+
+//==============================================================================
+/// Stores VTU file with particle data. Positions are stored as points and 
+/// fields as point data.
+///
+/// Graba fichero VTU con datos de particulas. Las posiciones se graban como
+/// puntos y los campos como datos de puntos.
+//==============================================================================
+void JSaveVtu::SaveFile(const std::string &file,unsigned np,const tfloat3 *pos
+  ,unsigned nfields,const JFormatFiles2::StScalarData *fields)const
+{
+  //-Defines arrays of cells (VTK_VERTEX).
+  std::vector<int> conn(np),offs(np);
+  std::vector<byte> types(np,1);
+  const int n=int(np);
+  #ifdef OMP_USE
+    #pragma omp parallel for schedule(static) if(n>OMP_LIMIT_COMPUTELIGHT)
+  #endif
+  for(int p=0;p<n;p++){ conn[p]=p; offs[p]=p+1; }
+  SaveFileCells(file,np,pos,nfields,fields,conn,offs,types);
+}
+
+//==============================================================================
+/// Stores VTU file with a surface of triangles (nvcell=3) or a set of lines 
+/// (nvcell=2). Array cells contains the nvcell point indices of each cell and
+/// fields are stored as point data.
+///
+/// Graba fichero VTU con una superficie de triangulos (nvcell=3) o un conjunto
+/// de lineas (nvcell=2). El array cells contiene los nvcell indices de puntos
+/// de cada celda y los campos se graban como datos de puntos.
+//==============================================================================
+void JSaveVtu::SaveFilePolys(const std::string &file,unsigned np,const tfloat3 *pos
+  ,unsigned ncells,unsigned nvcell,const unsigned *cells
+  ,unsigned nfields,const JFormatFiles2::StScalarData *fields)const
+{
+  if(nvcell!=2 && nvcell!=3)RunException("SaveFilePolys","Number of points per cell is invalid.",file);
+  //-Defines arrays of cells (VTK_LINE or VTK_TRIANGLE).
+  const ullong nconn=ullong(ncells)*nvcell;
+  if(nconn>=INT_MAX)RunException("SaveFilePolys","Number of cells is too high.",file);
+  std::vector<int> conn((size_t)nconn),offs(ncells);
+  std::vector<byte> types(ncells,byte(nvcell==2? 3: 5));
+  const int nc=int(ncells);
+  #ifdef OMP_USE
+    #pragma omp parallel for schedule(static) if(nc>OMP_LIMIT_COMPUTELIGHT)
+  #endif
+  for(int c=0;c<nc;c++){
+    for(unsigned cv=0;cv<nvcell;cv++)conn[c*nvcell+cv]=int(cells[c*nvcell+cv]);
+    offs[c]=int((c+1)*nvcell);
+  }
+  SaveFileCells(file,np,pos,nfields,fields,conn,offs,types);
+}
+
+//==============================================================================
+/// Stores VTU file with points, point data and the given cells.
+/// Graba fichero VTU con puntos, datos de puntos y las celdas indicadas.
+//==============================================================================
+void JSaveVtu::SaveFileCells(const std::string &file,unsigned np,const tfloat3 *pos
+  ,unsigned nfields,const JFormatFiles2::StScalarData *fields
+  ,const std::vector<int> &conn,const std::vector<int> &offs,const std::vector<byte> &types)const
+{
+  const char met[]="SaveFileCells";
+  const unsigned ncells=unsigned(types.size());
+  std::vector<StArrayOut> arrays;
+  for(unsigned cf=0;cf<nfields;cf++){
+    const JFormatFiles2::StScalarData &fd=fields[cf];
+    if(!TypeName(fd.type))RunException(met,fun::PrintStr("Type of field \'%s\' is invalid.",fd.name.c_str()),file);
+    StArrayOut ar={fd.name,fd.type,fd.comp,(const byte*)fd.pointer,ullong(TypeSize(fd.type))*fd.comp*np};
+    arrays.push_back(ar);
+  }
+  const unsigned npointdata=unsigned(arrays.size());
+  StArrayOut arpos={"Points",JFormatFiles2::Float32,3,(const byte*)pos,ullong(sizeof(tfloat3))*np};
+  StArrayOut arconn={"connectivity",JFormatFiles2::Int32,1,(conn.size()? (const byte*)&conn[0]: NULL),ullong(sizeof(int))*conn.size()};
+  StArrayOut aroffs={"offsets",JFormatFiles2::Int32,1,(ncells? (const byte*)&offs[0]: NULL),ullong(sizeof(int))*ncells};
+  StArrayOut artypes={"types",JFormatFiles2::UChar8,1,(ncells? &types[0]: NULL),ullong(ncells)};
+  arrays.push_back(arpos);
+  arrays.push_back(arconn);
+  arrays.push_back(aroffs);
+  arrays.push_back(artypes);
+  //-Compresses and encodes arrays.
+  EncodeArrays(arrays);
+  //-Creates XML header.
+  std::ostringstream xml;
+  xml << "<?xml version=\"1.0\"?>\n";
+  xml << "<VTKFile type=\"UnstructuredGrid\" version=\"1.0\" byte_order=\"LittleEndian\" header_type=\"UInt64\"";
+  if(Compress)xml << " compressor=\"vtkLZ4DataCompressor\"";
+  xml << ">\n  <UnstructuredGrid>\n";
+  xml << "    <Piece NumberOfPoints=\"" << np << "\" NumberOfCells=\"" << ncells << "\">\n";
+  ullong offset=0;
+  for(unsigned ca=0;ca<unsigned(arrays.size());ca++){
+    const StArrayOut &ar=arrays[ca];
+    if(ca==0 && npointdata)xml << "      <PointData>\n";
+    if(ca==npointdata)xml << (npointdata? "      </PointData>\n": "") << "      <Points>\n";
+    if(ca==npointdata+1)xml << "      </Points>\n      <Cells>\n";
+    xml << "        <DataArray type=\"" << TypeName(ar.type) << "\" Name=\"" << ar.name << "\"";
+    if(ar.comp>1)xml << " NumberOfComponents=\"" << ar.comp << "\"";
+    xml << " format=\"appended\" offset=\"" << offset << "\"/>\n";
+    offset+=GetEncodedSize(ar);
+  }
+  xml << "      </Cells>\n    </Piece>\n  </UnstructuredGrid>\n";
+  xml << "  <AppendedData encoding=\"" << GetEncodingStr(Encoding) << "\">\n   _";
+  //-Writes file.
+  std::ofstream pf;
+  pf.open(file.c_str(),ios::binary|ios::out);
+  if(!pf)RunException(met,"File could not be opened.",file);
+  const string txt=xml.str();
+  pf.write(txt.c_str(),txt.size());
+  for(unsigned ca=0;ca<unsigned(arrays.size());ca++){
+    const StArrayOut &ar=arrays[ca];
+    if(!ar.enc.empty())pf.write((const char*)&ar.enc[0],ar.enc.size());
+    else{
+      pf.write((const char*)&ar.size,sizeof(ullong));
+      if(ar.size)pf.write((const char*)ar.data,ar.size);
+    }
+  }
+  pf << "\n  </AppendedData>\n</VTKFile>\n";
+  if(pf.fail())RunException(met,"File writing failure.",file);
+  pf.close();
+}
+
+//==============================================================================
+/// Decodes array of appended data starting at ptr (nmax bytes available).
+/// Decodifica array de datos appended que empieza en ptr (nmax bytes disponibles).
+//==============================================================================
+void JSaveVtu::DecodeArray(const std::string &file,const char *ptr,ullong nmax
+  ,bool base64,bool compress,unsigned hsize,StArrayData &ar)const
+{
+  const char met[]="DecodeArray";
+  const string errtx=string("Data of array \'")+ar.name+"\' is invalid.";
+  std::vector<byte> head;
+  if(!compress){
+    //-Header with size of data and data.
+    ullong size=0;
+    if(base64){
+      head.resize(9);
+      if(VtuB64Len(hsize)>nmax || Base64Decode(ptr,VtuB64Len(hsize),&head[0])<hsize)RunException(met,errtx,file);
+      size=VtuGetHead(&head[0],hsize,0);
+      const ullong ntxt=VtuB64Len(hsize+size);
+      if(ntxt>nmax)RunException(met,errtx,file);
+      std::vector<byte> buf(size_t(ntxt/4*3));
+      if(Base64Decode(ptr,ntxt,&buf[0])!=hsize+size)RunException(met,errtx,file);
+      ar.data.assign(buf.begin()+hsize,buf.begin()+size_t(hsize+size));
+    }
+    else{
+      if(hsize>nmax)RunException(met,errtx,file);
+      size=VtuGetHead(ptr,hsize,0);
+      if(hsize+size>nmax)RunException(met,errtx,file);
+      ar.data.assign(ptr+hsize,ptr+size_t(hsize+size));
+    }
+  }
+  else{
+    //-Header of compressed blocks.
+    ullong nhead=0,ntxt=0;
+    if(base64){
+      head.resize(size_t(hsize)*3+2);
+      if(VtuB64Len(hsize*3)>nmax || Base64Decode(ptr,VtuB64Len(hsize*3),&head[0])<hsize*3)RunException(met,errtx,file);
+      nhead=hsize*(3+VtuGetHead(&head[0],hsize,0));
+      ntxt=VtuB64Len(nhead);
+      if(ntxt>nmax)RunException(met,errtx,file);
+      head.resize(size_t(ntxt/4*3));
+      if(Base64Decode(ptr,ntxt,&head[0])!=nhead)RunException(met,errtx,file);
+    }
+    else{
+      if(hsize*3>nmax)RunException(met,errtx,file);
+      nhead=hsize*(3+VtuGetHead(ptr,hsize,0));
+      if(nhead>nmax)RunException(met,errtx,file);
+      head.assign(ptr,ptr+size_t(nhead));
+      ntxt=nhead;
+    }
+    const ullong nblocks=VtuGetHead(&head[0],hsize,0);
+    const ullong bsize=VtuGetHead(&head[0],hsize,1);
+    const ullong lastsize=VtuGetHead(&head[0],hsize,2);
+    ullong csize=0;
+    for(ullong c=0;c<nblocks;c++)csize+=VtuGetHead(&head[0],hsize,3+c);
+    //-Compressed blocks.
+    std::vector<byte> cdata;
+    const byte *pc=(const byte*)ptr+ntxt;
+    if(base64){
+      const ullong nc=VtuB64Len(csize);
+      if(ntxt+nc>nmax)RunException(met,errtx,file);
+      cdata.resize(size_t(nc/4*3)+1);
+      if(Base64Decode(ptr+ntxt,nc,&cdata[0])!=csize)RunException(met,errtx,file);
+      pc=&cdata[0];
+    }
+    else if(ntxt+csize>nmax)RunException(met,errtx,file);
+    //-Decompresses blocks.
+    const ullong size=(nblocks? (nblocks-1)*bsize+(lastsize? lastsize: bsize): 0);
+    ar.data.resize(size_t(size));
+    for(ullong c=0;c<nblocks;c++){
+      const ullong n=VtuGetHead(&head[0],hsize,3+c);
+      const ullong rn=(c+1<nblocks || !lastsize? bsize: lastsize);
+      if(!JDataCompress::LzDecompress(pc,unsigned(n),&ar.data[size_t(c*bsize)],unsigned(rn)))RunException(met,errtx,file);
+      pc+=n;
+    }
+  }
+}
+
+//==============================================================================
+/// Loads VTU file with appended data (raw or base64 and compressed or not with
+/// vtkLZ4DataCompressor). Points and cells are returned as arrays.
+///
+/// Carga fichero VTU con datos appended (raw o base64 y comprimidos o no con 
+/// vtkLZ4DataCompressor). Los puntos y celdas se devuelven como arrays.
+//==============================================================================
+void JSaveVtu::LoadFile(const std::string &file,unsigned &np,std::vector<StArrayData> &arrays)const{
+  const char met[]="LoadFile";
+  np=0; arrays.clear();
+  //-Loads file in memory.
+  std::ifstream pf;
+  pf.open(file.c_str(),ios::binary);
+  if(!pf)RunException(met,"File could not be opened.",file);
+  pf.seekg(0,ios::end);
+  const ullong fsize=ullong(pf.tellg());
+  pf.seekg(0,ios::beg);
+  std::vector<char> fdata(size_t(fsize)+1,0);
+  if(fsize)pf.read(&fdata[0],fsize);
+  if(pf.fail())RunException(met,"File reading failure.",file);
+  pf.close();
+  //-Loads XML header.
+  const char *pdata=&fdata[0];
+  const char *papp=strstr(pdata,"<AppendedData");
+  if(!papp)RunException(met,"Appended data is missing.",file);
+  const string txt(pdata,papp);
+  const size_t pvtk=txt.find("<VTKFile");
+  if(pvtk==string::npos)RunException(met,"The file is not a VTK XML file.",file);
+  const string tagvtk=txt.substr(pvtk,txt.find('>',pvtk)-pvtk);
+  if(GetAttrib(tagvtk,"byte_order")!="LittleEndian")RunException(met,"Byte order is not supported.",file);
+  const string htype=GetAttrib(tagvtk,"header_type");
+  const unsigned hsize=(htype=="UInt64"? 8: 4);
+  if(htype!="" && htype!="UInt64" && htype!="UInt32")RunException(met,"Type of header is not supported.",file);
+  const string compressor=GetAttrib(tagvtk,"compressor");
+  const bool compress=(compressor!="");
+  if(compress && compressor!="vtkLZ4DataCompressor")RunException(met,string("Compressor \'")+compressor+"\' is not supported.",file);
+  const size_t ppiece=txt.find("<Piece");
+  if(ppiece==string::npos)RunException(met,"Piece of data is missing.",file);
+  np=unsigned(atoi(GetAttrib(txt.substr(ppiece,txt.find('>',ppiece)-ppiece),"NumberOfPoints").c_str()));
+  const char *pend=strchr(papp,'>');
+  const string tagapp=(pend? string(papp,pend): string(""));
+  const string encoding=GetAttrib(tagapp,"encoding");
+  if(encoding!="raw" && encoding!="base64")RunException(met,"Encoding of appended data is not supported.",file);
+  const bool base64=(encoding=="base64");
+  const char *pbase=(pend? strchr(pend,'_'): NULL);
+  if(!pbase)RunException(met,"Appended data is invalid.",file);
+  pbase++;
+  const ullong nbase=fsize-ullong(pbase-pdata);
+  //-Loads arrays.
+  size_t pos=0;
+  while((pos=txt.find("<DataArray",pos))!=string::npos){
+    const size_t pfin=txt.find('>',pos);
+    const string tag=txt.substr(pos,pfin-pos);
+    pos=pfin;
+    StArrayData ar;
+    ar.name=GetAttrib(tag,"Name");
+    ar.type=TypeFromName(GetAttrib(tag,"type"));
+    const string ncomp=GetAttrib(tag,"NumberOfComponents");
+    ar.comp=(ncomp.empty()? 1: unsigned(atoi(ncomp.c_str())));
+    if(ar.type==JFormatFiles2::TpDataNull)RunException(met,string("Type of array \'")+ar.name+"\' is not supported.",file);
+    if(GetAttrib(tag,"format")!="appended")RunException(met,string("Format of array \'")+ar.name+"\' is not supported.",file);
+    const ullong offset=strtoull(GetAttrib(tag,"offset").c_str(),NULL,10);
+    if(offset>=nbase)RunException(met,string("Offset of array \'")+ar.name+"\' is invalid.",file);
+    DecodeArray(file,pbase+offset,nbase-offset,base64,compress,hsize,ar);
+    arrays.push_back(ar);
+  }
+}
+
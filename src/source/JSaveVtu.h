@@ -0,0 +1,112 @@
+//HEAD_DSCODES
+/*
+ <DUALSPHYSICS>  Copyright (c) 2019 by Dr Jose M. Dominguez et al. (see http://dual.sphysics.org/index.php/developers/). 
+
+ EPHYSLAB Environmental Physics Laboratory, Universidade de Vigo, Ourense, Spain.
+ School of Mechanical, Aerospace and Civil Engineering, University of Manchester, Manchester, U.K.
+
+ This file is part of DualSPHysics. 
+
+ DualSPHysics is free software: you can redistribute it and/or modify it under the terms of the GNU Lesser General Public License 
+ as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) any later version.
+ 
+ DualSPHysics is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details. 
+
+ You should have received a copy of the GNU Lesser General Public License along with DualSPHysics. If not, see <http://www.gnu.org/licenses/>. 
+*/
+
+//:#############################################################################
+//:# Descripcion:
+//:# =============
+//:# Escritura de ficheros VTK XML (.vtu) de particulas sin librerias externas:
+//:# - Datos binarios en seccion appended con codificacion raw o base64.
+//:# - Compresion opcional por bloques con el codec LZ de JDataCompress, que es
+//:#   compatible con vtkLZ4DataCompressor.
+//:# - Compresion y codificacion de los arrays en paralelo con OpenMP.
+//:# - Lectura de los ficheros generados para comprobar los datos.
+//:#
+//:# Cambios:
+//:# =========
+//:# - Implementacion. (18-10-2026)
+//:# - Grabacion de superficies de triangulos y de lineas. (18-10-2026)
+//:#############################################################################
+
+/// \file JSaveVtu.h \brief Declares the class \ref JSaveVtu.
+
+#ifndef _JSaveVtu_
+#define _JSaveVtu_
+
+#include "TypesDef.h"
+#include "JObject.h"
+#include "JFormatFiles2.h"
+#include <string>
+#include <vector>
+
+//##############################################################################
+//# JSaveVtu
+//##############################################################################
+/// \brief Writes particle data in VTK XML files (.vtu) with appended binary data.
+/// Particles are stored as VTK_VERTEX cells and surfaces as VTK_TRIANGLE or 
+/// VTK_LINE cells. Compressed data uses the block format of VTK with the LZ 
+/// codec of \ref JDataCompress (LZ4 block format).
+
+class JSaveVtu : protected JObject
+{
+public:
+  /// Encoding of appended data.
+  typedef enum{ ENC_Raw=1,ENC_Base64=2 }TpEncoding; 
+
+  /// Array of data loaded from a VTU file.
+  typedef struct{
+    std::string name;
+    JFormatFiles2::TpData type;
+    unsigned comp;
+    std::vector<byte> data;
+  }StArrayData;
+
+  static const unsigned BLOCKSIZE=32768;  ///<Size of uncompressed blocks (value by default in VTK).
+
+protected:
+  /// Array to be stored.
+  typedef struct{
+    std::string name;
+    JFormatFiles2::TpData type;
+    unsigned comp;
+    const byte *data;       ///<Pointer to data.
+    ullong size;            ///<Size of data in bytes.
+    std::vector<byte> enc;  ///<Encoded data with header (empty for raw data without compression).
+  }StArrayOut;
+
+  const TpEncoding Encoding;
+  const bool Compress;
+
+  static const char* TypeName(JFormatFiles2::TpData type);
+  static JFormatFiles2::TpData TypeFromName(const std::string &name);
+  static std::string GetAttrib(const std::string &tag,const std::string &name);
+
+  static void Base64Encode(const byte *data,ullong size,std::vector<byte> &out);
+  static ullong Base64Decode(const char *txt,ullong ntxt,byte *data);
+
+  void EncodeArrays(std::vector<StArrayOut> &arrays)const;
+  ullong GetEncodedSize(const StArrayOut &ar)const{ return(ar.enc.empty()? sizeof(ullong)+ar.size: ullong(ar.enc.size())); }
+  void SaveFileCells(const std::string &file,unsigned np,const tfloat3 *pos
+    ,unsigned nfields,const JFormatFiles2::StScalarData *fields
+    ,const std::vector<int> &conn,const std::vector<int> &offs,const std::vector<byte> &types)const;
+  void DecodeArray(const std::string &file,const char *ptr,ullong nmax,bool base64,bool compress,unsigned hsize,StArrayData &ar)const;
+
+public:
+  JSaveVtu(TpEncoding encoding,bool compress);
+  ~JSaveVtu();
+  static std::string GetEncodingStr(TpEncoding encoding);
+  static unsigned TypeSize(JFormatFiles2::TpData type);
+
+  void SaveFile(const std::string &file,unsigned np,const tfloat3 *pos,unsigned nfields,const JFormatFiles2::StScalarData *fields)const;
+  void SaveFilePolys(const std::string &file,unsigned np,const tfloat3 *pos,unsigned ncells,unsigned nvcell,const unsigned *cells
+    ,unsigned nfields,const JFormatFiles2::StScalarData *fields)const;
+  void LoadFile(const std::string &file,unsigned &np,std::vector<StArrayData> &arrays)const;
+};
+
+#endif
+
+
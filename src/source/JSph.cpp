@@ -33,6 +33,8 @@
 #include "JFormatFiles2.h"
 #include "JSphDtFixed.h"
 #include "JSaveDt.h"
+#include "JSphSteadyState.h"
+#include "JSphPlugins.h"
 #include "JTimeOut.h"
 #include "JSphVisco.h"
 #include "JGaugeSystem.h"
@@ -42,16 +44,27 @@
 #include "JChronoObjects.h" //<vs_chroono>
 #include "JSphAccInput.h"
 #include "JPartDataBi4.h"
+#include "JPartSaveAsync.h"
+#include "JSphCheckpoint.h"
+#include "JSaveVtu.h"
+#include "JSaveCsv2.h"
 #include "JPartOutBi4Save.h"
 #include "JPartFloatBi4.h"
 #include "JPartsOut.h"
 #include "JDamping.h"
+#include "JSphSaveRegions.h"
 #include "JSphInitialize.h"
 #include "JSphInOut.h"       //<vs_innlet> 
 #include "JSphBoundCorr.h"   //<vs_innlet> 
 #include "JLinearValue.h"
 #include <climits>
 
+#ifdef IDP_SIZE8
+  #define IDP_FMTTYPE JFormatFiles2::ULlong64  ///<Data type of Idp in VTK and CSV files.
+#else
+  #define IDP_FMTTYPE JFormatFiles2::UInt32    ///<Data type of Idp in VTK and CSV files.
+#endif
+
 //using namespace std;
 using std::string;
 using std::ofstream;
@@ -67,10 +80,13 @@ JSph::JSph(bool cpu,bool withmpi):Cpu(cpu),WithMpi(withmpi){
   DataOutBi4=NULL;
   DataFloatBi4=NULL;
   PartsOut=NULL;
+  PartSaveAsync=NULL;
   Log=NULL;
   ViscoTime=NULL;
   DtFixed=NULL;
   SaveDt=NULL;
+  SteadyState=NULL;
+  Plugins=NULL;
   TimeOut=NULL;
   MkInfo=NULL;
   PartsInit=NULL;
@@ -83,8 +99,10 @@ JSph::JSph(bool cpu,bool withmpi):Cpu(cpu),WithMpi(withmpi){
   RelaxZones=NULL;    //<vs_rzone>
   ChronoObjects=NULL; //<vs_chroono>
   Damping=NULL;
+  SaveRegions=NULL;
   AccInput=NULL;
   PartsLoaded=NULL;
+  Checkpoint=NULL;
   InOut=NULL;       //<vs_innlet>
   BoundCorr=NULL;   //<vs_innlet>
   InitVars();
@@ -95,6 +113,7 @@ JSph::JSph(bool cpu,bool withmpi):Cpu(cpu),WithMpi(withmpi){
 //==============================================================================
 JSph::~JSph(){
   DestructorActive=true;
+  delete PartSaveAsync; PartSaveAsync=NULL; //-Writes pending data before deleting output objects.
   delete DataBi4;       DataBi4=NULL;
   delete DataOutBi4;    DataOutBi4=NULL;
   delete DataFloatBi4;  DataFloatBi4=NULL;
@@ -102,6 +121,8 @@ JSph::~JSph(){
   delete ViscoTime;     ViscoTime=NULL;
   delete DtFixed;       DtFixed=NULL;
   delete SaveDt;        SaveDt=NULL;
+  delete SteadyState;   SteadyState=NULL;
+  delete Plugins;       Plugins=NULL;
   delete TimeOut;       TimeOut=NULL;
   delete MkInfo;        MkInfo=NULL;
   delete PartsInit;     PartsInit=NULL;
@@ -114,8 +135,10 @@ JSph::~JSph(){
   delete RelaxZones;    RelaxZones=NULL;    //<vs_rzone>
   delete ChronoObjects; ChronoObjects=NULL; //<vs_chroono>
   delete Damping;       Damping=NULL;
+  delete SaveRegions;   SaveRegions=NULL;
   delete AccInput;      AccInput=NULL; 
   delete PartsLoaded;   PartsLoaded=NULL;
+  delete Checkpoint;    Checkpoint=NULL;
   delete InOut;         InOut=NULL;       //<vs_innlet>
   delete BoundCorr;     BoundCorr=NULL;   //<vs_innlet>
 }
@@ -162,6 +185,13 @@ void JSph::InitVars(){
   SvRes=false;
   SvTimers=false;
   SvDomainVtk=false;
+  SvAsync=0;
+  SvCompress=false;
+  SvQuantPos=SvQuantVel=SvQuantRhop=0;
+  SvQuantFull=0;
+  SvDelta=0;
+  SvCheckpoint=0;
+  SvVtu=0; SvVtuCompress=false;
 
   H=CteB=Gamma=RhopZero=CFLnumber=0;
   Dp=0;
@@ -402,6 +432,27 @@ void JSph::LoadConfig(const JCfgRun *cfg){
   SvRes=cfg->SvRes;
   SvTimers=cfg->SvTimers;
   SvDomainVtk=cfg->SvDomainVtk;
+  SvAsync=cfg->SvAsync;
+  SvCompress=cfg->SvCompress;
+  SvQuantPos=cfg->SvQuantPos;
+  SvQuantVel=cfg->SvQuantVel;
+  SvQuantRhop=cfg->SvQuantRhop;
+  SvQuantFull=cfg->SvQuantFull;
+  SvDelta=cfg->SvDelta;
+  if(SvDelta && SvQuantPos>0)RunException(met,"Quantised output (-svquant) can not be combined with delta output (-svdelta).");
+  SvCheckpoint=cfg->SvCheckpoint;
+  SvVtu=cfg->SvVtu;
+  SvVtuCompress=cfg->SvVtuCompress;
+  if(SvCheckpoint && !(SvData&SDAT_Binx))RunException(met,"Checkpoint (-checkpoint) requires binary output of PART files (-sv:binx).");
+  if(SvCheckpoint && SvQuantPos>0)RunException(met,"Checkpoint (-checkpoint) can not be combined with quantised output (-svquant).");
+  //-Loads checkpoint to restart the simulation from its PART.
+  if(!cfg->RestartDir.empty()){
+    if(PartBegin)RunException(met,"Restart from checkpoint (-restart) can not be combined with -partbegin.");
+    Checkpoint=new JSphCheckpoint();
+    Checkpoint->LoadFile(cfg->RestartDir);
+    PartBeginDir=cfg->RestartDir;
+    PartBegin=PartBeginFirst=Checkpoint->GetPartBegin();
+  }
 
   printf("\n");
   RunTimeDate=fun::GetDateTime();
@@ -420,6 +471,7 @@ void JSph::LoadConfig(const JCfgRun *cfg){
     if(DirOut!=DirDataOut)fun::MkdirPath(DirDataOut);
   }
 
+  if(Checkpoint)Log->Printf("Restart from checkpoint: \"%s\"",Checkpoint->GetFileIn().c_str());
   if(PartBegin){
     Log->Print(fun::VarStr("PartBegin",PartBegin));
     Log->Print(fun::VarStr("PartBeginDir",PartBeginDir));
@@ -696,6 +748,12 @@ void JSph::LoadCaseConfig(){
     Damping->LoadXml(&xml,"case.execution.special.damping");
   }
 
+  //-Configuration of output regions.
+  if(xml.GetNode("case.execution.special.saveregions",false)){
+    SaveRegions=new JSphSaveRegions(Log);
+    SaveRegions->LoadXml(&xml,"case.execution.special.saveregions");
+  }
+
   //-Loads floating objects.
   FtCount=parts.CountBlocks(TpPartFloating);
   if(FtCount){
@@ -867,7 +925,7 @@ void JSph::VisuDemCoefficients()const{
 /// Carga el codigo de grupo de las particulas y marca las nout ultimas
 /// particulas como excluidas.
 //==============================================================================
-void JSph::LoadCodeParticles(unsigned np,const unsigned *idp,typecode *code)const{
+void JSph::LoadCodeParticles(unsigned np,const typeidp *idp,typecode *code)const{
   const char met[]="LoadCodeParticles"; 
   //-Assigns code to each group of particles.
   for(unsigned p=0;p<np;p++)code[p]=MkInfo->GetCodeById(idp[p]);
@@ -1139,7 +1197,7 @@ void JSph::LoadDcellParticles(unsigned n,const typecode *code,const tdouble3 *po
 ///
 /// Inicializa datos de las particulas a partir de la configuracion en el XML.
 //==============================================================================
-void JSph::RunInitialize(unsigned np,unsigned npb,const tdouble3 *pos,const unsigned *idp,const typecode *code,tfloat4 *velrhop){
+void JSph::RunInitialize(unsigned np,unsigned npb,const tdouble3 *pos,const typeidp *idp,const typecode *code,tfloat4 *velrhop){
   const char met[]="RunInitialize";
   if(!PartBegin){
     JSphInitialize init(FileXml);
@@ -1265,7 +1323,7 @@ unsigned JSph::CalcCellCode(tuint3 ncells){
 /// Computes maximum distance between particles and center of floating.
 /// Calcula distancia maxima entre particulas y centro de cada floating.
 //==============================================================================
-void JSph::CalcFloatingRadius(unsigned np,const tdouble3 *pos,const unsigned *idp){
+void JSph::CalcFloatingRadius(unsigned np,const tdouble3 *pos,const typeidp *idp){
   const char met[]="CalcFloatingsRadius";
   const float overradius=1.2f; //-Percentage of ration increase. | Porcentaje de incremento de radio. 
   unsigned *ridp=new unsigned[CaseNfloat];
@@ -1275,8 +1333,8 @@ void JSph::CalcFloatingRadius(unsigned np,const tdouble3 *pos,const unsigned *id
   //-Calcula posicion segun id suponiendo que todas las particulas son normales (no periodicas).
   const unsigned idini=CaseNpb,idfin=CaseNpb+CaseNfloat;
   for(unsigned p=0;p<np;p++){
-    const unsigned id=idp[p];
-    if(idini<=id && id<idfin)ridp[id-idini]=p;
+    const typeidp id=idp[p];
+    if(idini<=id && id<idfin)ridp[unsigned(id-idini)]=p;
   }
   //-Checks that all floating particles are located.  
   //-Comprueba que todas las particulas floating estan localizadas.
@@ -1412,11 +1470,42 @@ void JSph::LoadCaseParticles(){
   SaveInitialDomainVtk();
 }
 
+//==============================================================================
+/// Returns constant values of the simulation for the analysis plugins.
+/// Devuelve valores constantes de la simulacion para los plugins de analisis.
+//==============================================================================
+JSphPlugin::StSetup JSph::GetPluginSetup()const{
+  JSphPlugin::StSetup setup;
+  setup.appname=AppName;
+  setup.dirout=DirOut;
+  setup.dirdataout=DirDataOut;
+  setup.casename=CaseName;
+  setup.csvsepcoma=CsvSepComa;
+  setup.simulate2d=Simulate2D;
+  setup.simulate2dposy=Simulate2DPosY;
+  setup.dp=Dp;
+  setup.h=H;
+  setup.massfluid=MassFluid;
+  setup.massbound=MassBound;
+  setup.cteb=CteB;
+  setup.gamma=Gamma;
+  setup.rhopzero=RhopZero;
+  setup.gravity=Gravity;
+  setup.timemax=TimeMax;
+  setup.timepart=TimePart;
+  setup.casenp=CaseNp;
+  setup.casenbound=CaseNbound;
+  setup.casenfixed=CaseNfixed;
+  setup.casenmoving=CaseNmoving;
+  setup.casenfloat=CaseNfloat;
+  return(setup);
+}
+
 //==============================================================================
 /// Initialisation of variables and objects for execution.
 /// Inicializa variables y objetos para la ejecucion.
 //==============================================================================
-void JSph::InitRun(unsigned np,const unsigned *idp,const tdouble3 *pos){
+void JSph::InitRun(unsigned np,const typeidp *idp,const tdouble3 *pos){
   const char met[]="InitRun";
   InterStep=(TStep==STEP_Symplectic? INTERSTEP_SymPredictor: INTERSTEP_Verlet);
   VerletStep=0;
@@ -1449,7 +1538,7 @@ void JSph::InitRun(unsigned np,const unsigned *idp,const tdouble3 *pos){
   //-Uses Inlet information from PART read.
   if(PartBeginTimeStep && PartBeginTotalNp){
     TotalNp=PartBeginTotalNp;
-    IdMax=unsigned(TotalNp-1);
+    IdMax=typeidp(TotalNp-1);
   }
 
   //-Shows Initialize configuration.
@@ -1515,6 +1604,27 @@ void JSph::InitRun(unsigned np,const unsigned *idp,const tdouble3 *pos){
     SaveDt->VisuConfig("SaveDt configuration:"," ");
   }
 
+  //-Configuration of SteadyState.
+  if(xml.GetNode("case.execution.special.steadystate",false)){
+    if(!Cpu)Log->PrintWarning("The steady state detection is only available for CPU executions.");
+    else{
+      SteadyState=new JSphSteadyState(Log);
+      SteadyState->Config(&xml,"case.execution.special.steadystate",GaugeSystem);
+      SteadyState->VisuConfig("SteadyState configuration:"," ");
+    }
+  }
+
+  //-Configuration of Plugins.
+  if(xml.GetNode("case.execution.special.plugins",false)){
+    if(!Cpu)Log->PrintWarning("The analysis plugins are only available for CPU executions.");
+    else{
+      Plugins=new JSphPlugins(Log);
+      Plugins->LoadXml(&xml,"case.execution.special.plugins",DirCase);
+      Plugins->Init(GetPluginSetup());
+      if(Plugins->GetCount())Plugins->VisuConfig("Plugins configuration:"," ");
+    }
+  }
+
   //-Prepares BoundCorr configuration.  //<vs_innlet_ini>
   if(BoundCorr){
     Log->Print("BoundCorr configuration:");
@@ -1523,6 +1633,9 @@ void JSph::InitRun(unsigned np,const unsigned *idp,const tdouble3 *pos){
     BoundCorr->VisuConfig(""," ");
   }//<vs_innlet_end>
 
+  //-Restores output files of JGaugeSystem from checkpoint before the initial measure.
+  if(Checkpoint)GaugeSystem->LoadCheckpointOutput(Checkpoint);
+
   //-Shows configuration of JGaugeSystem.
   if(GaugeSystem->GetCount())GaugeSystem->VisuConfig("GaugeSystem configuration:"," ");
 
@@ -1589,9 +1702,25 @@ void JSph::ConfigSaveData(unsigned piece,unsigned pieces,std::string div){
     else if(div=="Y")DataBi4->ConfigSimDiv(JPartDataBi4::DIV_Y);
     else if(div=="Z")DataBi4->ConfigSimDiv(JPartDataBi4::DIV_Z);
     else RunException(met,"The division configuration is invalid.");
+    DataBi4->ConfigCompression(SvCompress);
+    if(SvCompress)Log->Print("Particle arrays in bi4 files are compressed without loss.");
+    if(SvQuantPos>0){
+      Log->Printf("Particle data in bi4 files is quantised with maximum errors Pos:%g Vel:%g Rhop:%g.",SvQuantPos,SvQuantVel,SvQuantRhop);
+      if(SvQuantFull)Log->Printf("  One of each %u parts is stored without loss.",SvQuantFull);
+      else Log->Print("  Only the first part is stored without loss.");
+    }
+    if(SvDelta)Log->Printf("Particle data in bi4 files is stored as differences with the previous part and a keyframe each %u parts.",SvDelta);
+    if(SvCheckpoint){
+      Log->Printf("Checkpoint of the solver state is saved each %u parts.",SvCheckpoint);
+      Log->AddFileInfo(DirDataOut+JSphCheckpoint::GetFileName(),"Binary file with the full state of the solver to restart the simulation (-restart).");
+    }
     if(SvData&SDAT_Binx)Log->AddFileInfo(DirDataOut+"Part_????.bi4","Binary file with particle data in different instants.");
     if(SvData&SDAT_Info)Log->AddFileInfo(DirDataOut+"PartInfo.ibi4","Binary file with execution information for each instant (input for PartInfo program).");
   }
+  if((SvData&SDAT_Vtk) && SvVtu){
+    Log->Printf("VTK files of particles are stored in VTU format (%s%s).",JSaveVtu::GetEncodingStr(JSaveVtu::TpEncoding(SvVtu)).c_str(),(SvVtuCompress? ", compressed": ""));
+    Log->AddFileInfo(DirDataOut+"PartVtk_????.vtu","VTK XML file with particle data in different instants.");
+  }
   //-Configures object to store excluded particles.  
   //-Configura objeto para grabacion de particulas excluidas.
   if(SvData&SDAT_Binx){
@@ -1616,13 +1745,25 @@ void JSph::ConfigSaveData(unsigned piece,unsigned pieces,std::string div){
   //-Creates object to store excluded particles until recordering. 
   //-Crea objeto para almacenar las particulas excluidas hasta su grabacion.
   PartsOut=new JPartsOut();
+  //-Creates object to write particle data in background.
+  //-Crea objeto para grabar datos de particulas en segundo plano.
+  if(SvAsync){
+    PartSaveAsync=new JPartSaveAsync(this,SvAsync);
+    Log->Printf("Particle data is written in background with %u staging buffers.",SvAsync);
+  }
+  //-Configures output regions.
+  //-Configura regiones de salida.
+  if(SaveRegions){
+    SaveRegions->ConfigData(MkInfo,DirDataOut,&parthead,SvDouble,SvCompress,TimeStepIni);
+    SaveRegions->VisuConfig("Output regions configuration:"," ");
+  }
 }
 
 //==============================================================================
 /// Stores new excluded particles until recordering next PART.
 /// Almacena nuevas particulas excluidas hasta la grabacion del proximo PART.
 //==============================================================================
-void JSph::AddParticlesOut(unsigned nout,const unsigned *idp,const tdouble3 *pos
+void JSph::AddParticlesOut(unsigned nout,const typeidp *idp,const tdouble3 *pos
   ,const tfloat3 *vel,const float *rhop,const typecode *code)
 {
   PartsOut->AddParticles(nout,idp,pos,vel,rhop,code);
@@ -1632,7 +1773,7 @@ void JSph::AddParticlesOut(unsigned nout,const unsigned *idp,const tdouble3 *pos
 /// Manages excluded particles fixed, moving and floating before aborting the execution.
 /// Gestiona particulas excluidas fixed, moving y floating antes de abortar la ejecucion.
 //==============================================================================
-void JSph::AbortBoundOut(unsigned nout,const unsigned *idp,const tdouble3 *pos,const tfloat3 *vel,const float *rhop,const typecode *code){
+void JSph::AbortBoundOut(unsigned nout,const typeidp *idp,const tdouble3 *pos,const tfloat3 *vel,const float *rhop,const typecode *code){
   //-Prepares data of excluded boundary particles.
   byte* type=new byte[nout];
   byte* motive=new byte[nout];
@@ -1690,7 +1831,7 @@ void JSph::AbortBoundOut(unsigned nout,const unsigned *idp,const tdouble3 *pos,c
   Log->Print(" ");
   //-Creates VTK file.
   std::vector<JFormatFiles2::StScalarData> fields;
-  fields.push_back(JFormatFiles2::DefineField("Idp"   ,JFormatFiles2::UInt32 ,1,idp));
+  fields.push_back(JFormatFiles2::DefineField("Idp"   ,IDP_FMTTYPE ,1,idp));
   fields.push_back(JFormatFiles2::DefineField("Vel"   ,JFormatFiles2::Float32,3,vel));
   fields.push_back(JFormatFiles2::DefineField("Rhop"  ,JFormatFiles2::Float32,1,rhop));
   fields.push_back(JFormatFiles2::DefineField("Type"  ,JFormatFiles2::UChar8 ,1,type));
@@ -1719,20 +1860,89 @@ tfloat3* JSph::GetPointerDataFloat3(unsigned n,const tdouble3* v)const{
 /// Stores files of particle data.
 /// Graba los ficheros de datos de particulas.
 //==============================================================================
-void JSph::SavePartData(unsigned npok,unsigned nout,const unsigned *idp,const tdouble3 *pos,const tfloat3 *vel,const float *rhop,unsigned ndom,const tdouble3 *vdom,const StInfoPartPlus *infoplus){
+void JSph::SavePartData(unsigned npok,unsigned nout,const typeidp *idp,const tdouble3 *pos,const tfloat3 *vel,const float *rhop,unsigned ndom,const tdouble3 *vdom,const StInfoPartPlus *infoplus){
+  //-Collects data of PART in a staging buffer (in background) or with external pointers.
+  //-Reune datos del PART en un buffer intermedio (en segundo plano) o con punteros externos.
+  JPartSaveBuf bufext;
+  JPartSaveBuf *buf=(PartSaveAsync? PartSaveAsync->GetFreeBuf(): &bufext);
+  TimerPart.Stop();
+  buf->Part=Part;
+  buf->TimeStep=TimeStep;
+  buf->Npok=npok;
+  buf->Nout=nout;
+  buf->Nstep=Nstep;
+  buf->RunTime=TimerPart.GetElapsedTimeD()/1000.;
+  buf->DomMin=vdom[0];
+  buf->DomMax=vdom[1];
+  buf->TotalNp=TotalNp;
+  buf->SymplecticDtPre=SymplecticDtPre;
+  buf->DemDtForce=DemDtForce;
+  if(infoplus && SvData&SDAT_Info){
+    buf->InfoPlus=true;
+    buf->InfoPlusData=*infoplus;
+    buf->DtMean=(!Nstep? 0: (TimeStep-TimeStepM1)/(Nstep-PartNstep));
+    buf->DtMin=(!Nstep? 0: PartDtMin);
+    buf->DtMax=(!Nstep? 0: PartDtMax);
+    if(DtFixed){ buf->DtErrorUse=true; buf->DtError=DtFixed->GetDtError(true); }
+  }
+  buf->Idp=idp; buf->Pos=pos; buf->Vel=vel; buf->Rhop=rhop;
+  if(DataOutBi4 && PartsOut->GetCount()){
+    buf->OutCount=PartsOut->GetCount();
+    buf->OutIdp=PartsOut->GetIdpOut();
+    buf->OutPos=PartsOut->GetPosOut();
+    buf->OutVel=PartsOut->GetVelOut();
+    buf->OutRhop=PartsOut->GetRhopOut();
+    buf->OutMotive=PartsOut->GetMotiveOut();
+  }
+  if(DataFloatBi4){
+    buf->FtCenter.resize(FtCount); buf->FtVel.resize(FtCount); buf->FtOmega.resize(FtCount);
+    for(unsigned cf=0;cf<FtCount;cf++){
+      buf->FtCenter[cf]=FtObjs[cf].center;
+      buf->FtVel[cf]=FtObjs[cf].fvel;
+      buf->FtOmega[cf]=FtObjs[cf].fomega;
+    }
+  }
+
+  //-Stores data files or sends the buffer to the writer thread.
+  //-Graba ficheros de datos o envia el buffer al hilo de escritura.
+  if(PartSaveAsync){
+    buf->CopyData();
+    PartSaveAsync->PushBuf(buf);
+  }
+  else SavePartBuf(*buf);
+
+  //-Empties stock of excluded particles.
+  //-Vacia almacen de particulas excluidas.
+  PartsOut->Clear();
+}
+
+//==============================================================================
+/// Stores files of particle data from a buffer. It is also called by the 
+/// writer thread of JPartSaveAsync, so only constant members can be used.
+///
+/// Graba los ficheros de datos de particulas de un buffer. Tambien se llama 
+/// desde el hilo de escritura de JPartSaveAsync, por lo que solo pueden usarse
+/// miembros constantes.
+//==============================================================================
+void JSph::SavePartBuf(const JPartSaveBuf &buf){
+  const unsigned npok=buf.Npok;
+  const typeidp *idp=buf.Idp;
+  const tdouble3 *pos=buf.Pos;
+  const tfloat3 *vel=buf.Vel;
+  const float *rhop=buf.Rhop;
   //-Stores particle data and/or information in bi4 format.
   //-Graba datos de particulas y/o informacion en formato bi4.
   if(DataBi4){
     tfloat3* posf3=NULL;
-    TimerPart.Stop();
-    JBinaryData* bdpart=DataBi4->AddPartInfo(Part,TimeStep,npok,nout,Nstep,TimerPart.GetElapsedTimeD()/1000.,vdom[0],vdom[1],TotalNp);
-    if(TStep==STEP_Symplectic)bdpart->SetvDouble("SymplecticDtPre",SymplecticDtPre);
-    if(UseDEM)bdpart->SetvDouble("DemDtForce",DemDtForce); //(DEM)
-    if(infoplus && SvData&SDAT_Info){
-      bdpart->SetvDouble("dtmean",(!Nstep? 0: (TimeStep-TimeStepM1)/(Nstep-PartNstep)));
-      bdpart->SetvDouble("dtmin",(!Nstep? 0: PartDtMin));
-      bdpart->SetvDouble("dtmax",(!Nstep? 0: PartDtMax));
-      if(DtFixed)bdpart->SetvDouble("dterror",DtFixed->GetDtError(true));
+    JBinaryData* bdpart=DataBi4->AddPartInfo(buf.Part,buf.TimeStep,npok,buf.Nout,buf.Nstep,buf.RunTime,buf.DomMin,buf.DomMax,buf.TotalNp);
+    if(TStep==STEP_Symplectic)bdpart->SetvDouble("SymplecticDtPre",buf.SymplecticDtPre);
+    if(UseDEM)bdpart->SetvDouble("DemDtForce",buf.DemDtForce); //(DEM)
+    if(buf.InfoPlus){
+      const StInfoPartPlus *infoplus=&buf.InfoPlusData;
+      bdpart->SetvDouble("dtmean",buf.DtMean);
+      bdpart->SetvDouble("dtmin",buf.DtMin);
+      bdpart->SetvDouble("dtmax",buf.DtMax);
+      if(buf.DtErrorUse)bdpart->SetvDouble("dterror",buf.DtError);
       bdpart->SetvDouble("timesim",infoplus->timesim);
       bdpart->SetvUint("nct",infoplus->nct);
       bdpart->SetvUint("npbin",infoplus->npbin);
@@ -1750,7 +1960,18 @@ void JSph::SavePartData(unsigned npok,unsigned nout,const unsigned *idp,const td
       }
     }
     if(SvData&SDAT_Binx){
-      if(SvDouble)DataBi4->AddPartData(npok,idp,pos,vel,rhop);
+      const int npart=buf.Part-PartIni;
+      const bool quant=(SvQuantPos>0 && npart>0 && (!SvQuantFull || npart%SvQuantFull!=0));
+      if(quant)DataBi4->AddPartDataQuant(npok,idp,pos,vel,rhop,SvQuantPos,SvQuantVel,SvQuantRhop);
+      else if(SvDelta){
+        const bool keyframe=(npart%SvDelta==0);
+        if(SvDouble)DataBi4->AddPartDataDelta(npok,idp,NULL,pos,vel,rhop,keyframe);
+        else{
+          posf3=GetPointerDataFloat3(npok,pos);
+          DataBi4->AddPartDataDelta(npok,idp,posf3,NULL,vel,rhop,keyframe);
+        }
+      }
+      else if(SvDouble)DataBi4->AddPartData(npok,idp,pos,vel,rhop);
       else{
         posf3=GetPointerDataFloat3(npok,pos);
         DataBi4->AddPartData(npok,idp,posf3,vel,rhop);
@@ -1774,44 +1995,58 @@ void JSph::SavePartData(unsigned npok,unsigned nout,const unsigned *idp,const td
     tfloat3* posf3=GetPointerDataFloat3(npok,pos);
     byte *type=new byte[npok];
     for(unsigned p=0;p<npok;p++){
-      const unsigned id=idp[p];
+      const typeidp id=idp[p];
       type[p]=(id>=CaseNbound? 3: (id<CaseNfixed? 0: (id<CaseNpb? 1: 2)));
     }
     //-Defines fields to be stored.
     JFormatFiles2::StScalarData fields[8];
     unsigned nfields=0;
-    if(idp){   fields[nfields]=JFormatFiles2::DefineField("Idp" ,JFormatFiles2::UInt32 ,1,idp);   nfields++; }
+    if(idp){   fields[nfields]=JFormatFiles2::DefineField("Idp" ,IDP_FMTTYPE ,1,idp);   nfields++; }
     if(vel){   fields[nfields]=JFormatFiles2::DefineField("Vel" ,JFormatFiles2::Float32,3,vel);   nfields++; }
     if(rhop){  fields[nfields]=JFormatFiles2::DefineField("Rhop",JFormatFiles2::Float32,1,rhop);  nfields++; }
     if(type){  fields[nfields]=JFormatFiles2::DefineField("Type",JFormatFiles2::UChar8 ,1,type);  nfields++; }
-    if(SvData&SDAT_Vtk)JFormatFiles2::SaveVtk(DirDataOut+fun::FileNameSec("PartVtk.vtk",Part),npok,posf3,nfields,fields);
-    if(SvData&SDAT_Csv)JFormatFiles2::SaveCsv(DirDataOut+fun::FileNameSec("PartCsv.csv",Part),CsvSepComa,npok,posf3,nfields,fields);
+    if(SvData&SDAT_Vtk){
+      if(SvVtu)JSaveVtu(JSaveVtu::TpEncoding(SvVtu),SvVtuCompress).SaveFile(DirDataOut+fun::FileNameSec("PartVtk.vtu",buf.Part),npok,posf3,nfields,fields);
+      else JFormatFiles2::SaveVtk(DirDataOut+fun::FileNameSec("PartVtk.vtk",buf.Part),npok,posf3,nfields,fields);
+    }
+    if(SvData&SDAT_Csv)jcsv::JSaveCsv2(DirDataOut+fun::FileNameSec("PartCsv.csv",buf.Part),false,CsvSepComa).SaveParticles(npok,posf3,nfields,fields);
     //-Deallocate of memory.
     delete[] posf3;
     delete[] type; 
   }
 
   //-Stores data of excluded particles.
-  if(DataOutBi4 && PartsOut->GetCount()){
-    DataOutBi4->SavePartOut(SvDouble,Part,TimeStep,PartsOut->GetCount(),PartsOut->GetIdpOut(),NULL,PartsOut->GetPosOut(),PartsOut->GetVelOut(),PartsOut->GetRhopOut(),PartsOut->GetMotiveOut());
+  if(DataOutBi4 && buf.OutCount){
+    DataOutBi4->SavePartOut(SvDouble,buf.Part,buf.TimeStep,buf.OutCount,buf.OutIdp,NULL,buf.OutPos,buf.OutVel,buf.OutRhop,buf.OutMotive);
   }
 
   //-Stores data of floating bodies.
   if(DataFloatBi4){
-    for(unsigned cf=0;cf<FtCount;cf++)DataFloatBi4->AddPartData(cf,FtObjs[cf].center,FtObjs[cf].fvel,FtObjs[cf].fomega);
-    DataFloatBi4->SavePartFloat(Part,TimeStep,(UseDEM? DemDtForce: 0));
+    for(unsigned cf=0;cf<FtCount;cf++)DataFloatBi4->AddPartData(cf,buf.FtCenter[cf],buf.FtVel[cf],buf.FtOmega[cf]);
+    DataFloatBi4->SavePartFloat(buf.Part,buf.TimeStep,(UseDEM? buf.DemDtForce: 0));
   }
+}
 
-  //-Empties stock of excluded particles.
-  //-Vacia almacen de particulas excluidas.
-  PartsOut->Clear();
+//==============================================================================
+/// Waits for the particle data and gauge results written in background and 
+/// shows statistics.
+/// Espera por los datos de particulas y resultados de medidas grabados en 
+/// segundo plano y muestra estadisticas.
+//==============================================================================
+void JSph::FinishSaveData(){
+  if(GaugeSystem)GaugeSystem->FinishResults();
+  if(PartSaveAsync){
+    PartSaveAsync->WaitAll();
+    const llong mem=PartSaveAsync->GetAllocMemory();
+    Log->Printf("Asynchronous output: %u parts with %u staging buffers (%.2f MB), max pending: %u, waits: %u (%.3f s).",PartSaveAsync->GetPartCount(),PartSaveAsync->GetDepth(),double(mem)/(1024*1024),PartSaveAsync->GetMaxPending(),PartSaveAsync->GetWaitCount(),PartSaveAsync->GetWaitTime());
+  }
 }
 
 //==============================================================================
 /// Generates data output files.
 /// Genera los ficheros de salida de datos.
 //==============================================================================
-void JSph::SaveData(unsigned npok,const unsigned *idp,const tdouble3 *pos,const tfloat3 *vel,const float *rhop
+void JSph::SaveData(unsigned npok,const typeidp *idp,const tdouble3 *pos,const tfloat3 *vel,const float *rhop
   ,unsigned ndom,const tdouble3 *vdom,const StInfoPartPlus *infoplus)
 {
   const char met[]="SaveData";
@@ -1824,6 +2059,9 @@ void JSph::SaveData(unsigned npok,const unsigned *idp,const tdouble3 *pos,const
   if(nout!=PartsOut->GetCount())RunException(met,"Excluded particles with unknown reason.");
   AddOutCount(noutpos,noutrhop,noutmove);
 
+  //-Stores data files of output regions using the same data when possible.
+  if(SaveRegions && idp && SaveRegions->CheckTime(TimeStep))SaveRegionsData(npok,idp,pos,vel,rhop);
+
   //-Stores data files of particles.
   SavePartData(npok,nout,idp,pos,vel,rhop,ndom,vdom,infoplus);
 
@@ -1879,6 +2117,127 @@ void JSph::SaveData(unsigned npok,const unsigned *idp,const tdouble3 *pos,const
   if(BoundCorr && BoundCorr->GetUseMotion())BoundCorr->SaveData(Part);  //<vs_innlet>
 }
 
+//==============================================================================
+/// Graba datos de particulas de las regiones de salida que lo requieran.
+/// Saves particle data of the output regions whose output time was reached.
+//==============================================================================
+void JSph::SaveRegionsData(unsigned npok,const typeidp *idp,const tdouble3 *pos,const tfloat3 *vel,const float *rhop){
+  TimerSim.Stop();
+  SaveRegions->SaveData(TimeStep,Nstep,TimerSim.GetElapsedTimeD()/1000.,npok,idp,pos,vel,rhop);
+}
+
+//==============================================================================
+/// Stores general state of the simulation in checkpoint data. It is called 
+/// after the PART (Part-1) is saved.
+///
+/// Guarda estado general de la simulacion en datos de checkpoint. Se llama 
+/// despues de grabar el PART (Part-1).
+//==============================================================================
+void JSph::CheckpointSaveState(JBinaryData *data)const{
+  //-The PART file of the checkpoint must be completely written.
+  if(PartSaveAsync)PartSaveAsync->WaitAll();
+  //-Configuration to check the restart.
+  data->SetvText("CaseName",CaseName);
+  data->SetvUllong("CaseNp",CaseNp);
+  data->SetvUint("FtCount",FtCount);
+  data->SetvInt("TStep",int(TStep));
+  data->SetvBool("Psingle",Psingle);
+  //-Counters of PARTs and steps.
+  data->SetvUint("PartBegin",unsigned(Part-1));
+  data->SetvInt("Part",Part);
+  data->SetvInt("Nstep",Nstep);
+  data->SetvInt("PartNstep",PartNstep);
+  data->SetvUint("PartOut",PartOut);
+  data->SetvUint("OutPosCount",OutPosCount);
+  data->SetvUint("OutRhopCount",OutRhopCount);
+  data->SetvUint("OutMoveCount",OutMoveCount);
+  data->SetvUllong("TotalNp",TotalNp);
+#ifdef IDP_SIZE8
+  data->SetvUllong("IdMax",IdMax);
+#else
+  data->SetvUint("IdMax",IdMax);
+#endif
+  data->SetvUint("DtModif",DtModif);
+  data->SetvUint("MaxParticles",MaxParticles);
+  data->SetvUint("MaxCells",MaxCells);
+  data->SetvLlong("MaxMemoryCpu",MaxMemoryCpu);
+  //-Times.
+  data->SetvDouble("TimeStep",TimeStep);
+  data->SetvDouble("TimeStepM1",TimeStepM1);
+  data->SetvDouble("TimePartNext",TimePartNext);
+  data->SetvDouble("LastDt",LastDt);
+  data->SetvDouble("PartDtMin",PartDtMin);
+  data->SetvDouble("PartDtMax",PartDtMax);
+  //-Time integration.
+  data->SetvInt("VerletStep",VerletStep);
+  data->SetvDouble("SymplecticDtPre",SymplecticDtPre);
+  data->SetvDouble("DemDtForce",DemDtForce);
+  //-Floating bodies (stored as raw memory).
+  if(FtCount)data->CreateArray("FtObjs",JBinaryDataDef::DatUchar,unsigned(sizeof(StFloatingData)*FtCount),FtObjs,true);
+  //-Objects with output counters.
+  if(GaugeSystem)GaugeSystem->SaveCheckpoint(data);
+  if(SteadyState)SteadyState->SaveCheckpoint(data);
+  if(SaveRegions)SaveRegions->SaveCheckpoint(data);
+}
+
+//==============================================================================
+/// Restores state of the time integration and floating bodies from checkpoint.
+/// It is called once the particles of the checkpoint are loaded.
+///
+/// Restaura el estado de la integracion temporal y de los floatings desde el
+/// checkpoint. Se llama una vez cargadas las particulas del checkpoint.
+//==============================================================================
+void JSph::CheckpointLoadState(){
+  const char met[]="CheckpointLoadState";
+  const JBinaryData *data=Checkpoint->GetData();
+  if(data->GetvText("CaseName")!=CaseName || data->GetvUllong("CaseNp")!=CaseNp || data->GetvUint("FtCount")!=FtCount)RunException(met,"The checkpoint does not match the case.",Checkpoint->GetFileIn());
+  if(TpStep(data->GetvInt("TStep"))!=TStep || data->GetvBool("Psingle")!=Psingle)RunException(met,"The checkpoint does not match the execution options (step algorithm and precision of positions).",Checkpoint->GetFileIn());
+  TimeStep=data->GetvDouble("TimeStep");
+  LastDt=data->GetvDouble("LastDt");
+  TotalNp=data->GetvUllong("TotalNp");
+#ifdef IDP_SIZE8
+  IdMax=data->GetvUllong("IdMax");
+#else
+  IdMax=data->GetvUint("IdMax");
+#endif
+  DtModif=data->GetvUint("DtModif");
+  OutPosCount=data->GetvUint("OutPosCount");
+  OutRhopCount=data->GetvUint("OutRhopCount");
+  OutMoveCount=data->GetvUint("OutMoveCount");
+  MaxParticles=std::max(MaxParticles,data->GetvUint("MaxParticles"));
+  MaxCells=std::max(MaxCells,data->GetvUint("MaxCells"));
+  MaxMemoryCpu=std::max(MaxMemoryCpu,data->GetvLlong("MaxMemoryCpu"));
+  VerletStep=data->GetvInt("VerletStep");
+  SymplecticDtPre=data->GetvDouble("SymplecticDtPre");
+  DemDtForce=data->GetvDouble("DemDtForce");
+  if(FtCount)Checkpoint->LoadArray("FtObjs",JBinaryDataDef::DatUchar,unsigned(sizeof(StFloatingData)*FtCount),FtObjs);
+}
+
+//==============================================================================
+/// Restores counters of PARTs and steps and output objects from checkpoint
+/// and frees the checkpoint. It is called after saving the initial PART.
+///
+/// Restaura contadores de PARTs y pasos y objetos de salida desde checkpoint
+/// y libera el checkpoint. Se llama despues de grabar el PART inicial.
+//==============================================================================
+void JSph::CheckpointLoadCounters(){
+  const char met[]="CheckpointLoadCounters";
+  const JBinaryData *data=Checkpoint->GetData();
+  if(data->GetvInt("Part")!=Part)RunException(met,"Number of PART does not match the checkpoint.",Checkpoint->GetFileIn());
+  Nstep=data->GetvInt("Nstep");
+  PartNstep=data->GetvInt("PartNstep");
+  PartOut=data->GetvUint("PartOut");
+  TimeStepM1=data->GetvDouble("TimeStepM1");
+  TimePartNext=data->GetvDouble("TimePartNext");
+  PartDtMin=data->GetvDouble("PartDtMin");
+  PartDtMax=data->GetvDouble("PartDtMax");
+  if(GaugeSystem)GaugeSystem->LoadCheckpoint(Checkpoint);
+  if(SteadyState)SteadyState->LoadCheckpoint(Checkpoint);
+  if(SaveRegions)SaveRegions->LoadCheckpoint(Checkpoint);
+  Log->Printf("Solver state restored from checkpoint (t:%g, nstep:%d).",TimeStep,Nstep);
+  delete Checkpoint; Checkpoint=NULL;
+}
+
 //==============================================================================
 /// Generates VTK file with domain of the particles.
 /// Genera fichero VTK con el dominio de las particulas.
@@ -2011,6 +2370,7 @@ void JSph::SaveRes(float tsim,float ttot,const std::string &headplus,const std::
 //==============================================================================
 void JSph::ShowResume(bool stop,float tsim,float ttot,bool all,std::string infoplus){
   Log->Printf("\n[Simulation %s  %s]",(stop? "INTERRUPTED": "finished"),fun::GetDateTime().c_str());
+  if(SteadyState && SteadyState->IsSteady())Log->Printf("Stop reason......................: %s",SteadyState->GetStopInfo().c_str());
   Log->Printf("Particles of simulation (initial): %u",CaseNp);
   if(NpDynamic)Log->Printf("Particles of simulation (total)..: %llu",TotalNp);
   if(all){
@@ -2137,7 +2497,7 @@ std::string JSph::TimerToText(const std::string &name,float value){
 /// Graba fichero VTK con datos de las particulas (degug).
 //==============================================================================
 void JSph::DgSaveVtkParticlesCpu(std::string filename,int numfile,unsigned pini,unsigned pfin
-  ,const tdouble3 *pos,const typecode *code,const unsigned *idp,const tfloat4 *velrhop
+  ,const tdouble3 *pos,const typecode *code,const typeidp *idp,const tfloat4 *velrhop
   ,const tfloat3 *ace)const
 {
   int mpirank=Log->GetMpiRank();
@@ -2170,7 +2530,7 @@ void JSph::DgSaveVtkParticlesCpu(std::string filename,int numfile,unsigned pini,
   //-Generates VTK file.
   JFormatFiles2::StScalarData fields[10];
   unsigned nfields=0;
-  if(idp){   fields[nfields]=JFormatFiles2::DefineField("Idp" ,JFormatFiles2::UInt32 ,1,idp+pini); nfields++; }
+  if(idp){   fields[nfields]=JFormatFiles2::DefineField("Idp" ,IDP_FMTTYPE ,1,idp+pini); nfields++; }
   if(xtype){ fields[nfields]=JFormatFiles2::DefineField("Type",JFormatFiles2::UChar8 ,1,xtype);    nfields++; }
   if(xkind){ fields[nfields]=JFormatFiles2::DefineField("Kind",JFormatFiles2::UChar8 ,1,xkind);    nfields++; }
   if(xvel){  fields[nfields]=JFormatFiles2::DefineField("Vel" ,JFormatFiles2::Float32,3,xvel);     nfields++; }
@@ -2191,7 +2551,7 @@ void JSph::DgSaveVtkParticlesCpu(std::string filename,int numfile,unsigned pini,
 /// Saves VTK file with particle data (degug).
 /// Graba fichero VTK con datos de las particulas (degug).
 //==============================================================================
-void JSph::DgSaveVtkParticlesCpu(std::string filename,int numfile,unsigned pini,unsigned pfin,const tfloat3 *pos,const byte *check,const unsigned *idp,const tfloat3 *vel,const float *rhop){
+void JSph::DgSaveVtkParticlesCpu(std::string filename,int numfile,unsigned pini,unsigned pfin,const tfloat3 *pos,const byte *check,const typeidp *idp,const tfloat3 *vel,const float *rhop){
   int mpirank=Log->GetMpiRank();
   if(mpirank>=0)filename=string("p")+fun::IntStr(mpirank)+"_"+filename;
   if(numfile>=0)filename=fun::FileNameSec(filename,numfile);
@@ -2203,7 +2563,7 @@ void JSph::DgSaveVtkParticlesCpu(std::string filename,int numfile,unsigned pini,
   //-Generates VTK file.
   JFormatFiles2::StScalarData fields[10];
   unsigned nfields=0;
-  if(idp){   fields[nfields]=JFormatFiles2::DefineField("Idp"  ,JFormatFiles2::UInt32 ,1,idp+pini);   nfields++; }
+  if(idp){   fields[nfields]=JFormatFiles2::DefineField("Idp"  ,IDP_FMTTYPE ,1,idp+pini);   nfields++; }
   if(vel){   fields[nfields]=JFormatFiles2::DefineField("Vel"  ,JFormatFiles2::Float32,3,vel+pini);   nfields++; }
   if(rhop){  fields[nfields]=JFormatFiles2::DefineField("Rhop" ,JFormatFiles2::Float32,1,rhop+pini);  nfields++; }
   if(check){ fields[nfields]=JFormatFiles2::DefineField("Check",JFormatFiles2::UChar8 ,1,check+pini); nfields++; }
@@ -2218,7 +2578,7 @@ void JSph::DgSaveVtkParticlesCpu(std::string filename,int numfile,unsigned pini,
 /// Saves CSV file with particle data (degug).
 /// Graba fichero CSV con datos de las particulas (degug).
 //==============================================================================
-void JSph::DgSaveCsvParticlesCpu(std::string filename,int numfile,unsigned pini,unsigned pfin,std::string head,const tfloat3 *pos,const unsigned *idp,const tfloat3 *vel,const float *rhop,const float *ar,const tfloat3 *ace,const tfloat3 *vcorr){
+void JSph::DgSaveCsvParticlesCpu(std::string filename,int numfile,unsigned pini,unsigned pfin,std::string head,const tfloat3 *pos,const typeidp *idp,const tfloat3 *vel,const float *rhop,const float *ar,const tfloat3 *ace,const tfloat3 *vcorr){
   const char met[]="DgSaveCsvParticlesCpu";
   int mpirank=Log->GetMpiRank();
   if(mpirank>=0)filename=string("p")+fun::IntStr(mpirank)+"_"+filename;
@@ -2242,7 +2602,7 @@ void JSph::DgSaveCsvParticlesCpu(std::string filename,int numfile,unsigned pini,
     const char fmt3[]="%f;%f;%f"; //="%24.16f;%24.16f;%24.16f";
     for(unsigned p=pini;p<pfin;p++){
       pf << fun::UintStr(p-pini);
-      if(idp)pf << ";" << fun::UintStr(idp[p]);
+      if(idp)pf << ";" << fun::UlongStr(idp[p]);
       if(pos)pf << ";" << fun::Float3Str(pos[p],fmt3);
       if(vel)pf << ";" << fun::Float3Str(vel[p],fmt3);
       if(rhop)pf << ";" << fun::FloatStr(rhop[p],fmt1);
@@ -21,6 +21,7 @@
 //:# =========
 //:# - El calculo de constantes en ConfigConstants() se hace usando double aunque
 //:#   despues se convierte a float (22-04-2013)
+//:# - IdMax y los arrays de Idp usan typeidp (64 bits con IDP_SIZE8). (18-10-2026)
 //:#############################################################################
 
 /// \file JSph.h \brief Declares the class \ref JSph.
@@ -33,6 +34,7 @@
 #include "JCfgRun.h"
 #include "JLog2.h"
 #include "JTimer.h"
+#include "JSphPlugin.h"
 #include <float.h>
 #include <string>
 #include <cmath>
@@ -47,6 +49,8 @@ class JPartData;
 class JPartPData;
 class JSphDtFixed;
 class JSaveDt;
+class JSphSteadyState;
+class JSphPlugins;
 class JSphVisco;
 class JWaveGen;
 class JMLPistons;   //<vs_mlapiston>
@@ -57,7 +61,12 @@ class JPartDataBi4;
 class JPartOutBi4Save;
 class JPartFloatBi4Save;
 class JPartsOut;
+class JPartSaveAsync;
+class JPartSaveBuf;
 class JDamping;
+class JSphSaveRegions;
+class JSphCheckpoint;
+class JBinaryData;
 class JXml;
 class JTimeOut;
 class JGaugeSystem;
@@ -81,6 +90,7 @@ class JSpaceEParms;
 
 class JSph : protected JObject
 {
+  friend class JPartSaveAsync;
 public:
 /// Structure with constants for the Cubic Spline kernel.
   typedef struct {
@@ -119,6 +129,7 @@ private:
   JPartOutBi4Save *DataOutBi4;      ///<To store excluded particles in bi4 format.      | Para grabar particulas excluidas en formato bi4.
   JPartFloatBi4Save *DataFloatBi4;  ///<To store floating data in bi4 format.           | Para grabar datos de floatings en formato bi4.
   JPartsOut *PartsOut;              ///<Stores excluded particles until they are saved. | Almacena las particulas excluidas hasta su grabacion.
+  JPartSaveAsync *PartSaveAsync;    ///<Writes particle data in background (-svasync).   | Graba datos de particulas en segundo plano.
 
   //-Total number of excluded particles according to reason for exclusion.
   //-Numero acumulado de particulas excluidas segun motivo.
@@ -192,6 +203,8 @@ protected:
   bool DtAllParticles;       ///<Velocity of particles used to calculate DT. 1:All, 0:Only fluid/floating (def=0).
   JSphDtFixed *DtFixed;
   JSaveDt *SaveDt;
+  JSphSteadyState *SteadyState;  ///<Detects the steady state to finish the simulation.
+  JSphPlugins *Plugins;          ///<Analysis plugins executed during the simulation.
 
   float PartsOutMax;         ///<Allowed percentage of fluid particles out of the domain. | Porcentaje maximo de particulas excluidas permitidas.                                  
   unsigned NpMinimum;        ///<Minimum number of particles allowed.                     | Numero minimo de particulas permitidas.                                                
@@ -204,6 +217,16 @@ protected:
   bool SvRes;                ///<Creates file with execution summary.                            | Graba fichero con resumen de ejecucion.
   bool SvTimers;             ///<Computes the time for each process.                             | Obtiene tiempo para cada proceso.
   bool SvDomainVtk;          ///<Stores VTK file with the domain of particles of each PART file. | Graba fichero vtk con el dominio de las particulas en cada Part. 
+  unsigned SvAsync;          ///<Number of staging buffers to write particle data in background (0:disabled). | Numero de buffers para grabar datos de particulas en segundo plano.
+  bool SvCompress;           ///<Compresses arrays of particles in bi4 files.                    | Comprime los arrays de particulas en ficheros bi4.
+  double SvQuantPos;         ///<Maximum absolute error of quantised positions in bi4 files (0:disabled). | Error absoluto maximo de posiciones cuantizadas en ficheros bi4.
+  double SvQuantVel;         ///<Maximum absolute error of quantised velocities in bi4 files.   | Error absoluto maximo de velocidades cuantizadas.
+  double SvQuantRhop;        ///<Maximum absolute error of quantised densities in bi4 files.    | Error absoluto maximo de densidades cuantizadas.
+  unsigned SvQuantFull;      ///<One of each SvQuantFull parts is stored without loss (0:only the first). | Uno de cada SvQuantFull parts se graba sin perdidas.
+  unsigned SvDelta;          ///<Parts are stored as differences with a keyframe each SvDelta parts (0:disabled). | Parts grabados como diferencias con un keyframe cada SvDelta parts.
+  unsigned SvCheckpoint;     ///<Saves checkpoint file each SvCheckpoint parts (0:disabled). | Graba fichero de checkpoint cada SvCheckpoint parts.
+  unsigned SvVtu;            ///<Stores VTK files of particles in VTU format (0:legacy VTK, 1:raw, 2:base64). | Graba ficheros VTK de particulas en formato VTU.
+  bool SvVtuCompress;        ///<Compresses data of VTU files.                                   | Comprime los datos de ficheros VTU.
 
   //-Constants for computation.
   float H,CteB,Gamma,CFLnumber,RhopZero;
@@ -278,6 +301,8 @@ protected:
 
   JDamping *Damping;            ///<Object for damping zones.
 
+  JSphSaveRegions *SaveRegions; ///<Object to save particles of output regions.
+
   JSphAccInput *AccInput;  ///<Object for variable acceleration functionality.
 
   JSphInOut *InOut;         ///<Object for inlet/outlet conditions.  //<vs_innlet> 
@@ -317,7 +342,7 @@ protected:
   bool NpDynamic;          ///<CaseNp can increase.
   bool ReuseIds;           ///<Id of particles excluded values ​​are reused.
   ullong TotalNp;          ///<Total number of simulated particles (no cuenta las particulas inlet no validas).
-  unsigned IdMax;          ///<It is the maximum Id used.
+  typeidp IdMax;           ///<It is the maximum Id used.
 
   //-Monitors dt value.
   unsigned DtModif;       ///<Number of modifications on  dt computed when it is too low. | Numero de modificaciones del dt calculado por ser demasiado bajo.         
@@ -351,6 +376,7 @@ protected:
   
   //-Execution variables.
   JPartsLoad4 *PartsLoaded;
+  JSphCheckpoint *Checkpoint;  ///<Checkpoint data to restart the simulation (-restart). | Datos de checkpoint para reanudar la simulacion.
   TpInterStep InterStep;
   int VerletStep;
   double SymplecticDtPre;  ///<Previous Dt to use with Symplectic.
@@ -366,7 +392,7 @@ protected:
   StDemData LoadDemData(bool basicdata,bool extradata,const JSpacePartBlock* block)const;
   void VisuDemCoefficients()const;
 
-  void LoadCodeParticles(unsigned np,const unsigned *idp,typecode *code)const;
+  void LoadCodeParticles(unsigned np,const typeidp *idp,typecode *code)const;
   void PrepareCfgDomainValues(tdouble3 &v,tdouble3 vdef=TDouble3(0))const;
   void ResizeMapLimits();
 
@@ -374,31 +400,38 @@ protected:
   void VisuConfig()const;
   void VisuParticleSummary()const;
   void LoadDcellParticles(unsigned n,const typecode *code,const tdouble3 *pos,unsigned *dcell)const;
-  void RunInitialize(unsigned np,unsigned npb,const tdouble3 *pos,const unsigned *idp,const typecode *code,tfloat4 *velrhop);
+  void RunInitialize(unsigned np,unsigned npb,const tdouble3 *pos,const typeidp *idp,const typecode *code,tfloat4 *velrhop);
   void CreatePartsInit(unsigned np,const tdouble3 *pos,const typecode *code);
   void FreePartsInit();
 
   void ConfigCellDivision();
   void SelecDomain(tuint3 celini,tuint3 celfin);
   static unsigned CalcCellCode(tuint3 ncells);
-  void CalcFloatingRadius(unsigned np,const tdouble3 *pos,const unsigned *idp);
+  void CalcFloatingRadius(unsigned np,const tdouble3 *pos,const typeidp *idp);
   tdouble3 UpdatePeriodicPos(tdouble3 ps)const;
 
   void RestartCheckData();
   void LoadCaseParticles();
-  void InitRun(unsigned np,const unsigned *idp,const tdouble3 *pos);
+  void InitRun(unsigned np,const typeidp *idp,const tdouble3 *pos);
+  JSphPlugin::StSetup GetPluginSetup()const;
 
   void PrintSizeNp(unsigned np,llong size)const;
   void PrintHeadPart();
 
   void ConfigSaveData(unsigned piece,unsigned pieces,std::string div);
-  void AddParticlesOut(unsigned nout,const unsigned *idp,const tdouble3 *pos,const tfloat3 *vel,const float *rhop,const typecode *code);
-  void AbortBoundOut(unsigned nout,const unsigned *idp,const tdouble3 *pos,const tfloat3 *vel,const float *rhop,const typecode *code);
+  void AddParticlesOut(unsigned nout,const typeidp *idp,const tdouble3 *pos,const tfloat3 *vel,const float *rhop,const typecode *code);
+  void AbortBoundOut(unsigned nout,const typeidp *idp,const tdouble3 *pos,const tfloat3 *vel,const float *rhop,const typecode *code);
 
   tfloat3* GetPointerDataFloat3(unsigned n,const tdouble3* v)const;
-  void SavePartData(unsigned npok,unsigned nout,const unsigned *idp,const tdouble3 *pos,const tfloat3 *vel,const float *rhop,unsigned ndom,const tdouble3 *vdom,const StInfoPartPlus *infoplus);
-  void SaveData(unsigned npok,const unsigned *idp,const tdouble3 *pos,const tfloat3 *vel,const float *rhop,unsigned ndom,const tdouble3 *vdom,const StInfoPartPlus *infoplus);
+  void SavePartData(unsigned npok,unsigned nout,const typeidp *idp,const tdouble3 *pos,const tfloat3 *vel,const float *rhop,unsigned ndom,const tdouble3 *vdom,const StInfoPartPlus *infoplus);
+  void SavePartBuf(const JPartSaveBuf &buf);
+  void FinishSaveData();
+  void SaveData(unsigned npok,const typeidp *idp,const tdouble3 *pos,const tfloat3 *vel,const float *rhop,unsigned ndom,const tdouble3 *vdom,const StInfoPartPlus *infoplus);
+  void SaveRegionsData(unsigned npok,const typeidp *idp,const tdouble3 *pos,const tfloat3 *vel,const float *rhop);
   void SaveDomainVtk(unsigned ndom,const tdouble3 *vdom)const;
+  void CheckpointSaveState(JBinaryData *data)const;
+  void CheckpointLoadState();
+  void CheckpointLoadCounters();
   void SaveInitialDomainVtk()const;
   unsigned SaveMapCellsVtkSize()const;
   void SaveMapCellsVtk(float scell)const;
@@ -428,9 +461,9 @@ public:
 //----------------------
 public:
   unsigned DgNum;
-  void DgSaveVtkParticlesCpu(std::string filename,int numfile,unsigned pini,unsigned pfin,const tdouble3 *pos,const typecode *code,const unsigned *idp,const tfloat4 *velrhop,const tfloat3 *ace=NULL)const;
-  void DgSaveVtkParticlesCpu(std::string filename,int numfile,unsigned pini,unsigned pfin,const tfloat3 *pos,const byte *check,const unsigned *idp,const tfloat3 *vel,const float *rhop);
-  void DgSaveCsvParticlesCpu(std::string filename,int numfile,unsigned pini,unsigned pfin,std::string head,const tfloat3 *pos,const unsigned *idp=NULL,const tfloat3 *vel=NULL,const float *rhop=NULL,const float *ar=NULL,const tfloat3 *ace=NULL,const tfloat3 *vcorr=NULL);
+  void DgSaveVtkParticlesCpu(std::string filename,int numfile,unsigned pini,unsigned pfin,const tdouble3 *pos,const typecode *code,const typeidp *idp,const tfloat4 *velrhop,const tfloat3 *ace=NULL)const;
+  void DgSaveVtkParticlesCpu(std::string filename,int numfile,unsigned pini,unsigned pfin,const tfloat3 *pos,const byte *check,const typeidp *idp,const tfloat3 *vel,const float *rhop);
+  void DgSaveCsvParticlesCpu(std::string filename,int numfile,unsigned pini,unsigned pfin,std::string head,const tfloat3 *pos,const typeidp *idp=NULL,const tfloat3 *vel=NULL,const float *rhop=NULL,const float *ar=NULL,const tfloat3 *ace=NULL,const tfloat3 *vcorr=NULL);
 };
 
 /*:
@@ -0,0 +1,124 @@
+//HEAD_DSPH
+/*
+ <DUALSPHYSICS>  Copyright (c) 2019 by Dr Jose M. Dominguez et al. (see http://dual.sphysics.org/index.php/developers/). 
+
+ EPHYSLAB Environmental Physics Laboratory, Universidade de Vigo, Ourense, Spain.
+ School of Mechanical, Aerospace and Civil Engineering, University of Manchester, Manchester, U.K.
+
+ This file is part of DualSPHysics. 
+
+ DualSPHysics is free software: you can redistribute it and/or modify it under the terms of the GNU Lesser General Public License 
+ as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) any later version.
+ 
+ DualSPHysics is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details. 
+
+ You should have received a copy of the GNU Lesser General Public License along with DualSPHysics. If not, see <http://www.gnu.org/licenses/>. 
+*/
+
+/// \file JSphCheckpoint.cpp \brief Implements the class \ref JSphCheckpoint.
+
+#include "JSphCheckpoint.h"
+#include "Functions.h"
+#include <cstdio>
+
+using std::string;
+
+//##############################################################################
+//# JSphCheckpoint
+//##############################################################################
+//==============================================================================
+/// Constructor.
+//==============================================================================
+JSphCheckpoint::JSphCheckpoint(){
+  ClassName="JSphCheckpoint";
+  Data=NULL;
+  Reset();
+}
+
+//==============================================================================
+/// Destructor.
+//==============================================================================
+JSphCheckpoint::~JSphCheckpoint(){
+  DestructorActive=true;
+  Reset();
+}
+
+//==============================================================================
+/// Initialisation of variables.
+//==============================================================================
+void JSphCheckpoint::Reset(){
+  delete Data; Data=NULL;
+  FileIn="";
+}
+
+//==============================================================================
+/// Creates empty data to store a new checkpoint and returns it.
+/// Crea datos vacios para grabar un nuevo checkpoint y los devuelve.
+//==============================================================================
+JBinaryData* JSphCheckpoint::InitData(){
+  Reset();
+  Data=new JBinaryData(ClassName);
+  Data->SetvUint("FmtVersion",FmtVersion);
+  return(Data);
+}
+
+//==============================================================================
+/// Saves checkpoint file. The data is written in a temporary file that then 
+/// replaces the previous checkpoint, so a valid file always exists although 
+/// the execution is stopped during writing.
+///
+/// Graba fichero de checkpoint. Los datos se escriben en un fichero temporal
+/// que despues sustituye al checkpoint anterior, de forma que siempre existe
+/// un fichero valido aunque la ejecucion se detenga durante la grabacion.
+//==============================================================================
+void JSphCheckpoint::SaveFile(const std::string &dir){
+  const char met[]="SaveFile";
+  if(!Data)RunException(met,"There is no data to save.");
+  const string file=fun::GetDirWithSlash(dir)+GetFileName();
+  const string filetmp=file+".tmp";
+  Data->SaveFile(filetmp,false,true);
+ #ifdef WIN32
+  if(fun::FileExists(file))remove(file.c_str());
+ #endif
+  if(rename(filetmp.c_str(),file.c_str()))RunException(met,"Cannot replace the checkpoint file.",file);
+}
+
+//==============================================================================
+/// Loads checkpoint file. Arrays are read on demand with LoadArray().
+/// Carga fichero de checkpoint. Los arrays se leen bajo demanda con LoadArray().
+//==============================================================================
+void JSphCheckpoint::LoadFile(const std::string &dir){
+  const char met[]="LoadFile";
+  Reset();
+  FileIn=fun::GetDirWithSlash(dir)+GetFileName();
+  if(!fun::FileExists(FileIn))RunException(met,"Checkpoint file was not found.",FileIn);
+  Data=new JBinaryData(ClassName);
+  Data->OpenFileStructure(FileIn,ClassName);
+  if(Data->GetvUint("FmtVersion")!=FmtVersion)RunException(met,"Format version of checkpoint file is invalid.",FileIn);
+}
+
+//==============================================================================
+/// Returns the subitem of item with data of the indicated object or throws 
+/// exception.
+/// Devuelve el subitem de item con datos del objeto indicado o genera excepcion.
+//==============================================================================
+JBinaryData* JSphCheckpoint::GetItem(JBinaryData *item,const std::string &name)const{
+  JBinaryData *ite=(item? item->GetItem(name): NULL);
+  if(!ite)RunException("GetItem",fun::PrintStr("Data of '%s' is missing.",name.c_str()),FileIn);
+  return(ite);
+}
+
+//==============================================================================
+/// Loads data of array of item checking type and number of values.
+/// Carga datos de array de item comprobando tipo y numero de valores.
+//==============================================================================
+void JSphCheckpoint::LoadArray(JBinaryData *item,const std::string &name,JBinaryDataDef::TpData type,unsigned count,void *ptr)const{
+  const char met[]="LoadArray";
+  JBinaryDataArray *ar=(item? item->GetArray(name): NULL);
+  if(!ar)RunException(met,fun::PrintStr("Array '%s' is missing.",name.c_str()),FileIn);
+  if(ar->GetType()!=type)RunException(met,fun::PrintStr("Type of array '%s' is invalid.",name.c_str()),FileIn);
+  const unsigned n=(ar->DataInPointer()? ar->GetCount(): ar->GetFileDataCount());
+  if(n!=count)RunException(met,fun::PrintStr("Size of array '%s' is invalid.",name.c_str()),FileIn);
+  if(count && ar->GetDataCopy(count,ptr)!=count)RunException(met,fun::PrintStr("Array '%s' could not be loaded.",name.c_str()),FileIn);
+}
@@ -0,0 +1,73 @@
+//HEAD_DSPH
+/*
+ <DUALSPHYSICS>  Copyright (c) 2019 by Dr Jose M. Dominguez et al. (see http://dual.sphysics.org/index.php/developers/). 
+
+ EPHYSLAB Environmental Physics Laboratory, Universidade de Vigo, Ourense, Spain.
+ School of Mechanical, Aerospace and Civil Engineering, University of Manchester, Manchester, U.K.
+
+ This file is part of DualSPHysics. 
+
+ DualSPHysics is free software: you can redistribute it and/or modify it under the terms of the GNU Lesser General Public License 
+ as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) any later version.
+ 
+ DualSPHysics is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details. 
+
+ You should have received a copy of the GNU Lesser General Public License along with DualSPHysics. If not, see <http://www.gnu.org/licenses/>. 
+*/
+
+//:#############################################################################
+//:# Cambios:
+//:# =========
+//:# - Clase para grabar y cargar ficheros de checkpoint con el estado completo
+//:#   del solver (particulas en el orden interno, Verlet, floatings, contadores
+//:#   de salida...) para reanudar la simulacion con resultados identicos bit a
+//:#   bit. (18-10-2026)
+//:#############################################################################
+
+/// \file JSphCheckpoint.h \brief Declares the class \ref JSphCheckpoint.
+
+#ifndef _JSphCheckpoint_
+#define _JSphCheckpoint_
+
+#include <string>
+#include "JObject.h"
+#include "JBinaryData.h"
+
+//##############################################################################
+//# JSphCheckpoint
+//##############################################################################
+/// \brief Saves and loads checkpoint files with the full state of the solver.
+/// The file is only valid to restart the same case with the same binary since
+/// some data (e.g. floating objects) is stored as raw memory.
+
+class JSphCheckpoint : protected JObject
+{
+protected:
+  static const unsigned FmtVersion=1;  ///<Version of file format.
+  JBinaryData *Data;    ///<Data of checkpoint. | Datos del checkpoint.
+  std::string FileIn;   ///<Loaded file. | Fichero cargado.
+
+public:
+  JSphCheckpoint();
+  ~JSphCheckpoint();
+  void Reset();
+
+  static std::string GetFileName(){ return("Checkpoint.bi4"); }
+
+  JBinaryData* InitData();
+  JBinaryData* GetData()const{ return(Data); }
+  void SaveFile(const std::string &dir);
+  void LoadFile(const std::string &dir);
+  std::string GetFileIn()const{ return(FileIn); }
+
+  unsigned GetPartBegin()const{ return(Data->GetvUint("PartBegin")); }
+  JBinaryData* GetItem(JBinaryData *item,const std::string &name)const;
+  JBinaryData* GetItem(const std::string &name)const{ return(GetItem(Data,name)); }
+  void LoadArray(JBinaryData *item,const std::string &name,JBinaryDataDef::TpData type,unsigned count,void *ptr)const;
+  void LoadArray(const std::string &name,JBinaryDataDef::TpData type,unsigned count,void *ptr)const{ LoadArray(Data,name,type,count,ptr); }
+};
+
+#endif
+
+
@@ -32,6 +32,7 @@
 #include "JDamping.h"
 #include "JXml.h"
 #include "JSaveDt.h"
+#include "JSphSteadyState.h"
 #include "JTimeOut.h"
 #include "JSphAccInput.h"
 #include "JGaugeSystem.h"
@@ -68,6 +69,9 @@ JSphCpu::~JSphCpu(){
 void JSphCpu::InitVars(){
   RunMode="";
   OmpThreads=1;
+  CompactMem=false;
+  MemBudget=0; MemBudgetUser=false;
+  HugePages=HPAGES_None;
 
   Np=Npb=NpbOk=0;
   NpbPer=NpfPer=0;
@@ -75,12 +79,14 @@ void JSphCpu::InitVars(){
   Idpc=NULL; Codec=NULL; Dcellc=NULL; Posc=NULL; Velrhopc=NULL;
   VelrhopM1c=NULL;                //-Verlet
   PosPrec=NULL; VelrhopPrec=NULL; //-Symplectic
+  PosPreMovc=NULL;                //-Symplectic with CompactMem.
   PsPosc=NULL;                    //-Interaccion Pos-Single.
   SpsTauc=NULL; SpsGradvelc=NULL; //-Laminar+SPS. 
   Arc=NULL; Acec=NULL; Deltac=NULL;
   ShiftPosc=NULL; ShiftDetectc=NULL; //-Shifting.
   Pressc=NULL;
   RidpMove=NULL; 
+  RidpBound=NULL;
   FtRidp=NULL;
   FtoForces=NULL;
   FtoForcesRes=NULL;
@@ -96,6 +102,7 @@ void JSphCpu::InitVars(){
 void JSphCpu::FreeCpuMemoryFixed(){
   MemCpuFixed=0;
   delete[] RidpMove;     RidpMove=NULL;
+  delete[] RidpBound;    RidpBound=NULL;
   delete[] FtRidp;       FtRidp=NULL;
   delete[] FtoForces;    FtoForces=NULL;
   delete[] FtoForcesRes; FtoForcesRes=NULL;
@@ -129,6 +136,7 @@ void JSphCpu::AllocCpuMemoryFixed(){
 //==============================================================================
 void JSphCpu::FreeCpuMemoryParticles(){
   CpuParticlesSize=0;
+  CpuParticlesCapacity=0;
   MemCpuParticles=0;
   ArraysCpu->Reset();
 }
@@ -144,13 +152,17 @@ void JSphCpu::AllocCpuMemoryParticles(unsigned np,float over){
   const unsigned np2=(over>0? unsigned(over*np): np);
   CpuParticlesSize=np2+PARTICLES_OVERMEMORY_MIN;
   //-Define number or arrays to use. | Establece numero de arrays a usar.
-  ArraysCpu->SetArraySize(CpuParticlesSize);
   #ifdef CODE_SIZE4
     ArraysCpu->AddArrayCount(JArraysCpu::SIZE_4B,2);  //-code,code2
   #else
     ArraysCpu->AddArrayCount(JArraysCpu::SIZE_2B,2);  //-code,code2
   #endif
-  ArraysCpu->AddArrayCount(JArraysCpu::SIZE_4B,5);  //-idp,ar,viscdt,dcell,prrhop
+  #ifdef IDP_SIZE8
+    ArraysCpu->AddArrayCount(JArraysCpu::SIZE_8B,2);  //-idp,idp2
+    ArraysCpu->AddArrayCount(JArraysCpu::SIZE_4B,4);  //-ar,viscdt,dcell,prrhop
+  #else
+    ArraysCpu->AddArrayCount(JArraysCpu::SIZE_4B,5);  //-idp,ar,viscdt,dcell,prrhop
+  #endif
   if(TDeltaSph==DELTA_DynamicExt)ArraysCpu->AddArrayCount(JArraysCpu::SIZE_4B,1);  //-delta
   ArraysCpu->AddArrayCount(JArraysCpu::SIZE_12B,1); //-ace
   ArraysCpu->AddArrayCount(JArraysCpu::SIZE_16B,1); //-velrhop
@@ -160,7 +172,8 @@ void JSphCpu::AllocCpuMemoryParticles(unsigned np,float over){
     ArraysCpu->AddArrayCount(JArraysCpu::SIZE_16B,1); //-velrhopm1
   }
   else if(TStep==STEP_Symplectic){
-    ArraysCpu->AddArrayCount(JArraysCpu::SIZE_24B,1); //-pospre
+    if(CompactMem)ArraysCpu->AddArrayCount(JArraysCpu::SIZE_12B,1); //-pospremov
+    else ArraysCpu->AddArrayCount(JArraysCpu::SIZE_24B,1); //-pospre
     ArraysCpu->AddArrayCount(JArraysCpu::SIZE_16B,1); //-velrhoppre
   }
   if(TVisco==VISCO_LaminarSPS){     
@@ -172,18 +185,38 @@ void JSphCpu::AllocCpuMemoryParticles(unsigned np,float over){
   if(InOut){  //<vs_innlet_ini>
     ArraysCpu->AddArrayCount(JArraysCpu::SIZE_4B,1);  //-InOutPart
   }  //<vs_innlet_end>
+  //-Reserves virtual memory according to memory budget to grow arrays in place (includes buffers of JCellDivCpu). | Reserva memoria virtual segun presupuesto para crecer sin copiar (incluye buffers de JCellDivCpu).
+  const unsigned bytespart=ArraysCpu->GetBytesPerElement()+JCellDivCpu::GetBytesPerParticle();
+  const llong npbudget=(MemBudget>MemCpuFixed? (MemBudget-MemCpuFixed)/bytespart: 0);
+  if(MemBudgetUser && CpuParticlesSize>npbudget)RunException(met,fun::PrintStr("The memory budget (%.1f MB) is not enough for %u particles.",double(MemBudget)/(1024*1024),CpuParticlesSize));
+  ArraysCpu->SetReserveSize(unsigned(min(npbudget,llong(UINT_MAX))));
+  //-Allocates arrays. | Asigna arrays.
+  ArraysCpu->SetArraySize(CpuParticlesSize);
+  CpuParticlesCapacity=max(CpuParticlesSize,unsigned(min(npbudget,llong(UINT_MAX))));
   //-Shows the allocated memory.
   MemCpuParticles=ArraysCpu->GetAllocMemoryCpu();
   PrintSizeNp(CpuParticlesSize,MemCpuParticles);
+  Log->Printf("**Memory per particle: %u bytes%s.",unsigned(MemCpuParticles/CpuParticlesSize),(CompactMem? " (CompactMem)": ""));
 }
 
 //==============================================================================
 /// Resizes space in CPU memory for particles.
 //==============================================================================
 void JSphCpu::ResizeCpuMemoryParticles(unsigned npnew){
+  const char met[]="ResizeCpuMemoryParticles";
   npnew=npnew+PARTICLES_OVERMEMORY_MIN;
+  const double mbparticle=(double(MemCpuParticles)/(1024*1024))/CpuParticlesSize; //-MB por particula.
+  //-Resizes arrays in place when reserved memory is enough (data are kept). | Redimensiona arrays sin copiar cuando hay memoria reservada suficiente.
+  if(ArraysCpu->CheckResizeInPlace(npnew)){
+    Log->Printf("**JSphCpu: Resizing in place cpu memory for %u particles: %.1f MB.",npnew,mbparticle*npnew);
+    ArraysCpu->SetArraySize(npnew);
+    CpuParticlesSize=npnew;
+    MemCpuParticles=ArraysCpu->GetAllocMemoryCpu();
+    return;
+  }
+  if(MemBudgetUser)RunException(met,fun::PrintStr("The memory budget (%.1f MB) is not enough for %u particles.",double(MemBudget)/(1024*1024),npnew));
   //-Saves current data from CPU.
-  unsigned    *idp       =SaveArrayCpu(Np,Idpc);
+  typeidp    *idp       =SaveArrayCpu(Np,Idpc);
   typecode    *code      =SaveArrayCpu(Np,Codec);
   unsigned    *dcell     =SaveArrayCpu(Np,Dcellc);
   tdouble3    *pos       =SaveArrayCpu(Np,Posc);
@@ -191,6 +224,7 @@ void JSphCpu::ResizeCpuMemoryParticles(unsigned npnew){
   tfloat4     *velrhopm1 =SaveArrayCpu(Np,VelrhopM1c);
   tdouble3    *pospre    =SaveArrayCpu(Np,PosPrec);
   tfloat4     *velrhoppre=SaveArrayCpu(Np,VelrhopPrec);
+  tfloat3     *pospremov=SaveArrayCpu(Np,PosPreMovc);
   tsymatrix3f *spstau    =SaveArrayCpu(Np,SpsTauc);
   int         *inoutpart =SaveArrayCpu(Np,InOutPartc);  //<vs_innlet>
   //-Frees pointers.
@@ -202,14 +236,14 @@ void JSphCpu::ResizeCpuMemoryParticles(unsigned npnew){
   ArraysCpu->Free(VelrhopM1c);
   ArraysCpu->Free(PosPrec);
   ArraysCpu->Free(VelrhopPrec);
+  ArraysCpu->Free(PosPreMovc);
   ArraysCpu->Free(SpsTauc);
   ArraysCpu->Free(InOutPartc);  //<vs_innlet>
   //-Resizes CPU memory allocation.
-  const double mbparticle=(double(MemCpuParticles)/(1024*1024))/CpuParticlesSize; //-MB por particula.
   Log->Printf("**JSphCpu: Requesting cpu memory for %u particles: %.1f MB.",npnew,mbparticle*npnew);
   ArraysCpu->SetArraySize(npnew);
   //-Reserve pointers.
-  Idpc    =ArraysCpu->ReserveUint();
+  Idpc    =ArraysCpu->ReserveTypeIdp();
   Codec   =ArraysCpu->ReserveTypeCode();
   Dcellc  =ArraysCpu->ReserveUint();
   Posc    =ArraysCpu->ReserveDouble3();
@@ -217,6 +251,7 @@ void JSphCpu::ResizeCpuMemoryParticles(unsigned npnew){
   if(velrhopm1) VelrhopM1c =ArraysCpu->ReserveFloat4();
   if(pospre)    PosPrec    =ArraysCpu->ReserveDouble3();
   if(velrhoppre)VelrhopPrec=ArraysCpu->ReserveFloat4();
+  if(pospremov)PosPreMovc =ArraysCpu->ReserveFloat3();
   if(spstau)    SpsTauc    =ArraysCpu->ReserveSymatrix3f();
   if(inoutpart) InOutPartc =ArraysCpu->ReserveInt();  //<vs_innlet>
   //-Restore data in CPU memory.
@@ -228,6 +263,7 @@ void JSphCpu::ResizeCpuMemoryParticles(unsigned npnew){
   RestoreArrayCpu(Np,velrhopm1,VelrhopM1c);
   RestoreArrayCpu(Np,pospre,PosPrec);
   RestoreArrayCpu(Np,velrhoppre,VelrhopPrec);
+  RestoreArrayCpu(Np,pospremov,PosPreMovc);
   RestoreArrayCpu(Np,spstau,SpsTauc);
   RestoreArrayCpu(Np,inoutpart,InOutPartc);  //<vs_innlet>
   //-Updates values.
@@ -265,7 +301,7 @@ template<class T> void JSphCpu::TRestoreArrayCpu(unsigned np,T *data,T *datanew)
 /// Arrays para datos basicos de las particulas. 
 //==============================================================================
 void JSphCpu::ReserveBasicArraysCpu(){
-  Idpc=ArraysCpu->ReserveUint();
+  Idpc=ArraysCpu->ReserveTypeIdp();
   Codec=ArraysCpu->ReserveTypeCode();
   Dcellc=ArraysCpu->ReserveUint();
   Posc=ArraysCpu->ReserveDouble3();
@@ -296,6 +332,19 @@ llong JSphCpu::GetAllocMemoryCpu()const{
 //==============================================================================
 void JSphCpu::PrintAllocMemory(llong mcpu)const{
   Log->Printf("Allocated memory in CPU: %lld (%.2f MB)",mcpu,double(mcpu)/(1024*1024));
+  if(HugePages)PrintHugePagesUsage();
+}
+
+//==============================================================================
+/// Shows memory of the process obtained in huge pages.
+/// Muestra la memoria del proceso obtenida en huge pages.
+//==============================================================================
+void JSphCpu::PrintHugePagesUsage()const{
+  llong thp,htlb;
+  JArraysCpu::GetHugePagesUsage(thp,htlb);
+  const double mb=1024*1024;
+  if(thp<0 && htlb<0)Log->Printf("Huge pages (%s): usage is not available.",GetNameHugePages(HugePages));
+  else Log->Printf("Huge pages (%s): transparent %.2f MB, explicit %.2f MB.",GetNameHugePages(HugePages),(thp>0? double(thp)/mb: 0),(htlb>0? double(htlb)/mb: 0));
 }
 
 //==============================================================================
@@ -308,13 +357,13 @@ void JSphCpu::PrintAllocMemory(llong mcpu)const{
 /// - onlynormal: Solo se queda con las normales, elimina las particulas periodicas.
 //==============================================================================
 unsigned JSphCpu::GetParticlesData(unsigned n,unsigned pini,bool onlynormal
-  ,unsigned *idp,tdouble3 *pos,tfloat3 *vel,float *rhop,typecode *code)
+  ,typeidp *idp,tdouble3 *pos,tfloat3 *vel,float *rhop,typecode *code)
 {
   const char met[]="GetParticlesData";
   unsigned num=n;
   //-Copy selected values.
   if(code)memcpy(code,Codec+pini,sizeof(typecode)*n);
-  if(idp)memcpy(idp,Idpc+pini,sizeof(unsigned)*n);
+  if(idp)memcpy(idp,Idpc+pini,sizeof(typeidp)*n);
   if(pos)memcpy(pos,Posc+pini,sizeof(tdouble3)*n);
   if(vel && rhop){
     for(unsigned p=0;p<n;p++){
@@ -377,6 +426,60 @@ void JSphCpu::ConfigOmp(const JCfgRun *cfg){
 #endif
 }
 
+//==============================================================================
+/// Configures compact storage of particle data (-compactmem). It is only 
+/// applied with Symplectic and without floating bodies or symmetry, since 
+/// position of predictor is recovered from the current position.
+///
+/// Configura almacenamiento compacto de datos de particulas (-compactmem).
+//==============================================================================
+void JSphCpu::ConfigCompactMem(const JCfgRun *cfg){
+  CompactMem=false;
+  if(cfg->CompactMem){
+    if(TStep!=STEP_Symplectic)Log->PrintWarning("CompactMem is only applied with Symplectic time step algorithm.");
+    else if(CaseNfloat)Log->PrintWarning("CompactMem is not applied with floating bodies.");
+    else if(Symmetry)Log->PrintWarning("CompactMem is not applied with symmetry.");  //<vs_syymmetry>
+    else CompactMem=true;
+  }
+}
+
+//==============================================================================
+/// Configures memory budget for particle arrays (-membudget). Virtual memory
+/// is reserved to grow arrays without copying data only when the budget is
+/// defined. Also configures the use of huge pages (-hugepages).
+///
+/// Configura presupuesto de memoria para arrays de particulas (-membudget) y
+/// uso de huge pages (-hugepages).
+//==============================================================================
+void JSphCpu::ConfigMemBudget(const JCfgRun *cfg){
+  HugePages=cfg->HugePages;
+  ArraysCpu->SetHugePages(HugePages);
+  MemBudget=0; MemBudgetUser=false;
+  if(cfg->MemBudget>0){
+    MemBudget=llong(cfg->MemBudget)*1024*1024;
+    MemBudgetUser=true;
+  }
+}
+
+//==============================================================================
+/// Shows memory planning: bytes per particle, estimated peak of particles and
+/// capacity available in reserved memory.
+///
+/// Muestra la planificacion de memoria.
+//==============================================================================
+void JSphCpu::VisuMemoryPlan(ullong npestimated)const{
+  const unsigned bytespart=ArraysCpu->GetBytesPerElement()+JCellDivCpu::GetBytesPerParticle();
+  const double mb=1024*1024;
+  Log->Printf("Memory planner: %u bytes per particle, estimated peak of %llu particles (%.1f MB).",bytespart,npestimated,double(npestimated*bytespart)/mb);
+  if(CpuParticlesCapacity>CpuParticlesSize){
+    Log->Printf("  Memory budget: %.1f MB for up to %u particles without copying arrays.",double(MemBudget)/mb,CpuParticlesCapacity);
+  }
+  else Log->Print("  Memory budget: none, arrays are copied when they grow.");
+  if(npestimated>CpuParticlesCapacity && (MemBudgetUser || CpuParticlesCapacity>CpuParticlesSize)){
+    Log->PrintfWarning("The estimated peak of particles (%llu) exceeds the memory budget (%u particles).",npestimated,CpuParticlesCapacity);
+  }
+}
+
 //==============================================================================
 /// Configures execution mode in CPU.
 /// Configura modo de ejecucion en CPU.
@@ -393,6 +496,7 @@ void JSphCpu::ConfigRunMode(const JCfgRun *cfg,std::string preinfo){
   else RunMode=string("OpenMP(Threads:")+fun::IntStr(OmpThreads)+")";
   if(!preinfo.empty())RunMode=preinfo+" - "+RunMode;
   if(Stable)RunMode=string("Stable - ")+RunMode;
+  if(CompactMem)RunMode=string("CompactMem - ")+RunMode;
   if(Psingle)RunMode=string("Pos-Single - ")+RunMode;
   else RunMode=string("Pos-Double - ")+RunMode;
   Log->Print(" ");
@@ -407,6 +511,17 @@ void JSphCpu::ConfigRunMode(const JCfgRun *cfg,std::string preinfo){
 void JSphCpu::InitRunCpu(){
   InitRun(Np,Idpc,Posc);
 
+  //-Allocates index of boundary particles for mk-filtered loops of force and pressure gauges.
+  if(GaugeSystem->GetCountType(JGaugeItem::GAUGE_Force) || GaugeSystem->GetCountType(JGaugeItem::GAUGE_Pressure)){
+    try{
+      RidpBound=new unsigned[CaseNpb];  MemCpuFixed+=(sizeof(unsigned)*CaseNpb);
+    }
+    catch(const std::bad_alloc){
+      RunException("InitRunCpu","Could not allocate the requested memory.");
+    }
+    CalcRidp(PeriActive!=0,NpbOk,0,0,CaseNpb,Codec,Idpc,RidpBound);
+  }
+
   if(TStep==STEP_Verlet)memcpy(VelrhopM1c,Velrhopc,sizeof(tfloat4)*Np);
   if(TVisco==VISCO_LaminarSPS)memset(SpsTauc,0,sizeof(tsymatrix3f)*Np);
   if(CaseNfloat)InitFloating();
@@ -581,6 +696,59 @@ float JSphCpu::CalcVelMaxOmp(unsigned np,const tfloat4* velrhop)const{
   return(velmax);
 }
 
+//==============================================================================
+/// Computes kinetic energy and maximum velocity of normal fluid particles
+/// (periodic duplicates are excluded).
+///
+/// Calcula la energia cinetica y la velocidad maxima de las particulas de 
+/// fluido normales (se excluyen las duplicadas periodicas).
+//==============================================================================
+void JSphCpu::CalcKinEnergy(unsigned n,unsigned pini,const tfloat4 *velrhop,const typecode *code
+  ,double &kinenergy,double &velmax)const
+{
+  const int pfin=int(pini+n);
+  double ekin=0;
+  float vmax=0;
+  #ifdef OMP_USE
+    #pragma omp parallel if(n>OMP_LIMIT_COMPUTELIGHT)
+  #endif
+  {
+    double ekin2=0;
+    float vmax2=0;
+    #ifdef OMP_USE
+      #pragma omp for nowait
+    #endif
+    for(int p=int(pini);p<pfin;p++)if(CODE_IsNormal(code[p]) && CODE_IsFluid(code[p])){
+      const tfloat4 v=velrhop[p];
+      const float v2=v.x*v.x+v.y*v.y+v.z*v.z;
+      ekin2+=v2;
+      if(vmax2<v2)vmax2=v2;
+    }
+    #ifdef OMP_USE
+      #pragma omp critical 
+    #endif
+    {
+      ekin+=ekin2;
+      if(vmax<vmax2)vmax=vmax2;
+    }
+  }
+  kinenergy=ekin*MassFluid*0.5;
+  velmax=sqrt(vmax);
+}
+
+//==============================================================================
+/// Adds monitored values of current PART to SteadyState and returns true 
+/// when the steady state is reached.
+///
+/// Agrega valores monitorizados del PART actual a SteadyState y devuelve true
+/// cuando se alcanza el estado estacionario.
+//==============================================================================
+bool JSphCpu::CheckSteadyState(){
+  double kinenergy=0,velmax=0;
+  if(SteadyState->GetUseKinEnergy() || SteadyState->GetUseVelMax())CalcKinEnergy(Np-Npb,Npb,Velrhopc,Codec,kinenergy,velmax);
+  return(SteadyState->AddValues(TimeStep,kinenergy,velmax,GaugeSystem));
+}
+
 //==============================================================================
 /// Free memory assigned to ArraysCpu.
 /// Libera memoria asignada de ArraysCpu.
@@ -792,7 +960,7 @@ void JSphCpu::GetInteractionCells(const tdouble3 &pos
 template<bool psingle,TpKernel tker,TpFtMode ftmode> void JSphCpu::InteractionForcesBound
   (unsigned n,unsigned pinit,tint4 nc,int hdiv,unsigned cellinitial
   ,const unsigned *beginendcell,tint3 cellzero,const unsigned *dcell
-  ,const tdouble3 *pos,const tfloat3 *pspos,const tfloat4 *velrhop,const typecode *code,const unsigned *idp
+  ,const tdouble3 *pos,const tfloat3 *pspos,const tfloat4 *velrhop,const typecode *code,const typeidp *idp
   ,float &viscdt,float *ar)const
 {
   //-Initialize viscth to calculate max viscdt with OpenMP. | Inicializa viscth para calcular visdt maximo con OpenMP.
@@ -889,7 +1057,7 @@ template<bool psingle,TpKernel tker,TpFtMode ftmode,bool lamsps,TpDeltaSph tdelt
   (unsigned n,unsigned pinit,tint4 nc,int hdiv,unsigned cellinitial,float visco
   ,const unsigned *beginendcell,tint3 cellzero,const unsigned *dcell
   ,const tsymatrix3f* tau,tsymatrix3f* gradvel
-  ,const tdouble3 *pos,const tfloat3 *pspos,const tfloat4 *velrhop,const typecode *code,const unsigned *idp
+  ,const tdouble3 *pos,const tfloat3 *pspos,const tfloat4 *velrhop,const typecode *code,const typeidp *idp
   ,const float *press 
   ,float &viscdt,float *ar,tfloat3 *ace,float *delta
   ,TpShifting tshifting,tfloat3 *shiftpos,float *shiftdetect)const
@@ -1088,7 +1256,7 @@ template<bool psingle> void JSphCpu::InteractionForcesDEM
   (unsigned nfloat,tint4 nc,int hdiv,unsigned cellfluid
   ,const unsigned *beginendcell,tint3 cellzero,const unsigned *dcell
   ,const unsigned *ftridp,const StDemData* demdata
-  ,const tdouble3 *pos,const tfloat3 *pspos,const tfloat4 *velrhop,const typecode *code,const unsigned *idp
+  ,const tdouble3 *pos,const tfloat3 *pspos,const tfloat4 *velrhop,const typecode *code,const typeidp *idp
   ,float &viscdt,tfloat3 *ace)const
 {
   //-Initialise demdtth to calculate max demdt with OpenMP. | Inicializa demdtth para calcular demdt maximo con OpenMP.
@@ -1449,10 +1617,11 @@ void JSphCpu::ComputeSymplecticPre(double dt){
 template<bool shift> void JSphCpu::ComputeSymplecticPreT(double dt){
   TmcStart(Timers,TMC_SuComputeStep);
   //-Assign memory to variables Pre. | Asigna memoria a variables Pre.
-  PosPrec=ArraysCpu->ReserveDouble3();
+  if(CompactMem)PosPreMovc=ArraysCpu->ReserveFloat3();
+  else PosPrec=ArraysCpu->ReserveDouble3();
   VelrhopPrec=ArraysCpu->ReserveFloat4();
   //-Change data to variables Pre to calculate new data. | Cambia datos a variables Pre para calcular nuevos datos.
-  swap(PosPrec,Posc);         //Put value of Pos[] in PosPre[].         | Es decir... PosPre[] <= Pos[].
+  if(!CompactMem)swap(PosPrec,Posc); //Put value of Pos[] in PosPre[]. | Es decir... PosPre[] <= Pos[].
   swap(VelrhopPrec,Velrhopc); //Put value of Velrhop[] in VelrhopPre[]. | Es decir... VelrhopPre[] <= Velrhop[].
   //-Calculate new values of particles. | Calcula nuevos datos de particulas.
   const double dt05=dt*.5;
@@ -1487,7 +1656,12 @@ template<bool shift> void JSphCpu::ComputeSymplecticPreT(double dt){
         dz+=double(ShiftPosc[p].z);
       }
       bool outrhop=(rhopnew<RhopOutMin||rhopnew>RhopOutMax);
-      UpdatePos(PosPrec[p],dx,dy,dz,outrhop,p,Posc,Dcellc,Codec);
+      if(CompactMem){//-Keeps displacement to recover PosPre in corrector. | Guarda desplazamiento para recuperar PosPre en corrector.
+        const tfloat3 mov=TFloat3(float(dx),float(dy),float(dz));
+        PosPreMovc[p]=mov;
+        UpdatePos(Posc[p],double(mov.x),double(mov.y),double(mov.z),outrhop,p,Posc,Dcellc,Codec);
+      }
+      else UpdatePos(PosPrec[p],dx,dy,dz,outrhop,p,Posc,Dcellc,Codec);
       //-Update velocity & density. | Actualiza velocidad y densidad.
       Velrhopc[p].x=float(double(VelrhopPrec[p].x)+double(Acec[p].x)* dt05);
       Velrhopc[p].y=float(double(VelrhopPrec[p].y)+double(Acec[p].y)* dt05);
@@ -1498,12 +1672,13 @@ template<bool shift> void JSphCpu::ComputeSymplecticPreT(double dt){
       Velrhopc[p]=VelrhopPrec[p];
       Velrhopc[p].w=(rhopnew<RhopZero? RhopZero: rhopnew); //-Avoid fluid particles being absorbed by floating ones. | Evita q las floating absorvan a las fluidas.
       //-Copy position. | Copia posicion.
-      Posc[p]=PosPrec[p];
+      if(CompactMem)PosPreMovc[p]=TFloat3(0);
+      else Posc[p]=PosPrec[p];
     }
   }
 
   //-Copy previous position of boundary. | Copia posicion anterior del contorno.
-  memcpy(Posc,PosPrec,sizeof(tdouble3)*Npb);
+  if(!CompactMem)memcpy(Posc,PosPrec,sizeof(tdouble3)*Npb);
 
   TmcStop(Timers,TMC_SuComputeStep);
 }
@@ -1560,18 +1735,20 @@ template<bool shift> void JSphCpu::ComputeSymplecticCorrT(double dt){
         dz+=double(ShiftPosc[p].z);
       }
       bool outrhop=(rhopnew<RhopOutMin||rhopnew>RhopOutMax);
-      UpdatePos(PosPrec[p],dx,dy,dz,outrhop,p,Posc,Dcellc,Codec);
+      const tdouble3 rposp=(CompactMem? Posc[p]-ToTDouble3(PosPreMovc[p]): PosPrec[p]);
+      UpdatePos(rposp,dx,dy,dz,outrhop,p,Posc,Dcellc,Codec);
     }
     else{//-Floating Particles.
       Velrhopc[p]=VelrhopPrec[p];
       Velrhopc[p].w=(rhopnew<RhopZero? RhopZero: rhopnew); //-Avoid fluid particles being absorbed by floating ones. | Evita q las floating absorvan a las fluidas.
       //-Copy position. | Copia posicion.
-      Posc[p]=PosPrec[p];
+      Posc[p]=(CompactMem? Posc[p]-ToTDouble3(PosPreMovc[p]): PosPrec[p]);
     }
   }
 
   //-Free memory assigned to variables Pre and ComputeSymplecticPre(). | Libera memoria asignada a variables Pre en ComputeSymplecticPre().
   ArraysCpu->Free(PosPrec);      PosPrec=NULL;
+  ArraysCpu->Free(PosPreMovc);   PosPreMovc=NULL;
   ArraysCpu->Free(VelrhopPrec);  VelrhopPrec=NULL;
   TmcStop(Timers,TMC_SuComputeStep);
 }
@@ -1640,7 +1817,7 @@ void JSphCpu::RunShifting(double dt){
 /// Cuando periactive es False supone que no hay particulas duplicadas (periodicas)
 /// y todas son CODE_NORMAL.
 //==============================================================================
-void JSphCpu::CalcRidp(bool periactive,unsigned np,unsigned pini,unsigned idini,unsigned idfin,const typecode *code,const unsigned *idp,unsigned *ridp)const{
+void JSphCpu::CalcRidp(bool periactive,unsigned np,unsigned pini,unsigned idini,unsigned idfin,const typecode *code,const typeidp *idp,unsigned *ridp)const{
   //-Assign values UINT_MAX. | Asigna valores UINT_MAX.
   const unsigned nsel=idfin-idini;
   memset(ridp,255,sizeof(unsigned)*nsel); 
@@ -1651,9 +1828,9 @@ void JSphCpu::CalcRidp(bool periactive,unsigned np,unsigned pini,unsigned idini,
       #pragma omp parallel for schedule (static) if(pfin>OMP_LIMIT_COMPUTELIGHT)
     #endif
     for(int p=int(pini);p<pfin;p++){
-      const unsigned id=idp[p];
+      const typeidp id=idp[p];
       if(idini<=id && id<idfin){
-        if(CODE_IsNormal(code[p]))ridp[id-idini]=p;
+        if(CODE_IsNormal(code[p]))ridp[unsigned(id-idini)]=p;
       }
     }
   }
@@ -1662,11 +1839,52 @@ void JSphCpu::CalcRidp(bool periactive,unsigned np,unsigned pini,unsigned idini,
       #pragma omp parallel for schedule (static) if(pfin>OMP_LIMIT_COMPUTELIGHT)
     #endif
     for(int p=int(pini);p<pfin;p++){
-      const unsigned id=idp[p];
-      if(idini<=id && id<idfin)ridp[id-idini]=p;
+      const typeidp id=idp[p];
+      if(idini<=id && id<idfin)ridp[unsigned(id-idini)]=p;
+    }
+  }
+}
+
+#ifdef IDP_SIZE8
+//==============================================================================
+/// Returns a copy of Idpc with 32 bits for modules that only support this 
+/// size. The returned array must be released with ArraysCpu->Free().
+///
+/// Devuelve una copia de Idpc de 32 bits para modulos que solo soportan este
+/// tamanho. El array devuelto debe liberarse con ArraysCpu->Free().
+//==============================================================================
+unsigned* JSphCpu::GetIdpc32(const std::string &module)const{
+  const char met[]="GetIdpc32";
+  unsigned *idp32=ArraysCpu->ReserveUint();
+  const int n=int(Np);
+  typeidp idmax=0;
+  #ifdef OMP_USE
+    #pragma omp parallel if(n>OMP_LIMIT_COMPUTELIGHT)
+  #endif
+  {
+    typeidp idmaxth=0;
+    #ifdef OMP_USE
+      #pragma omp for schedule (static)
+    #endif
+    for(int p=0;p<n;p++){
+      const typeidp id=Idpc[p];
+      idp32[p]=unsigned(id);
+      if(idmaxth<id)idmaxth=id;
+    }
+    #ifdef OMP_USE
+      #pragma omp critical
+    #endif
+    {
+      if(idmax<idmaxth)idmax=idmaxth;
     }
   }
+  if(idmax>UINT_MAX){
+    ArraysCpu->Free(idp32);
+    RunException(met,module+" only supports particle identifiers of 32 bits.");
+  }
+  return(idp32);
 }
+#endif
 
 //==============================================================================
 /// Applies a linear movement to a group of particles.
@@ -1878,7 +2096,13 @@ void JSphCpu::MovePiston2d(unsigned np,unsigned ini
 //==============================================================================
 void JSphCpu::RunRelaxZone(double dt){
   TmcStart(Timers,TMC_SuMotion);
+#ifdef IDP_SIZE8
+  unsigned *idp32=GetIdpc32("RelaxZone");
+  RelaxZones->SetFluidVel(TimeStep,dt,Np-Npb,Npb,Posc,idp32,Velrhopc);
+  ArraysCpu->Free(idp32);
+#else
   RelaxZones->SetFluidVel(TimeStep,dt,Np-Npb,Npb,Posc,Idpc,Velrhopc);
+#endif
   TmcStop(Timers,TMC_SuMotion);
 }
 //<vs_rzone_end>
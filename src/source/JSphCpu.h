@@ -37,7 +37,7 @@ typedef struct{
   const tdouble3 *pdpos;
   const tfloat3 *pspos;
   const tfloat4 *velrhop;
-  const unsigned *idp;
+  const typeidp *idp;
   const typecode *code;
   const float *press;
   float* ar;
@@ -54,7 +54,7 @@ typedef struct{
 inline stinterparmsc StInterparmsc(unsigned np,unsigned npb,unsigned npbok
   ,tuint3 ncells,const unsigned *begincell,tuint3 cellmin,const unsigned *dcell
   ,const tdouble3 *pdpos,const tfloat3 *pspos
-  ,const tfloat4 *velrhop,const unsigned *idp,const typecode *code
+  ,const tfloat4 *velrhop,const typeidp *idp,const typecode *code
   ,const float *press
   ,float* ar,tfloat3 *ace,float *delta
   ,tsymatrix3f *spstau,tsymatrix3f *spsgradvel
@@ -87,6 +87,7 @@ private:
 
 protected:
   int OmpThreads;        ///<Max number of OpenMP threads in execution on CPU host (minimum 1). | Numero maximo de hilos OpenMP en ejecucion por host en CPU (minimo 1).
+  bool CompactMem;       ///<Symplectic predictor position is stored as float displacement in PosPreMovc[] (-compactmem). | Guarda la posicion del predictor como desplazamiento float.
   std::string RunMode;   ///<Overall mode of execution (symmetry, openmp, load balancing). |  Almacena modo de ejecucion (simetria,openmp,balanceo,...).
 
   //-Number of particles in domain | Numero de particulas del dominio.
@@ -105,14 +106,20 @@ protected:
   llong MemCpuParticles;      ///<Memory reserved for particles' vectors. | Mermoria reservada para vectores de datos de particulas.
   llong MemCpuFixed;          ///<Memory reserved in AllocMemoryFixed. | Mermoria reservada en AllocMemoryFixed.
 
+  llong MemBudget;               ///<Memory budget for particle arrays to reserve virtual memory (0:disabled). | Presupuesto de memoria para arrays de particulas.
+  bool MemBudgetUser;            ///<MemBudget was defined by the user (-membudget) so it can not be exceeded.
+  TpHugePages HugePages;         ///<Mode of huge pages for particle and cell arrays (-hugepages). | Modo de huge pages para arrays de particulas y celdas.
+  unsigned CpuParticlesCapacity; ///<Number of particles that fit in reserved memory without copying arrays. | Numero de particulas que caben en la memoria reservada sin copiar arrays.
+
   //-Particle Position according to id. | Posicion de particula segun id.
   unsigned *RidpMove; ///<Only for moving boundary particles [CaseNmoving] and when CaseNmoving!=0 | Solo para boundary moving particles [CaseNmoving] y cuando CaseNmoving!=0 
+  unsigned *RidpBound; ///<Fixed and moving boundary particles [CaseNpb] updated after each cell division, so the particles of each mk block are RidpBound[Begin,Begin+Count) (only with force gauges). | Boundary fixed y moving [CaseNpb] actualizado tras cada division en celdas (solo con gauges de fuerza).
 
   //-List of particle arrays on CPU. | Lista de arrays en CPU para particulas.
   JArraysCpu* ArraysCpu;
 
   //-Execution Variables for particles (size=ParticlesSize). | Variables con datos de las particulas para ejecucion (size=ParticlesSize).
-  unsigned *Idpc;    ///<Identifier of particle | Identificador de particula.
+  typeidp *Idpc;    ///<Identifier of particle | Identificador de particula.
   typecode *Codec;   ///<Indicator of group of particles & other special markers. | Indica el grupo de las particulas y otras marcas especiales.
   unsigned *Dcellc;  ///<Cells inside DomCells coded with DomCellCode. | Celda dentro de DomCells codificada con DomCellCode.
   tdouble3 *Posc;
@@ -124,6 +131,7 @@ protected:
   //-Variables for compute step: SYMPLECTIC. | Vars. para compute step: SYMPLECTIC.
   tdouble3 *PosPrec;    ///<Sympletic: in order to keep previous values. | Sympletic: para guardar valores en predictor.
   tfloat4 *VelrhopPrec;
+  tfloat3 *PosPreMovc;  ///<Sympletic with CompactMem: displacement of predictor to recover PosPre from Pos. | Sympletic con CompactMem: desplazamiento del predictor para recuperar PosPre a partir de Pos.
 
   //-Variables for floating bodies.
   unsigned *FtRidp;             ///<Identifier to access to the particles of the floating object [CaseNfloat].
@@ -171,8 +179,10 @@ protected:
   unsigned*    SaveArrayCpu(unsigned np,const unsigned    *datasrc)const{ return(TSaveArrayCpu<unsigned>   (np,datasrc)); }
   int*         SaveArrayCpu(unsigned np,const int         *datasrc)const{ return(TSaveArrayCpu<int>        (np,datasrc)); }
   float*       SaveArrayCpu(unsigned np,const float       *datasrc)const{ return(TSaveArrayCpu<float>      (np,datasrc)); }
+  tfloat3*     SaveArrayCpu(unsigned np,const tfloat3     *datasrc)const{ return(TSaveArrayCpu<tfloat3>    (np,datasrc)); }
   tfloat4*     SaveArrayCpu(unsigned np,const tfloat4     *datasrc)const{ return(TSaveArrayCpu<tfloat4>    (np,datasrc)); }
   double*      SaveArrayCpu(unsigned np,const double      *datasrc)const{ return(TSaveArrayCpu<double>     (np,datasrc)); }
+  ullong*      SaveArrayCpu(unsigned np,const ullong      *datasrc)const{ return(TSaveArrayCpu<ullong>     (np,datasrc)); }
   tdouble3*    SaveArrayCpu(unsigned np,const tdouble3    *datasrc)const{ return(TSaveArrayCpu<tdouble3>   (np,datasrc)); }
   tsymatrix3f* SaveArrayCpu(unsigned np,const tsymatrix3f *datasrc)const{ return(TSaveArrayCpu<tsymatrix3f>(np,datasrc)); }
   template<class T> void TRestoreArrayCpu(unsigned np,T *data,T *datanew)const;
@@ -180,18 +190,24 @@ protected:
   void RestoreArrayCpu(unsigned np,unsigned    *data,unsigned    *datanew)const{ TRestoreArrayCpu<unsigned>   (np,data,datanew); }
   void RestoreArrayCpu(unsigned np,int         *data,int         *datanew)const{ TRestoreArrayCpu<int>        (np,data,datanew); }
   void RestoreArrayCpu(unsigned np,float       *data,float       *datanew)const{ TRestoreArrayCpu<float>      (np,data,datanew); }
+  void RestoreArrayCpu(unsigned np,tfloat3     *data,tfloat3     *datanew)const{ TRestoreArrayCpu<tfloat3>    (np,data,datanew); }
   void RestoreArrayCpu(unsigned np,tfloat4     *data,tfloat4     *datanew)const{ TRestoreArrayCpu<tfloat4>    (np,data,datanew); }
   void RestoreArrayCpu(unsigned np,double      *data,double      *datanew)const{ TRestoreArrayCpu<double>     (np,data,datanew); }
+  void RestoreArrayCpu(unsigned np,ullong      *data,ullong      *datanew)const{ TRestoreArrayCpu<ullong>     (np,data,datanew); }
   void RestoreArrayCpu(unsigned np,tdouble3    *data,tdouble3    *datanew)const{ TRestoreArrayCpu<tdouble3>   (np,data,datanew); }
   void RestoreArrayCpu(unsigned np,tsymatrix3f *data,tsymatrix3f *datanew)const{ TRestoreArrayCpu<tsymatrix3f>(np,data,datanew); }
 
   llong GetAllocMemoryCpu()const;
   void PrintAllocMemory(llong mcpu)const;
+  void PrintHugePagesUsage()const;
 
   unsigned GetParticlesData(unsigned n,unsigned pini,bool onlynormal
-    ,unsigned *idp,tdouble3 *pos,tfloat3 *vel,float *rhop,typecode *code);
+    ,typeidp *idp,tdouble3 *pos,tfloat3 *vel,float *rhop,typecode *code);
   void ConfigOmp(const JCfgRun *cfg);
 
+  void ConfigCompactMem(const JCfgRun *cfg);
+  void ConfigMemBudget(const JCfgRun *cfg);
+  void VisuMemoryPlan(ullong npestimated)const;
   void ConfigRunMode(const JCfgRun *cfg,std::string preinfo="");
   void ConfigCellDiv(JCellDivCpu* celldiv){ CellDiv=celldiv; }
   void InitFloating();
@@ -201,6 +217,8 @@ protected:
 
   float CalcVelMaxSeq(unsigned np,const tfloat4* velrhop)const;
   float CalcVelMaxOmp(unsigned np,const tfloat4* velrhop)const;
+  void CalcKinEnergy(unsigned n,unsigned pini,const tfloat4 *velrhop,const typecode *code,double &kinenergy,double &velmax)const;
+  bool CheckSteadyState();
 
   void PreInteractionVars_Forces(unsigned np,unsigned npb);
   void PreInteraction_Forces();
@@ -225,14 +243,14 @@ protected:
   template<bool psingle,TpKernel tker,TpFtMode ftmode> void InteractionForcesBound
     (unsigned n,unsigned pini,tint4 nc,int hdiv,unsigned cellinitial
     ,const unsigned *beginendcell,tint3 cellzero,const unsigned *dcell
-    ,const tdouble3 *pos,const tfloat3 *pspos,const tfloat4 *velrhopp,const typecode *code,const unsigned *id
+    ,const tdouble3 *pos,const tfloat3 *pspos,const tfloat4 *velrhopp,const typecode *code,const typeidp *id
     ,float &viscdt,float *ar)const;
 
   template<bool psingle,TpKernel tker,TpFtMode ftmode,bool lamsps,TpDeltaSph tdelta,bool shift> void InteractionForcesFluid
     (unsigned n,unsigned pini,tint4 nc,int hdiv,unsigned cellfluid,float visco
     ,const unsigned *beginendcell,tint3 cellzero,const unsigned *dcell
     ,const tsymatrix3f* tau,tsymatrix3f* gradvel
-    ,const tdouble3 *pos,const tfloat3 *pspos,const tfloat4 *velrhop,const typecode *code,const unsigned *idp
+    ,const tdouble3 *pos,const tfloat3 *pspos,const tfloat4 *velrhop,const typecode *code,const typeidp *idp
     ,const float *press
     ,float &viscdt,float *ar,tfloat3 *ace,float *delta
     ,TpShifting tshifting,tfloat3 *shiftpos,float *shiftdetect)const;
@@ -241,7 +259,7 @@ protected:
     (unsigned nfloat,tint4 nc,int hdiv,unsigned cellfluid
     ,const unsigned *beginendcell,tint3 cellzero,const unsigned *dcell
     ,const unsigned *ftridp,const StDemData* demobjs
-    ,const tdouble3 *pos,const tfloat3 *pspos,const tfloat4 *velrhop,const typecode *code,const unsigned *idp
+    ,const tdouble3 *pos,const tfloat3 *pspos,const tfloat4 *velrhop,const typecode *code,const typeidp *idp
     ,float &viscdt,tfloat3 *ace)const;
 
   template<bool psingle,TpKernel tker,TpFtMode ftmode,bool lamsps,TpDeltaSph tdelta,bool shift> 
@@ -267,7 +285,10 @@ protected:
 
   void RunShifting(double dt);
 
-  void CalcRidp(bool periactive,unsigned np,unsigned pini,unsigned idini,unsigned idfin,const typecode *code,const unsigned *idp,unsigned *ridp)const;
+  void CalcRidp(bool periactive,unsigned np,unsigned pini,unsigned idini,unsigned idfin,const typecode *code,const typeidp *idp,unsigned *ridp)const;
+#ifdef IDP_SIZE8
+  unsigned* GetIdpc32(const std::string &module)const;
+#endif
   void MoveLinBound(unsigned np,unsigned ini,const tdouble3 &mvpos,const tfloat3 &mvvel,const unsigned *ridp,tdouble3 *pos,unsigned *dcell,tfloat4 *velrhop,typecode *code)const;
   void MoveMatBound(unsigned np,unsigned ini,tmatrix4d m,double dt,const unsigned *ridpmv,tdouble3 *pos,unsigned *dcell,tfloat4 *velrhop,typecode *code)const;
   void CalcMotion(double stepdt);
@@ -315,7 +336,7 @@ protected:
     ,const tplane3f *planes,const float* width,const tfloat3 *dirdata,float determlimit
     ,tint4 nc,int hdiv,unsigned cellinitial
     ,const unsigned *beginendcell,tint3 cellzero,const unsigned *dcell
-    ,const tdouble3 *pos,const typecode *code,const unsigned *idp
+    ,const tdouble3 *pos,const typecode *code,const typeidp *idp
     ,tfloat4 *velrhop);
   
   template<bool sim2d,TpKernel tker> void InteractionInOutExtrap_Single
@@ -323,38 +344,42 @@ protected:
     ,const tplane3f *planes,const float* width,const tfloat3 *dirdata,float determlimit
     ,tint4 nc,int hdiv,unsigned cellinitial
     ,const unsigned *beginendcell,tint3 cellzero,const unsigned *dcell
-    ,const tdouble3 *pos,const typecode *code,const unsigned *idp
+    ,const tdouble3 *pos,const typecode *code,const typeidp *idp
     ,tfloat4 *velrhop);
   
   void Interaction_InOutExtrap(byte doublemode,unsigned inoutcount,const int *inoutpart
     ,const byte *cfgzone,const tplane3f *planes
     ,const float* width,const tfloat3 *dirdata,float determlimit
     ,tuint3 ncells,const unsigned *begincell,tuint3 cellmin,const unsigned *dcell
-    ,const tdouble3 *pos,const typecode *code,const unsigned *idp
+    ,const tdouble3 *pos,const typecode *code,const typeidp *idp
     ,tfloat4 *velrhop);
 
   float Interaction_InOutZsurf(unsigned nptz,const tfloat3 *ptzpos,float maxdist,float zbottom
     ,tuint3 ncells,const unsigned *begincell,tuint3 cellmin
     ,const tdouble3 *pos,const typecode *code);
 
+  void Interaction_InOutProximity(unsigned npbok,unsigned npb,unsigned np,typeidp idini,double dist
+    ,tuint3 ncells,const unsigned *begincell,tuint3 cellmin
+    ,const tdouble3 *pos,const typecode *code,const typeidp *idp,unsigned *nearby)const;
+
 
   template<bool sim2d,TpKernel tker> void InteractionBoundCorr_Double
     (unsigned npb,typecode boundcode,tplane3f plane,tfloat3 direction,float determlimit
     ,tint4 nc,int hdiv,unsigned cellinitial
     ,const unsigned *beginendcell,tint3 cellzero
-    ,const tdouble3 *pos,const typecode *code,const unsigned *idp
+    ,const tdouble3 *pos,const typecode *code,const typeidp *idp
     ,tfloat4 *velrhop);
 
   template<bool sim2d,TpKernel tker> void InteractionBoundCorr_Single
     (unsigned npb,typecode boundcode,tplane3f plane,tfloat3 direction,float determlimit
     ,tint4 nc,int hdiv,unsigned cellinitial
     ,const unsigned *beginendcell,tint3 cellzero
-    ,const tdouble3 *pos,const typecode *code,const unsigned *idp
+    ,const tdouble3 *pos,const typecode *code,const typeidp *idp
     ,tfloat4 *velrhop);
 
   void Interaction_BoundCorr(byte doublemode,typecode boundcode,tplane3f plane,tfloat3 direction,float determlimit
     ,tuint3 ncells,const unsigned *begincell,tuint3 cellmin
-    ,const tdouble3 *pos,const typecode *code,const unsigned *idp
+    ,const tdouble3 *pos,const typecode *code,const typeidp *idp
     ,tfloat4 *velrhop);
 //<vs_innlet_end>
 };
@@ -35,6 +35,11 @@
 #include "JTimeOut.h"
 #include "JTimeControl.h"
 #include "JGaugeSystem.h"
+#include "JSphSteadyState.h"
+#include "JSphPlugins.h"
+#include "JSphSaveRegions.h"
+#include "JSphCheckpoint.h"
+#include "JBinaryData.h"
 #include "JSphInOut.h"  //<vs_innlet>
 #include "JLinearValue.h"
 #include <climits>
@@ -88,6 +93,10 @@ void JSphCpuSingle::LoadConfig(JCfgRun *cfg){
   ConfigOmp(cfg);
   //-Load basic general configuraction. | Carga configuracion basica general.
   JSph::LoadConfig(cfg);
+  //-Load configuration of compact storage. | Carga configuracion de almacenamiento compacto.
+  ConfigCompactMem(cfg);
+  //-Load memory budget for particle arrays. | Carga presupuesto de memoria para arrays de particulas.
+  ConfigMemBudget(cfg);
   //-Checks compatibility of selected options.
   Log->Print("**Special case configuration is loaded");
 }
@@ -108,7 +117,7 @@ void JSphCpuSingle::ConfigDomain(){
   //-Copies particle data.
   ReserveBasicArraysCpu();
   memcpy(Posc,PartsLoaded->GetPos(),sizeof(tdouble3)*Np);
-  memcpy(Idpc,PartsLoaded->GetIdp(),sizeof(unsigned)*Np);
+  memcpy(Idpc,PartsLoaded->GetIdp(),sizeof(typeidp)*Np);
   memcpy(Velrhopc,PartsLoaded->GetVelRhop(),sizeof(tfloat4)*Np);
 
   //-Computes radius of floating bodies.
@@ -116,7 +125,15 @@ void JSphCpuSingle::ConfigDomain(){
 
   //<vs_mlapiston_ini>
   //-Configures Multi-Layer Pistons according particles. | Configura pistones Multi-Layer segun particulas.
+#ifdef IDP_SIZE8
+  if(MLPistons){
+    unsigned *idp32=GetIdpc32("Multi-Layer Pistons");
+    MLPistons->PreparePiston(Dp,Np,idp32,Posc);
+    ArraysCpu->Free(idp32);
+  }
+#else
   if(MLPistons)MLPistons->PreparePiston(Dp,Np,Idpc,Posc);
+#endif
   //<vs_mlapiston_end>
 
   //-Load particle code. | Carga code de particulas.
@@ -144,6 +161,8 @@ void JSphCpuSingle::ConfigDomain(){
   //-Crea objeto para divide en CPU y selecciona un cellmode valido.
   CellDivSingle=new JCellDivCpuSingle(Stable,FtCount!=0,PeriActive,CellMode
     ,Scell,Map_PosMin,Map_PosMax,Map_Cells,CaseNbound,CaseNfixed,CaseNpb,Log,DirOut);
+  CellDivSingle->SetHugePages(HugePages);
+  if(CpuParticlesCapacity>CpuParticlesSize)CellDivSingle->SetReserveNp(CpuParticlesCapacity);
   CellDivSingle->DefineDomain(DomCellCode,DomCelIni,DomCelFin,DomPosMin,DomPosMax);
   ConfigCellDiv((JCellDivCpu*)CellDivSingle);
 
@@ -252,7 +271,7 @@ void JSphCpuSingle::PeriodicDuplicatePos(unsigned pnew,unsigned pcopy,bool inver
 /// Este kernel vale para single-cpu y multi-cpu porque usa domposmin. 
 //==============================================================================
 void JSphCpuSingle::PeriodicDuplicateVerlet(unsigned np,unsigned pini,tuint3 cellmax,tdouble3 perinc,const unsigned *listp
-  ,unsigned *idp,typecode *code,unsigned *dcell,tdouble3 *pos,tfloat4 *velrhop,tsymatrix3f *spstau,tfloat4 *velrhopm1)const
+  ,typeidp *idp,typecode *code,unsigned *dcell,tdouble3 *pos,tfloat4 *velrhop,tsymatrix3f *spstau,tfloat4 *velrhopm1)const
 {
   const int n=int(np);
   #ifdef OMP_USE
@@ -283,7 +302,7 @@ void JSphCpuSingle::PeriodicDuplicateVerlet(unsigned np,unsigned pini,tuint3 cel
 /// Este kernel vale para single-cpu y multi-cpu porque usa domposmin. 
 //==============================================================================
 void JSphCpuSingle::PeriodicDuplicateSymplectic(unsigned np,unsigned pini,tuint3 cellmax,tdouble3 perinc,const unsigned *listp
-  ,unsigned *idp,typecode *code,unsigned *dcell,tdouble3 *pos,tfloat4 *velrhop,tsymatrix3f *spstau,tdouble3 *pospre,tfloat4 *velrhoppre)const
+  ,typeidp *idp,typecode *code,unsigned *dcell,tdouble3 *pos,tfloat4 *velrhop,tsymatrix3f *spstau,tdouble3 *pospre,tfloat4 *velrhoppre,tfloat3 *pospremov)const
 {
   const int n=int(np);
   #ifdef OMP_USE
@@ -301,6 +320,7 @@ void JSphCpuSingle::PeriodicDuplicateSymplectic(unsigned np,unsigned pini,tuint3
     velrhop[pnew]=velrhop[pcopy];
     if(pospre)pospre[pnew]=pospre[pcopy];
     if(velrhoppre)velrhoppre[pnew]=velrhoppre[pcopy];
+    if(pospremov)pospremov[pnew]=pospremov[pcopy];
     if(spstau)spstau[pnew]=spstau[pcopy];
   }
 }
@@ -356,7 +376,7 @@ void JSphCpuSingle::RunPeriodic(){
           unsigned* listp=ArraysCpu->ReserveUint();
           unsigned nmax=CpuParticlesSize-1; //-Maximmum number of particles that fit in the list. | Numero maximo de particulas que caben en la lista.
           //-Generate list of new periodic particles. | Genera lista de nuevas periodicas.
-          if(Np>=0x80000000)RunException(met,"The number of particles is too big.");//-Because the last bit is used to mark the direction in which a new periodic particle is created. | Porque el ultimo bit se usa para marcar el sentido en que se crea la nueva periodica.
+          if(Np>=0x80000000)RunException(met,fun::PrintStr("The number of particles (%u) is too big, the maximum with periodic conditions is 2^31 particles.",Np));//-Because the last bit is used to mark the direction in which a new periodic particle is created. | Porque el ultimo bit se usa para marcar el sentido en que se crea la nueva periodica.
           unsigned count=PeriodicMakeList(num2,pini2,Stable,nmax,perinc,Posc,Codec,listp);
           //-Redimension memory for particles if there is insufficient space and repeat the search process.
           //-Redimensiona memoria para particulas si no hay espacio suficiente y repite el proceso de busqueda.
@@ -372,8 +392,8 @@ void JSphCpuSingle::RunPeriodic(){
             //-Crea nuevas particulas periodicas duplicando las particulas de la lista.
             if(TStep==STEP_Verlet)PeriodicDuplicateVerlet(count,Np,DomCells,perinc,listp,Idpc,Codec,Dcellc,Posc,Velrhopc,SpsTauc,VelrhopM1c);
             if(TStep==STEP_Symplectic){
-              if((PosPrec || VelrhopPrec) && (!PosPrec || !VelrhopPrec))RunException(met,"Symplectic data is invalid.") ;
-              PeriodicDuplicateSymplectic(count,Np,DomCells,perinc,listp,Idpc,Codec,Dcellc,Posc,Velrhopc,SpsTauc,PosPrec,VelrhopPrec);
+              if((PosPrec || PosPreMovc || VelrhopPrec) && ((!PosPrec && !PosPreMovc) || !VelrhopPrec))RunException(met,"Symplectic data is invalid.") ;
+              PeriodicDuplicateSymplectic(count,Np,DomCells,perinc,listp,Idpc,Codec,Dcellc,Posc,Velrhopc,SpsTauc,PosPrec,VelrhopPrec,PosPreMovc);
             }
 
             //-Free the list and update the number of particles. | Libera lista y actualiza numero de particulas.
@@ -391,10 +411,11 @@ void JSphCpuSingle::RunPeriodic(){
 }
 
 //==============================================================================
-/// Executes divide of particles in cells.
+/// Executes divide of particles in cells. With inoutlist=false the list of 
+/// inout particles is not updated (fluid in inout zones is not converted).
 /// Ejecuta divide de particulas en celdas.
 //==============================================================================
-void JSphCpuSingle::RunCellDivide(bool updateperiodic){
+void JSphCpuSingle::RunCellDivide(bool updateperiodic,bool inoutlist){
   const char met[]="RunCellDivide";
   //-Creates new periodic particles and marks the old ones to be ignored.
   //-Crea nuevas particulas periodicas y marca las viejas para ignorarlas.
@@ -413,9 +434,10 @@ void JSphCpuSingle::RunCellDivide(bool updateperiodic){
   if(TStep==STEP_Verlet){
     CellDivSingle->SortArray(VelrhopM1c);
   }
-  else if(TStep==STEP_Symplectic && (PosPrec || VelrhopPrec)){//-In reality, this is only necessary in divide for corrector, not in predictor??? | En realidad solo es necesario en el divide del corrector, no en el predictor???
-    if(!PosPrec || !VelrhopPrec)RunException(met,"Symplectic data is invalid.") ;
-    CellDivSingle->SortArray(PosPrec);
+  else if(TStep==STEP_Symplectic && (PosPrec || PosPreMovc || VelrhopPrec)){//-In reality, this is only necessary in divide for corrector, not in predictor??? | En realidad solo es necesario en el divide del corrector, no en el predictor???
+    if((!PosPrec && !PosPreMovc) || !VelrhopPrec)RunException(met,"Symplectic data is invalid.") ;
+    if(PosPrec)CellDivSingle->SortArray(PosPrec);
+    if(PosPreMovc)CellDivSingle->SortArray(PosPreMovc);
     CellDivSingle->SortArray(VelrhopPrec);
   }
   if(TVisco==VISCO_LaminarSPS)CellDivSingle->SortArray(SpsTauc);
@@ -430,6 +452,8 @@ void JSphCpuSingle::RunCellDivide(bool updateperiodic){
 
   //-Collect position of floating particles. | Recupera posiciones de floatings.
   if(CaseNfloat)CalcRidp(PeriActive!=0,Np-Npb,Npb,CaseNpb,CaseNpb+CaseNfloat,Codec,Idpc,FtRidp);
+  //-Collect position of boundary particles for mk-filtered loops. | Recupera posiciones de contorno para bucles filtrados por mk.
+  if(RidpBound)CalcRidp(PeriActive!=0,NpbOk,0,0,CaseNpb,Codec,Idpc,RidpBound);
   TmcStop(Timers,TMC_NlSortData);
 
   //-Control of excluded particles (only fluid because excluded boundary are checked before).
@@ -437,7 +461,7 @@ void JSphCpuSingle::RunCellDivide(bool updateperiodic){
   TmcStart(Timers,TMC_NlOutCheck);
   unsigned npfout=CellDivSingle->GetNpfOut();
   if(npfout){
-    unsigned* idp=ArraysCpu->ReserveUint();
+    typeidp *idp=ArraysCpu->ReserveTypeIdp();
     tdouble3* pos=ArraysCpu->ReserveDouble3();
     tfloat3* vel=ArraysCpu->ReserveFloat3();
     float* rhop=ArraysCpu->ReserveFloat();
@@ -453,7 +477,7 @@ void JSphCpuSingle::RunCellDivide(bool updateperiodic){
   TmcStop(Timers,TMC_NlOutCheck);
   BoundChanged=false;
   //-Creates list with particles in inout zones.  //<vs_innlet>
-  if(InOut)InOutCreateList();                     //<vs_innlet>
+  if(InOut && inoutlist)InOutCreateList();        //<vs_innlet>
 }
 
 //==============================================================================
@@ -463,7 +487,7 @@ void JSphCpuSingle::RunCellDivide(bool updateperiodic){
 void JSphCpuSingle::AbortBoundOut(){
   const unsigned nboundout=CellDivSingle->GetNpbOut();
   //-Get data of excluded boundary particles.
-  unsigned* idp=ArraysCpu->ReserveUint();
+  typeidp *idp=ArraysCpu->ReserveTypeIdp();
   tdouble3* pos=ArraysCpu->ReserveDouble3();
   tfloat3* vel=ArraysCpu->ReserveFloat3();
   float* rhop=ArraysCpu->ReserveFloat();
@@ -890,7 +914,35 @@ void JSphCpuSingle::RunGaugeSystem(double timestep){
   const bool svpart=(TimeStep>=TimePartNext);
   GaugeSystem->CalculeCpu(timestep,svpart,CellDivSingle->GetNcells()
     ,CellDivSingle->GetCellDomainMin(),CellDivSingle->GetBeginCell()
-    ,NpbOk,Npb,Np,Posc,Codec,Idpc,Velrhopc);
+    ,NpbOk,Npb,Np,Posc,Codec,Idpc,Velrhopc,RidpBound);
+}
+
+//==============================================================================
+/// Returns read-only view of particle data and cell division for plugins.
+/// Devuelve vista de solo lectura de particulas y division en celdas para plugins.
+//==============================================================================
+JSphPlugin::StParticles JSphCpuSingle::GetPluginParticles(){
+  JSphPlugin::StParticles data;
+  data.timestep=TimeStep;
+  data.dt=LastDt;
+  data.nstep=Nstep;
+  data.part=Part;
+  data.np=Np;
+  data.npb=Npb;
+  data.npbok=NpbOk;
+  data.pos=Posc;
+  data.velrhop=Velrhopc;
+  data.idp=Idpc;
+  data.code=Codec;
+  data.dcell=Dcellc;
+  data.ncells=CellDivSingle->GetNcells();
+  data.cellmin=CellDivSingle->GetCellDomainMin();
+  data.begincell=CellDivSingle->GetBeginCell();
+  data.domcellcode=DomCellCode;
+  data.domposmin=DomPosMin;
+  data.scell=Scell;
+  data.hdiv=int(Hdiv);
+  return(data);
 }
 
 //==============================================================================
@@ -919,21 +971,25 @@ void JSphCpuSingle::Run(std::string appname,JCfgRun *cfg,JLog2 *log){
   //-Initialisation of execution variables. | Inicializacion de variables de ejecucion.
   //------------------------------------------------------------------------------------
   InitRunCpu();
+  if(Checkpoint)LoadCheckpoint();
   RunGaugeSystem(TimeStep);
   if(InOut)InOutInit(TimeStepIni);  //<vs_innlet>
   FreePartsInit();
   UpdateMaxValues();
+  VisuMemoryPlan(Np+(InOut? InOut->CalcResizeNp(TimeStep,TimeMax-TimeStep): 0));  //<vs_innlet>
   PrintAllocMemory(GetAllocMemoryCpu());
   SaveData(); 
   TmcResetValues(Timers);
   TmcStop(Timers,TMC_Init);
   if(Log->WarningCount())Log->PrintWarningList("\n[WARNINGS]","");
   PartNstep=-1; Part++;
+  if(Checkpoint)CheckpointLoadCounters();
 
   //-Main Loop.
   //------------
   JTimeControl tc("30,60,300,600");//-Shows information at 0.5, 1, 5 y 10 minutes (before first PART).
   bool partoutstop=false;
+  bool svcheckpoint=false;
   TimerSim.Start();
   TimerPart.Start();
   Log->Print(string("\n[Initialising simulation (")+RunCode+")  "+fun::GetDateTime()+"]");
@@ -950,6 +1006,7 @@ void JSphCpuSingle::Run(std::string appname,JCfgRun *cfg,JLog2 *log){
     else RunCellDivide(true);               //<vs_innlet>
     TimeStep+=stepdt;
     LastDt=stepdt;
+    if(Plugins)Plugins->RunStepEnd(GetPluginParticles());
     partoutstop=(Np<NpMinimum || !Np);
     if(TimeStep>=TimePartNext || partoutstop){
       if(partoutstop){
@@ -961,10 +1018,18 @@ void JSphCpuSingle::Run(std::string appname,JCfgRun *cfg,JLog2 *log){
       PartNstep=Nstep;
       TimeStepM1=TimeStep;
       TimePartNext=TimeOut->GetNextTime(TimeStep);
+      svcheckpoint=(SvCheckpoint && (Part-1)%SvCheckpoint==0);
       TimerPart.Start();
+      //-Finishes the simulation when the steady state is reached (last PART is already saved).
+      if(SteadyState && !partoutstop && CheckSteadyState()){
+        Log->Print(string("  ")+SteadyState->GetStopInfo());
+        TimeMax=TimeStep;
+      }
     }
+    if(SaveRegions)RunSaveRegions();
     UpdateMaxValues();
     Nstep++;
+    if(svcheckpoint){ SaveCheckpoint(); svcheckpoint=false; }
     if(Part<=PartIni+1 && tc.CheckTime())Log->Print(string("  ")+tc.GetInfoFinish((TimeStep-TimeStepIni)/(TimeMax-TimeStepIni)));
     //if(Nstep>=3)break;
   }
@@ -984,13 +1049,13 @@ void JSphCpuSingle::SaveData(){
   const unsigned npsave=Np-NpbPer-NpfPer; //-Subtracts the periodic particles if they exist. | Resta las periodicas si las hubiera.
   TmcStart(Timers,TMC_SuSavePart);
   //-Collect particle values in original order. | Recupera datos de particulas en orden original.
-  unsigned *idp=NULL;
+  typeidp *idp=NULL;
   tdouble3 *pos=NULL;
   tfloat3 *vel=NULL;
   float *rhop=NULL;
   if(save){
     //-Assign memory and collect particle values. | Asigna memoria y recupera datos de las particulas.
-    idp=ArraysCpu->ReserveUint();
+    idp=ArraysCpu->ReserveTypeIdp();
     pos=ArraysCpu->ReserveDouble3();
     vel=ArraysCpu->ReserveFloat3();
     rhop=ArraysCpu->ReserveFloat();
@@ -1015,7 +1080,9 @@ void JSphCpuSingle::SaveData(){
   }
   //-Stores particle data. | Graba datos de particulas.
   const tdouble3 vdom[2]={CellDivSingle->GetDomainLimits(true),CellDivSingle->GetDomainLimits(false)};
+  if(Plugins)Plugins->StartPartSave(GetPluginParticles());
   JSph::SaveData(npsave,idp,pos,vel,rhop,1,vdom,&infoplus);
+  if(Plugins)Plugins->WaitPartSave();
   //-Free auxiliary memory for particle data. | Libera memoria auxiliar para datos de particulas.
   ArraysCpu->Free(idp);
   ArraysCpu->Free(pos);
@@ -1024,13 +1091,97 @@ void JSphCpuSingle::SaveData(){
   TmcStop(Timers,TMC_SuSavePart);
 }
 
+//==============================================================================
+/// Graba datos de las regiones de salida entre instantes de PART.
+/// Stores data of output regions between PART instants.
+//==============================================================================
+void JSphCpuSingle::RunSaveRegions(){
+  if(SaveRegions->CheckTime(TimeStep)){
+    const unsigned npsave=Np-NpbPer-NpfPer;
+    TmcStart(Timers,TMC_SuSavePart);
+    typeidp *idp=ArraysCpu->ReserveTypeIdp();
+    tdouble3 *pos=ArraysCpu->ReserveDouble3();
+    tfloat3 *vel=ArraysCpu->ReserveFloat3();
+    float *rhop=ArraysCpu->ReserveFloat();
+    unsigned npnormal=GetParticlesData(Np,0,PeriActive!=0,idp,pos,vel,rhop,NULL);
+    if(npnormal!=npsave)RunException("RunSaveRegions","The number of particles is invalid.");
+    SaveRegionsData(npsave,idp,pos,vel,rhop);
+    ArraysCpu->Free(idp);
+    ArraysCpu->Free(pos);
+    ArraysCpu->Free(vel);
+    ArraysCpu->Free(rhop);
+    TmcStop(Timers,TMC_SuSavePart);
+  }
+}
+
+//==============================================================================
+/// Stores checkpoint with the complete state of the particles and the solver 
+/// to restart the simulation with bitwise identical results (-restart).
+///
+/// Graba checkpoint con el estado completo de las particulas y del solver 
+/// para reiniciar la simulacion con resultados identicos bit a bit (-restart).
+//==============================================================================
+void JSphCpuSingle::SaveCheckpoint(){
+  TmcStart(Timers,TMC_SuSavePart);
+  JSphCheckpoint ckp;
+  JBinaryData *data=ckp.InitData();
+  CheckpointSaveState(data);
+  //-Particle data in current order (including periodic particles).
+  JBinaryData *item=data->CreateItem("Particles");
+  item->SetvUint("Np",Np);
+  item->SetvUint("Npb",Npb);
+  item->SetvUint("NpbOk",NpbOk);
+  item->SetvUint("NpbPer",NpbPer);
+  item->SetvUint("NpfPer",NpfPer);
+  item->CreateArray("Idp",(sizeof(typeidp)==8? JBinaryDataDef::DatUllong: JBinaryDataDef::DatUint),Np,Idpc,true);
+  item->CreateArray("Code",(sizeof(typecode)==2? JBinaryDataDef::DatUshort: JBinaryDataDef::DatUint),Np,Codec,true);
+  item->CreateArray("Dcell",JBinaryDataDef::DatUint,Np,Dcellc,true);
+  item->CreateArray("Pos",JBinaryDataDef::DatDouble3,Np,Posc,true);
+  item->CreateArray("Velrhop",JBinaryDataDef::DatFloat,Np*4,Velrhopc,true);
+  if(TStep==STEP_Verlet)item->CreateArray("VelrhopM1",JBinaryDataDef::DatFloat,Np*4,VelrhopM1c,true);
+  if(TVisco==VISCO_LaminarSPS)item->CreateArray("SpsTau",JBinaryDataDef::DatFloat,Np*6,SpsTauc,true);
+  ckp.SaveFile(DirDataOut);
+  TmcStop(Timers,TMC_SuSavePart);
+}
+
+//==============================================================================
+/// Restores particles and solver state from checkpoint after InitRunCpu().
+/// Restaura particulas y estado del solver desde checkpoint despues de InitRunCpu().
+//==============================================================================
+void JSphCpuSingle::LoadCheckpoint(){
+  const char met[]="LoadCheckpoint";
+  JBinaryData *item=Checkpoint->GetItem("Particles");
+  const unsigned np=item->GetvUint("Np");
+  if(!CheckCpuParticlesSize(np))ResizeParticlesSize(np,0,false);
+  Checkpoint->LoadArray(item,"Idp",(sizeof(typeidp)==8? JBinaryDataDef::DatUllong: JBinaryDataDef::DatUint),np,Idpc);
+  Checkpoint->LoadArray(item,"Code",(sizeof(typecode)==2? JBinaryDataDef::DatUshort: JBinaryDataDef::DatUint),np,Codec);
+  Checkpoint->LoadArray(item,"Dcell",JBinaryDataDef::DatUint,np,Dcellc);
+  Checkpoint->LoadArray(item,"Pos",JBinaryDataDef::DatDouble3,np,Posc);
+  Checkpoint->LoadArray(item,"Velrhop",JBinaryDataDef::DatFloat,np*4,Velrhopc);
+  if(TStep==STEP_Verlet)Checkpoint->LoadArray(item,"VelrhopM1",JBinaryDataDef::DatFloat,np*4,VelrhopM1c);
+  if(TVisco==VISCO_LaminarSPS)Checkpoint->LoadArray(item,"SpsTau",JBinaryDataDef::DatFloat,np*6,SpsTauc);
+  Np=np;
+  Npb=item->GetvUint("Npb");
+  NpbOk=item->GetvUint("NpbOk");
+  NpbPer=item->GetvUint("NpbPer");
+  NpfPer=item->GetvUint("NpfPer");
+  CheckpointLoadState();
+  //-Updates cell division with the restored particles (order is kept).
+  BoundChanged=true;
+  RunCellDivide(false);
+  if(Np!=np)RunException(met,"The number of particles after restoring the checkpoint is invalid.",Checkpoint->GetFileIn());
+}
+
 //==============================================================================
 /// Displays and stores final summary of the execution.
 /// Muestra y graba resumen final de ejecucion.
 //==============================================================================
 void JSphCpuSingle::FinishRun(bool stop){
+  FinishSaveData();
+  if(Plugins)Plugins->Finish();
   float tsim=TimerSim.GetElapsedTimeF()/1000.f,ttot=TimerTot.GetElapsedTimeF()/1000.f;
   JSph::ShowResume(stop,tsim,ttot,true,"");
+  if(HugePages)PrintHugePagesUsage();
   Log->Print(" ");
   string hinfo=";RunMode",dinfo=string(";")+RunMode;
   if(SvTimers){
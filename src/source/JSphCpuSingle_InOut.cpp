@@ -26,11 +26,9 @@
 #include "JSphPartsInit.h"
 #include "JSphBoundCorr.h"
 #include "JSphInOutPoints.h"
-#include "JSimpleNeigs.h"
 #include "FunctionsMath.h"
 #include "JFormatFiles2.h"
 #include "JAppInfo.h"
-#include "JTimeControl.h"
 #include <climits>
 
 using namespace std;
@@ -54,7 +52,8 @@ void JSphCpuSingle::InOutIgnoreFluidDef(const std::vector<unsigned> &mkfluidlist
 
 //==============================================================================
 /// Checks proximity of inout particles to other particles and excludes fluid 
-/// particles near the inout particles.
+/// particles near the inout particles. The new inout particles must be 
+/// included in the cell division.
 ///
 /// Comprueba proximidad de particulas inout con otras particulas y excluye 
 /// particulas fluid cerca de particulas inout.
@@ -63,17 +62,11 @@ void JSphCpuSingle::InOutCheckProximity(unsigned newnp){
   const char met[]="InOutCheckProximity";
   //-Look for nearby particles.
   const double disterror=Dp*0.8;
-  JSimpleNeigs neigs(Np,Posc,Scell);
+  const typeidp idini=IdMax+1-newnp; //-Idp of the first new inout particle.
   unsigned* errpart=(unsigned*)InOutPartc; //-Use InOutPartc like auxiliary memory.
-  memset(errpart,0,sizeof(int)*Np);
-  const unsigned pini=Np-newnp;
-  JTimeControl tc(5,60);
-  for(unsigned p=pini;p<Np;p++){//-Only inout particles.
-    const unsigned n=neigs.NearbyPositions(Posc[p],p,disterror);
-    const unsigned *selpos=neigs.GetSelectPos();
-    for(unsigned cp=0;cp<n;cp++)errpart[selpos[cp]]=1;
-    if(tc.CheckTime())Log->Print(string("  ")+tc.GetInfoFinish(double(p-pini)/double(Np-pini)));
-  }
+  Interaction_InOutProximity(NpbOk,Npb,Np,idini,disterror
+    ,CellDivSingle->GetNcells(),CellDivSingle->GetBeginCell(),CellDivSingle->GetCellDomainMin()
+    ,Posc,Codec,Idpc,errpart);
   //-Obtain number and type of nearby particles.
   unsigned nfluid=0,nfluidinout=0,nbound=0;
   for(unsigned p=0;p<Np;p++)if(errpart[p]){
@@ -147,6 +140,7 @@ void JSphCpuSingle::InOutInit(double timestepini){
   TmcStart(Timers,TMC_SuInOut);
   Log->Print("InOut configuration:");
   if(PartBegin)RunException(met,"Simulation restart not allowed when Inlet/Outlet is used.");
+  if(SvCheckpoint)RunException(met,"Checkpoint (-checkpoint) is not available when Inlet/Outlet is used since the simulation can not be restarted.");
 
   //-Configures InOut zones and prepares new inout particles to create.
   const unsigned newnp=InOut->Config(timestepini,Stable,Simulate2D,Simulate2DPosY,PeriActive,RhopZero,CteB,Gamma,Gravity,Dp,MapRealPosMin,MapRealPosMax,MkInfo->GetCodeNewFluid(),PartsInit);
@@ -165,7 +159,8 @@ void JSphCpuSingle::InOutInit(double timestepini){
   }
 
   //-Creates initial inlet particles with pos, idp, code and velrhop=0.
-  unsigned idnext=IdMax+1;
+  if(ullong(TotalNp+newnp-1)>ullong(IDP_MAX))RunException(met,fun::PrintStr("The number of particle identifiers exceeds the maximum value supported (%u bits).",unsigned(sizeof(typeidp)*8)));
+  typeidp idnext=IdMax+1;
   InOut->LoadInitPartsData(idnext,newnp,Idpc+Np,Codec+Np,Posc+Np,Velrhopc+Np);
 
   //-Checks position of new particles and calculates cell.
@@ -179,9 +174,10 @@ void JSphCpuSingle::InOutInit(double timestepini){
   Np+=newnp;
   TotalNp+=newnp;
   InOut->AddNewNp(newnp);
-  IdMax=unsigned(TotalNp-1);
+  IdMax=typeidp(TotalNp-1);
   
   //-Checks proximity of inout particles to other particles and excludes fluid particles near the inout particles.
+  RunCellDivide(true,false); //-Includes new particles in cells without converting fluid in inout zones yet.
   InOutCheckProximity(newnp);
 
   //-Shows configuration.
@@ -233,6 +229,9 @@ void JSphCpuSingle::InOutComputeStep(double stepdt){
   //-Removes interpolated Z velocity of inlet/outlet particles.
   if(InOut->GetInterpolatedVel())InOut->InterpolateResetZVelCpu(InOutCount,InOutPartc,Codec,Velrhopc);
 
+  //-Checks that identifiers of new inlet particles do not overflow. | Comprueba que los identificadores de nuevas particulas inlet no desborden.
+  if(ullong(TotalNp+InOutCount-1)>ullong(IDP_MAX))RunException(met,fun::PrintStr("The number of particle identifiers exceeds the maximum value supported (%u bits) at t=%g.",unsigned(sizeof(typeidp)*8),TimeStep));
+
   //-Updates position of inout particles according its velocity and create new inlet particles.
   unsigned newnp=0;
   if(InOut->GetUseRefilling()){
@@ -252,7 +251,7 @@ void JSphCpuSingle::InOutComputeStep(double stepdt){
     Np+=newnp;
     TotalNp+=newnp;
     InOut->AddNewNp(newnp);
-    IdMax=unsigned(TotalNp-1);
+    IdMax=typeidp(TotalNp-1);
   }
 
   //-Updates divide information.
@@ -54,7 +54,7 @@ template<bool sim2d,TpKernel tker> void JSphCpu::InteractionInOutExtrap_Double
   ,const tplane3f *planes,const float* width,const tfloat3 *dirdata,float determlimit
   ,tint4 nc,int hdiv,unsigned cellinitial
   ,const unsigned *beginendcell,tint3 cellzero,const unsigned *dcell
-  ,const tdouble3 *pos,const typecode *code,const unsigned *idp
+  ,const tdouble3 *pos,const typecode *code,const typeidp *idp
   ,tfloat4 *velrhop)
 {
   const char met[]="InteractionInOutExtrap_Double3";
@@ -256,7 +256,7 @@ template<bool sim2d,TpKernel tker> void JSphCpu::InteractionInOutExtrap_Single
   ,const tplane3f *planes,const float* width,const tfloat3 *dirdata,float determlimit
   ,tint4 nc,int hdiv,unsigned cellinitial
   ,const unsigned *beginendcell,tint3 cellzero,const unsigned *dcell
-  ,const tdouble3 *pos,const typecode *code,const unsigned *idp
+  ,const tdouble3 *pos,const typecode *code,const typeidp *idp
   ,tfloat4 *velrhop)
 {
   const char met[]="InteractionInOutExtrap_Double2";
@@ -452,7 +452,7 @@ void JSphCpu::Interaction_InOutExtrap(byte doublemode,unsigned inoutcount,const
   ,const byte *cfgzone,const tplane3f *planes
   ,const float* width,const tfloat3 *dirdata,float determlimit
   ,tuint3 ncells,const unsigned *begincell,tuint3 cellmin,const unsigned *dcell
-  ,const tdouble3 *pos,const typecode *code,const unsigned *idp
+  ,const tdouble3 *pos,const typecode *code,const typeidp *idp
   ,tfloat4 *velrhop)
 {
   const tint4 nc=TInt4(int(ncells.x),int(ncells.y),int(ncells.z),int(ncells.x*ncells.y));
@@ -531,6 +531,54 @@ float JSphCpu::Interaction_InOutZsurf(unsigned nptz,const tfloat3 *ptzpos,float
   return(zsurfmax);
 }
 
+//==============================================================================
+/// Marks particles at distance dist or less from new inout particles (normal 
+/// particles with idp>=idini) using the cell division. Each particle only 
+/// writes its own value in nearby[] (1:nearby, 0:otherwise), so the loop runs 
+/// in parallel without synchronisation.
+///
+/// Marca las particulas a distancia dist o menor de nuevas particulas inout
+/// (particulas normales con idp>=idini) usando la division en celdas.
+//==============================================================================
+void JSphCpu::Interaction_InOutProximity(unsigned npbok,unsigned npb,unsigned np,typeidp idini,double dist
+  ,tuint3 ncells,const unsigned *beginendcell,tuint3 cellmin
+  ,const tdouble3 *pos,const typecode *code,const typeidp *idp,unsigned *nearby)const
+{
+  const tint4 nc=TInt4(int(ncells.x),int(ncells.y),int(ncells.z),int(ncells.x*ncells.y));
+  const tint3 cellzero=TInt3(cellmin.x,cellmin.y,cellmin.z);
+  const unsigned cellfluid=nc.w*nc.z+1;
+  const int hdiv=(CellMode==CELLMODE_H? 2: 1);
+  const double dist2=dist*dist;
+  const int n=int(np);
+  #ifdef OMP_USE
+    #pragma omp parallel for schedule (guided)
+  #endif
+  for(int p1=0;p1<n;p1++){
+    unsigned near1=0;
+    if(unsigned(p1)<npbok || unsigned(p1)>=npb){//-Ignores boundary particles out of the cells.
+      const tdouble3 posp1=pos[p1];
+      //-Obtain limits of interaction.
+      int cxini,cxfin,yini,yfin,zini,zfin;
+      GetInteractionCells(posp1,hdiv,nc,cellzero,cxini,cxfin,yini,yfin,zini,zfin);
+
+      //-Search for new inout particles in adjacent fluid cells. | Busqueda de nuevas particulas inout en celdas de fluido adyacentes.
+      for(int z=zini;z<zfin && !near1;z++){
+        const int zmod=(nc.w)*z+cellfluid; //-Sum from start of fluid cells. | Le suma donde empiezan las celdas de fluido.
+        for(int y=yini;y<yfin && !near1;y++){
+          int ymod=zmod+nc.x*y;
+          const unsigned pini=beginendcell[cxini+ymod];
+          const unsigned pfin=beginendcell[cxfin+ymod];
+          for(unsigned p2=pini;p2<pfin;p2++)if(idp[p2]>=idini && p2!=unsigned(p1) && CODE_IsNormal(code[p2])){
+            const tdouble3 ds=posp1-pos[p2];
+            if(ds.x*ds.x+ds.y*ds.y+ds.z*ds.z<=dist2){ near1=1; break; }
+          }
+        }
+      }
+    }
+    nearby[p1]=near1;
+  }
+}
+
 //==============================================================================
 /// Perform interaction between ghost node of selected boundary and fluid.
 //==============================================================================
@@ -538,7 +586,7 @@ template<bool sim2d,TpKernel tker> void JSphCpu::InteractionBoundCorr_Double
   (unsigned npb,typecode boundcode,tplane3f plane,tfloat3 direction,float determlimit
   ,tint4 nc,int hdiv,unsigned cellinitial
   ,const unsigned *beginendcell,tint3 cellzero
-  ,const tdouble3 *pos,const typecode *code,const unsigned *idp
+  ,const tdouble3 *pos,const typecode *code,const typeidp *idp
   ,tfloat4 *velrhop)
 {
   const char met[]="InteractionBoundCorr_Double";
@@ -663,7 +711,7 @@ template<bool sim2d,TpKernel tker> void JSphCpu::InteractionBoundCorr_Single
   (unsigned npb,typecode boundcode,tplane3f plane,tfloat3 direction,float determlimit
   ,tint4 nc,int hdiv,unsigned cellinitial
   ,const unsigned *beginendcell,tint3 cellzero
-  ,const tdouble3 *pos,const typecode *code,const unsigned *idp
+  ,const tdouble3 *pos,const typecode *code,const typeidp *idp
   ,tfloat4 *velrhop)
 {
   const char met[]="InteractionBoundCorr_Single";
@@ -786,7 +834,7 @@ template<bool sim2d,TpKernel tker> void JSphCpu::InteractionBoundCorr_Single
 //==============================================================================
 void JSphCpu::Interaction_BoundCorr(byte doublemode,typecode boundcode,tplane3f plane,tfloat3 direction,float determlimit
   ,tuint3 ncells,const unsigned *begincell,tuint3 cellmin
-  ,const tdouble3 *pos,const typecode *code,const unsigned *idp
+  ,const tdouble3 *pos,const typecode *code,const typeidp *idp
   ,tfloat4 *velrhop)
 {
   const tint4 nc=TInt4(int(ncells.x),int(ncells.y),int(ncells.z),int(ncells.x*ncells.y));
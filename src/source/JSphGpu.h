@@ -26,6 +26,10 @@
 #include "JSph.h"
 #include <string>
 
+#ifdef IDP_SIZE8
+  #error IDP_SIZE8 (64-bit particle identifiers) is only supported on CPU.
+#endif
+
 class JPartsOut;
 class JArraysGpu;
 class JCellDivGpu;
@@ -36,6 +36,7 @@
 #include "JSphGpu_ker.h"
 #include "JBlockSizeAuto.h"
 #include "JGaugeSystem.h"
+#include "JSphSaveRegions.h"
 #include "JSphInOut.h"  //<vs_innlet>
 #include "JLinearValue.h"
 #include <climits>
@@ -122,6 +123,7 @@ void JSphGpuSingle::LoadConfig(JCfgRun *cfg){
   JSph::LoadConfig(cfg);
   BlockSizeMode=cfg->BlockSizeMode;
   //-Checks compatibility of selected options.
+  if(SvCheckpoint || Checkpoint)RunException(met,"Checkpoint/restart is not available on GPU.");
   Log->Print("**Special case configuration is loaded");
 }
 
@@ -270,7 +272,7 @@ void JSphGpuSingle::RunPeriodic(){
           unsigned* listpg=ArraysGpu->ReserveUint();
           unsigned nmax=GpuParticlesSize-1; //-Maximum number of particles that can be included in the list. | Numero maximo de particulas que caben en la lista.
           //-Generates list of new periodic particles
-          if(Np>=0x80000000)RunException(met,"The number of particles is too big.");//-Because the last bit is used to mark the reason the new periodical is created. | Porque el ultimo bit se usa para marcar el sentido en que se crea la nueva periodica. 
+          if(Np>=0x80000000)RunException(met,fun::PrintStr("The number of particles (%u) is too big, the maximum with periodic conditions is 2^31 particles.",Np));//-Because the last bit is used to mark the reason the new periodical is created. | Porque el ultimo bit se usa para marcar el sentido en que se crea la nueva periodica. 
           unsigned count=cusph::PeriodicMakeList(num2,pini2,Stable,nmax,Map_PosMin,Map_PosMax,perinc,Posxyg,Poszg,Codeg,listpg);
           //-Resizes the memory size for the particles if there is not sufficient space and repeats the serach process.
           //-Redimensiona memoria para particulas si no hay espacio suficiente y repite el proceso de busqueda.
@@ -694,6 +696,7 @@ void JSphGpuSingle::Run(std::string appname,JCfgRun *cfg,JLog2 *log){
       TimePartNext=TimeOut->GetNextTime(TimeStep);
       TimerPart.Start();
     }
+    if(SaveRegions)RunSaveRegions();
     UpdateMaxValues();
     Nstep++;
     if(Part<=PartIni+1 && tc.CheckTime())Log->Print(string("  ")+tc.GetInfoFinish((TimeStep-TimeStepIni)/(TimeMax-TimeStepIni)));
@@ -751,11 +754,29 @@ void JSphGpuSingle::SaveData(){
   TmgStop(Timers,TMG_SuSavePart);
 }
 
+//==============================================================================
+/// Graba datos de las regiones de salida entre instantes de PART.
+/// Stores data of output regions between PART instants.
+//==============================================================================
+void JSphGpuSingle::RunSaveRegions(){
+  if(SaveRegions->CheckTime(TimeStep)){
+    const unsigned npsave=Np-NpbPer-NpfPer;
+    TmgStart(Timers,TMG_SuDownData);
+    unsigned npnormal=ParticlesDataDown(Np,0,false,PeriActive!=0);
+    if(npnormal!=npsave)RunException("RunSaveRegions","The number of particles is invalid.");
+    TmgStop(Timers,TMG_SuDownData);
+    TmgStart(Timers,TMG_SuSavePart);
+    SaveRegionsData(npsave,Idp,AuxPos,AuxVel,AuxRhop);
+    TmgStop(Timers,TMG_SuSavePart);
+  }
+}
+
 //==============================================================================
 /// Displays and stores final summary of the execution.
 /// Muestra y graba resumen final de ejecucion.
 //==============================================================================
 void JSphGpuSingle::FinishRun(bool stop){
+  FinishSaveData();
   if(BsAuto){ delete BsAuto; BsAuto=NULL; }
   float tsim=TimerSim.GetElapsedTimeF()/1000.f,ttot=TimerTot.GetElapsedTimeF()/1000.f;
   JSph::ShowResume(stop,tsim,ttot,true,"");
@@ -63,6 +63,7 @@ protected:
   void RunGaugeSystem(double timestep);
 
   void SaveData();
+  void RunSaveRegions();
   void FinishRun(bool stop);
 
 public:
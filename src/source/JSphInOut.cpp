@@ -1353,7 +1353,7 @@ unsigned JSphInOut::Config(double timestep,bool stable,bool simulate2d,double si
 //==============================================================================
 /// Loads basic data (pos,idp,code,velrhop=0) for initial inout particles.
 //==============================================================================
-void JSphInOut::LoadInitPartsData(unsigned idpfirst,unsigned nparttot,unsigned* idp,typecode* code,tdouble3* pos,tfloat4* velrhop){
+void JSphInOut::LoadInitPartsData(typeidp idpfirst,unsigned nparttot,typeidp* idp,typecode* code,tdouble3* pos,tfloat4* velrhop){
   const char met[]="LoadInitPartsData";
   //Log->Printf(" LoadInitPartsData--> nparttot:%u",nparttot);
   unsigned npart=0;
@@ -1379,7 +1379,7 @@ void JSphInOut::LoadInitPartsData(unsigned idpfirst,unsigned nparttot,unsigned*
 /// new inlet/outlet particles from normal fluid.
 //==============================================================================
 unsigned JSphInOut::CreateListCpu(unsigned nstep,unsigned npf,unsigned pini
-  ,const tdouble3 *pos,const unsigned *idp,typecode *code,int *inoutpart)
+  ,const tdouble3 *pos,const typeidp *idp,typecode *code,int *inoutpart)
 {
   const char met[]="CreateListCpu";
   unsigned count=0;
@@ -1495,7 +1495,7 @@ bool JSphInOut::UpdateZsurf(double timestep,bool full){
 /// Actualiza velocidad y densidad de particulas inlet/outlet cuando no es extrapolada.
 //==============================================================================
 void JSphInOut::UpdateDataCpu(float timestep,bool full,unsigned inoutcount,const int *inoutpart
-  ,const tdouble3 *pos,const typecode *code,const unsigned *idp,tfloat4 *velrhop)
+  ,const tdouble3 *pos,const typecode *code,const typeidp *idp,tfloat4 *velrhop)
 {
   const bool modifvel=UpdateVelData(timestep,full);
   //const bool modifzsurf=UpdateZsurf(timestep,full);
@@ -1573,7 +1573,7 @@ void JSphInOut::UpdateDataGpu(float timestep,bool full,unsigned inoutcount,const
 /// Interpola velocidad de particulas inlet/outlet a partir de datos en el objeto InputVelGrid.
 //==============================================================================
 void JSphInOut::InterpolateVelCpu(float timestep,unsigned inoutcount,const int *inoutpart
-  ,const tdouble3 *pos,const typecode *code,const unsigned *idp,tfloat4 *velrhop)
+  ,const tdouble3 *pos,const typecode *code,const typeidp *idp,tfloat4 *velrhop)
 {
   for(unsigned ci=0;ci<GetCount();ci++)if(List[ci]->GetInterpolatedVel()){
     JSphInOutGridData* gd=List[ci]->GetInputVelGrid();
@@ -1644,8 +1644,8 @@ void JSphInOut::InterpolateResetZVelGpu(unsigned inoutcount,const int *inoutpart
 /// - If particle is moved out the domain then it changes to ignore particle.
 //==============================================================================
 unsigned JSphInOut::ComputeStepCpu(unsigned nstep,double dt,unsigned inoutcount,int *inoutpart
-  ,const JSphCpu *sphcpu,unsigned idnext,unsigned sizenp,unsigned np
-  ,tdouble3 *pos,unsigned *dcell,typecode *code,unsigned *idp,tfloat4 *velrhop)
+  ,const JSphCpu *sphcpu,typeidp idnext,unsigned sizenp,unsigned np
+  ,tdouble3 *pos,unsigned *dcell,typecode *code,typeidp *idp,tfloat4 *velrhop)
 {
   const char met[]="ComputeStepCpu";
   //-Checks particle position.
@@ -1728,8 +1728,8 @@ unsigned JSphInOut::ComputeStepGpu(unsigned nstep,double dt,unsigned inoutcount,
 /// - If particle is moved out the domain then it changes to ignore particle.
 //==============================================================================
 unsigned JSphInOut::ComputeStepFillingCpu(unsigned nstep,double dt,unsigned inoutcount,int *inoutpart
-  ,const JSphCpu *sphcpu,unsigned idnext,unsigned sizenp,unsigned np
-  ,tdouble3 *pos,unsigned *dcell,typecode *code,unsigned *idp,tfloat4 *velrhop
+  ,const JSphCpu *sphcpu,typeidp idnext,unsigned sizenp,unsigned np
+  ,tdouble3 *pos,unsigned *dcell,typecode *code,typeidp *idp,tfloat4 *velrhop
   ,float *prodist,tdouble3 *propos)
 {
   const char met[]="ComputeStepFillingCpu";
@@ -2002,6 +2002,15 @@ unsigned JSphInOut::CalcResizeNp(double timestep)const{
   return(newp);
 }
 
+//==============================================================================
+/// Calculates number of new particles for a given time interval.
+//==============================================================================
+ullong JSphInOut::CalcResizeNp(double timestep,double timeinterval)const{
+  ullong newp=0;
+  for(unsigned ci=0;ci<GetCount();ci++)newp+=List[ci]->CalcResizeNp(timestep,timeinterval);
+  return(newp);
+}
+
 
 
 
@@ -367,26 +367,26 @@ public:
     ,byte periactive,float rhopzero,float cteb,float gamma,tfloat3 gravity,double dp
     ,tdouble3 posmin,tdouble3 posmax,typecode codenewpart,const JSphPartsInit *partsdata);
     
-  void LoadInitPartsData(unsigned idpfirst,unsigned npart,unsigned* idp,typecode* code,tdouble3* pos,tfloat4* velrhop);
+  void LoadInitPartsData(typeidp idpfirst,unsigned npart,typeidp* idp,typecode* code,tdouble3* pos,tfloat4* velrhop);
 
 
 //-Specific code for CPU.
   unsigned CreateListCpu(unsigned nstep,unsigned npf,unsigned pini
-    ,const tdouble3 *pos,const unsigned *idp,typecode *code,int *inoutpart);
+    ,const tdouble3 *pos,const typeidp *idp,typecode *code,int *inoutpart);
   void UpdateDataCpu(float timestep,bool full,unsigned inoutcount,const int *inoutpart
-    ,const tdouble3 *pos,const typecode *code,const unsigned *idp,tfloat4 *velrhop);
+    ,const tdouble3 *pos,const typecode *code,const typeidp *idp,tfloat4 *velrhop);
 
   void InterpolateVelCpu(float timestep,unsigned inoutcount,const int *inoutpart
-    ,const tdouble3 *pos,const typecode *code,const unsigned *idp,tfloat4 *velrhop);
+    ,const tdouble3 *pos,const typecode *code,const typeidp *idp,tfloat4 *velrhop);
   void InterpolateResetZVelCpu(unsigned inoutcount,const int *inoutpart
     ,const typecode *code,tfloat4 *velrhop);
 
   unsigned ComputeStepCpu(unsigned nstep,double dt,unsigned inoutcount,int *inoutpart
-    ,const JSphCpu *sphcpu,unsigned idnext,unsigned sizenp,unsigned np
-    ,tdouble3 *pos,unsigned *dcell,typecode *code,unsigned *idp,tfloat4 *velrhop);
+    ,const JSphCpu *sphcpu,typeidp idnext,unsigned sizenp,unsigned np
+    ,tdouble3 *pos,unsigned *dcell,typecode *code,typeidp *idp,tfloat4 *velrhop);
   unsigned ComputeStepFillingCpu(unsigned nstep,double dt,unsigned inoutcount,int *inoutpart
-    ,const JSphCpu *sphcpu,unsigned idnext,unsigned sizenp,unsigned np
-    ,tdouble3 *pos,unsigned *dcell,typecode *code,unsigned *idp,tfloat4 *velrhop
+    ,const JSphCpu *sphcpu,typeidp idnext,unsigned sizenp,unsigned np
+    ,tdouble3 *pos,unsigned *dcell,typecode *code,typeidp *idp,tfloat4 *velrhop
     ,float *prodist,tdouble3 *propos);
 
   void UpdateVelrhopM1Cpu(unsigned inoutcount,const int *inoutpart
@@ -451,6 +451,7 @@ public:
   float GetZbottom(unsigned ci)const{ return(ci<ListSize? List[ci]->GetInputZbottom(): 0); }
 
   unsigned CalcResizeNp(double timestep)const;
+  ullong CalcResizeNp(double timestep,double timeinterval)const;
 
   void AddNewNp(unsigned newnp){ NewNpPart+=newnp; NewNpTotal+=newnp; }
   void ClearNewNpPart(){ NewNpPart=0; }
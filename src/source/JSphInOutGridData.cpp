@@ -392,7 +392,7 @@ void JSphInOutGridData::InterpolateVel(double time,unsigned np,const tdouble3* p
 /// Interpolate velocity in time and position of selected partiles in a list.
 //==============================================================================
 void JSphInOutGridData::InterpolateVelCpu(double time,unsigned izone,unsigned np,const int *plist
-  ,const tdouble3 *pos,const typecode *code,const unsigned *idp,tfloat4 *velrhop)
+  ,const tdouble3 *pos,const typecode *code,const typeidp *idp,tfloat4 *velrhop)
 {
   ComputeTime(time);
   const float *velx=SelData->GetVelx();
@@ -444,7 +444,7 @@ void JSphInOutGridData::InterpolateVelCpu(double time,unsigned izone,unsigned np
 /// Interpolate velocity in time and Z-position of selected partiles in a list.
 //==============================================================================
 void JSphInOutGridData::InterpolateZVelCpu(double time,unsigned izone,unsigned np,const int *plist
-  ,const tdouble3 *pos,const typecode *code,const unsigned *idp,tfloat4 *velrhop)
+  ,const tdouble3 *pos,const typecode *code,const typeidp *idp,tfloat4 *velrhop)
 {
   ComputeTime(time);
   const float *velx=SelData->GetVelx();
@@ -144,9 +144,9 @@ public:
 
   void InterpolateVel(double time,unsigned np,const tdouble3* pos,tfloat3 *vel);
   void InterpolateVelCpu(double time,unsigned izone,unsigned np,const int *plist
-    ,const tdouble3 *pos,const typecode *code,const unsigned *idp,tfloat4 *velrhop);
+    ,const tdouble3 *pos,const typecode *code,const typeidp *idp,tfloat4 *velrhop);
   void InterpolateZVelCpu(double time,unsigned izone,unsigned np,const int *plist
-    ,const tdouble3 *pos,const typecode *code,const unsigned *idp,tfloat4 *velrhop);
+    ,const tdouble3 *pos,const typecode *code,const typeidp *idp,tfloat4 *velrhop);
 
 #ifdef _WITHGPU
   void InterpolateZVelGpu(double time,unsigned izone,unsigned np,const int *plist
@@ -77,7 +77,7 @@ void JSphInitializeOp_FluidVel::ReadXml(JXml *sxml,TiXmlElement* xele){
 //==============================================================================
 /// Initializes data of particles according XML configuration.
 //==============================================================================
-void JSphInitializeOp_FluidVel::Run(unsigned np,unsigned npb,const tdouble3 *pos,const unsigned *idp,const word *mktype,tfloat4 *velrhop){
+void JSphInitializeOp_FluidVel::Run(unsigned np,unsigned npb,const tdouble3 *pos,const typeidp *idp,const word *mktype,tfloat4 *velrhop){
   const char met[]="Run";
   const tfloat3 dir=fgeo::VecUnitary(Direction);
   float m2=0,b2=0;
@@ -193,7 +193,7 @@ void JSphInitialize::ReadXml(JXml *sxml,TiXmlElement* lis){
 //==============================================================================
 /// Initializes data of particles according XML configuration.
 //==============================================================================
-void JSphInitialize::Run(unsigned np,unsigned npb,const tdouble3 *pos,const unsigned *idp,const word *mktype,tfloat4 *velrhop){
+void JSphInitialize::Run(unsigned np,unsigned npb,const tdouble3 *pos,const typeidp *idp,const word *mktype,tfloat4 *velrhop){
   for(unsigned c=0;c<Count();c++){
     Opes[c]->Run(np,npb,pos,idp,mktype,velrhop);
   }
@@ -33,7 +33,7 @@
 #include <cstdlib>
 #include <cmath>
 #include "JObject.h"
-#include "TypesDef.h"
+#include "Types.h"
 
 class JXml;
 class TiXmlElement;
@@ -60,7 +60,7 @@ public:
   } 
   virtual ~JSphInitializeOp(){ DestructorActive=true; }
   virtual void ReadXml(JXml *sxml,TiXmlElement* ele)=0;
-  virtual void Run(unsigned np,unsigned npb,const tdouble3 *pos,const unsigned *idp,const word *mktype,tfloat4 *velrhop)=0;
+  virtual void Run(unsigned np,unsigned npb,const tdouble3 *pos,const typeidp *idp,const word *mktype,tfloat4 *velrhop)=0;
   virtual void GetConfig(std::vector<std::string> &lines)const=0;
 };
 
@@ -92,7 +92,7 @@ public:
   }
   void Reset();
   void ReadXml(JXml *sxml,TiXmlElement* ele);
-  void Run(unsigned np,unsigned npb,const tdouble3 *pos,const unsigned *idp,const word *mktype,tfloat4 *velrhop);
+  void Run(unsigned np,unsigned npb,const tdouble3 *pos,const typeidp *idp,const word *mktype,tfloat4 *velrhop);
   void GetConfig(std::vector<std::string> &lines)const;
 };  
 
@@ -116,7 +116,7 @@ public:
   void Reset();
   unsigned Count()const{ return(unsigned(Opes.size())); }
 
-  void Run(unsigned np,unsigned npb,const tdouble3 *pos,const unsigned *idp,const word *mktype,tfloat4 *velrhop);
+  void Run(unsigned np,unsigned npb,const tdouble3 *pos,const typeidp *idp,const word *mktype,tfloat4 *velrhop);
   void GetConfig(std::vector<std::string> &lines)const;
 
 };
@@ -152,7 +152,7 @@ unsigned JSphMk::GetFirstBlockType(TpParticles type)const{
 //==============================================================================
 /// Returns the block in MkList according to a given Id.
 //==============================================================================
-unsigned JSphMk::GetMkBlockById(unsigned id)const{
+unsigned JSphMk::GetMkBlockById(typeidp id)const{
   unsigned c=0;
   for(;c<MkListSize && id>=(MkList[c]->Begin+MkList[c]->Count);c++);
   return(c);
@@ -161,10 +161,10 @@ unsigned JSphMk::GetMkBlockById(unsigned id)const{
 //==============================================================================
 /// Returns the particle code according to a given Id.
 //==============================================================================
-typecode JSphMk::GetCodeById(unsigned id)const{
+typecode JSphMk::GetCodeById(typeidp id)const{
   const char met[]="GetCodeById";
   const unsigned cmk=GetMkBlockById(id);
-  if(cmk>=Size())RunException(met,fun::PrintStr("Mk block of particle (idp=%u) was not found.",id));
+  if(cmk>=Size())RunException(met,fun::PrintStr("Mk block of particle (idp=%s) was not found.",fun::UlongStr(id).c_str()));
   return(MkList[cmk]->Code);
 }
 
@@ -21,6 +21,7 @@
 //:# =========
 //:# - Creacion de clase para gestionar informacion relativa a MK de particulas. (25-01-2018)
 //:# - Nuevos metodos CountBlockType() y GetFirstBlockType(). (14-08-2018)
+//:# - GetCodeById() y GetMkBlockById() usan typeidp para Idp de 64 bits. (18-10-2026)
 //:#############################################################################
 
 /// \file JSphMk.h \brief Declares the class \ref JSphMk.
@@ -102,8 +103,8 @@ public:
 
   typecode GetCodeNewFluid()const{ return(CodeNewFluid); }
 
-  unsigned GetMkBlockById(unsigned id)const;
-  typecode GetCodeById(unsigned id)const;
+  unsigned GetMkBlockById(typeidp id)const;
+  typecode GetCodeById(typeidp id)const;
 
   word GetMkBoundFirst()const{ return(MkBoundFirst); }
   word GetMkFluidFirst()const{ return(MkFluidFirst); }
@@ -0,0 +1,161 @@
+//HEAD_DSPH
+/*
+ <DUALSPHYSICS>  Copyright (c) 2019 by Dr Jose M. Dominguez et al. (see http://dual.sphysics.org/index.php/developers/).
+
+ EPHYSLAB Environmental Physics Laboratory, Universidade de Vigo, Ourense, Spain.
+ School of Mechanical, Aerospace and Civil Engineering, University of Manchester, Manchester, U.K.
+
+ This file is part of DualSPHysics.
+
+ DualSPHysics is free software: you can redistribute it and/or modify it under the terms of the GNU Lesser General Public License
+ as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) any later version.
+
+ DualSPHysics is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License along with DualSPHysics. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+//:#############################################################################
+//:# Descripcion:
+//:# =============
+//:# Interfaz de modulos de analisis que se ejecutan dentro del proceso de
+//:# simulacion (compilados con el programa o cargados desde librerias
+//:# dinamicas). Los modulos reciben vistas de solo lectura de los datos de
+//:# particulas y de la division en celdas sin copiar los datos.
+//:# Este fichero solo depende de Types.h para poder compilar librerias
+//:# externas sin el resto del codigo.
+//:#
+//:# Cambios:
+//:# =========
+//:# - Implementacion. (18-10-2026)
+//:#############################################################################
+
+/// \file JSphPlugin.h \brief Declares the interface \ref JSphPlugin for analysis plugins.
+
+#ifndef _JSphPlugin_
+#define _JSphPlugin_
+
+#include "Types.h"
+#include <string>
+#include <vector>
+
+#define JSPHPLUGIN_VERSION 1  ///<Version of the plugin interface (must match in shared libraries).
+
+//##############################################################################
+//# JSphPlugin
+//##############################################################################
+/// \brief Interface of analysis plugins executed during the simulation.
+/// Plugins are compiled with the program (JSphPlugins::RegisterFactory()) or
+/// loaded from shared libraries that export the functions
+/// DsphPluginVersion() and DsphPluginCreate() (see \ref JSPHPLUGIN_EXPORT).
+/// The particle data received by StepEnd() and PartSave() are the arrays of
+/// the solver (zero-copy), so they are only valid during the call and must
+/// not be modified. Errors are reported throwing std::string or std::exception.
+
+class JSphPlugin
+{
+public:
+  /// Parameter of plugin configuration (from XML).
+  typedef struct{
+    std::string key;
+    std::string value;
+  }StParam;
+
+  /// Constant values of the simulation given to Init().
+  typedef struct{
+    std::string appname;     ///<Name and version of the application.
+    std::string dirout;      ///<Output directory.
+    std::string dirdataout;  ///<Output directory for particle data.
+    std::string casename;    ///<Name of the case.
+    bool csvsepcoma;         ///<Separator character in CSV files (false=semicolon, true=coma).
+    bool simulate2d;         ///<2D simulation.
+    double simulate2dposy;   ///<Y value in 2D simulations.
+    double dp;               ///<Initial distance between particles.
+    float h;                 ///<Smoothing length.
+    float massfluid;         ///<Mass of fluid particles.
+    float massbound;         ///<Mass of boundary particles.
+    float cteb;              ///<Constant of the equation of state.
+    float gamma;             ///<Polytropic constant of the equation of state.
+    float rhopzero;          ///<Reference density of the fluid.
+    tfloat3 gravity;         ///<Gravity acceleration.
+    double timemax;          ///<Total time of simulation.
+    double timepart;         ///<Time between PART files.
+    unsigned casenp;         ///<Number of particles of the case.
+    unsigned casenbound;     ///<Number of boundary particles of the case (fixed, moving and floating).
+    unsigned casenfixed;     ///<Number of fixed boundary particles of the case.
+    unsigned casenmoving;    ///<Number of moving boundary particles of the case.
+    unsigned casenfloat;     ///<Number of floating particles of the case.
+  }StSetup;
+
+  /// Read-only view of the particle data of the solver (valid only during the call).
+  /// Boundary particles are stored first [0,npb) and the valid ones are [0,npbok).
+  /// Fluid and floating particles are [npb,np). Periodic copies are included
+  /// and can be excluded with CODE_IsNormal(code[p]).
+  typedef struct{
+    double timestep;         ///<Current instant of the simulation.
+    double dt;               ///<Last time step (zero before the first step).
+    int nstep;               ///<Number of the current step (starts at 0).
+    unsigned part;           ///<Number of the PART being saved in PartSave() or the next PART in StepEnd().
+    unsigned np;             ///<Total number of particles.
+    unsigned npb;            ///<Number of boundary particles.
+    unsigned npbok;          ///<Number of boundary particles inside the domain.
+    const tdouble3 *pos;     ///<Position of particles [np].
+    const tfloat4 *velrhop;  ///<Velocity and density of particles [np].
+    const typeidp *idp;     ///<Identifier of particles [np].
+    const typecode *code;    ///<Code of particles (type, mk block and special state) [np].
+    const unsigned *dcell;   ///<Cell of particles encoded with domcellcode [np].
+    //-Cell division (particles are sorted by cell).
+    tuint3 ncells;           ///<Number of cells of the division in each direction.
+    tuint3 cellmin;          ///<First cell of the division in the domain.
+    const unsigned *begincell; ///<First particle of each cell (boundary cells and then fluid cells starting at ncells.x*ncells.y*ncells.z+1).
+    unsigned domcellcode;    ///<Key to decode dcell (see PC__Cellx(), PC__Celly() and PC__Cellz()).
+    tdouble3 domposmin;      ///<Minimum position of the domain of the cells.
+    float scell;             ///<Size of cells.
+    int hdiv;                ///<Number of cells of interaction (2h/scell).
+  }StParticles;
+
+public:
+  virtual ~JSphPlugin(){}
+
+  /// Returns the name of the plugin type.
+  virtual std::string GetName()const=0;
+  /// The plugin can be executed at the same time as other plugins (it does not share data with them).
+  virtual bool ThreadSafe()const{ return(false); }
+  /// PartSave() is executed in a background thread while the solver saves the PART files.
+  virtual bool AsyncPart()const{ return(false); }
+
+  /// Initialises the plugin with the name of the instance and its parameters.
+  virtual void Init(const std::string &name,const std::vector<StParam> &params,const StSetup &setup)=0;
+  /// Returns lines with configuration information.
+  virtual void GetConfig(std::vector<std::string> &lines)const{}
+  /// Called at the end of each step after the cell division.
+  virtual void StepEnd(const StParticles &data){}
+  /// Called when a PART is saved.
+  virtual void PartSave(const StParticles &data){}
+  /// Called at the end of the simulation.
+  virtual void Finish(){}
+};
+
+/// Function to create plugins compiled with the program.
+typedef JSphPlugin* (*JSphPluginFactory)();
+
+/// Functions exported by shared libraries with plugins.
+/// Funciones exportadas por librerias dinamicas con plugins.
+typedef unsigned (*JSphPluginVersionFun)();
+typedef JSphPlugin* (*JSphPluginCreateFun)(const char *type);
+
+#ifdef WIN32
+  #define JSPHPLUGIN_DLLEXPORT __declspec(dllexport)
+#else
+  #define JSPHPLUGIN_DLLEXPORT __attribute__((visibility("default")))
+#endif
+
+/// Defines the entry points of a shared library with plugins. The function
+/// createfun(const char *type) returns a new plugin of the requested type or NULL.
+#define JSPHPLUGIN_EXPORT(createfun) \
+  extern "C" JSPHPLUGIN_DLLEXPORT unsigned DsphPluginVersion(){ return(JSPHPLUGIN_VERSION); } \
+  extern "C" JSPHPLUGIN_DLLEXPORT JSphPlugin* DsphPluginCreate(const char *type){ return(createfun(type)); }
+
+#endif
+
@@ -0,0 +1,482 @@
+//HEAD_DSPH
+/*
+ <DUALSPHYSICS>  Copyright (c) 2019 by Dr Jose M. Dominguez et al. (see http://dual.sphysics.org/index.php/developers/).
+
+ EPHYSLAB Environmental Physics Laboratory, Universidade de Vigo, Ourense, Spain.
+ School of Mechanical, Aerospace and Civil Engineering, University of Manchester, Manchester, U.K.
+
+ This file is part of DualSPHysics.
+
+ DualSPHysics is free software: you can redistribute it and/or modify it under the terms of the GNU Lesser General Public License
+ as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) any later version.
+
+ DualSPHysics is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License along with DualSPHysics. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/// \file JSphPlugins.cpp \brief Implements the class \ref JSphPlugins.
+
+#include "JSphPlugins.h"
+#include "JLog2.h"
+#include "JXml.h"
+#include "Functions.h"
+#include "JSaveCsv2.h"
+#include "JException.h"
+#include <cstdlib>
+#include <cstring>
+#include <climits>
+#include <algorithm>
+#ifdef OMP_USE
+  #include <omp.h>
+#endif
+#ifndef WIN32
+  #include <dlfcn.h>
+#endif
+
+using namespace std;
+
+//##############################################################################
+//# JSphPluginEnergy
+//##############################################################################
+/// \brief Plugin compiled with the program that computes kinetic and potential
+/// energy of fluid particles in each PART (and every N steps with parameter
+/// <steps value="N"/>). Results are saved in PluginEnergy_<name>.csv.
+
+class JSphPluginEnergy : public JSphPlugin
+{
+protected:
+  /// Structure with the results of one instant.
+  typedef struct{
+    double timestep;
+    int nstep;
+    unsigned np;
+    double ekin;
+    double epot;
+  }StResult;
+
+  std::string Name;
+  std::string FileCsv;
+  unsigned Steps;          ///<Computes energy every Steps steps (0:only PARTs).
+  bool CsvSepComa;
+  double MassFluid;
+  tdouble3 Gravity;
+  std::vector<StResult> Results;  ///<Results pending to be saved.
+  bool FileInit;
+
+  StResult Compute(const StParticles &data)const;
+  void SaveResults();
+
+public:
+  JSphPluginEnergy():Steps(0),CsvSepComa(false),MassFluid(0),FileInit(false){ Gravity=TDouble3(0); }
+  std::string GetName()const{ return("Energy"); }
+  bool AsyncPart()const{ return(true); }
+  void Init(const std::string &name,const std::vector<StParam> &params,const StSetup &setup);
+  void GetConfig(std::vector<std::string> &lines)const;
+  void StepEnd(const StParticles &data);
+  void PartSave(const StParticles &data);
+  void Finish(){ SaveResults(); }
+  static JSphPlugin* Create(){ return(new JSphPluginEnergy()); }
+};
+
+//==============================================================================
+/// Initialises plugin.
+//==============================================================================
+void JSphPluginEnergy::Init(const std::string &name,const std::vector<StParam> &params,const StSetup &setup){
+  Name=name;
+  for(unsigned c=0;c<unsigned(params.size());c++){
+    if(params[c].key=="steps")Steps=unsigned(atoi(params[c].value.c_str()));
+    else throw string("The parameter \'")+params[c].key+"\' is invalid.";
+  }
+  CsvSepComa=setup.csvsepcoma;
+  MassFluid=setup.massfluid;
+  Gravity=ToTDouble3(setup.gravity);
+  FileCsv=setup.dirout+"PluginEnergy_"+Name+".csv";
+}
+
+//==============================================================================
+/// Returns lines with configuration information.
+//==============================================================================
+void JSphPluginEnergy::GetConfig(std::vector<std::string> &lines)const{
+  lines.push_back(fun::PrintStr("Steps....: %u%s",Steps,(Steps? "": " (only PARTs)")));
+  lines.push_back(string("File.....: ")+fun::GetFile(FileCsv));
+}
+
+//==============================================================================
+/// Computes kinetic and potential energy of normal fluid particles.
+//==============================================================================
+JSphPluginEnergy::StResult JSphPluginEnergy::Compute(const StParticles &data)const{
+  const int pini=int(data.npb),pfin=int(data.np);
+  double ekin=0,epot=0;
+  int nfluid=0;
+  #ifdef OMP_USE
+    #pragma omp parallel for schedule (static) reduction(+:ekin,epot,nfluid)
+  #endif
+  for(int p=pini;p<pfin;p++){
+    const typecode rcode=data.code[p];
+    if(CODE_IsNormal(rcode) && CODE_IsFluid(rcode)){
+      const tfloat4 v=data.velrhop[p];
+      const tdouble3 ps=data.pos[p];
+      ekin+=double(v.x)*v.x+double(v.y)*v.y+double(v.z)*v.z;
+      epot-=Gravity.x*ps.x+Gravity.y*ps.y+Gravity.z*ps.z;
+      nfluid++;
+    }
+  }
+  StResult res={data.timestep,data.nstep,unsigned(nfluid),ekin*MassFluid*0.5,epot*MassFluid};
+  return(res);
+}
+
+//==============================================================================
+/// Computes energy at the end of the step when it is required.
+//==============================================================================
+void JSphPluginEnergy::StepEnd(const StParticles &data){
+  if(Steps && data.nstep%Steps==0)Results.push_back(Compute(data));
+}
+
+//==============================================================================
+/// Computes energy of the PART and saves pending results.
+//==============================================================================
+void JSphPluginEnergy::PartSave(const StParticles &data){
+  if(Results.empty() || Results.back().nstep!=data.nstep || Results.back().timestep!=data.timestep)Results.push_back(Compute(data));
+  SaveResults();
+}
+
+//==============================================================================
+/// Saves pending results in CSV file.
+//==============================================================================
+void JSphPluginEnergy::SaveResults(){
+  if(Results.empty())return;
+  jcsv::JSaveCsv2 scsv(FileCsv,FileInit,CsvSepComa);
+  if(!FileInit){
+    scsv.SetHead();
+    scsv << "Time [s];Step;Np;EKin [J];EPot [J];ETotal [J]" << jcsv::Endl();
+    FileInit=true;
+  }
+  scsv.SetData();
+  scsv << jcsv::Fmt(jcsv::TpDouble1,"%20.12E");
+  for(unsigned c=0;c<unsigned(Results.size());c++){
+    const StResult &r=Results[c];
+    scsv << r.timestep << r.nstep << r.np << r.ekin << r.epot << (r.ekin+r.epot) << jcsv::Endl();
+  }
+  scsv.SaveData();
+  Results.clear();
+}
+
+
+//##############################################################################
+//# JSphPlugins
+//##############################################################################
+//==============================================================================
+/// Constructor.
+//==============================================================================
+JSphPlugins::JSphPlugins(JLog2* log):Log(log){
+  ClassName="JSphPlugins";
+  RegisterFactory("Energy",JSphPluginEnergy::Create);
+  Reset();
+}
+
+//==============================================================================
+/// Destructor.
+//==============================================================================
+JSphPlugins::~JSphPlugins(){
+  DestructorActive=true;
+  Reset();
+}
+
+//==============================================================================
+/// Initialisation of variables.
+//==============================================================================
+void JSphPlugins::Reset(){
+  if(PartThread.joinable())PartThread.join();
+  PartError="";
+  for(unsigned c=0;c<unsigned(List.size());c++)delete List[c].plugin;
+  List.clear();
+  #ifndef WIN32
+    for(unsigned c=0;c<unsigned(Libraries.size());c++)dlclose(Libraries[c]);
+  #endif
+  Libraries.clear();
+  StepSafe.clear();
+  StepSeq.clear();
+  memset(&PartData,0,sizeof(JSphPlugin::StParticles));
+}
+
+//==============================================================================
+/// Returns list of plugin factories compiled with the program.
+/// Devuelve lista de factorias de plugins compilados con el programa.
+//==============================================================================
+std::vector<JSphPlugins::StFactory>& JSphPlugins::Factories(){
+  static std::vector<StFactory> factories;
+  return(factories);
+}
+
+//==============================================================================
+/// Registers factory of plugins compiled with the program (replaces previous
+/// factory with the same type).
+///
+/// Registra factoria de plugins compilados con el programa (reemplaza una
+/// factoria previa con el mismo tipo).
+//==============================================================================
+void JSphPlugins::RegisterFactory(const std::string &type,JSphPluginFactory factory){
+  std::vector<StFactory> &facs=Factories();
+  const string typelw=fun::StrLower(type);
+  unsigned c=0;
+  for(;c<unsigned(facs.size()) && facs[c].type!=typelw;c++);
+  if(c<unsigned(facs.size()))facs[c].factory=factory;
+  else{
+    StFactory fac={typelw,factory};
+    facs.push_back(fac);
+  }
+}
+
+//==============================================================================
+/// Creates plugin compiled with the program. Returns NULL when the type is unknown.
+//==============================================================================
+JSphPlugin* JSphPlugins::CreateCompiled(const std::string &type){
+  const std::vector<StFactory> &facs=Factories();
+  const string typelw=fun::StrLower(type);
+  for(unsigned c=0;c<unsigned(facs.size());c++)if(facs[c].type==typelw)return(facs[c].factory());
+  return(NULL);
+}
+
+//==============================================================================
+/// Creates plugin from shared library.
+/// Crea plugin a partir de libreria dinamica.
+//==============================================================================
+JSphPlugin* JSphPlugins::CreateFromLibrary(const std::string &type,const std::string &library){
+  const char met[]="CreateFromLibrary";
+  JSphPlugin* plugin=NULL;
+#ifdef WIN32
+  RunException(met,"Plugins in shared libraries are not supported on Windows.",library);
+#else
+  void* lib=dlopen(library.c_str(),RTLD_NOW|RTLD_LOCAL);
+  if(!lib){
+    const char* err=dlerror();
+    RunException(met,string("Cannot load the shared library. ")+(err? err: ""),library);
+  }
+  Libraries.push_back(lib);
+  JSphPluginVersionFun funversion=(JSphPluginVersionFun)dlsym(lib,"DsphPluginVersion");
+  JSphPluginCreateFun funcreate=(JSphPluginCreateFun)dlsym(lib,"DsphPluginCreate");
+  if(!funversion || !funcreate)RunException(met,"The shared library does not export the functions DsphPluginVersion() and DsphPluginCreate().",library);
+  const unsigned ver=funversion();
+  if(ver!=JSPHPLUGIN_VERSION)RunException(met,fun::PrintStr("The plugin interface version %u of the shared library does not match the expected version %u.",ver,JSPHPLUGIN_VERSION),library);
+  plugin=funcreate(type.c_str());
+#endif
+  return(plugin);
+}
+
+//==============================================================================
+/// Loads plugins configuration from XML object.
+/// Carga configuracion de plugins del objeto XML.
+//==============================================================================
+void JSphPlugins::LoadXml(JXml *sxml,const std::string &place,const std::string &dirbase){
+  Reset();
+  TiXmlNode* node=sxml->GetNode(place,false);
+  if(node)ReadXml(sxml,node->ToElement(),dirbase);
+}
+
+//==============================================================================
+/// Reads list of plugins in the XML node. Each child element of <plugin> is
+/// a parameter with its name and the attribute value.
+///
+/// Lee lista de plugins en el nodo XML. Cada elemento hijo de <plugin> es un
+/// parametro con su nombre y el atributo value.
+//==============================================================================
+void JSphPlugins::ReadXml(JXml *sxml,TiXmlElement* lis,const std::string &dirbase){
+  const char met[]="ReadXml";
+  TiXmlElement* ele=lis->FirstChildElement("plugin");
+  while(ele){
+    StPluginItem item;
+    item.type=sxml->GetAttributeStr(ele,"type");
+    item.name=sxml->GetAttributeStr(ele,"name",true,item.type);
+    item.library=sxml->GetAttributeStr(ele,"library",true);
+    for(unsigned c=0;c<unsigned(List.size());c++)if(List[c].name==item.name)
+      RunException(met,fun::PrintStr("The plugin name \'%s\' is repeated.",item.name.c_str()),sxml->ErrGetFileRow(ele));
+    TiXmlElement* elep=ele->FirstChildElement();
+    while(elep){
+      JSphPlugin::StParam param;
+      param.key=elep->Value();
+      param.value=sxml->GetAttributeStr(elep,"value");
+      item.params.push_back(param);
+      elep=elep->NextSiblingElement();
+    }
+    //-Creates plugin.
+    if(item.library.empty())item.plugin=CreateCompiled(item.type);
+    else{
+      if(fun::FileExists(dirbase+item.library))item.library=dirbase+item.library;
+      item.plugin=CreateFromLibrary(item.type,item.library);
+    }
+    if(!item.plugin)RunException(met,fun::PrintStr("The plugin type \'%s\' is unknown.",item.type.c_str()),sxml->ErrGetFileRow(ele));
+    item.threadsafe=item.plugin->ThreadSafe();
+    item.asyncpart=item.plugin->AsyncPart();
+    List.push_back(item);
+    ele=ele->NextSiblingElement("plugin");
+  }
+}
+
+//==============================================================================
+/// Initialises plugins with the constant values of the simulation.
+/// Inicializa los plugins con los valores constantes de la simulacion.
+//==============================================================================
+void JSphPlugins::Init(const JSphPlugin::StSetup &setup){
+  StepSafe.clear();
+  StepSeq.clear();
+  for(unsigned c=0;c<unsigned(List.size());c++){
+    StPluginItem &item=List[c];
+    try{
+      item.plugin->Init(item.name,item.params,setup);
+    }
+    catch(const string &e){ RunException("Init",fun::PrintStr("Error in plugin \'%s\'. ",item.name.c_str())+e); }
+    catch(const std::exception &e){ RunException("Init",fun::PrintStr("Error in plugin \'%s\'. ",item.name.c_str())+e.what()); }
+    if(item.threadsafe)StepSafe.push_back(c);
+    else StepSeq.push_back(c);
+  }
+}
+
+//==============================================================================
+/// Shows configuration of plugins using Log.
+/// Muestra configuracion de los plugins usando Log.
+//==============================================================================
+void JSphPlugins::VisuConfig(std::string txhead,std::string txfoot)const{
+  if(!txhead.empty())Log->Print(txhead);
+  for(unsigned c=0;c<unsigned(List.size());c++){
+    const StPluginItem &item=List[c];
+    string mode=(item.threadsafe? "parallel": "sequential");
+    if(item.asyncpart)mode=mode+", async-part";
+    Log->Printf("Plugin_%u \"%s\": %s (%s)",c,item.name.c_str(),item.plugin->GetName().c_str(),mode.c_str());
+    if(!item.library.empty())Log->Printf("  Library..: %s",item.library.c_str());
+    std::vector<std::string> lines;
+    item.plugin->GetConfig(lines);
+    for(unsigned cl=0;cl<unsigned(lines.size());cl++)Log->Print(string("  ")+lines[cl]);
+  }
+  if(!txfoot.empty())Log->Print(txfoot);
+}
+
+//==============================================================================
+/// Executes StepEnd() or PartSave() of plugins in parallel. Exceptions are
+/// captured in each thread and the first one is thrown after the loop.
+///
+/// Ejecuta StepEnd() o PartSave() de los plugins en paralelo. Las excepciones
+/// se capturan en cada hilo y se lanza la primera despues del bucle.
+//==============================================================================
+void JSphPlugins::RunSafe(const std::vector<unsigned> &idx,bool stepend,const JSphPlugin::StParticles &data){
+  const int n=int(idx.size());
+  string error;
+  #ifdef OMP_USE
+    #pragma omp parallel for schedule (dynamic) if(n>1)
+  #endif
+  for(int c=0;c<n;c++){
+    const StPluginItem &item=List[idx[c]];
+    string err;
+    try{
+      if(stepend)item.plugin->StepEnd(data);
+      else item.plugin->PartSave(data);
+    }
+    catch(const string &e){ err=e; }
+    catch(const JException &e){ err=e.ToStr(); }
+    catch(const std::exception &e){ err=e.what(); }
+    catch(...){ err="Unknown error."; }
+    if(!err.empty()){
+      #ifdef OMP_USE
+        #pragma omp critical
+      #endif
+      {
+        if(error.empty())error=fun::PrintStr("Error in plugin \'%s\'. ",item.name.c_str())+err;
+      }
+    }
+  }
+  if(!error.empty())RunException((stepend? "RunStepEnd": "StartPartSave"),error);
+}
+
+//==============================================================================
+/// Executes StepEnd() of plugins. Plugins with ThreadSafe() are executed in
+/// parallel and the others one by one using all threads.
+///
+/// Ejecuta StepEnd() de los plugins. Los plugins con ThreadSafe() se ejecutan
+/// en paralelo y el resto uno a uno usando todos los hilos.
+//==============================================================================
+void JSphPlugins::RunStepEnd(const JSphPlugin::StParticles &data){
+  if(!StepSafe.empty())RunSafe(StepSafe,true,data);
+  for(unsigned c=0;c<unsigned(StepSeq.size());c++){
+    std::vector<unsigned> idx(1,StepSeq[c]);
+    RunSafe(idx,true,data);
+  }
+}
+
+//==============================================================================
+/// Main function of the background thread that executes PartSave() of plugins
+/// with AsyncPart().
+//==============================================================================
+void JSphPlugins::RunPartAsync(){
+  for(unsigned c=0;c<unsigned(List.size()) && PartError.empty();c++)if(List[c].asyncpart){
+    string err;
+    try{
+      List[c].plugin->PartSave(PartData);
+    }
+    catch(const string &e){ err=e; }
+    catch(const JException &e){ err=e.ToStr(); }
+    catch(const std::exception &e){ err=e.what(); }
+    catch(...){ err="Unknown error."; }
+    if(!err.empty())PartError=fun::PrintStr("Error in plugin \'%s\'. ",List[c].name.c_str())+err;
+  }
+}
+
+//==============================================================================
+/// Starts PartSave() of plugins with AsyncPart() in a background thread and
+/// executes PartSave() of the other plugins. WaitPartSave() must be called
+/// before particle data are modified.
+///
+/// Inicia PartSave() de los plugins con AsyncPart() en un hilo en segundo
+/// plano y ejecuta PartSave() del resto. Se debe llamar a WaitPartSave()
+/// antes de modificar los datos de particulas.
+//==============================================================================
+void JSphPlugins::StartPartSave(const JSphPlugin::StParticles &data){
+  WaitPartSave();
+  PartData=data;
+  std::vector<unsigned> idxsync;
+  bool async=false;
+  for(unsigned c=0;c<unsigned(List.size());c++){
+    if(List[c].asyncpart)async=true;
+    else idxsync.push_back(c);
+  }
+  if(async)PartThread=std::thread(&JSphPlugins::RunPartAsync,this);
+  for(unsigned c=0;c<unsigned(idxsync.size());c++){
+    std::vector<unsigned> idx(1,idxsync[c]);
+    try{
+      RunSafe(idx,false,data);
+    }
+    catch(...){
+      WaitPartSave();
+      throw;
+    }
+  }
+}
+
+//==============================================================================
+/// Waits for the background thread of PartSave() and throws its error.
+/// Espera al hilo en segundo plano de PartSave() y lanza su error.
+//==============================================================================
+void JSphPlugins::WaitPartSave(){
+  if(PartThread.joinable())PartThread.join();
+  if(!PartError.empty()){
+    const string error=PartError;
+    PartError="";
+    RunException("WaitPartSave",error);
+  }
+}
+
+//==============================================================================
+/// Finishes plugins at the end of the simulation.
+/// Finaliza los plugins al terminar la simulacion.
+//==============================================================================
+void JSphPlugins::Finish(){
+  WaitPartSave();
+  for(unsigned c=0;c<unsigned(List.size());c++){
+    try{
+      List[c].plugin->Finish();
+    }
+    catch(const string &e){ RunException("Finish",fun::PrintStr("Error in plugin \'%s\'. ",List[c].name.c_str())+e); }
+    catch(const std::exception &e){ RunException("Finish",fun::PrintStr("Error in plugin \'%s\'. ",List[c].name.c_str())+e.what()); }
+  }
+}
+
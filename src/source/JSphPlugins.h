@@ -0,0 +1,118 @@
+//HEAD_DSPH
+/*
+ <DUALSPHYSICS>  Copyright (c) 2019 by Dr Jose M. Dominguez et al. (see http://dual.sphysics.org/index.php/developers/).
+
+ EPHYSLAB Environmental Physics Laboratory, Universidade de Vigo, Ourense, Spain.
+ School of Mechanical, Aerospace and Civil Engineering, University of Manchester, Manchester, U.K.
+
+ This file is part of DualSPHysics.
+
+ DualSPHysics is free software: you can redistribute it and/or modify it under the terms of the GNU Lesser General Public License
+ as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) any later version.
+
+ DualSPHysics is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License along with DualSPHysics. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+//:#############################################################################
+//:# Cambios:
+//:# =========
+//:# - Clase para gestionar los plugins de analisis configurados en el XML
+//:#   (compilados con el programa o cargados desde librerias dinamicas) y
+//:#   ejecutarlos al final de cada paso y al grabar cada PART. (18-10-2026)
+//:# - Plugin interno Energy que calcula la energia cinetica y potencial del
+//:#   fluido. (18-10-2026)
+//:#############################################################################
+
+/// \file JSphPlugins.h \brief Declares the class \ref JSphPlugins.
+
+#ifndef _JSphPlugins_
+#define _JSphPlugins_
+
+#include <string>
+#include <vector>
+#include <thread>
+#include "JObject.h"
+#include "JSphPlugin.h"
+
+class JXml;
+class TiXmlElement;
+class JLog2;
+
+//##############################################################################
+//# XML format in _FmtXML_Plugins.xml.
+//##############################################################################
+
+//##############################################################################
+//# JSphPlugins
+//##############################################################################
+/// \brief Manages the analysis plugins executed during the simulation.
+/// Plugins are created from the types compiled with the program or from
+/// shared libraries. StepEnd() of plugins that are ThreadSafe() is executed
+/// in parallel and PartSave() of plugins with AsyncPart() is executed in a
+/// background thread while the PART files are written.
+
+class JSphPlugins : protected JObject
+{
+protected:
+  /// Structure with the information of one plugin.
+  typedef struct{
+    std::string type;       ///<Type of plugin.
+    std::string name;       ///<Name of the instance.
+    std::string library;    ///<Shared library with the plugin (empty for compiled types).
+    std::vector<JSphPlugin::StParam> params; ///<Parameters of configuration.
+    JSphPlugin* plugin;     ///<Plugin object.
+    bool threadsafe;        ///<StepEnd() can be executed in parallel with other plugins.
+    bool asyncpart;         ///<PartSave() is executed in background.
+  }StPluginItem;
+
+  /// Structure with a factory of plugins compiled with the program.
+  typedef struct{
+    std::string type;
+    JSphPluginFactory factory;
+  }StFactory;
+
+  JLog2* Log;
+  std::vector<StPluginItem> List;  ///<Configured plugins.
+  std::vector<void*> Libraries;    ///<Handles of loaded shared libraries.
+
+  std::vector<unsigned> StepSafe;  ///<Index of plugins with ThreadSafe() to execute StepEnd() in parallel.
+  std::vector<unsigned> StepSeq;   ///<Index of plugins to execute StepEnd() one by one.
+
+  //-Variables for asynchronous execution of PartSave().
+  JSphPlugin::StParticles PartData; ///<Particle data for the background thread.
+  std::thread PartThread;          ///<Background thread executing PartSave() of AsyncPart() plugins.
+  std::string PartError;           ///<Error of the background thread.
+
+  static std::vector<StFactory>& Factories();
+  static JSphPlugin* CreateCompiled(const std::string &type);
+  JSphPlugin* CreateFromLibrary(const std::string &type,const std::string &library);
+  void ReadXml(JXml *sxml,TiXmlElement* lis,const std::string &dirbase);
+  void RunPartAsync();
+  void RunSafe(const std::vector<unsigned> &idx,bool stepend,const JSphPlugin::StParticles &data);
+
+public:
+  JSphPlugins(JLog2* log);
+  ~JSphPlugins();
+  void Reset();
+
+  static void RegisterFactory(const std::string &type,JSphPluginFactory factory);
+
+  void LoadXml(JXml *sxml,const std::string &place,const std::string &dirbase);
+  void Init(const JSphPlugin::StSetup &setup);
+  void VisuConfig(std::string txhead,std::string txfoot)const;
+
+  unsigned GetCount()const{ return(unsigned(List.size())); }
+
+  void RunStepEnd(const JSphPlugin::StParticles &data);
+  void StartPartSave(const JSphPlugin::StParticles &data);
+  void WaitPartSave();
+  void Finish();
+};
+
+
+#endif
+
+
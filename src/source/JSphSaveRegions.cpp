@@ -0,0 +1,283 @@
+//HEAD_DSPH
+/*
+ <DUALSPHYSICS>  Copyright (c) 2019 by Dr Jose M. Dominguez et al. (see http://dual.sphysics.org/index.php/developers/). 
+
+ EPHYSLAB Environmental Physics Laboratory, Universidade de Vigo, Ourense, Spain.
+ School of Mechanical, Aerospace and Civil Engineering, University of Manchester, Manchester, U.K.
+
+ This file is part of DualSPHysics. 
+
+ DualSPHysics is free software: you can redistribute it and/or modify it under the terms of the GNU Lesser General Public License 
+ as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) any later version.
+ 
+ DualSPHysics is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details. 
+
+ You should have received a copy of the GNU Lesser General Public License along with DualSPHysics. If not, see <http://www.gnu.org/licenses/>. 
+*/
+
+/// \file JSphSaveRegions.cpp \brief Implements the class \ref JSphSaveRegions.
+
+#include "JSphSaveRegions.h"
+#include "JSphMk.h"
+#include "JPartDataHead.h"
+#include "JPartDataBi4.h"
+#include "JLog2.h"
+#include "JXml.h"
+#include "JRangeFilter.h"
+#include "JSphCheckpoint.h"
+#include "Functions.h"
+#include "OmpDefs.h"
+#include <cfloat>
+#include <cmath>
+#include <climits>
+#include <algorithm>
+
+using std::string;
+
+//##############################################################################
+//# JSphSaveRegions
+//##############################################################################
+//==============================================================================
+/// Constructor.
+//==============================================================================
+JSphSaveRegions::JSphSaveRegions(JLog2 *log):Log(log){
+  ClassName="JSphSaveRegions";
+  Reset();
+}
+
+//==============================================================================
+/// Destructor.
+//==============================================================================
+JSphSaveRegions::~JSphSaveRegions(){
+  DestructorActive=true;
+  Reset();
+}
+
+//==============================================================================
+/// Initialisation of variables.
+//==============================================================================
+void JSphSaveRegions::Reset(){
+  for(unsigned c=0;c<Data.size();c++)delete Data[c];
+  Data.clear();
+  List.clear();
+  TimeNext.clear();
+  Cpart.clear();
+  SvDouble=false;
+  Sel.clear();
+  SelIdp.clear(); SelPos.clear(); SelPosf.clear(); SelVel.clear(); SelRhop.clear();
+}
+
+//==============================================================================
+/// Loads configuration of XML object.
+//==============================================================================
+void JSphSaveRegions::LoadXml(JXml *sxml,const std::string &place){
+  Reset();
+  TiXmlNode* node=sxml->GetNode(place,false);
+  if(!node)RunException("LoadXml",std::string("Cannot find the element \'")+place+"\'.");
+  ReadXml(sxml,node->ToElement());
+}
+
+//==============================================================================
+/// Reads list of regions in the XML node.
+//==============================================================================
+void JSphSaveRegions::ReadXml(JXml *sxml,TiXmlElement* lis){
+  TiXmlElement* ele=lis->FirstChildElement("region"); 
+  while(ele){
+    StRegion rg;
+    rg.name=sxml->GetAttributeStr(ele,"name");
+    if(rg.name.empty() || rg.name.find_first_of("/\\:*?\"<>| ")!=string::npos)sxml->ErrReadElement(ele,"region",false,"The name of region is invalid.");
+    for(unsigned c=0;c<List.size();c++)if(List[c].name==rg.name)sxml->ErrReadElement(ele,"region",false,"The name of region is repeated.");
+    rg.tout=sxml->ReadElementDouble(ele,"tout","value");
+    if(rg.tout<=0)sxml->ErrReadElement(ele,"tout",false,"The output interval must be greater than zero.");
+    rg.stride=sxml->ReadElementUnsigned(ele,"stride","value",true,1);
+    if(!rg.stride)sxml->ErrReadElement(ele,"stride",false,"The stride must be greater than zero.");
+    rg.mklist=sxml->ReadElementStr(ele,"mk","value",true,"");
+    //-Loads boxes.
+    TiXmlElement* box=ele->FirstChildElement("box");
+    while(box){
+      const tdouble3 pmin=sxml->ReadElementDouble3(box,"pointmin");
+      const tdouble3 pmax=sxml->ReadElementDouble3(box,"pointmax");
+      if(pmin.x>pmax.x || pmin.y>pmax.y || pmin.z>pmax.z)sxml->ErrReadElement(box,"box",false,"The limits of box are invalid.");
+      rg.boxmin.push_back(pmin);
+      rg.boxmax.push_back(pmax);
+      box=box->NextSiblingElement("box");
+    }
+    List.push_back(rg);
+    ele=ele->NextSiblingElement("region");
+  }
+}
+
+//==============================================================================
+/// Configures Idp ranges of mk lists and objects to save bi4 files of each 
+/// region in the directory DirDataOut/Region_<name>.
+//==============================================================================
+void JSphSaveRegions::ConfigData(const JSphMk *mkinfo,const std::string &dirdataout,JPartDataHead *parthead,bool svdouble,bool compress,double timestepini){
+  const char met[]="ConfigData";
+  SvDouble=svdouble;
+  for(unsigned c=0;c<List.size();c++){
+    StRegion &rg=List[c];
+    //-Computes Idp ranges of selected mk blocks.
+    rg.idranges.clear();
+    if(!rg.mklist.empty()){
+      std::vector<unsigned> mks;
+      JRangeFilter(rg.mklist).GetValues(mks);
+      for(unsigned cm=0;cm<mks.size();cm++){
+        const unsigned cb=(mks[cm]<=USHRT_MAX? mkinfo->GetMkBlockByMk(word(mks[cm])): mkinfo->Size());
+        if(cb>=mkinfo->Size())RunException(met,fun::PrintStr("Mk=%u of region \'%s\' is not available.",mks[cm],rg.name.c_str()));
+        const JSphMkBlock* mb=mkinfo->Mkblock(cb);
+        rg.idranges.push_back(TUint2(mb->Begin,mb->Begin+mb->Count));
+      }
+    }
+    //-Creates object to save bi4 files.
+    const string dir=fun::GetDirWithSlash(dirdataout)+"Region_"+rg.name+"/";
+    fun::MkdirPath(dir);
+    parthead->SaveFile(dir);
+    JPartDataBi4 *pd=new JPartDataBi4();
+    Data.push_back(pd);
+    pd->Config(0,1,dir,parthead);
+    pd->ConfigSimDiv(JPartDataBi4::DIV_None);
+    pd->ConfigCompression(compress);
+    TimeNext.push_back(timestepini);
+    Cpart.push_back(0);
+    Log->AddFileInfo(dir+"Part_????.bi4",fun::PrintStr("Binary file with particle data of output region \'%s\'.",rg.name.c_str()));
+  }
+}
+
+//==============================================================================
+/// Shows object configuration using Log.
+//==============================================================================
+void JSphSaveRegions::VisuConfig(std::string txhead,std::string txfoot)const{
+  if(!txhead.empty())Log->Print(txhead);
+  for(unsigned c=0;c<GetCount();c++){
+    const StRegion &rg=List[c];
+    Log->Printf("Region_%s",rg.name.c_str());
+    Log->Printf("  TimeOut....: %g",rg.tout);
+    Log->Printf("  Stride.....: %u",rg.stride);
+    for(unsigned cb=0;cb<rg.boxmin.size();cb++)Log->Printf("  Box........: %s",fun::Double3gRangeStr(rg.boxmin[cb],rg.boxmax[cb]).c_str());
+    if(!rg.mklist.empty())Log->Printf("  Mk.........: %s",rg.mklist.c_str());
+  }
+  if(!txfoot.empty())Log->Print(txfoot);
+}
+
+//==============================================================================
+/// Returns the requested region.
+//==============================================================================
+const JSphSaveRegions::StRegion* JSphSaveRegions::GetRegion(unsigned c)const{
+  if(c>=GetCount())RunException("GetRegion","The requested region is invalid.");
+  return(&(List[c]));
+}
+
+//==============================================================================
+/// Returns true when some region has to be saved at timestep.
+//==============================================================================
+bool JSphSaveRegions::CheckTime(double timestep)const{
+  bool ret=false;
+  for(unsigned c=0;c<TimeNext.size() && !ret;c++)ret=(timestep>=TimeNext[c]);
+  return(ret);
+}
+
+//==============================================================================
+/// Returns true when the particle belongs to the region.
+//==============================================================================
+bool JSphSaveRegions::PointInRegion(const StRegion &rg,typeidp id,const tdouble3 &ps)const{
+  bool ok=(rg.stride<=1 || id%rg.stride==0);
+  if(ok && !rg.idranges.empty()){
+    ok=false;
+    for(unsigned c=0;c<rg.idranges.size() && !ok;c++)ok=(id>=rg.idranges[c].x && id<rg.idranges[c].y);
+  }
+  if(ok && !rg.boxmin.empty()){
+    ok=false;
+    for(unsigned c=0;c<rg.boxmin.size() && !ok;c++){
+      const tdouble3 &pmin=rg.boxmin[c],&pmax=rg.boxmax[c];
+      ok=(pmin.x<=ps.x && ps.x<=pmax.x && pmin.y<=ps.y && ps.y<=pmax.y && pmin.z<=ps.z && ps.z<=pmax.z);
+    }
+  }
+  return(ok);
+}
+
+//==============================================================================
+/// Selects particles of the region in parallel and copies their data in the 
+/// auxiliary arrays. Returns the number of selected particles.
+//==============================================================================
+unsigned JSphSaveRegions::SelectParticles(const StRegion &rg,unsigned npok,const typeidp *idp,const tdouble3 *pos,const tfloat3 *vel,const float *rhop){
+  if(Sel.size()<npok)Sel.resize(npok);
+  byte *sel=(npok? &Sel[0]: NULL);
+  const int n=int(npok);
+  #ifdef OMP_USE
+    #pragma omp parallel for schedule(static)
+  #endif
+  for(int p=0;p<n;p++)sel[p]=(PointInRegion(rg,idp[p],pos[p])? 1: 0);
+  unsigned nsel=0;
+  for(unsigned p=0;p<npok;p++)nsel+=sel[p];
+  const unsigned nsize=std::max(nsel,1u);
+  SelIdp.resize(nsize); SelPos.resize(nsize); SelVel.resize(nsize); SelRhop.resize(nsize);
+  unsigned cp=0;
+  for(unsigned p=0;p<npok;p++)if(sel[p]){
+    SelIdp[cp]=idp[p]; SelPos[cp]=pos[p]; SelVel[cp]=vel[p]; SelRhop[cp]=rhop[p];
+    cp++;
+  }
+  return(nsel);
+}
+
+//==============================================================================
+/// Saves bi4 files of the regions whose output time has been reached.
+//==============================================================================
+void JSphSaveRegions::SaveData(double timestep,unsigned nstep,double runtime,unsigned npok,const typeidp *idp,const tdouble3 *pos,const tfloat3 *vel,const float *rhop){
+  for(unsigned c=0;c<List.size();c++)if(timestep>=TimeNext[c]){
+    const StRegion &rg=List[c];
+    const unsigned nsel=SelectParticles(rg,npok,idp,pos,vel,rhop);
+    //-Computes domain of selected particles.
+    tdouble3 pmin=TDouble3(0),pmax=TDouble3(0);
+    if(nsel){
+      pmin=TDouble3(DBL_MAX); pmax=TDouble3(-DBL_MAX);
+      for(unsigned p=0;p<nsel;p++){
+        pmin=MinValues(pmin,SelPos[p]);
+        pmax=MaxValues(pmax,SelPos[p]);
+      }
+    }
+    //-Saves bi4 file.
+    JPartDataBi4 *pd=Data[c];
+    pd->AddPartInfo(Cpart[c],timestep,nsel,0,nstep,runtime,pmin,pmax);
+    if(SvDouble)pd->AddPartData(nsel,&SelIdp[0],&SelPos[0],&SelVel[0],&SelRhop[0]);
+    else{
+      SelPosf.resize(SelPos.size());
+      for(unsigned p=0;p<nsel;p++)SelPosf[p]=ToTFloat3(SelPos[p]);
+      pd->AddPartData(nsel,&SelIdp[0],&SelPosf[0],&SelVel[0],&SelRhop[0]);
+    }
+    pd->SaveFilePart();
+    //-Computes next output time.
+    Cpart[c]++;
+    TimeNext[c]=(floor(timestep/rg.tout+1e-6)+1)*rg.tout;
+  }
+}
+
+//==============================================================================
+/// Stores next output time and PART number of regions in checkpoint data.
+/// Guarda siguiente instante de salida y numero de PART de las regiones en 
+/// datos de checkpoint.
+//==============================================================================
+void JSphSaveRegions::SaveCheckpoint(JBinaryData *data)const{
+  JBinaryData *item=data->CreateItem("SaveRegions");
+  const unsigned n=GetCount();
+  item->SetvUint("Count",n);
+  if(n){
+    item->CreateArray("TimeNext",JBinaryDataDef::DatDouble,n,&TimeNext[0],false);
+    item->CreateArray("Cpart",JBinaryDataDef::DatUint,n,&Cpart[0],false);
+  }
+}
+
+//==============================================================================
+/// Restores next output time and PART number of regions from checkpoint.
+/// Restaura siguiente instante de salida y numero de PART de las regiones 
+/// desde checkpoint.
+//==============================================================================
+void JSphSaveRegions::LoadCheckpoint(const JSphCheckpoint *ckp){
+  JBinaryData *item=ckp->GetItem("SaveRegions");
+  const unsigned n=GetCount();
+  if(item->GetvUint("Count")!=n)RunException("LoadCheckpoint","Number of output regions does not match the checkpoint.");
+  if(n){
+    ckp->LoadArray(item,"TimeNext",JBinaryDataDef::DatDouble,n,&TimeNext[0]);
+    ckp->LoadArray(item,"Cpart",JBinaryDataDef::DatUint,n,&Cpart[0]);
+  }
+}
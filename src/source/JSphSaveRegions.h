@@ -0,0 +1,113 @@
+//HEAD_DSPH
+/*
+ <DUALSPHYSICS>  Copyright (c) 2019 by Dr Jose M. Dominguez et al. (see http://dual.sphysics.org/index.php/developers/). 
+
+ EPHYSLAB Environmental Physics Laboratory, Universidade de Vigo, Ourense, Spain.
+ School of Mechanical, Aerospace and Civil Engineering, University of Manchester, Manchester, U.K.
+
+ This file is part of DualSPHysics. 
+
+ DualSPHysics is free software: you can redistribute it and/or modify it under the terms of the GNU Lesser General Public License 
+ as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) any later version.
+ 
+ DualSPHysics is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details. 
+
+ You should have received a copy of the GNU Lesser General Public License along with DualSPHysics. If not, see <http://www.gnu.org/licenses/>. 
+*/
+
+//:#############################################################################
+//:# Cambios:
+//:# =========
+//:# - Clase para grabar particulas de regiones de interes (cajas y/o lista de
+//:#   mk) con su propio intervalo de salida y diezmado por Idp. Cada region se
+//:#   graba como una serie independiente de ficheros bi4. (18-10-2026)
+//:# - Grabacion y carga del estado de salida para checkpoint/restart. (18-10-2026)
+//:# - Idp de particulas seleccionadas usa typeidp (64 bits con IDP_SIZE8). (18-10-2026)
+//:#############################################################################
+
+/// \file JSphSaveRegions.h \brief Declares the class \ref JSphSaveRegions.
+
+#ifndef _JSphSaveRegions_
+#define _JSphSaveRegions_
+
+#include <string>
+#include <vector>
+#include "JObject.h"
+#include "Types.h"
+
+class JXml;
+class TiXmlElement;
+class JLog2;
+class JSphMk;
+class JPartDataHead;
+class JPartDataBi4;
+class JBinaryData;
+class JSphCheckpoint;
+
+//##############################################################################
+//# XML format in _FmtXML_SaveRegions.xml.
+//##############################################################################
+
+//##############################################################################
+//# JSphSaveRegions
+//##############################################################################
+/// \brief Saves particle data of regions of interest in separate bi4 series.
+
+class JSphSaveRegions : protected JObject
+{
+public:
+  /// Structure with the definition of an output region.
+  typedef struct{
+    std::string name;             ///<Name of region (used for output directory).
+    double tout;                  ///<Output interval. | Intervalo de salida.
+    unsigned stride;              ///<Keeps particles with Idp%stride==0. | Mantiene particulas con Idp%stride==0.
+    std::vector<tdouble3> boxmin; ///<Minimum limits of boxes (empty: whole domain). | Limites minimos de cajas.
+    std::vector<tdouble3> boxmax; ///<Maximum limits of boxes. | Limites maximos de cajas.
+    std::string mklist;           ///<List of mk values (empty: all particles). | Lista de valores mk.
+    std::vector<tuint2> idranges; ///<Ranges [x,y) of Idp of selected mk blocks. | Rangos de Idp de los bloques mk seleccionados.
+  }StRegion;
+
+private:
+  JLog2 *Log;
+  std::vector<StRegion> List;
+  std::vector<JPartDataBi4*> Data;  ///<Object to save bi4 files of each region. | Objeto para grabar ficheros bi4 de cada region.
+  std::vector<double> TimeNext;     ///<Next output time of each region. | Siguiente instante de salida de cada region.
+  std::vector<unsigned> Cpart;      ///<Number of next PART of each region. | Numero del siguiente PART de cada region.
+  bool SvDouble;                    ///<Stores positions in double precision. | Graba posiciones en doble precision.
+
+  //-Auxiliary memory for selected particles.
+  std::vector<byte> Sel;
+  std::vector<typeidp> SelIdp;
+  std::vector<tdouble3> SelPos;
+  std::vector<tfloat3> SelPosf;
+  std::vector<tfloat3> SelVel;
+  std::vector<float> SelRhop;
+
+  void ReadXml(JXml *sxml,TiXmlElement* lis);
+  bool PointInRegion(const StRegion &rg,typeidp id,const tdouble3 &ps)const;
+  unsigned SelectParticles(const StRegion &rg,unsigned npok,const typeidp *idp,const tdouble3 *pos,const tfloat3 *vel,const float *rhop);
+
+public:
+  JSphSaveRegions(JLog2 *log);
+  ~JSphSaveRegions();
+  void Reset();
+
+  void LoadXml(JXml *sxml,const std::string &place);
+  void ConfigData(const JSphMk *mkinfo,const std::string &dirdataout,JPartDataHead *parthead,bool svdouble,bool compress,double timestepini);
+  void VisuConfig(std::string txhead,std::string txfoot)const;
+
+  unsigned GetCount()const{ return(unsigned(List.size())); }
+  const StRegion* GetRegion(unsigned c)const;
+
+  bool CheckTime(double timestep)const;
+  void SaveData(double timestep,unsigned nstep,double runtime,unsigned npok,const typeidp *idp,const tdouble3 *pos,const tfloat3 *vel,const float *rhop);
+
+  void SaveCheckpoint(JBinaryData *data)const;
+  void LoadCheckpoint(const JSphCheckpoint *ckp);
+};
+
+
+#endif
+
+
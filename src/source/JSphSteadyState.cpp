@@ -0,0 +1,306 @@
+//HEAD_DSPH
+/*
+ <DUALSPHYSICS>  Copyright (c) 2019 by Dr Jose M. Dominguez et al. (see http://dual.sphysics.org/index.php/developers/). 
+
+ EPHYSLAB Environmental Physics Laboratory, Universidade de Vigo, Ourense, Spain.
+ School of Mechanical, Aerospace and Civil Engineering, University of Manchester, Manchester, U.K.
+
+ This file is part of DualSPHysics. 
+
+ DualSPHysics is free software: you can redistribute it and/or modify it under the terms of the GNU Lesser General Public License 
+ as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) any later version.
+ 
+ DualSPHysics is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details. 
+
+ You should have received a copy of the GNU Lesser General Public License along with DualSPHysics. If not, see <http://www.gnu.org/licenses/>. 
+*/
+
+/// \file JSphSteadyState.cpp \brief Implements the class \ref JSphSteadyState.
+
+#include "JSphSteadyState.h"
+#include "JLog2.h"
+#include "JXml.h"
+#include "JAppInfo.h"
+#include "Functions.h"
+#include "JSaveCsv2.h"
+#include "JGaugeSystem.h"
+#include "JSphCheckpoint.h"
+#include <cfloat>
+#include <climits>
+#include <cmath>
+#include <algorithm>
+
+using namespace std;
+
+//##############################################################################
+//# JSphSteadyState
+//##############################################################################
+//==============================================================================
+/// Constructor.
+//==============================================================================
+JSphSteadyState::JSphSteadyState(JLog2* log):Log(log){
+  ClassName="JSphSteadyState";
+  Reset();
+}
+
+//==============================================================================
+/// Destructor.
+//==============================================================================
+JSphSteadyState::~JSphSteadyState(){
+  DestructorActive=true;
+  Reset();
+}
+
+//==============================================================================
+/// Initialisation of variables.
+//==============================================================================
+void JSphSteadyState::Reset(){
+  FileCsv="";
+  TimeStart=0;
+  WindowSize=0;
+  Tolerance=0;
+  UseKinEnergy=UseVelMax=UseAllGauges=false;
+  GaugeNames.clear();
+  GaugeIdx.clear();
+  ValueNames.clear();
+  NumValues=0;
+  Values.clear();
+  LastValues.clear();
+  Count=Position=0;
+  Variation=DBL_MAX;
+  VariationIdx=0;
+  Steady=false;
+  TimeSteady=0;
+}
+
+//==============================================================================
+/// Configures object.
+//==============================================================================
+void JSphSteadyState::Config(JXml *sxml,const std::string &place,const JGaugeSystem *gaugesystem){
+  const char met[]="Config";
+  Reset();
+  LoadXml(sxml,place);
+  //-Selects monitored gauges.
+  const unsigned ng=(gaugesystem? gaugesystem->GetCount(): 0);
+  if(UseAllGauges)for(unsigned cg=0;cg<ng;cg++)GaugeIdx.push_back(cg);
+  else for(unsigned c=0;c<unsigned(GaugeNames.size());c++){
+    const unsigned cg=(gaugesystem? gaugesystem->GetGaugeIdx(GaugeNames[c]): UINT_MAX);
+    if(cg==UINT_MAX)RunException(met,fun::PrintStr("The gauge \'%s\' does not exist.",GaugeNames[c].c_str()));
+    if(find(GaugeIdx.begin(),GaugeIdx.end(),cg)==GaugeIdx.end())GaugeIdx.push_back(cg);
+  }
+  //-Defines names of monitored values.
+  if(UseKinEnergy)ValueNames.push_back("KinEnergy [J]");
+  if(UseVelMax)ValueNames.push_back("VelMax [m/s]");
+  for(unsigned c=0;c<unsigned(GaugeIdx.size());c++)ValueNames.push_back(string("Gauge_")+gaugesystem->GetGauge(GaugeIdx[c])->Name);
+  NumValues=unsigned(ValueNames.size());
+  if(!NumValues)RunException(met,"No value is selected to check the steady state.");
+  //-Allocates circular buffer.
+  Values.resize(size_t(WindowSize)*NumValues,0);
+  LastValues.resize(NumValues,0);
+}
+
+//==============================================================================
+/// Loads initial conditions of XML object.
+//==============================================================================
+void JSphSteadyState::LoadXml(JXml *sxml,const std::string &place){
+  TiXmlNode* node=sxml->GetNode(place,false);
+  if(!node)RunException("LoadXml",std::string("Cannot find the element \'")+place+"\'.");
+  ReadXml(sxml,node->ToElement());
+}
+
+//==============================================================================
+/// Reads configuration in the XML node.
+//==============================================================================
+void JSphSteadyState::ReadXml(JXml *sxml,TiXmlElement* lis){
+  const char met[]="ReadXml";
+  TimeStart=sxml->ReadElementDouble(lis,"start","value",true,0);
+  WindowSize=sxml->ReadElementUnsigned(lis,"window","value",true,10);
+  Tolerance=sxml->ReadElementDouble(lis,"tolerance","value",true,0.001);
+  UseKinEnergy=sxml->ReadElementBool(lis,"kineticenergy","value",true,true);
+  UseVelMax=sxml->ReadElementBool(lis,"velmax","value",true,false);
+  UseAllGauges=sxml->ReadElementBool(lis,"gauges","value",true,false);
+  TiXmlElement* ele=lis->FirstChildElement("gauge"); 
+  while(ele){
+    GaugeNames.push_back(sxml->GetAttributeStr(ele,"name"));
+    ele=ele->NextSiblingElement("gauge");
+  }
+  if(WindowSize<2)RunException(met,"The window size must be at least 2 PARTs.",sxml->ErrGetFileRow(lis));
+  if(Tolerance<=0)RunException(met,"The tolerance must be greater than zero.",sxml->ErrGetFileRow(lis));
+}
+
+//==============================================================================
+/// Shows object configuration using Log.
+//==============================================================================
+void JSphSteadyState::VisuConfig(std::string txhead,std::string txfoot)const{
+  if(!txhead.empty())Log->Print(txhead);
+  Log->Printf("  Start.....: %f",TimeStart);
+  Log->Printf("  Window....: %u PARTs",WindowSize);
+  Log->Printf("  Tolerance.: %g",Tolerance);
+  for(unsigned cv=0;cv<NumValues;cv++)Log->Printf("  Value_%u...: %s",cv,ValueNames[cv].c_str());
+  if(!txfoot.empty())Log->Print(txfoot);
+}
+
+//==============================================================================
+/// Returns scalar value of the last result of the gauge.
+/// Devuelve valor escalar del ultimo resultado del gauge.
+//==============================================================================
+double JSphSteadyState::GetGaugeValue(const JGaugeItem *gau){
+  double v=0;
+  switch(gau->Type){
+    case JGaugeItem::GAUGE_Vel:{
+      const tfloat3 vel=((const JGaugeVelocity*)gau)->GetResult().vel;
+      v=sqrt(double(vel.x)*vel.x+double(vel.y)*vel.y+double(vel.z)*vel.z);
+    }break;
+    case JGaugeItem::GAUGE_Swl:   v=((const JGaugeSwl*)gau)->GetResult().posswl.z;  break;
+    case JGaugeItem::GAUGE_MaxZ:  v=((const JGaugeMaxZ*)gau)->GetResult().zmax;     break;
+    case JGaugeItem::GAUGE_Mesh:  v=((const JGaugeMesh*)gau)->GetResultVelMean();   break;
+    case JGaugeItem::GAUGE_Isosurface: v=((const JGaugeIsosurface*)gau)->GetResultZMean(); break;
+    case JGaugeItem::GAUGE_Flow:  v=((const JGaugeFlow*)gau)->GetResult().flow;     break;
+    case JGaugeItem::GAUGE_Pressure: v=((const JGaugePressure*)gau)->GetResultPressMean(); break;
+    case JGaugeItem::GAUGE_Force:{
+      const tfloat3 force=((const JGaugeForce*)gau)->GetResult().force;
+      v=sqrt(double(force.x)*force.x+double(force.y)*force.y+double(force.z)*force.z);
+    }break;
+  }
+  return(v);
+}
+
+//==============================================================================
+/// Returns relative variation (max-min)/|mean| of one value in the window.
+/// Devuelve la variacion relativa (max-min)/|mean| de un valor en la ventana.
+//==============================================================================
+double JSphSteadyState::ComputeVariation(unsigned cv)const{
+  double vmin=DBL_MAX,vmax=-DBL_MAX,vsum=0;
+  for(unsigned c=0;c<WindowSize;c++){
+    const double v=Values[size_t(c)*NumValues+cv];
+    vmin=min(vmin,v);
+    vmax=max(vmax,v);
+    vsum+=v;
+  }
+  const double range=vmax-vmin;
+  const double vmean=fabs(vsum/WindowSize);
+  return(range==0? 0: (vmean>0? range/vmean: DBL_MAX));
+}
+
+//==============================================================================
+/// Saves monitored values of last PART in CSV file.
+/// Graba valores monitorizados del ultimo PART en fichero CSV.
+//==============================================================================
+void JSphSteadyState::SaveCsvValues(double timestep){
+  const bool firstsv=FileCsv.empty();
+  if(firstsv){
+    FileCsv=AppInfo.GetDirOut()+"SteadyState.csv";
+    Log->AddFileInfo(FileCsv,"Saves values monitored to detect the steady state (by JSphSteadyState).");
+  }
+  jcsv::JSaveCsv2 scsv(FileCsv,!firstsv,AppInfo.GetCsvSepComa());
+  //-Saves head.
+  if(firstsv){
+    scsv.SetHead();
+    scsv << "Time [s];Variation";
+    for(unsigned cv=0;cv<NumValues;cv++)scsv << ValueNames[cv];
+    scsv << jcsv::Endl();
+  }
+  //-Saves data.
+  scsv.SetData();
+  scsv << jcsv::Fmt(jcsv::TpDouble1,"%20.12E");
+  scsv << timestep << (Count>=WindowSize? Variation: -1.);
+  for(unsigned cv=0;cv<NumValues;cv++)scsv << LastValues[cv];
+  scsv << jcsv::Endl();
+  scsv.SaveData();
+}
+
+//==============================================================================
+/// Adds monitored values of the current PART and checks the steady state.
+/// Returns true when the steady state is reached.
+///
+/// Agrega valores monitorizados del PART actual y comprueba el estado 
+/// estacionario. Devuelve true cuando se alcanza el estado estacionario.
+//==============================================================================
+bool JSphSteadyState::AddValues(double timestep,double kinenergy,double velmax,const JGaugeSystem *gaugesystem){
+  if(!Steady && timestep>=TimeStart){
+    //-Collects values.
+    unsigned cv=0;
+    if(UseKinEnergy)LastValues[cv++]=kinenergy;
+    if(UseVelMax)LastValues[cv++]=velmax;
+    for(unsigned c=0;c<unsigned(GaugeIdx.size());c++)LastValues[cv++]=GetGaugeValue(gaugesystem->GetGauge(GaugeIdx[c]));
+    //-Stores values in circular buffer.
+    for(unsigned c=0;c<NumValues;c++)Values[size_t(Position)*NumValues+c]=LastValues[c];
+    Position=(Position+1)%WindowSize;
+    if(Count<WindowSize)Count++;
+    //-Computes maximum relative variation when the window is full.
+    if(Count>=WindowSize){
+      Variation=0; VariationIdx=0;
+      for(unsigned c=0;c<NumValues;c++){
+        const double var=ComputeVariation(c);
+        if(var>Variation){ Variation=var; VariationIdx=c; }
+      }
+      if(Variation<=Tolerance){
+        Steady=true;
+        TimeSteady=timestep;
+      }
+    }
+    SaveCsvValues(timestep);
+  }
+  return(Steady);
+}
+
+//==============================================================================
+/// Returns information about stop by steady state.
+/// Devuelve informacion sobre la parada por estado estacionario.
+//==============================================================================
+std::string JSphSteadyState::GetStopInfo()const{
+  const string name=(VariationIdx<NumValues? ValueNames[VariationIdx]: string("?"));
+  return(fun::PrintStr("Steady state reached at t=%f (max variation %g of %s <= tolerance %g over %u PARTs)",TimeSteady,Variation,name.c_str(),Tolerance,WindowSize));
+}
+
+//==============================================================================
+/// Stores state of the sliding window in checkpoint data.
+/// Guarda el estado de la ventana deslizante en datos de checkpoint.
+//==============================================================================
+void JSphSteadyState::SaveCheckpoint(JBinaryData *data)const{
+  JBinaryData *item=data->CreateItem("SteadyState");
+  item->SetvUint("NumValues",NumValues);
+  item->SetvUint("WindowSize",WindowSize);
+  item->SetvUint("Count",Count);
+  item->SetvUint("Position",Position);
+  item->SetvDouble("Variation",Variation);
+  item->SetvUint("VariationIdx",VariationIdx);
+  item->SetvBool("Steady",Steady);
+  item->SetvDouble("TimeSteady",TimeSteady);
+  item->SetvLlong("FileCsvSize",(FileCsv.empty()? 0: fun::FileSize(FileCsv)));
+  if(NumValues){
+    item->CreateArray("Values",JBinaryDataDef::DatDouble,unsigned(Values.size()),&Values[0],false);
+    item->CreateArray("LastValues",JBinaryDataDef::DatDouble,unsigned(LastValues.size()),&LastValues[0],false);
+  }
+}
+
+//==============================================================================
+/// Restores state of the sliding window from checkpoint.
+/// Restaura el estado de la ventana deslizante desde checkpoint.
+//==============================================================================
+void JSphSteadyState::LoadCheckpoint(const JSphCheckpoint *ckp){
+  JBinaryData *item=ckp->GetItem("SteadyState");
+  if(item->GetvUint("NumValues")!=NumValues || item->GetvUint("WindowSize")!=WindowSize)RunException("LoadCheckpoint","Configuration of steady state does not match the checkpoint.");
+  Count=item->GetvUint("Count");
+  Position=item->GetvUint("Position");
+  Variation=item->GetvDouble("Variation");
+  VariationIdx=item->GetvUint("VariationIdx");
+  Steady=item->GetvBool("Steady");
+  TimeSteady=item->GetvDouble("TimeSteady");
+  //-Continues the CSV file of the previous execution.
+  const llong fsize=item->GetvLlong("FileCsvSize");
+  if(fsize>0){
+    const string file=AppInfo.GetDirOut()+"SteadyState.csv";
+    if(fun::FileSize(file)>=fsize && fun::FileTruncate(file,fsize)){
+      FileCsv=file;
+      Log->AddFileInfo(FileCsv,"Saves values monitored to detect the steady state (by JSphSteadyState).");
+    }
+    else Log->PrintfWarning("Values of steady state before the checkpoint are not available in \"%s\", a new file is created.",file.c_str());
+  }
+  if(NumValues){
+    ckp->LoadArray(item,"Values",JBinaryDataDef::DatDouble,unsigned(Values.size()),&Values[0]);
+    ckp->LoadArray(item,"LastValues",JBinaryDataDef::DatDouble,unsigned(LastValues.size()),&LastValues[0]);
+  }
+}
+
@@ -0,0 +1,116 @@
+//HEAD_DSPH
+/*
+ <DUALSPHYSICS>  Copyright (c) 2019 by Dr Jose M. Dominguez et al. (see http://dual.sphysics.org/index.php/developers/). 
+
+ EPHYSLAB Environmental Physics Laboratory, Universidade de Vigo, Ourense, Spain.
+ School of Mechanical, Aerospace and Civil Engineering, University of Manchester, Manchester, U.K.
+
+ This file is part of DualSPHysics. 
+
+ DualSPHysics is free software: you can redistribute it and/or modify it under the terms of the GNU Lesser General Public License 
+ as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) any later version.
+ 
+ DualSPHysics is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details. 
+
+ You should have received a copy of the GNU Lesser General Public License along with DualSPHysics. If not, see <http://www.gnu.org/licenses/>. 
+*/
+
+//:#############################################################################
+//:# Cambios:
+//:# =========
+//:# - Clase para detectar el estado estacionario de la simulacion a partir de
+//:#   la variacion de magnitudes monitorizadas en cada PART. (18-10-2026)
+//:# - Grabacion y carga del estado para checkpoint/restart. (18-10-2026)
+//:# - El fichero CSV se continua al reiniciar desde checkpoint. (18-10-2026)
+//:#############################################################################
+
+/// \file JSphSteadyState.h \brief Declares the class \ref JSphSteadyState.
+
+#ifndef _JSphSteadyState_
+#define _JSphSteadyState_
+
+#include <string>
+#include <vector>
+#include "JObject.h"
+#include "Types.h"
+
+class JXml;
+class TiXmlElement;
+class JLog2;
+class JGaugeSystem;
+class JGaugeItem;
+class JBinaryData;
+class JSphCheckpoint;
+
+//##############################################################################
+//# XML format in _FmtXML_SteadyState.xml.
+//##############################################################################
+
+//##############################################################################
+//# JSphSteadyState
+//##############################################################################
+/// \brief Detects the steady state of the simulation using the variation of 
+/// monitored values over a sliding window of PARTs.
+
+class JSphSteadyState : protected JObject
+{
+private:
+  JLog2* Log;
+  std::string FileCsv;      ///<CSV file with monitored values for each PART.
+
+  //-Configuration variables.
+  double TimeStart;         ///<Time to start checking the steady state.
+  unsigned WindowSize;      ///<Number of PARTs in the sliding window.
+  double Tolerance;         ///<Maximum relative variation of monitored values in the window.
+  bool UseKinEnergy;        ///<Monitors kinetic energy of fluid particles.
+  bool UseVelMax;           ///<Monitors maximum velocity of fluid particles.
+  bool UseAllGauges;        ///<Monitors results of all gauges.
+  std::vector<std::string> GaugeNames; ///<Names of monitored gauges.
+
+  //-Monitored values.
+  std::vector<unsigned> GaugeIdx;      ///<Index of monitored gauges in JGaugeSystem.
+  std::vector<std::string> ValueNames; ///<Names of monitored values.
+  unsigned NumValues;                  ///<Number of monitored values.
+  std::vector<double> Values;          ///<Circular buffer with monitored values [WindowSize*NumValues].
+  std::vector<double> LastValues;      ///<Values of last PART [NumValues].
+  unsigned Count;                      ///<Number of stored PARTs in buffer (up to WindowSize).
+  unsigned Position;                   ///<Next position in circular buffer.
+
+  //-Results.
+  double Variation;         ///<Maximum relative variation in the last window.
+  unsigned VariationIdx;    ///<Index of value with maximum relative variation.
+  bool Steady;              ///<Steady state was reached.
+  double TimeSteady;        ///<Time when steady state was reached.
+
+  void ReadXml(JXml *sxml,TiXmlElement* ele);
+  void LoadXml(JXml *sxml,const std::string &place);
+  static double GetGaugeValue(const JGaugeItem *gau);
+  double ComputeVariation(unsigned cv)const;
+  void SaveCsvValues(double timestep);
+
+public:
+  JSphSteadyState(JLog2* log);
+  ~JSphSteadyState();
+  void Reset();
+  void Config(JXml *sxml,const std::string &place,const JGaugeSystem *gaugesystem);
+  void VisuConfig(std::string txhead,std::string txfoot)const;
+
+  bool GetUseKinEnergy()const{ return(UseKinEnergy); }
+  bool GetUseVelMax()const{ return(UseVelMax); }
+
+  bool AddValues(double timestep,double kinenergy,double velmax,const JGaugeSystem *gaugesystem);
+
+  bool IsSteady()const{ return(Steady); }
+  double GetVariation()const{ return(Variation); }
+  double GetTimeSteady()const{ return(TimeSteady); }
+  std::string GetStopInfo()const;
+
+  void SaveCheckpoint(JBinaryData *data)const;
+  void LoadCheckpoint(const JSphCheckpoint *ckp);
+};
+
+
+#endif
+
+
@@ -26,6 +26,7 @@
 #include "JPeriodicDef.h"
 #include "OmpDefs.h"
 #include <algorithm>
+#include <climits>
 
 #define DELTA_HEAVYFLOATING  ///<Applies DeltaSPH to fluid particles interacting with floatings with higher density (massp>MassFluid*1.2). | Aplica DeltaSPH a fluido que interaccionan con floatings pesados (massp>MassFluid*1.2). NO_COMENTARIO
 
@@ -92,6 +93,15 @@
   #define CODE_TYPE_FLUID_INOUT     0x1ff0  //---First inlet/outlet code: 8176 (Allows 16 different codes for InOut particles). //<vs_innlet>
 #endif
 
+//#define IDP_SIZE8  //-Enables or disables the use of ullong type (64 bits) for particle identifiers (only CPU). | Activa o desactiva el uso de ullong (64 bits) para el identificador de particula (solo CPU).
+#ifdef IDP_SIZE8
+  typedef ullong typeidp;           //-Type of the particle identifier using 8 bytes.
+  #define IDP_MAX ULLONG_MAX        //-Maximum value of the particle identifier. | Valor maximo del identificador de particula.
+#else
+  typedef unsigned typeidp;         //-Type of the particle identifier using 4 bytes.
+  #define IDP_MAX UINT_MAX          //-Maximum value of the particle identifier. | Valor maximo del identificador de particula.
+#endif
+
 #define CODE_SetNormal(code)    (code&(~CODE_MASKSPECIAL))
 #define CODE_SetPeriodic(code)  (CODE_SetNormal(code)|CODE_PERIODIC)
 #define CODE_SetOutIgnore(code) (CODE_SetNormal(code)|CODE_OUTIGNORE)
@@ -285,6 +295,23 @@ inline const char* GetNameCellMode(TpCellMode cellmode){
   return("???");
 }
 
+///Modes of huge pages for large CPU arrays.
+typedef enum{ 
+   HPAGES_None=0          ///<Arrays aligned to cache line (64 bytes) without huge pages.
+  ,HPAGES_Transparent=1   ///<Transparent huge pages are requested with madvise().
+  ,HPAGES_Explicit=2      ///<Explicit huge pages of 2 MB (MAP_HUGETLB), transparent ones when they are not available.
+}TpHugePages; 
+
+///Returns the name of the huge pages mode in text format.
+inline const char* GetNameHugePages(TpHugePages hpages){
+  switch(hpages){
+    case HPAGES_None:         return("None");
+    case HPAGES_Transparent:  return("Transparent");
+    case HPAGES_Explicit:     return("Explicit");
+  }
+  return("???");
+}
+
 ///Modes of BlockSize selection.
 #define BSIZE_FIXED 128
 typedef enum{ 
@@ -48,6 +48,8 @@ Please download source files and documentation from <a href="http://dual.sphysic
 #include "JCfgRun.h"
 #include "JException.h"
 #include "JSphCpuSingle.h"
+#include "JGaugeBi4.h"
+#include "JFormatCheck.h"
 #ifdef _WITHGPU
   #include "JSphGpuSingle.h"
 #endif
@@ -122,7 +124,24 @@ int main(int argc, char** argv){
   try{
     cfg.LoadArgv(argc,argv);
     //cfg.VisuConfig();
-    if(!cfg.PrintInfo){
+    if(!cfg.GaugesCsv.empty()){
+      //-Converts results of gauges in binary format to CSV files.
+      JGaugeBi4Load gbin;
+      gbin.LoadFile(cfg.GaugesCsv);
+      const unsigned nfiles=gbin.SaveCsv(fun::GetDirParent(cfg.GaugesCsv),cfg.CsvSepComa);
+      printf("Results of %u gauges saved in %u CSV files.\n",gbin.GetGaugeCount(),nfiles);
+    }
+    else if(!cfg.CsvBenchDir.empty()){
+      //-Measures the writing of CSV files.
+      JFormatCheck fcheck;
+      if(!fcheck.CsvBenchmark(cfg.CsvBenchDir,cfg.CsvBenchNp,cfg.CsvSepComa))throw "The CSV files are not identical.";
+    }
+    else if(!cfg.VtuCheckDir.empty()){
+      //-Checks the writing and reading of VTU files.
+      JFormatCheck fcheck;
+      if(!fcheck.VtuRoundTrip(cfg.VtuCheckDir,cfg.VtuCheckNp))throw "The data loaded from VTU files is not identical.";
+    }
+    else if(!cfg.PrintInfo){
       AppInfo.ConfigOutput(cfg.CreateDirs,cfg.CsvSepComa,cfg.DirOut,cfg.DirDataOut);
       AppInfo.LogInit(AppInfo.GetDirOut()+"/Run.out");
       log=AppInfo.LogPtr();